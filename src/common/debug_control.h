@@ -2,3 +2,9 @@
 
 // Prevent system-wide input lagging while paused in the debugger
 //#define DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED
+
+// Measure the latency of the Keyboard Manager hook handlers. The latency statistics are added to the module settings sent to the runner
+//#define KEYBOARDMANAGER_HOOK_LATENCY_METRICS
+
+// Record the key events received by the Keyboard Manager hook. The recording is saved to the module save folder when the hook is stopped, and can be replayed headlessly by the Keyboard Manager tests
+//#define KEYBOARDMANAGER_RECORD_HOOK_EVENTS
@@ -0,0 +1,121 @@
+#include "LayoutCache.h"
+
+#include <algorithm>
+
+namespace LayoutEngine
+{
+    LayoutCache::LayoutCache(size_t capacity) :
+        m_capacity((std::max)(capacity, size_t{ 1 }))
+    {
+    }
+
+    std::optional<Zones> LayoutCache::CalculateLayout(LayoutType type, long workAreaWidth, long workAreaHeight, int zoneCount, int spacing)
+    {
+        Key key{ KeyKind::Predefined, { static_cast<long>(type), workAreaWidth, workAreaHeight, zoneCount, spacing } };
+        return Find(std::move(key), [&] {
+            return LayoutEngine::CalculateLayout(type, workAreaWidth, workAreaHeight, zoneCount, spacing);
+        });
+    }
+
+    std::optional<Zones> LayoutCache::CalculateGridZones(const GridLayout& gridLayout, long workAreaWidth, long workAreaHeight, int spacing)
+    {
+        Key key{ KeyKind::Grid, { workAreaWidth, workAreaHeight, spacing, gridLayout.rows, gridLayout.columns } };
+        key.values.insert(key.values.end(), gridLayout.rowsPercents.begin(), gridLayout.rowsPercents.end());
+        key.values.insert(key.values.end(), gridLayout.columnsPercents.begin(), gridLayout.columnsPercents.end());
+        for (const auto& row : gridLayout.cellChildMap)
+        {
+            // The row size keeps maps with rows of different lengths apart
+            key.values.push_back(static_cast<long>(row.size()));
+            key.values.insert(key.values.end(), row.begin(), row.end());
+        }
+
+        return Find(std::move(key), [&] {
+            return LayoutEngine::CalculateGridZones(gridLayout, workAreaWidth, workAreaHeight, spacing);
+        });
+    }
+
+    std::optional<Zones> LayoutCache::CalculateCanvasZones(const std::vector<CanvasZone>& zones, Dpi dpi)
+    {
+        Key key{ KeyKind::Canvas, { static_cast<long>(dpi.x), static_cast<long>(dpi.y) } };
+        key.values.reserve(2 + zones.size() * 4);
+        for (const auto& zone : zones)
+        {
+            key.values.insert(key.values.end(), { zone.x, zone.y, zone.width, zone.height });
+        }
+
+        return Find(std::move(key), [&] {
+            return LayoutEngine::CalculateCanvasZones(zones, dpi);
+        });
+    }
+
+    void LayoutCache::Clear()
+    {
+        std::scoped_lock lock{ m_lock };
+        m_index.clear();
+        m_entries.clear();
+    }
+
+    size_t LayoutCache::Size() const
+    {
+        std::scoped_lock lock{ m_lock };
+        return m_entries.size();
+    }
+
+    LayoutCache::Statistics LayoutCache::GetStatistics() const
+    {
+        std::scoped_lock lock{ m_lock };
+        return m_statistics;
+    }
+
+    size_t LayoutCache::KeyHash::operator()(const Key& key) const noexcept
+    {
+        // FNV-1a over the kind and the values
+        size_t hash = 14695981039346656037ull;
+        auto combine = [&hash](unsigned long long value) {
+            hash ^= static_cast<size_t>(value);
+            hash *= 1099511628211ull;
+        };
+
+        combine(static_cast<unsigned long long>(key.kind));
+        for (const long value : key.values)
+        {
+            combine(static_cast<unsigned long long>(value));
+        }
+
+        return hash;
+    }
+
+    template<typename Calculate>
+    std::optional<Zones> LayoutCache::Find(Key&& key, Calculate&& calculate)
+    {
+        {
+            std::scoped_lock lock{ m_lock };
+            if (const auto it = m_index.find(key); it != m_index.end())
+            {
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                m_statistics.hits++;
+                return it->second->zones;
+            }
+
+            m_statistics.misses++;
+        }
+
+        // Calculate outside of the lock, another thread may be calculating the same layout in the meantime
+        auto zones = calculate();
+
+        std::scoped_lock lock{ m_lock };
+        if (m_index.find(key) == m_index.end())
+        {
+            m_entries.push_front(Entry{ key, zones });
+            m_index.emplace(std::move(key), m_entries.begin());
+
+            if (m_entries.size() > m_capacity)
+            {
+                m_index.erase(m_entries.back().key);
+                m_entries.pop_back();
+            }
+        }
+
+        return zones;
+    }
+}
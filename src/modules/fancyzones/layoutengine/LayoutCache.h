@@ -0,0 +1,85 @@
+#pragma once
+
+#include "LayoutEngine.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace LayoutEngine
+{
+    /**
+     * Least recently used cache of computed layouts, safe to use from several threads.
+     *
+     * Entries are keyed by every input of the calculation (the layout type or the definition of a custom layout,
+     * zone count, spacing, work area size and, for canvas layouts, the DPI), so they never have to be invalidated:
+     * an edited custom layout or a changed work area simply maps to another entry. Zones are relative to the work
+     * area, so monitors with the same work area size share their entries.
+     */
+    class LayoutCache
+    {
+    public:
+        static constexpr size_t DefaultCapacity = 128;
+
+        struct Statistics
+        {
+            size_t hits{};
+            size_t misses{};
+        };
+
+        explicit LayoutCache(size_t capacity = DefaultCapacity);
+
+        LayoutCache(const LayoutCache&) = delete;
+        LayoutCache& operator=(const LayoutCache&) = delete;
+
+        /**
+         * Same as the layout engine functions with the same name, served from the cache when possible.
+         */
+        std::optional<Zones> CalculateLayout(LayoutType type, long workAreaWidth, long workAreaHeight, int zoneCount, int spacing);
+        std::optional<Zones> CalculateGridZones(const GridLayout& gridLayout, long workAreaWidth, long workAreaHeight, int spacing);
+        std::optional<Zones> CalculateCanvasZones(const std::vector<CanvasZone>& zones, Dpi dpi);
+
+        void Clear();
+        size_t Size() const;
+        Statistics GetStatistics() const;
+
+    private:
+        enum class KeyKind
+        {
+            Predefined,
+            Grid,
+            Canvas,
+        };
+
+        struct Key
+        {
+            KeyKind kind;
+            // All inputs of the calculation, flattened
+            std::vector<long> values;
+
+            bool operator==(const Key& other) const = default;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const noexcept;
+        };
+
+        struct Entry
+        {
+            Key key;
+            std::optional<Zones> zones;
+        };
+
+        template<typename Calculate>
+        std::optional<Zones> Find(Key&& key, Calculate&& calculate);
+
+        const size_t m_capacity;
+
+        mutable std::mutex m_lock;
+        // Most recently used entry first
+        std::list<Entry> m_entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+        Statistics m_statistics;
+    };
+}
@@ -0,0 +1,399 @@
+#include "LayoutEngine.h"
+
+#include <iterator>
+
+namespace
+{
+    using namespace LayoutEngine;
+
+    // PriorityGrid layout is unique for zoneCount <= 11. For zoneCount > 11 PriorityGrid is same as Grid
+    const GridLayout predefinedPriorityGridLayouts[11] = {
+        /* 1 */
+        GridLayout{
+            .rows = 1,
+            .columns = 1,
+            .rowsPercents = { 10000 },
+            .columnsPercents = { 10000 },
+            .cellChildMap = { { 0 } } },
+        /* 2 */
+        GridLayout{
+            .rows = 1,
+            .columns = 2,
+            .rowsPercents = { 10000 },
+            .columnsPercents = { 6667, 3333 },
+            .cellChildMap = { { 0, 1 } } },
+        /* 3 */
+        GridLayout{
+            .rows = 1,
+            .columns = 3,
+            .rowsPercents = { 10000 },
+            .columnsPercents = { 2500, 5000, 2500 },
+            .cellChildMap = { { 0, 1, 2 } } },
+        /* 4 */
+        GridLayout{
+            .rows = 2,
+            .columns = 3,
+            .rowsPercents = { 5000, 5000 },
+            .columnsPercents = { 2500, 5000, 2500 },
+            .cellChildMap = { { 0, 1, 2 }, { 0, 1, 3 } } },
+        /* 5 */
+        GridLayout{
+            .rows = 2,
+            .columns = 3,
+            .rowsPercents = { 5000, 5000 },
+            .columnsPercents = { 2500, 5000, 2500 },
+            .cellChildMap = { { 0, 1, 2 }, { 3, 1, 4 } } },
+        /* 6 */
+        GridLayout{
+            .rows = 3,
+            .columns = 3,
+            .rowsPercents = { 3333, 3334, 3333 },
+            .columnsPercents = { 2500, 5000, 2500 },
+            .cellChildMap = { { 0, 1, 2 }, { 0, 1, 3 }, { 4, 1, 5 } } },
+        /* 7 */
+        GridLayout{
+            .rows = 3,
+            .columns = 3,
+            .rowsPercents = { 3333, 3334, 3333 },
+            .columnsPercents = { 2500, 5000, 2500 },
+            .cellChildMap = { { 0, 1, 2 }, { 3, 1, 4 }, { 5, 1, 6 } } },
+        /* 8 */
+        GridLayout{
+            .rows = 3,
+            .columns = 4,
+            .rowsPercents = { 3333, 3334, 3333 },
+            .columnsPercents = { 2500, 2500, 2500, 2500 },
+            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 2, 5 }, { 6, 1, 2, 7 } } },
+        /* 9 */
+        GridLayout{
+            .rows = 3,
+            .columns = 4,
+            .rowsPercents = { 3333, 3334, 3333 },
+            .columnsPercents = { 2500, 2500, 2500, 2500 },
+            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 2, 5 }, { 6, 1, 7, 8 } } },
+        /* 10 */
+        GridLayout{
+            .rows = 3,
+            .columns = 4,
+            .rowsPercents = { 3333, 3334, 3333 },
+            .columnsPercents = { 2500, 2500, 2500, 2500 },
+            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 5, 6 }, { 7, 1, 8, 9 } } },
+        /* 11 */
+        GridLayout{
+            .rows = 3,
+            .columns = 4,
+            .rowsPercents = { 3333, 3334, 3333 },
+            .columnsPercents = { 2500, 2500, 2500, 2500 },
+            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 5, 6 }, { 7, 8, 9, 10 } } },
+    };
+
+    // All zones within zone set should be valid in order to use its functionality.
+    bool AddZone(Zones& zones, size_t id, const ZoneRect& rect)
+    {
+        if (!IsValidZoneRect(rect))
+        {
+            return false;
+        }
+
+        zones.push_back(Zone{ .id = id, .rect = rect });
+        return true;
+    }
+}
+
+namespace LayoutEngine
+{
+    bool IsValidZoneRect(const ZoneRect& rect) noexcept
+    {
+        long width = rect.right - rect.left;
+        long height = rect.bottom - rect.top;
+        return rect.left >= MaxNegativeSpacing &&
+               rect.right >= MaxNegativeSpacing &&
+               rect.top >= MaxNegativeSpacing &&
+               rect.bottom >= MaxNegativeSpacing &&
+               width >= 0 && height >= 0;
+    }
+
+    std::optional<Zones> CalculateLayout(LayoutType type, long workAreaWidth, long workAreaHeight, int zoneCount, int spacing)
+    {
+        //invalid work area
+        if (workAreaWidth == 0 || workAreaHeight == 0)
+        {
+            return std::nullopt;
+        }
+
+        //invalid zoneCount, may cause division by zero
+        if (zoneCount <= 0)
+        {
+            return std::nullopt;
+        }
+
+        switch (type)
+        {
+        case LayoutType::Focus:
+            return CalculateFocusLayout(workAreaWidth, workAreaHeight, zoneCount);
+        case LayoutType::Columns:
+        case LayoutType::Rows:
+            return CalculateColumnsAndRowsLayout(type, workAreaWidth, workAreaHeight, zoneCount, spacing);
+        case LayoutType::Grid:
+        case LayoutType::PriorityGrid:
+            return CalculateGridLayout(type, workAreaWidth, workAreaHeight, zoneCount, spacing);
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<Zones> CalculateFocusLayout(long workAreaWidth, long workAreaHeight, int zoneCount)
+    {
+        long left{ 100 };
+        long top{ 100 };
+        long right{ left + long(workAreaWidth * 0.4) };
+        long bottom{ top + long(workAreaHeight * 0.4) };
+
+        ZoneRect focusZoneRect{ left, top, right, bottom };
+
+        long focusRectXIncrement = (zoneCount <= 1) ? 0 : 50;
+        long focusRectYIncrement = (zoneCount <= 1) ? 0 : 50;
+
+        Zones zones;
+        zones.reserve(zoneCount);
+        for (int i = 0; i < zoneCount; i++)
+        {
+            if (!AddZone(zones, zones.size(), focusZoneRect))
+            {
+                return std::nullopt;
+            }
+
+            focusZoneRect.left += focusRectXIncrement;
+            focusZoneRect.right += focusRectXIncrement;
+            focusZoneRect.bottom += focusRectYIncrement;
+            focusZoneRect.top += focusRectYIncrement;
+        }
+
+        return zones;
+    }
+
+    std::optional<Zones> CalculateColumnsAndRowsLayout(LayoutType type, long workAreaWidth, long workAreaHeight, int zoneCount, int spacing)
+    {
+        long totalWidth;
+        long totalHeight;
+
+        if (type == LayoutType::Columns)
+        {
+            totalWidth = workAreaWidth - (spacing * (zoneCount + 1));
+            totalHeight = workAreaHeight - (spacing * 2);
+        }
+        else
+        { //Rows
+            totalWidth = workAreaWidth - (spacing * 2);
+            totalHeight = workAreaHeight - (spacing * (zoneCount + 1));
+        }
+
+        long top = spacing;
+        long left = spacing;
+        long bottom;
+        long right;
+
+        Zones zones;
+        zones.reserve(zoneCount);
+
+        // Note: The expressions below are NOT equal to total{Width|Height} / zoneCount and are done
+        // like this to make the sum of all zones' sizes exactly total{Width|Height}.
+        for (int zoneIndex = 0; zoneIndex < zoneCount; ++zoneIndex)
+        {
+            if (type == LayoutType::Columns)
+            {
+                right = left + (zoneIndex + 1) * totalWidth / zoneCount - zoneIndex * totalWidth / zoneCount;
+                bottom = totalHeight + spacing;
+            }
+            else
+            { //Rows
+                right = totalWidth + spacing;
+                bottom = top + (zoneIndex + 1) * totalHeight / zoneCount - zoneIndex * totalHeight / zoneCount;
+            }
+
+            if (!AddZone(zones, zones.size(), ZoneRect{ left, top, right, bottom }))
+            {
+                return std::nullopt;
+            }
+
+            if (type == LayoutType::Columns)
+            {
+                left = right + spacing;
+            }
+            else
+            { //Rows
+                top = bottom + spacing;
+            }
+        }
+
+        return zones;
+    }
+
+    std::optional<Zones> CalculateGridLayout(LayoutType type, long workAreaWidth, long workAreaHeight, int zoneCount, int spacing)
+    {
+        if (type == LayoutType::PriorityGrid)
+        {
+            if (const GridLayout* priorityGridLayout = GetPriorityGridLayout(zoneCount))
+            {
+                return CalculateGridZones(*priorityGridLayout, workAreaWidth, workAreaHeight, spacing);
+            }
+        }
+
+        return CalculateGridZones(MakeGridLayout(zoneCount), workAreaWidth, workAreaHeight, spacing);
+    }
+
+    std::optional<Zones> CalculateGridZones(const GridLayout& gridLayout, long workAreaWidth, long workAreaHeight, int spacing)
+    {
+        long totalWidth = workAreaWidth - (spacing * (gridLayout.columns + 1));
+        long totalHeight = workAreaHeight - (spacing * (gridLayout.rows + 1));
+        struct Info
+        {
+            long Extent;
+            long Start;
+            long End;
+        };
+        std::vector<Info> rowInfo(gridLayout.rows);
+        std::vector<Info> columnInfo(gridLayout.columns);
+
+        // Note: The expressions below are carefully written to
+        // make the sum of all zones' sizes exactly total{Width|Height}
+        int totalPercents = 0;
+        for (int row = 0; row < gridLayout.rows; row++)
+        {
+            rowInfo[row].Start = totalPercents * totalHeight / PercentsMultiplier + (row + 1) * spacing;
+            totalPercents += gridLayout.rowsPercents[row];
+            rowInfo[row].End = totalPercents * totalHeight / PercentsMultiplier + (row + 1) * spacing;
+            rowInfo[row].Extent = rowInfo[row].End - rowInfo[row].Start;
+        }
+
+        totalPercents = 0;
+        for (int col = 0; col < gridLayout.columns; col++)
+        {
+            columnInfo[col].Start = totalPercents * totalWidth / PercentsMultiplier + (col + 1) * spacing;
+            totalPercents += gridLayout.columnsPercents[col];
+            columnInfo[col].End = totalPercents * totalWidth / PercentsMultiplier + (col + 1) * spacing;
+            columnInfo[col].Extent = columnInfo[col].End - columnInfo[col].Start;
+        }
+
+        Zones zones;
+        for (int row = 0; row < gridLayout.rows; row++)
+        {
+            for (int col = 0; col < gridLayout.columns; col++)
+            {
+                int i = gridLayout.cellChildMap[row][col];
+                if (((row == 0) || (gridLayout.cellChildMap[row - 1][col] != i)) &&
+                    ((col == 0) || (gridLayout.cellChildMap[row][col - 1] != i)))
+                {
+                    long left = columnInfo[col].Start;
+                    long top = rowInfo[row].Start;
+
+                    int maxRow = row;
+                    while (((maxRow + 1) < gridLayout.rows) && (gridLayout.cellChildMap[maxRow + 1][col] == i))
+                    {
+                        maxRow++;
+                    }
+                    int maxCol = col;
+                    while (((maxCol + 1) < gridLayout.columns) && (gridLayout.cellChildMap[row][maxCol + 1] == i))
+                    {
+                        maxCol++;
+                    }
+
+                    long right = columnInfo[maxCol].End;
+                    long bottom = rowInfo[maxRow].End;
+
+                    if (!AddZone(zones, static_cast<size_t>(i), ZoneRect{ left, top, right, bottom }))
+                    {
+                        return std::nullopt;
+                    }
+                }
+            }
+        }
+
+        return zones;
+    }
+
+    std::optional<Zones> CalculateCanvasZones(const std::vector<CanvasZone>& canvasZones, Dpi dpi)
+    {
+        Zones zones;
+        zones.reserve(canvasZones.size());
+        for (const auto& zone : canvasZones)
+        {
+            const int x = zone.x * static_cast<int>(dpi.x) / static_cast<int>(DefaultDpi);
+            const int y = zone.y * static_cast<int>(dpi.y) / static_cast<int>(DefaultDpi);
+            const int width = zone.width * static_cast<int>(dpi.x) / static_cast<int>(DefaultDpi);
+            const int height = zone.height * static_cast<int>(dpi.y) / static_cast<int>(DefaultDpi);
+
+            if (!AddZone(zones, zones.size(), ZoneRect{ x, y, x + width, y + height }))
+            {
+                return std::nullopt;
+            }
+        }
+
+        return zones;
+    }
+
+    GridLayout MakeGridLayout(int zoneCount)
+    {
+        int rows = 1, columns = 1;
+        while (zoneCount / rows >= rows)
+        {
+            rows++;
+        }
+        rows--;
+        columns = zoneCount / rows;
+        if (zoneCount % rows == 0)
+        {
+            // even grid
+        }
+        else
+        {
+            columns++;
+        }
+
+        GridLayout gridLayout;
+        gridLayout.rows = rows;
+        gridLayout.columns = columns;
+        gridLayout.rowsPercents.resize(rows);
+        gridLayout.columnsPercents.resize(columns);
+
+        // Note: The expressions below are NOT equal to PercentsMultiplier / {rows|columns} and are done
+        // like this to make the sum of all percents exactly PercentsMultiplier
+        for (int row = 0; row < rows; row++)
+        {
+            gridLayout.rowsPercents[row] = PercentsMultiplier * (row + 1) / rows - PercentsMultiplier * row / rows;
+        }
+        for (int col = 0; col < columns; col++)
+        {
+            gridLayout.columnsPercents[col] = PercentsMultiplier * (col + 1) / columns - PercentsMultiplier * col / columns;
+        }
+
+        gridLayout.cellChildMap.assign(rows, std::vector<int>(columns));
+
+        int index = 0;
+        for (int row = 0; row < rows; row++)
+        {
+            for (int col = 0; col < columns; col++)
+            {
+                gridLayout.cellChildMap[row][col] = index++;
+                if (index == zoneCount)
+                {
+                    index--;
+                }
+            }
+        }
+
+        return gridLayout;
+    }
+
+    const GridLayout* GetPriorityGridLayout(int zoneCount) noexcept
+    {
+        // The predefined grid for 11 zones is not used, 11 zones fall back to the Grid layout
+        const int count = static_cast<int>(std::size(predefinedPriorityGridLayouts));
+        if (zoneCount <= 0 || zoneCount >= count)
+        {
+            return nullptr;
+        }
+
+        return &predefinedPriorityGridLayouts[zoneCount - 1];
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Layout math of FancyZones. It has no dependency on Windows or on the zone objects, so that it builds on its own
+// and layouts can be computed and profiled without a desktop session.
+// Zones are computed relative to the top left corner of the work area.
+namespace LayoutEngine
+{
+    // Zones may extend out of the work area by a negative spacing, but not further than this
+    constexpr int MaxNegativeSpacing = -10;
+
+    // Sum of the row or column percents of a grid layout
+    constexpr int PercentsMultiplier = 10000;
+
+    constexpr unsigned DefaultDpi = 96;
+
+    enum class LayoutType
+    {
+        Focus,
+        Columns,
+        Rows,
+        Grid,
+        PriorityGrid,
+    };
+
+    struct ZoneRect
+    {
+        long left{};
+        long top{};
+        long right{};
+        long bottom{};
+
+        bool operator==(const ZoneRect& other) const = default;
+    };
+
+    struct Zone
+    {
+        size_t id{};
+        ZoneRect rect;
+
+        bool operator==(const Zone& other) const = default;
+    };
+
+    // Zones of a layout, in the order in which FancyZones adds them to the zone set
+    using Zones = std::vector<Zone>;
+
+    struct GridLayout
+    {
+        int rows{};
+        int columns{};
+        std::vector<int> rowsPercents;
+        std::vector<int> columnsPercents;
+        // Id of the zone covering each cell, zones cover rectangular groups of cells
+        std::vector<std::vector<int>> cellChildMap;
+    };
+
+    // Zone of a canvas layout, in unscaled pixels
+    struct CanvasZone
+    {
+        int x{};
+        int y{};
+        int width{};
+        int height{};
+    };
+
+    struct Dpi
+    {
+        unsigned x = DefaultDpi;
+        unsigned y = DefaultDpi;
+    };
+
+    /**
+     * Check the rules every zone of a layout has to follow.
+     */
+    bool IsValidZoneRect(const ZoneRect& rect) noexcept;
+
+    /**
+     * Calculate the zones of a predefined layout.
+     *
+     * @param   type            Type of the layout.
+     * @param   workAreaWidth   Width of the work area.
+     * @param   workAreaHeight  Height of the work area.
+     * @param   zoneCount       Number of zones in the layout.
+     * @param   spacing         Space between the zones and around them, can be negative.
+     *
+     * @returns The zones of the layout, or nullopt if the parameters are invalid or a zone would not be valid.
+     */
+    std::optional<Zones> CalculateLayout(LayoutType type, long workAreaWidth, long workAreaHeight, int zoneCount, int spacing);
+
+    std::optional<Zones> CalculateFocusLayout(long workAreaWidth, long workAreaHeight, int zoneCount);
+    std::optional<Zones> CalculateColumnsAndRowsLayout(LayoutType type, long workAreaWidth, long workAreaHeight, int zoneCount, int spacing);
+    std::optional<Zones> CalculateGridLayout(LayoutType type, long workAreaWidth, long workAreaHeight, int zoneCount, int spacing);
+
+    /**
+     * Calculate the zones of a grid layout, predefined or custom.
+     */
+    std::optional<Zones> CalculateGridZones(const GridLayout& gridLayout, long workAreaWidth, long workAreaHeight, int spacing);
+
+    /**
+     * Calculate the zones of a custom canvas layout.
+     *
+     * @param   zones   Zones of the layout, in unscaled pixels.
+     * @param   dpi     DPI of the monitor the zones are scaled to.
+     */
+    std::optional<Zones> CalculateCanvasZones(const std::vector<CanvasZone>& zones, Dpi dpi);
+
+    /**
+     * @returns The grid of a Grid layout with the given number of zones, which must be positive.
+     */
+    GridLayout MakeGridLayout(int zoneCount);
+
+    /**
+     * @returns The predefined grid of a PriorityGrid layout, or nullptr if PriorityGrid has no unique grid
+     *          for this number of zones and falls back to the Grid layout.
+     */
+    const GridLayout* GetPriorityGridLayout(int zoneCount) noexcept;
+}
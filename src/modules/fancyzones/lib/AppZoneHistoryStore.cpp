@@ -0,0 +1,243 @@
+#include "pch.h"
+#include "AppZoneHistoryStore.h"
+
+#include <algorithm>
+
+using FancyZonesDataTypes::AppZoneHistoryData;
+
+AppZoneHistoryStore::Id AppZoneHistoryStore::StringTable::Intern(std::wstring_view value)
+{
+    if (auto it = m_ids.find(value); it != m_ids.end())
+    {
+        return it->second;
+    }
+
+    const Id id = static_cast<Id>(m_strings.size());
+    auto [it, inserted] = m_ids.emplace(std::wstring{ value }, id);
+    m_strings.push_back(&it->first);
+    return id;
+}
+
+std::optional<AppZoneHistoryStore::Id> AppZoneHistoryStore::StringTable::Find(std::wstring_view value) const noexcept
+{
+    if (auto it = m_ids.find(value); it != m_ids.end())
+    {
+        return it->second;
+    }
+
+    return std::nullopt;
+}
+
+void AppZoneHistoryStore::StringTable::Clear() noexcept
+{
+    m_ids.clear();
+    m_strings.clear();
+}
+
+void AppZoneHistoryStore::Assign(HistoryMap history)
+{
+    m_history = std::move(history);
+    RebuildIndex();
+}
+
+void AppZoneHistoryStore::Clear() noexcept
+{
+    m_history.clear();
+    m_index.clear();
+    m_apps.Clear();
+    m_devices.Clear();
+}
+
+AppZoneHistoryData* AppZoneHistoryStore::Find(std::wstring_view appPath, std::wstring_view deviceId) noexcept
+{
+    const auto location = Locate(appPath, deviceId);
+    return location ? &(*location->entries)[location->position] : nullptr;
+}
+
+const AppZoneHistoryData* AppZoneHistoryStore::Find(std::wstring_view appPath, std::wstring_view deviceId) const noexcept
+{
+    const auto location = Locate(appPath, deviceId);
+    return location ? &(*location->entries)[location->position] : nullptr;
+}
+
+AppZoneHistoryData& AppZoneHistoryStore::Insert(const std::wstring& appPath, AppZoneHistoryData data)
+{
+    if (auto existing = Find(appPath, data.deviceId))
+    {
+        *existing = std::move(data);
+        return *existing;
+    }
+
+    const Id app = m_apps.Intern(appPath);
+    const Id device = m_devices.Intern(data.deviceId);
+
+    auto& entries = m_history[appPath];
+    entries.push_back(std::move(data));
+    m_index[MakeKey(app, device)] = Location{ &entries, entries.size() - 1 };
+    return entries.back();
+}
+
+bool AppZoneHistoryStore::Erase(std::wstring_view appPath, std::wstring_view deviceId)
+{
+    const auto location = Locate(appPath, deviceId);
+    if (!location)
+    {
+        return false;
+    }
+
+    const Id app = *m_apps.Find(appPath);
+    m_index.erase(MakeKey(app, *m_devices.Find(deviceId)));
+
+    auto& entries = *location->entries;
+    entries.erase(entries.begin() + location->position);
+    if (entries.empty())
+    {
+        m_history.erase(m_apps.Get(app));
+    }
+    else
+    {
+        IndexApp(app, entries);
+    }
+
+    return true;
+}
+
+void AppZoneHistoryStore::EraseDevices(const std::function<bool(const std::wstring& deviceId)>& predicate)
+{
+    // The predicate is evaluated once per device rather than once per entry
+    std::vector<bool> erased(m_devices.Size());
+    bool any = false;
+    for (Id device = 0; device < erased.size(); device++)
+    {
+        erased[device] = predicate(m_devices.Get(device));
+        any = any || erased[device];
+    }
+
+    if (!any)
+    {
+        return;
+    }
+
+    for (auto it = m_history.begin(); it != m_history.end();)
+    {
+        const Id app = *m_apps.Find(it->first);
+        auto& entries = it->second;
+        const auto isErased = [&](const AppZoneHistoryData& data) {
+            return erased[*m_devices.Find(data.deviceId)];
+        };
+
+        if (std::none_of(entries.begin(), entries.end(), isErased))
+        {
+            ++it;
+            continue;
+        }
+
+        for (const auto& data : entries)
+        {
+            m_index.erase(MakeKey(app, *m_devices.Find(data.deviceId)));
+        }
+
+        entries.erase(std::remove_if(entries.begin(), entries.end(), isErased), entries.end());
+        if (entries.empty())
+        {
+            it = m_history.erase(it);
+        }
+        else
+        {
+            IndexApp(app, entries);
+            ++it;
+        }
+    }
+}
+
+void AppZoneHistoryStore::RenameDevices(const std::function<std::optional<std::wstring>(const std::wstring& deviceId)>& rename)
+{
+    bool renamed = false;
+    for (auto& [appPath, entries] : m_history)
+    {
+        for (auto& data : entries)
+        {
+            if (auto newDeviceId = rename(data.deviceId))
+            {
+                data.deviceId = std::move(*newDeviceId);
+                renamed = true;
+            }
+        }
+    }
+
+    if (renamed)
+    {
+        RebuildIndex();
+    }
+}
+
+std::optional<AppZoneHistoryStore::Location> AppZoneHistoryStore::Locate(std::wstring_view appPath, std::wstring_view deviceId) const noexcept
+{
+    const auto app = m_apps.Find(appPath);
+    const auto device = m_devices.Find(deviceId);
+    if (!app || !device)
+    {
+        return std::nullopt;
+    }
+
+    if (auto it = m_index.find(MakeKey(*app, *device)); it != m_index.end())
+    {
+        return it->second;
+    }
+
+    return std::nullopt;
+}
+
+void AppZoneHistoryStore::IndexApp(Id app, std::vector<AppZoneHistoryData>& entries)
+{
+    for (size_t position = 0; position < entries.size(); position++)
+    {
+        m_index[MakeKey(app, m_devices.Intern(entries[position].deviceId))] = Location{ &entries, position };
+    }
+}
+
+void AppZoneHistoryStore::RebuildIndex()
+{
+    m_index.clear();
+    m_apps.Clear();
+    m_devices.Clear();
+
+    for (auto it = m_history.begin(); it != m_history.end();)
+    {
+        const Id app = m_apps.Intern(it->first);
+        auto& entries = it->second;
+
+        // Drop the entries for a device which already has one, they could never be found
+        std::vector<bool> seen;
+        size_t kept = 0;
+        for (size_t position = 0; position < entries.size(); position++)
+        {
+            const Id device = m_devices.Intern(entries[position].deviceId);
+            if (device >= seen.size())
+            {
+                seen.resize(device + 1);
+            }
+
+            if (!seen[device])
+            {
+                seen[device] = true;
+                if (kept != position)
+                {
+                    entries[kept] = std::move(entries[position]);
+                }
+                kept++;
+            }
+        }
+        entries.erase(entries.begin() + kept, entries.end());
+
+        if (entries.empty())
+        {
+            it = m_history.erase(it);
+        }
+        else
+        {
+            IndexApp(app, entries);
+            ++it;
+        }
+    }
+}
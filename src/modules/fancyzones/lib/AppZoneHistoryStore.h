@@ -0,0 +1,114 @@
+#pragma once
+
+#include "FancyZonesDataTypes.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * App zone history, indexed by application and device.
+ *
+ * The history is kept in the layout it is serialized in (application path to the history on each device), next
+ * to an index mapping an (application, device) pair to its entry. Application paths and device ids are interned,
+ * so a lookup hashes each string once, compares integers and doesn't allocate.
+ *
+ * An application has at most one entry per device. Pointers returned by Find stay valid until the history of
+ * the same application is modified through the store.
+ */
+class AppZoneHistoryStore
+{
+public:
+    using HistoryMap = std::unordered_map<std::wstring, std::vector<FancyZonesDataTypes::AppZoneHistoryData>>;
+
+    /**
+     * @returns The history of all applications, in the layout it is serialized in.
+     */
+    const HistoryMap& GetMap() const noexcept { return m_history; }
+
+    /**
+     * Replace the whole history, e.g. with the one read from the disk. Only the first entry of an application on
+     * a device is kept.
+     */
+    void Assign(HistoryMap history);
+    void Clear() noexcept;
+
+    /**
+     * @returns The history of the application on the device, or nullptr if there is none.
+     */
+    FancyZonesDataTypes::AppZoneHistoryData* Find(std::wstring_view appPath, std::wstring_view deviceId) noexcept;
+    const FancyZonesDataTypes::AppZoneHistoryData* Find(std::wstring_view appPath, std::wstring_view deviceId) const noexcept;
+
+    /**
+     * Add the history of the application on the device given by data.deviceId, replacing the existing one.
+     */
+    FancyZonesDataTypes::AppZoneHistoryData& Insert(const std::wstring& appPath, FancyZonesDataTypes::AppZoneHistoryData data);
+
+    /**
+     * Remove the history of the application on the device.
+     *
+     * @returns True if there was a history to remove.
+     */
+    bool Erase(std::wstring_view appPath, std::wstring_view deviceId);
+
+    /**
+     * Remove the history of all applications on the devices accepted by the predicate.
+     */
+    void EraseDevices(const std::function<bool(const std::wstring& deviceId)>& predicate);
+
+    /**
+     * Change device ids. The function returns the new id of a device, or nullopt to keep its id.
+     */
+    void RenameDevices(const std::function<std::optional<std::wstring>(const std::wstring& deviceId)>& rename);
+
+private:
+    using Id = uint32_t;
+
+    // Hash accepting any string type, so that lookups don't have to construct a std::wstring
+    struct StringHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::wstring_view value) const noexcept { return std::hash<std::wstring_view>{}(value); }
+    };
+
+    // Maps strings to small integers. Strings are never removed, only cleared all at once
+    class StringTable
+    {
+    public:
+        Id Intern(std::wstring_view value);
+        std::optional<Id> Find(std::wstring_view value) const noexcept;
+        const std::wstring& Get(Id id) const noexcept { return *m_strings[id]; }
+        size_t Size() const noexcept { return m_strings.size(); }
+        void Clear() noexcept;
+
+    private:
+        std::unordered_map<std::wstring, Id, StringHash, std::equal_to<>> m_ids;
+        // Keys of m_ids by id, map nodes don't move
+        std::vector<const std::wstring*> m_strings;
+    };
+
+    static uint64_t MakeKey(Id app, Id device) noexcept { return (static_cast<uint64_t>(app) << 32) | device; }
+
+    struct Location
+    {
+        // History of the application, the value of its m_history node
+        std::vector<FancyZonesDataTypes::AppZoneHistoryData>* entries;
+        size_t position;
+    };
+
+    std::optional<Location> Locate(std::wstring_view appPath, std::wstring_view deviceId) const noexcept;
+
+    // Index the entries of one application again after their positions changed
+    void IndexApp(Id app, std::vector<FancyZonesDataTypes::AppZoneHistoryData>& entries);
+    void RebuildIndex();
+
+    HistoryMap m_history;
+
+    StringTable m_apps;
+    StringTable m_devices;
+    std::unordered_map<uint64_t, Location> m_index;
+};
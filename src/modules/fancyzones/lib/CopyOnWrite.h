@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Value shared between threads which is read much more often than it is changed.
+ *
+ * Readers get an immutable snapshot of the value and use it without holding any lock, so they never wait for
+ * a writer. Writers are serialized, each one copies the current value, changes the copy and publishes it as the
+ * new snapshot. Snapshots taken before a write keep seeing the previous value.
+ */
+template<typename T>
+class CopyOnWrite
+{
+public:
+    CopyOnWrite() :
+        m_snapshot(std::make_shared<const T>())
+    {
+    }
+
+    explicit CopyOnWrite(T value) :
+        m_snapshot(std::make_shared<const T>(std::move(value)))
+    {
+    }
+
+    CopyOnWrite(const CopyOnWrite&) = delete;
+    CopyOnWrite& operator=(const CopyOnWrite&) = delete;
+
+    /**
+     * @returns The current value, which doesn't change while the snapshot is held.
+     */
+    std::shared_ptr<const T> Read() const
+    {
+        std::scoped_lock lock{ m_snapshotLock };
+        return m_snapshot;
+    }
+
+    /**
+     * Change the value. The update function is called with a copy of the current value, which is published
+     * once it returns. The result of the update function is returned.
+     */
+    template<typename Update>
+    auto Write(Update&& update)
+    {
+        std::scoped_lock lock{ m_writeLock };
+        auto value = std::make_shared<T>(*Read());
+        if constexpr (std::is_void_v<std::invoke_result_t<Update, T&>>)
+        {
+            std::forward<Update>(update)(*value);
+            Publish(std::move(value));
+        }
+        else
+        {
+            auto result = std::forward<Update>(update)(*value);
+            Publish(std::move(value));
+            return result;
+        }
+    }
+
+    /**
+     * Replace the value.
+     */
+    void Assign(T value)
+    {
+        std::scoped_lock lock{ m_writeLock };
+        Publish(std::make_shared<T>(std::move(value)));
+    }
+
+private:
+    void Publish(std::shared_ptr<const T> value)
+    {
+        // The previous value is released outside of the lock, readers only wait for the pointer swap
+        std::shared_ptr<const T> previous;
+        {
+            std::scoped_lock lock{ m_snapshotLock };
+            previous = std::exchange(m_snapshot, std::move(value));
+        }
+    }
+
+    // Serializes writers, so that no change is lost
+    std::mutex m_writeLock;
+    // Guards the snapshot pointer only
+    mutable std::mutex m_snapshotLock;
+    std::shared_ptr<const T> m_snapshot;
+};
@@ -19,6 +19,9 @@
 
 #include <lib/SecondaryMouseButtonsHook.h>
 
+#include <atomic>
+#include <chrono>
+
 extern "C" IMAGE_DOS_HEADER __ImageBase;
 
 enum class DisplayChangeType
@@ -65,28 +68,31 @@ public:
 
     void MoveSizeStart(HWND window, HMONITOR monitor, POINT const& ptScreen) noexcept
     {
-        std::unique_lock writeLock(m_lock);
         if (m_settings->GetSettings()->spanZonesAcrossMonitors)
         {
             monitor = NULL;
         }
-        m_windowMoveHandler.MoveSizeStart(window, monitor, ptScreen, m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId));
+        const auto workAreas = m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId);
+        std::scoped_lock lock(m_windowMoveLock);
+        m_windowMoveHandler.MoveSizeStart(window, monitor, ptScreen, *workAreas);
     }
 
     void MoveSizeUpdate(HMONITOR monitor, POINT const& ptScreen) noexcept
     {
-        std::unique_lock writeLock(m_lock);
         if (m_settings->GetSettings()->spanZonesAcrossMonitors)
         {
             monitor = NULL;
         }
-        m_windowMoveHandler.MoveSizeUpdate(monitor, ptScreen, m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId));
+        const auto workAreas = m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId);
+        std::scoped_lock lock(m_windowMoveLock);
+        m_windowMoveHandler.MoveSizeUpdate(monitor, ptScreen, *workAreas);
     }
 
     void MoveSizeEnd(HWND window, POINT const& ptScreen) noexcept
     {
-        std::unique_lock writeLock(m_lock);
-        m_windowMoveHandler.MoveSizeEnd(window, ptScreen, m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId));
+        const auto workAreas = m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId);
+        std::scoped_lock lock(m_windowMoveLock);
+        m_windowMoveHandler.MoveSizeEnd(window, ptScreen, *workAreas);
     }
 
     IFACEMETHODIMP_(void)
@@ -118,6 +124,12 @@ public:
                 PostMessageW(m_window, WM_PRIV_WINDOWCREATED, wparam, lparam);
             }
             break;
+        case EVENT_OBJECT_DESTROY:
+            if (data->idObject == OBJID_WINDOW && data->idChild == CHILDID_SELF)
+            {
+                PostMessageW(m_window, WM_PRIV_WINDOWDESTROYED, wparam, lparam);
+            }
+            break;
         }
     }
 
@@ -167,7 +179,7 @@ public:
     IFACEMETHODIMP_(bool)
     InMoveSize() noexcept
     {
-        std::shared_lock readLock(m_lock);
+        std::scoped_lock lock(m_windowMoveLock);
         return m_windowMoveHandler.InMoveSize();
     }
 
@@ -228,14 +240,20 @@ private:
 
     const HINSTANCE m_hinstance{};
 
+    // The state is split in parts synchronized independently, so that drag handling doesn't wait for the
+    // editor, the creation of work areas or the zone data being saved.
+    // Guards the FancyZones window and the editor state.
     mutable std::shared_mutex m_lock;
     HWND m_window{};
+    // Guards the state of the window being dragged and the windows moved by FancyZones.
+    std::mutex m_windowMoveLock;
     WindowMoveHandler m_windowMoveHandler;
+    // Synchronized by itself, lookups read a snapshot of the work areas.
     MonitorWorkAreaHandler m_workAreaHandler;
 
     winrt::com_ptr<IFancyZonesSettings> m_settings{};
-    GUID m_previousDesktopId{}; // UUID of previously active virtual desktop.
-    GUID m_currentDesktopId{}; // UUID of the current virtual desktop.
+    std::atomic<GUID> m_previousDesktopId{}; // UUID of previously active virtual desktop.
+    std::atomic<GUID> m_currentDesktopId{}; // UUID of the current virtual desktop.
     wil::unique_handle m_terminateEditorEvent; // Handle of FancyZonesEditor.exe we launch and wait on
     wil::unique_handle m_terminateVirtualDesktopTrackerEvent;
 
@@ -319,6 +337,9 @@ FancyZones::Destroy() noexcept
     {
         SetEvent(m_terminateVirtualDesktopTrackerEvent.get());
     }
+
+    // Changes are written behind, make sure that nothing is lost when FancyZones is disabled or the runner exits
+    FancyZonesDataInstance().FlushPendingSaves();
 }
 
 // IFancyZonesCallback
@@ -384,7 +405,7 @@ std::pair<winrt::com_ptr<IZoneWindow>, std::vector<size_t>> FancyZones::GetAppZo
 std::pair<winrt::com_ptr<IZoneWindow>, std::vector<size_t>> FancyZones::GetAppZoneHistoryInfo(HWND window, HMONITOR monitor, bool isPrimaryMonitor) noexcept
 {
     std::pair<winrt::com_ptr<IZoneWindow>, std::vector<size_t>> appZoneHistoryInfo{ nullptr, {} };
-    auto workAreaMap = m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId);
+    auto workAreaMap = *m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId);
 
     // Search application history on currently active monitor.
     appZoneHistoryInfo = GetAppZoneHistoryInfo(window, monitor, workAreaMap);
@@ -410,7 +431,10 @@ void FancyZones::MoveWindowIntoZone(HWND window, winrt::com_ptr<IZoneWindow> zon
     auto& fancyZonesData = FancyZonesDataInstance();
     if (!fancyZonesData.IsAnotherWindowOfApplicationInstanceZoned(window, zoneWindow->UniqueId()))
     {
-        m_windowMoveHandler.MoveWindowIntoZoneByIndexSet(window, zoneIndexSet, zoneWindow);
+        {
+            std::scoped_lock lock(m_windowMoveLock);
+            m_windowMoveHandler.MoveWindowIntoZoneByIndexSet(window, zoneIndexSet, zoneWindow);
+        }
         fancyZonesData.UpdateProcessIdToHandleMap(window, zoneWindow->UniqueId());
     }
 }
@@ -486,7 +510,6 @@ void OpenWindowOnActiveMonitor(HWND window, HMONITOR monitor) noexcept
 IFACEMETHODIMP_(void)
 FancyZones::WindowCreated(HWND window) noexcept
 {
-    std::shared_lock readLock(m_lock);
     GUID desktopId{};
     if (VirtualDesktopUtils::GetWindowDesktopId(window, &desktopId) && desktopId != m_currentDesktopId)
     {
@@ -615,8 +638,6 @@ void FancyZones::ToggleEditor() noexcept
 
     winrt::com_ptr<IZoneWindow> zoneWindow;
 
-    std::shared_lock readLock(m_lock);
-
     if (m_settings->GetSettings()->spanZonesAcrossMonitors)
     {
         zoneWindow = m_workAreaHandler.GetWorkArea(m_currentDesktopId, NULL);
@@ -870,6 +891,11 @@ LRESULT FancyZones::WndProc(HWND window, UINT message, WPARAM wparam, LPARAM lpa
             auto hwnd = reinterpret_cast<HWND>(wparam);
             WindowCreated(hwnd);
         }
+        else if (message == WM_PRIV_WINDOWDESTROYED)
+        {
+            auto hwnd = reinterpret_cast<HWND>(wparam);
+            FancyZonesDataInstance().WindowDestroyed(hwnd);
+        }
         else
         {
             return DefWindowProc(window, message, wparam, lparam);
@@ -885,7 +911,7 @@ void FancyZones::OnDisplayChange(DisplayChangeType changeType) noexcept
     if (changeType == DisplayChangeType::VirtualDesktop ||
         changeType == DisplayChangeType::Initialization)
     {
-        m_previousDesktopId = m_currentDesktopId;
+        m_previousDesktopId = m_currentDesktopId.load();
         GUID currentVirtualDesktopId{};
         if (VirtualDesktopUtils::GetCurrentVirtualDesktopId(&currentVirtualDesktopId))
         {
@@ -919,8 +945,6 @@ void FancyZones::OnDisplayChange(DisplayChangeType changeType) noexcept
 
 void FancyZones::AddZoneWindow(HMONITOR monitor, const std::wstring& deviceId) noexcept
 {
-    std::unique_lock writeLock(m_lock);
-
     if (m_workAreaHandler.IsNewWorkArea(m_currentDesktopId, monitor))
     {
         wil::unique_cotaskmem_string virtualDesktopId;
@@ -951,7 +975,7 @@ void FancyZones::AddZoneWindow(HMONITOR monitor, const std::wstring& deviceId) n
             if (workArea)
             {
                 m_workAreaHandler.AddWorkArea(m_currentDesktopId, monitor, workArea);
-                FancyZonesDataInstance().SaveFancyZonesData();
+                FancyZonesDataInstance().ScheduleZoneSettingsSave();
             }
         }
     }
@@ -1030,10 +1054,26 @@ void FancyZones::UpdateZoneWindows() noexcept
 
 void FancyZones::UpdateWindowsPositions() noexcept
 {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Zoned windows with their zone bitmask
+    std::vector<std::pair<HWND, size_t>> zonedWindows;
     auto callback = [](HWND window, LPARAM data) -> BOOL {
         size_t bitmask = reinterpret_cast<size_t>(::GetProp(window, ZonedWindowProperties::PropertyMultipleZoneID));
 
         if (bitmask != 0)
+        {
+            reinterpret_cast<std::vector<std::pair<HWND, size_t>>*>(data)->emplace_back(window, bitmask);
+        }
+        return TRUE;
+    };
+    EnumWindows(callback, reinterpret_cast<LPARAM>(&zonedWindows));
+
+    // Compute the placement of all windows under a single lock, then move them together without holding it
+    FancyZonesUtils::WindowPlacementBatch batch;
+    {
+        std::scoped_lock lock(m_windowMoveLock);
+        for (const auto& [window, bitmask] : zonedWindows)
         {
             std::vector<size_t> indexSet;
             for (int i = 0; i < std::numeric_limits<size_t>::digits; i++)
@@ -1044,17 +1084,20 @@ void FancyZones::UpdateWindowsPositions() noexcept
                 }
             }
 
-            auto strongThis = reinterpret_cast<FancyZones*>(data);
-            std::unique_lock writeLock(strongThis->m_lock);
-            auto zoneWindow = strongThis->m_workAreaHandler.GetWorkArea(window);
+            auto zoneWindow = m_workAreaHandler.GetWorkArea(window);
             if (zoneWindow)
             {
-                strongThis->m_windowMoveHandler.MoveWindowIntoZoneByIndexSet(window, indexSet, zoneWindow);
+                if (const auto rect = m_windowMoveHandler.PlaceWindowIntoZoneByIndexSet(window, indexSet, zoneWindow))
+                {
+                    batch.Add(window, *rect);
+                }
             }
         }
-        return TRUE;
-    };
-    EnumWindows(callback, reinterpret_cast<LPARAM>(this));
+    }
+
+    const auto result = batch.Apply();
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    Trace::FancyZones::WindowsPositionsUpdated(result.windows, result.deferred, result.batches, duration.count());
 }
 
 void FancyZones::CycleActiveZoneSet(DWORD vkCode) noexcept
@@ -1065,8 +1108,6 @@ void FancyZones::CycleActiveZoneSet(DWORD vkCode) noexcept
         const HMONITOR monitor = MonitorFromWindow(window, MONITOR_DEFAULTTONULL);
         if (monitor)
         {
-            std::shared_lock readLock(m_lock);
-
             auto zoneWindow = m_workAreaHandler.GetWorkArea(m_currentDesktopId, monitor);
             if (zoneWindow)
             {
@@ -1096,7 +1137,7 @@ bool FancyZones::OnSnapHotkeyBasedOnZoneNumber(HWND window, DWORD vkCode) noexce
         auto currMonitorInfo = std::find(std::begin(monitorInfo), std::end(monitorInfo), current);
         do
         {
-            std::unique_lock writeLock(m_lock);
+            std::scoped_lock lock(m_windowMoveLock);
             if (m_windowMoveHandler.MoveWindowIntoZoneByDirectionAndIndex(window, vkCode, false /* cycle through zones */, m_workAreaHandler.GetWorkArea(m_currentDesktopId, *currMonitorInfo)))
             {
                 return true;
@@ -1123,7 +1164,7 @@ bool FancyZones::OnSnapHotkeyBasedOnZoneNumber(HWND window, DWORD vkCode) noexce
     else
     {
         // Single monitor environment, or combined multi-monitor environment.
-        std::unique_lock writeLock(m_lock);
+        std::scoped_lock lock(m_windowMoveLock);
         if (m_settings->GetSettings()->restoreSize)
         {
             bool moved = m_windowMoveHandler.MoveWindowIntoZoneByDirectionAndIndex(window, vkCode, false /* cycle through zones */, m_workAreaHandler.GetWorkArea(m_currentDesktopId, current));
@@ -1218,6 +1259,7 @@ bool FancyZones::OnSnapHotkeyBasedOnPosition(HWND window, DWORD vkCode) noexcept
         {
             // Moving to another monitor succeeded
             const auto& [trueZoneIdx, zoneWindow] = zoneRectsInfo[chosenIdx];
+            std::scoped_lock lock(m_windowMoveLock);
             m_windowMoveHandler.MoveWindowIntoZoneByIndexSet(window, { trueZoneIdx }, zoneWindow);
             return true;
         }
@@ -1262,6 +1304,7 @@ bool FancyZones::OnSnapHotkeyBasedOnPosition(HWND window, DWORD vkCode) noexcept
         {
             // Moving to another monitor succeeded
             const auto& [trueZoneIdx, zoneWindow] = zoneRectsInfo[chosenIdx];
+            std::scoped_lock lock(m_windowMoveLock);
             m_windowMoveHandler.MoveWindowIntoZoneByIndexSet(window, { trueZoneIdx }, zoneWindow);
             return true;
         }
@@ -1297,6 +1340,8 @@ bool FancyZones::OnSnapHotkey(DWORD vkCode) noexcept
 
 bool FancyZones::ProcessDirectedSnapHotkey(HWND window, DWORD vkCode, bool cycle, winrt::com_ptr<IZoneWindow> zoneWindow) noexcept
 {
+    std::scoped_lock lock(m_windowMoveLock);
+
     // Check whether Alt is used in the shortcut key combination
     if (GetAsyncKeyState(VK_MENU) & 0x8000)
     {
@@ -1310,8 +1355,6 @@ bool FancyZones::ProcessDirectedSnapHotkey(HWND window, DWORD vkCode, bool cycle
 
 void FancyZones::RegisterVirtualDesktopUpdates(std::vector<GUID>& ids) noexcept
 {
-    std::unique_lock writeLock(m_lock);
-
     m_workAreaHandler.RegisterUpdates(ids);
     std::vector<std::wstring> active{};
     if (VirtualDesktopUtils::GetVirtualDesktopIds(active))
@@ -1378,8 +1421,6 @@ bool FancyZones::ShouldProcessSnapHotkey(DWORD vkCode) noexcept
 
 std::vector<HMONITOR> FancyZones::GetMonitorsSorted() noexcept
 {
-    std::shared_lock readLock(m_lock);
-
     auto monitorInfo = GetRawMonitorData();
     FancyZonesUtils::OrderMonitors(monitorInfo);
     std::vector<HMONITOR> output;
@@ -1389,11 +1430,9 @@ std::vector<HMONITOR> FancyZones::GetMonitorsSorted() noexcept
 
 std::vector<std::pair<HMONITOR, RECT>> FancyZones::GetRawMonitorData() noexcept
 {
-    std::shared_lock readLock(m_lock);
-
     std::vector<std::pair<HMONITOR, RECT>> monitorInfo;
-    const auto& activeWorkAreaMap = m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId);
-    for (const auto& [monitor, workArea] : activeWorkAreaMap)
+    const auto activeWorkAreaMap = m_workAreaHandler.GetWorkAreasByDesktopId(m_currentDesktopId);
+    for (const auto& [monitor, workArea] : *activeWorkAreaMap)
     {
         if (workArea->ActiveZoneSet() != nullptr)
         {
@@ -4,6 +4,7 @@
 #include "JsonHelpers.h"
 #include "ZoneSet.h"
 #include "Settings.h"
+#include "trace.h"
 
 #include <common/common.h>
 #include <common/json.h>
@@ -27,6 +28,8 @@ namespace NonLocalizable
     const wchar_t DefaultGuid[] = L"{00000000-0000-0000-0000-000000000000}";
     const wchar_t RegistryPath[] = L"Software\\SuperFancyZones";
 
+    const wchar_t ApplicationFrameHost[] = L"ApplicationFrameHost.exe";
+
     const wchar_t ActiveZoneSetsTmpFileName[] = L"FancyZonesActiveZoneSets.json";
     const wchar_t AppliedZoneSetsTmpFileName[] = L"FancyZonesAppliedZoneSets.json";
     const wchar_t DeletedCustomZoneSetsTmpFileName[] = L"FancyZonesDeletedCustomZoneSets.json";
@@ -155,29 +158,41 @@ FancyZonesData::FancyZonesData()
     activeZoneSetTmpFileName = GetTempDirPath() + NonLocalizable::ActiveZoneSetsTmpFileName;
     appliedZoneSetTmpFileName = GetTempDirPath() + NonLocalizable::AppliedZoneSetsTmpFileName;
     deletedCustomZoneSetsTmpFileName = GetTempDirPath() + NonLocalizable::DeletedCustomZoneSetsTmpFileName;
+
+    zoneSettingsSection = persister.AddSection([this] { SaveZoneSettings(); });
+    appZoneHistorySection = persister.AddSection([this] { SaveAppZoneHistory(); });
 }
 
 std::optional<FancyZonesDataTypes::DeviceInfoData> FancyZonesData::FindDeviceInfo(const std::wstring& zoneWindowId) const
 {
-    std::scoped_lock lock{ dataLock };
-    auto it = deviceInfoMap.find(zoneWindowId);
-    return it != end(deviceInfoMap) ? std::optional{ it->second } : std::nullopt;
+    const auto devices = deviceInfoMap.Read();
+    auto it = devices->find(zoneWindowId);
+    return it != end(*devices) ? std::optional{ it->second } : std::nullopt;
 }
 
 std::optional<FancyZonesDataTypes::CustomZoneSetData> FancyZonesData::FindCustomZoneSet(const std::wstring& guid) const
 {
-    std::scoped_lock lock{ dataLock };
-    auto it = customZoneSetsMap.find(guid);
-    return it != end(customZoneSetsMap) ? std::optional{ it->second } : std::nullopt;
+    const auto customZoneSets = customZoneSetsMap.Read();
+    auto it = customZoneSets->find(guid);
+    return it != end(*customZoneSets) ? std::optional{ it->second } : std::nullopt;
 }
 
 bool FancyZonesData::AddDevice(const std::wstring& deviceId)
 {
     using namespace FancyZonesDataTypes;
 
-    std::scoped_lock lock{ dataLock };
-    if (!deviceInfoMap.contains(deviceId))
+    // Most work areas are created for known devices, don't copy the map for them
+    if (deviceInfoMap.Read()->contains(deviceId))
     {
+        return false;
+    }
+
+    return deviceInfoMap.Write([&](auto& devices) {
+        if (devices.contains(deviceId))
+        {
+            return false;
+        }
+
         // Creates default entry in map when ZoneWindow is created
         GUID guid;
         auto result{ CoCreateGuid(&guid) };
@@ -186,17 +201,15 @@ bool FancyZonesData::AddDevice(const std::wstring& deviceId)
         {
             const ZoneSetData zoneSetData{ guidString.get(), ZoneSetLayoutType::PriorityGrid };
             DeviceInfoData defaultDeviceInfoData{ zoneSetData, DefaultValues::ShowSpacing, DefaultValues::Spacing, DefaultValues::ZoneCount, DefaultValues::SensitivityRadius };
-            deviceInfoMap[deviceId] = std::move(defaultDeviceInfoData);
+            devices[deviceId] = std::move(defaultDeviceInfoData);
         }
         else
         {
-            deviceInfoMap[deviceId] = DeviceInfoData{ ZoneSetData{ NonLocalizable::NullStr, ZoneSetLayoutType::Blank } };
+            devices[deviceId] = DeviceInfoData{ ZoneSetData{ NonLocalizable::NullStr, ZoneSetLayoutType::Blank } };
         }
 
         return true;
-    }
-
-    return false;
+    });
 }
 
 void FancyZonesData::CloneDeviceInfo(const std::wstring& source, const std::wstring& destination)
@@ -205,15 +218,14 @@ void FancyZonesData::CloneDeviceInfo(const std::wstring& source, const std::wstr
     {
         return;
     }
-    std::scoped_lock lock{ dataLock };
-
-    // The source virtual desktop is deleted, simply ignore it.
-    if (!deviceInfoMap.contains(source))
-    {
-        return;
-    }
 
-    deviceInfoMap[destination] = deviceInfoMap[source];
+    deviceInfoMap.Write([&](auto& devices) {
+        // The source virtual desktop is deleted, simply ignore it.
+        if (devices.contains(source))
+        {
+            devices[destination] = devices[source];
+        }
+    });
 }
 
 void FancyZonesData::UpdatePrimaryDesktopData(const std::wstring& desktopId)
@@ -227,83 +239,84 @@ void FancyZonesData::UpdatePrimaryDesktopData(const std::wstring& desktopId)
     auto replaceDesktopId = [&desktopId](const std::wstring& deviceId) {
         return deviceId.substr(0, deviceId.rfind('_') + 1) + desktopId;
     };
-    std::scoped_lock lock{ dataLock };
-    for (auto& [path, perDesktopData] : appZoneHistoryMap)
     {
-        for (auto& data : perDesktopData)
+        std::scoped_lock lock{ appZoneHistoryLock };
+        appZoneHistory.RenameDevices([&](const std::wstring& deviceId) -> std::optional<std::wstring> {
+            if (ExtractVirtualDesktopId(deviceId) == NonLocalizable::DefaultGuid)
+            {
+                return replaceDesktopId(deviceId);
+            }
+            return std::nullopt;
+        });
+    }
+    deviceInfoMap.Write([&](auto& devices) {
+        std::vector<std::wstring> toReplace{};
+        for (const auto& [id, data] : devices)
         {
-            if (ExtractVirtualDesktopId(data.deviceId) == NonLocalizable::DefaultGuid)
+            if (ExtractVirtualDesktopId(id) == NonLocalizable::DefaultGuid)
             {
-                data.deviceId = replaceDesktopId(data.deviceId);
+                toReplace.push_back(id);
             }
         }
-    }
-    std::vector<std::wstring> toReplace{};
-    for (const auto& [id, data] : deviceInfoMap)
-    {
-        if (ExtractVirtualDesktopId(id) == NonLocalizable::DefaultGuid)
+        for (const auto& id : toReplace)
         {
-            toReplace.push_back(id);
+            auto mapEntry = devices.extract(id);
+            mapEntry.key() = replaceDesktopId(id);
+            devices.insert(std::move(mapEntry));
         }
-    }
-    for (const auto& id : toReplace)
-    {
-        auto mapEntry = deviceInfoMap.extract(id);
-        mapEntry.key() = replaceDesktopId(id);
-        deviceInfoMap.insert(std::move(mapEntry));
-    }
-    SaveFancyZonesData();
+    });
+    persister.MarkDirty(zoneSettingsSection);
+    persister.MarkDirty(appZoneHistorySection);
 }
 
 void FancyZonesData::RemoveDeletedDesktops(const std::vector<std::wstring>& activeDesktops)
 {
     std::unordered_set<std::wstring> active(std::begin(activeDesktops), std::end(activeDesktops));
-    std::scoped_lock lock{ dataLock };
-    for (auto it = std::begin(deviceInfoMap); it != std::end(deviceInfoMap);)
-    {
-        std::wstring desktopId = ExtractVirtualDesktopId(it->first);
-        auto foundId = active.find(desktopId);
-        if (foundId == std::end(active))
-        {
-            RemoveDesktopAppZoneHistory(desktopId);
-            it = deviceInfoMap.erase(it);
-        }
-        else
+    std::unordered_set<std::wstring> deleted{};
+    deviceInfoMap.Write([&](auto& devices) {
+        for (auto it = std::begin(devices); it != std::end(devices);)
         {
-            ++it;
+            std::wstring desktopId = ExtractVirtualDesktopId(it->first);
+            auto foundId = active.find(desktopId);
+            if (foundId == std::end(active))
+            {
+                deleted.insert(std::move(desktopId));
+                it = devices.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
         }
+    });
+    for (const auto& desktopId : deleted)
+    {
+        RemoveDesktopAppZoneHistory(desktopId);
     }
-    SaveFancyZonesData();
+    persister.MarkDirty(zoneSettingsSection);
+    persister.MarkDirty(appZoneHistorySection);
 }
 
 bool FancyZonesData::IsAnotherWindowOfApplicationInstanceZoned(HWND window, const std::wstring_view& deviceId) const
 {
-    std::scoped_lock lock{ dataLock };
-    auto processPath = get_process_path(window);
+    std::scoped_lock lock{ appZoneHistoryLock };
+    const auto& processPath = GetProcessPath(window);
     if (!processPath.empty())
     {
-        auto history = appZoneHistoryMap.find(processPath);
-        if (history != std::end(appZoneHistoryMap))
+        if (const auto data = appZoneHistory.Find(processPath, deviceId))
         {
-            auto& perDesktopData = history->second;
-            for (auto& data : perDesktopData)
+            DWORD processId = 0;
+            GetWindowThreadProcessId(window, &processId);
+
+            auto processIdIt = data->processIdToHandleMap.find(processId);
+
+            if (processIdIt == std::end(data->processIdToHandleMap))
             {
-                if (data.deviceId == deviceId)
-                {
-                    DWORD processId = 0;
-                    GetWindowThreadProcessId(window, &processId);
-
-                    auto processIdIt = data.processIdToHandleMap.find(processId);
-
-                    if (processIdIt == std::end(data.processIdToHandleMap))
-                    {
-                        return false;
-                    }
-                    else if (processIdIt->second != window && IsWindow(processIdIt->second))
-                    {
-                        return true;
-                    }
-                }
+                return false;
+            }
+            else if (processIdIt->second != window && IsWindow(processIdIt->second))
+            {
+                return true;
             }
         }
     }
@@ -313,45 +326,29 @@ bool FancyZonesData::IsAnotherWindowOfApplicationInstanceZoned(HWND window, cons
 
 void FancyZonesData::UpdateProcessIdToHandleMap(HWND window, const std::wstring_view& deviceId)
 {
-    std::scoped_lock lock{ dataLock };
-    auto processPath = get_process_path(window);
+    std::scoped_lock lock{ appZoneHistoryLock };
+    const auto& processPath = GetProcessPath(window);
     if (!processPath.empty())
     {
-        auto history = appZoneHistoryMap.find(processPath);
-        if (history != std::end(appZoneHistoryMap))
+        if (const auto data = appZoneHistory.Find(processPath, deviceId))
         {
-            auto& perDesktopData = history->second;
-            for (auto& data : perDesktopData)
-            {
-                if (data.deviceId == deviceId)
-                {
-                    DWORD processId = 0;
-                    GetWindowThreadProcessId(window, &processId);
-                    data.processIdToHandleMap[processId] = window;
-                    break;
-                }
-            }
+            DWORD processId = 0;
+            GetWindowThreadProcessId(window, &processId);
+            data->processIdToHandleMap[processId] = window;
         }
     }
 }
 
 std::vector<size_t> FancyZonesData::GetAppLastZoneIndexSet(HWND window, const std::wstring_view& deviceId, const std::wstring_view& zoneSetId) const
 {
-    std::scoped_lock lock{ dataLock };
-    auto processPath = get_process_path(window);
+    std::scoped_lock lock{ appZoneHistoryLock };
+    const auto& processPath = GetProcessPath(window);
     if (!processPath.empty())
     {
-        auto history = appZoneHistoryMap.find(processPath);
-        if (history != std::end(appZoneHistoryMap))
+        const auto data = appZoneHistory.Find(processPath, deviceId);
+        if (data && data->zoneSetUuid == zoneSetId)
         {
-            const auto& perDesktopData = history->second;
-            for (const auto& data : perDesktopData)
-            {
-                if (data.zoneSetUuid == zoneSetId && data.deviceId == deviceId)
-                {
-                    return data.zoneIndexSet;
-                }
-            }
+            return data->zoneIndexSet;
         }
     }
 
@@ -360,50 +357,35 @@ std::vector<size_t> FancyZonesData::GetAppLastZoneIndexSet(HWND window, const st
 
 bool FancyZonesData::RemoveAppLastZone(HWND window, const std::wstring_view& deviceId, const std::wstring_view& zoneSetId)
 {
-    std::scoped_lock lock{ dataLock };
-    auto processPath = get_process_path(window);
+    std::scoped_lock lock{ appZoneHistoryLock };
+    const auto& processPath = GetProcessPath(window);
     if (!processPath.empty())
     {
-        auto history = appZoneHistoryMap.find(processPath);
-        if (history != std::end(appZoneHistoryMap))
+        const auto data = appZoneHistory.Find(processPath, deviceId);
+        if (data && data->zoneSetUuid == zoneSetId)
         {
-            auto& perDesktopData = history->second;
-            for (auto data = std::begin(perDesktopData); data != std::end(perDesktopData);)
+            if (!IsAnotherWindowOfApplicationInstanceZoned(window, deviceId))
             {
-                if (data->deviceId == deviceId && data->zoneSetUuid == zoneSetId)
-                {
-                    if (!IsAnotherWindowOfApplicationInstanceZoned(window, deviceId))
-                    {
-                        DWORD processId = 0;
-                        GetWindowThreadProcessId(window, &processId);
-
-                        data->processIdToHandleMap.erase(processId);
-                    }
-
-                    // if there is another instance of same application placed in the same zone don't erase history
-                    size_t windowZoneStamp = reinterpret_cast<size_t>(::GetProp(window, ZonedWindowProperties::PropertyMultipleZoneID));
-                    for (auto placedWindow : data->processIdToHandleMap)
-                    {
-                        size_t placedWindowZoneStamp = reinterpret_cast<size_t>(::GetProp(placedWindow.second, ZonedWindowProperties::PropertyMultipleZoneID));
-                        if (IsWindow(placedWindow.second) && (windowZoneStamp == placedWindowZoneStamp))
-                        {
-                            return false;
-                        }
-                    }
-
-                    data = perDesktopData.erase(data);
-                    if (perDesktopData.empty())
-                    {
-                        appZoneHistoryMap.erase(processPath);
-                    }
-                    SaveFancyZonesData();
-                    return true;
-                }
-                else
+                DWORD processId = 0;
+                GetWindowThreadProcessId(window, &processId);
+
+                data->processIdToHandleMap.erase(processId);
+            }
+
+            // if there is another instance of same application placed in the same zone don't erase history
+            size_t windowZoneStamp = reinterpret_cast<size_t>(::GetProp(window, ZonedWindowProperties::PropertyMultipleZoneID));
+            for (auto placedWindow : data->processIdToHandleMap)
+            {
+                size_t placedWindowZoneStamp = reinterpret_cast<size_t>(::GetProp(placedWindow.second, ZonedWindowProperties::PropertyMultipleZoneID));
+                if (IsWindow(placedWindow.second) && (windowZoneStamp == placedWindowZoneStamp))
                 {
-                    ++data;
+                    return false;
                 }
             }
+
+            appZoneHistory.Erase(processPath, deviceId);
+            persister.MarkDirty(appZoneHistorySection);
+            return true;
         }
     }
 
@@ -412,14 +394,14 @@ bool FancyZonesData::RemoveAppLastZone(HWND window, const std::wstring_view& dev
 
 bool FancyZonesData::SetAppLastZones(HWND window, const std::wstring& deviceId, const std::wstring& zoneSetId, const std::vector<size_t>& zoneIndexSet)
 {
-    std::scoped_lock lock{ dataLock };
+    std::scoped_lock lock{ appZoneHistoryLock };
 
     if (IsAnotherWindowOfApplicationInstanceZoned(window, deviceId))
     {
         return false;
     }
 
-    auto processPath = get_process_path(window);
+    const auto& processPath = GetProcessPath(window);
     if (processPath.empty())
     {
         return false;
@@ -428,22 +410,14 @@ bool FancyZonesData::SetAppLastZones(HWND window, const std::wstring& deviceId,
     DWORD processId = 0;
     GetWindowThreadProcessId(window, &processId);
 
-    auto history = appZoneHistoryMap.find(processPath);
-    if (history != std::end(appZoneHistoryMap))
+    if (const auto data = appZoneHistory.Find(processPath, deviceId))
     {
-        auto& perDesktopData = history->second;
-        for (auto& data : perDesktopData)
-        {
-            if (data.deviceId == deviceId)
-            {
-                // application already has history on this work area, update it with new window position
-                data.processIdToHandleMap[processId] = window;
-                data.zoneSetUuid = zoneSetId;
-                data.zoneIndexSet = zoneIndexSet;
-                SaveFancyZonesData();
-                return true;
-            }
-        }
+        // application already has history on this work area, update it with new window position
+        data->processIdToHandleMap[processId] = window;
+        data->zoneSetUuid = zoneSetId;
+        data->zoneIndexSet = zoneIndexSet;
+        persister.MarkDirty(appZoneHistorySection);
+        return true;
     }
 
     std::unordered_map<DWORD, HWND> processIdToHandleMap{};
@@ -453,29 +427,28 @@ bool FancyZonesData::SetAppLastZones(HWND window, const std::wstring& deviceId,
                                                   .deviceId = deviceId,
                                                   .zoneIndexSet = zoneIndexSet };
 
-    if (appZoneHistoryMap.contains(processPath))
-    {
-        // application already has history but on other desktop, add with new desktop info
-        appZoneHistoryMap[processPath].push_back(data);
-    }
-    else
-    {
-        // new application, create entry in app zone history map
-        appZoneHistoryMap[processPath] = std::vector<FancyZonesDataTypes::AppZoneHistoryData>{ data };
-    }
+    // new application, or application which has history on other work areas only
+    appZoneHistory.Insert(processPath, std::move(data));
 
-    SaveFancyZonesData();
+    persister.MarkDirty(appZoneHistorySection);
     return true;
 }
 
+void FancyZonesData::WindowDestroyed(HWND window)
+{
+    std::scoped_lock lock{ appZoneHistoryLock };
+    processPathCache.erase(window);
+}
+
 void FancyZonesData::SetActiveZoneSet(const std::wstring& deviceId, const FancyZonesDataTypes::ZoneSetData& data)
 {
-    std::scoped_lock lock{ dataLock };
-    auto it = deviceInfoMap.find(deviceId);
-    if (it != deviceInfoMap.end())
-    {
-        it->second.activeZoneSet = data;
-    }
+    deviceInfoMap.Write([&](auto& devices) {
+        auto it = devices.find(deviceId);
+        if (it != devices.end())
+        {
+            it->second.activeZoneSet = data;
+        }
+    });
 }
 
 bool FancyZonesData::SerializeDeviceInfoToTmpFile(const std::wstring& uniqueId) const
@@ -497,38 +470,40 @@ void FancyZonesData::ParseDataFromTmpFiles()
     ParseDeviceInfoFromTmpFile(activeZoneSetTmpFileName);
     ParseDeletedCustomZoneSetsFromTmpFile(deletedCustomZoneSetsTmpFileName);
     ParseCustomZoneSetFromTmpFile(appliedZoneSetTmpFileName);
-    SaveFancyZonesData();
+    persister.MarkDirty(zoneSettingsSection);
 }
 
 void FancyZonesData::ParseDeviceInfoFromTmpFile(std::wstring_view tmpFilePath)
 {
-    std::scoped_lock lock{ dataLock };
-    const auto& deviceInfo = JSONHelpers::ParseDeviceInfoFromTmpFile(tmpFilePath);
+    auto deviceInfo = JSONHelpers::ParseDeviceInfoFromTmpFile(tmpFilePath);
 
     if (deviceInfo)
     {
-        deviceInfoMap[deviceInfo->deviceId] = std::move(deviceInfo->data);
+        deviceInfoMap.Write([&](auto& devices) { devices[deviceInfo->deviceId] = std::move(deviceInfo->data); });
     }
 }
 
 void FancyZonesData::ParseCustomZoneSetFromTmpFile(std::wstring_view tmpFilePath)
 {
-    std::scoped_lock lock{ dataLock };
-    const auto& customZoneSet = JSONHelpers::ParseCustomZoneSetFromTmpFile(tmpFilePath);
+    auto customZoneSet = JSONHelpers::ParseCustomZoneSetFromTmpFile(tmpFilePath);
 
     if (customZoneSet)
     {
-        customZoneSetsMap[customZoneSet->uuid] = std::move(customZoneSet->data);
+        customZoneSetsMap.Write([&](auto& customZoneSets) { customZoneSets[customZoneSet->uuid] = std::move(customZoneSet->data); });
     }
 }
 
 void FancyZonesData::ParseDeletedCustomZoneSetsFromTmpFile(std::wstring_view tmpFilePath)
 {
-    std::scoped_lock lock{ dataLock };
     const auto& deletedCustomZoneSets = JSONHelpers::ParseDeletedCustomZoneSetsFromTmpFile(tmpFilePath);
-    for (const auto& zoneSet : deletedCustomZoneSets)
+    if (!deletedCustomZoneSets.empty())
     {
-        customZoneSetsMap.erase(zoneSet);
+        customZoneSetsMap.Write([&](auto& customZoneSets) {
+            for (const auto& zoneSet : deletedCustomZoneSets)
+            {
+                customZoneSets.erase(zoneSet);
+            }
+        });
     }
 }
 
@@ -545,11 +520,14 @@ void FancyZonesData::LoadFancyZonesData()
     }
     else
     {
-        json::JsonObject fancyZonesDataJSON = GetPersistFancyZonesJSON();
+        auto data = JSONHelpers::ReadPersistFancyZonesData(zonesSettingsFileName, appZoneHistoryFileName);
 
-        appZoneHistoryMap = JSONHelpers::ParseAppZoneHistory(fancyZonesDataJSON);
-        deviceInfoMap = JSONHelpers::ParseDeviceInfos(fancyZonesDataJSON);
-        customZoneSetsMap = JSONHelpers::ParseCustomZoneSets(fancyZonesDataJSON);
+        {
+            std::scoped_lock lock{ appZoneHistoryLock };
+            appZoneHistory.Assign(std::move(data.appZoneHistoryMap));
+        }
+        deviceInfoMap.Assign(std::move(data.deviceInfoMap));
+        customZoneSetsMap.Assign(std::move(data.customZoneSetsMap));
     }
 
     DeleteFancyZonesRegistryData();
@@ -557,38 +535,95 @@ void FancyZonesData::LoadFancyZonesData()
 
 void FancyZonesData::SaveFancyZonesData() const
 {
-    std::scoped_lock lock{ dataLock };
-    JSONHelpers::SaveFancyZonesData(zonesSettingsFileName,
-                                    appZoneHistoryFileName,
-                                    deviceInfoMap,
-                                    customZoneSetsMap,
-                                    appZoneHistoryMap);
+    persister.MarkDirty(zoneSettingsSection);
+    persister.MarkDirty(appZoneHistorySection);
+    persister.Flush();
+}
+
+void FancyZonesData::ScheduleZoneSettingsSave() const
+{
+    persister.MarkDirty(zoneSettingsSection);
+}
+
+void FancyZonesData::FlushPendingSaves() const
+{
+    persister.Flush();
+}
+
+void FancyZonesData::SaveZoneSettings() const
+{
+    // Serialized from snapshots, without copying the maps or blocking their readers and writers
+    const auto devices = deviceInfoMap.Read();
+    const auto customZoneSets = customZoneSetsMap.Read();
+
+    std::string content = JSONHelpers::SerializeZoneSettingsContent(*devices, *customZoneSets);
+    if (!lastSavedZoneSettings.has_value())
+    {
+        // Only the first write compares against the file, later ones compare against what was written.
+        // The file is read back and written again, so that the formatting of older versions isn't reported as a change
+        std::ifstream file{ zonesSettingsFileName, std::ios::binary };
+        const std::string fileContent{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+        const auto before = JSONHelpers::ParsePersistedContent(fileContent);
+        lastSavedZoneSettings = before.has_value() ? JSONHelpers::SerializeZoneSettingsContent(before->deviceInfoMap, before->customZoneSetsMap) : std::string{};
+    }
+
+    if (content != *lastSavedZoneSettings)
+    {
+        Trace::FancyZones::DataChanged();
+    }
+
+    if (JSONHelpers::WriteFileAtomically(zonesSettingsFileName, content))
+    {
+        lastSavedZoneSettings = std::move(content);
+    }
+}
+
+void FancyZonesData::SaveAppZoneHistory() const
+{
+    JSONHelpers::TAppZoneHistoryMap appZoneHistoryMapCopy;
+    {
+        std::scoped_lock lock{ appZoneHistoryLock };
+        appZoneHistoryMapCopy = appZoneHistory.GetMap();
+    }
+
+    std::string content = JSONHelpers::SerializeAppZoneHistoryContent(appZoneHistoryMapCopy);
+    JSONHelpers::WriteFileAtomically(appZoneHistoryFileName, content);
 }
 
 void FancyZonesData::RemoveDesktopAppZoneHistory(const std::wstring& desktopId)
 {
-    for (auto it = std::begin(appZoneHistoryMap); it != std::end(appZoneHistoryMap);)
+    std::scoped_lock lock{ appZoneHistoryLock };
+    appZoneHistory.EraseDevices([&desktopId](const std::wstring& deviceId) {
+        return ExtractVirtualDesktopId(deviceId) == desktopId;
+    });
+}
+
+const std::wstring& FancyZonesData::GetProcessPath(HWND window) const
+{
+    DWORD processId = 0;
+    GetWindowThreadProcessId(window, &processId);
+
+    auto it = processPathCache.find(window);
+    if (it != std::end(processPathCache) && it->second.processId == processId && processId != 0)
     {
-        auto& perDesktopData = it->second;
-        for (auto desktopIt = std::begin(perDesktopData); desktopIt != std::end(perDesktopData);)
-        {
-            if (ExtractVirtualDesktopId(desktopIt->deviceId) == desktopId)
-            {
-                desktopIt = perDesktopData.erase(desktopIt);
-            }
-            else
-            {
-                ++desktopIt;
-            }
-        }
+        return it->second.path;
+    }
 
-        if (perDesktopData.empty())
-        {
-            it = appZoneHistoryMap.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+    // Handles of windows destroyed without notification are only dropped when the cache grows too big
+    const size_t maxCachedWindows = 1024;
+    if (it == std::end(processPathCache) && processPathCache.size() >= maxCachedWindows)
+    {
+        processPathCache.clear();
     }
+
+    auto path = get_process_path(window);
+
+    // The process of a UWP app window is only known once its frame hosts the app, so it has to be queried again.
+    // Process id 0 never matches a window
+    const std::wstring_view applicationFrameHost = NonLocalizable::ApplicationFrameHost;
+    const DWORD cachedProcessId = path.ends_with(applicationFrameHost) ? 0 : processId;
+
+    auto& cached = processPathCache[window];
+    cached = CachedProcessPath{ cachedProcessId, std::move(path) };
+    return cached.path;
 }
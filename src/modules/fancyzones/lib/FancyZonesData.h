@@ -1,6 +1,9 @@
 #pragma once
 
+#include "AppZoneHistoryStore.h"
+#include "CopyOnWrite.h"
 #include "JsonHelpers.h"
+#include "WriteBehindPersister.h"
 
 #include <common/settings_helpers.h>
 #include <common/json.h>
@@ -40,22 +43,21 @@ public:
 
     std::optional<FancyZonesDataTypes::CustomZoneSetData> FindCustomZoneSet(const std::wstring& guid) const;
 
-    inline const std::unordered_map<std::wstring, FancyZonesDataTypes::DeviceInfoData>& GetDeviceInfoMap() const
+    // The maps are returned by value, they can be changed by other threads as soon as their lock is released
+    inline JSONHelpers::TDeviceInfoMap GetDeviceInfoMap() const
     {
-        std::scoped_lock lock{ dataLock };
-        return deviceInfoMap;
+        return *deviceInfoMap.Read();
     }
 
-    inline const std::unordered_map<std::wstring, FancyZonesDataTypes::CustomZoneSetData>& GetCustomZoneSetsMap() const
+    inline JSONHelpers::TCustomZoneSetsMap GetCustomZoneSetsMap() const
     {
-        std::scoped_lock lock{ dataLock };
-        return customZoneSetsMap;
+        return *customZoneSetsMap.Read();
     }
 
-    inline const std::unordered_map<std::wstring, std::vector<FancyZonesDataTypes::AppZoneHistoryData>>& GetAppZoneHistoryMap() const
+    inline JSONHelpers::TAppZoneHistoryMap GetAppZoneHistoryMap() const
     {
-        std::scoped_lock lock{ dataLock };
-        return appZoneHistoryMap;
+        std::scoped_lock lock{ appZoneHistoryLock };
+        return appZoneHistory.GetMap();
     }
 
     bool AddDevice(const std::wstring& deviceId);
@@ -69,6 +71,9 @@ public:
     bool RemoveAppLastZone(HWND window, const std::wstring_view& deviceId, const std::wstring_view& zoneSetId);
     bool SetAppLastZones(HWND window, const std::wstring& deviceId, const std::wstring& zoneSetId, const std::vector<size_t>& zoneIndexSet);
 
+    // Forgets the cached process path of a destroyed window, as the handle can be reused by another process
+    void WindowDestroyed(HWND window);
+
     void SetActiveZoneSet(const std::wstring& deviceId, const FancyZonesDataTypes::ZoneSetData& zoneSet);
 
     bool SerializeDeviceInfoToTmpFile(const std::wstring& uniqueId) const;
@@ -77,8 +82,16 @@ public:
     json::JsonObject GetPersistFancyZonesJSON();
 
     void LoadFancyZonesData();
+
+    // Writes the zone settings and the app zone history files before returning
     void SaveFancyZonesData() const;
 
+    // Schedules a write of the zone settings file on the background thread
+    void ScheduleZoneSettingsSave() const;
+
+    // Writes the changes which are still pending, called on shutdown
+    void FlushPendingSaves() const;
+
 private:
 #if defined(UNIT_TESTS)
     friend class FancyZonesUnitTests::FancyZonesDataUnitTests;
@@ -89,20 +102,24 @@ private:
 
     inline void SetDeviceInfo(const std::wstring& deviceId, FancyZonesDataTypes::DeviceInfoData data)
     {
-        deviceInfoMap[deviceId] = data;
+        deviceInfoMap.Write([&](auto& devices) { devices[deviceId] = data; });
     }
 
     inline bool ParseDeviceInfos(const json::JsonObject& fancyZonesDataJSON)
     {
-        deviceInfoMap = JSONHelpers::ParseDeviceInfos(fancyZonesDataJSON);
-        return !deviceInfoMap.empty();
+        deviceInfoMap.Assign(JSONHelpers::ParseDeviceInfos(fancyZonesDataJSON));
+        return !deviceInfoMap.Read()->empty();
     }
 
     inline void clear_data()
     {
-        appZoneHistoryMap.clear();
-        deviceInfoMap.clear();
-        customZoneSetsMap.clear();
+        {
+            std::scoped_lock lock{ appZoneHistoryLock };
+            appZoneHistory.Clear();
+            processPathCache.clear();
+        }
+        deviceInfoMap.Assign({});
+        customZoneSetsMap.Assign({});
     }
 
     inline void SetSettingsModulePath(std::wstring_view moduleName)
@@ -118,12 +135,36 @@ private:
 
     void RemoveDesktopAppZoneHistory(const std::wstring& desktopId);
 
-    // Maps app path to app's zone history data
-    std::unordered_map<std::wstring, std::vector<FancyZonesDataTypes::AppZoneHistoryData>> appZoneHistoryMap{};
-    // Maps device unique ID to device data
-    std::unordered_map<std::wstring, FancyZonesDataTypes::DeviceInfoData> deviceInfoMap{};
+    // Write callbacks of the persister. The data is copied under the data lock and serialized without it
+    void SaveZoneSettings() const;
+    void SaveAppZoneHistory() const;
+
+    // Process path of the window, from the cache when the window still belongs to the same process.
+    // Must be called with the app zone history lock held, the reference is valid until the path of another window is queried
+    const std::wstring& GetProcessPath(HWND window) const;
+
+    // The data is split in parts synchronized independently: the app zone history, which changes whenever a window
+    // is zoned, and the device and custom zone set data, which are mostly read and use copy-on-write snapshots.
+    // A lock is never held while taking another one.
+
+    // Guards the app zone history and the process path cache
+    mutable std::recursive_mutex appZoneHistoryLock;
+
+    // App zone history data, indexed by app path and device
+    AppZoneHistoryStore appZoneHistory;
+
+    struct CachedProcessPath
+    {
+        DWORD processId;
+        std::wstring path;
+    };
+    // Maps window handle to the path of its process, which takes several system calls to query
+    mutable std::unordered_map<HWND, CachedProcessPath> processPathCache{};
+
+    // Maps device unique ID to device data, the device ID includes the virtual desktop
+    CopyOnWrite<JSONHelpers::TDeviceInfoMap> deviceInfoMap;
     // Maps custom zoneset UUID to it's data
-    std::unordered_map<std::wstring, FancyZonesDataTypes::CustomZoneSetData> customZoneSetsMap{};
+    CopyOnWrite<JSONHelpers::TCustomZoneSetsMap> customZoneSetsMap;
 
     std::wstring zonesSettingsFileName;
     std::wstring appZoneHistoryFileName;
@@ -132,7 +173,14 @@ private:
     std::wstring appliedZoneSetTmpFileName;
     std::wstring deletedCustomZoneSetsTmpFileName;
 
-    mutable std::recursive_mutex dataLock;
+    // Content of the last zone settings write, used to detect changes for telemetry without re-reading the file
+    mutable std::optional<std::string> lastSavedZoneSettings;
+
+    // Writes the zone settings and the app zone history independently of each other, off the calling thread.
+    // Declared last so that pending writes are flushed while the rest of the data is still alive
+    WriteBehindPersister::SectionId zoneSettingsSection;
+    WriteBehindPersister::SectionId appZoneHistorySection;
+    mutable WriteBehindPersister persister;
 };
 
 FancyZonesData& FancyZonesDataInstance();
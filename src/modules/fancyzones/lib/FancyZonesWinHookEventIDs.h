@@ -5,5 +5,6 @@ extern UINT WM_PRIV_MOVESIZEEND;
 extern UINT WM_PRIV_LOCATIONCHANGE;
 extern UINT WM_PRIV_NAMECHANGE;
 extern UINT WM_PRIV_WINDOWCREATED;
+extern UINT WM_PRIV_WINDOWDESTROYED;
 
 void InitializeWinhookEventIds();
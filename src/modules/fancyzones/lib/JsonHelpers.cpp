@@ -3,10 +3,11 @@
 #include "JsonHelpers.h"
 #include "FancyZonesData.h"
 #include "FancyZonesDataTypes.h"
-#include "trace.h"
+#include "JsonStream.h"
 #include "util.h"
 
 #include <filesystem>
+#include <fstream>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -38,6 +39,7 @@ namespace NonLocalizable
     const wchar_t RefWidthStr[] = L"ref-width";
     const wchar_t RowsPercentageStr[] = L"rows-percentage";
     const wchar_t RowsStr[] = L"rows";
+    const wchar_t TmpFileExtension[] = L".tmp";
     const wchar_t TypeStr[] = L"type";
     const wchar_t UuidStr[] = L"uuid";
     const wchar_t WidthStr[] = L"width";
@@ -106,6 +108,718 @@ namespace
     }
 }
 
+// Streaming parser and writer of the persisted files. The parser accepts and rejects the same entries as the
+// document based one: an entry with a missing member or a member of an unexpected type is dropped, and an array
+// of entries which contains something else than objects is dropped altogether.
+namespace
+{
+    using JsonStream::ValueType;
+
+    // Read the value of a member. A value of another type is skipped and read as nullopt
+    std::optional<std::wstring> ReadString(JsonStream::Reader& reader)
+    {
+        if (reader.Peek() != ValueType::String)
+        {
+            reader.SkipValue();
+            return std::nullopt;
+        }
+        return reader.ReadString();
+    }
+
+    std::optional<double> ReadNumber(JsonStream::Reader& reader)
+    {
+        if (reader.Peek() != ValueType::Number)
+        {
+            reader.SkipValue();
+            return std::nullopt;
+        }
+        return reader.ReadNumber();
+    }
+
+    std::optional<bool> ReadBoolean(JsonStream::Reader& reader)
+    {
+        if (reader.Peek() != ValueType::Boolean)
+        {
+            reader.SkipValue();
+            return std::nullopt;
+        }
+        return reader.ReadBoolean();
+    }
+
+    // Walk the members of an object, readMember has to read or skip the value of each member.
+    // Returns false when the value isn't an object, it is skipped
+    template<typename ReadMember>
+    bool ReadObject(JsonStream::Reader& reader, ReadMember&& readMember)
+    {
+        if (reader.Peek() != ValueType::Object)
+        {
+            reader.SkipValue();
+            return false;
+        }
+
+        std::wstring name;
+        reader.BeginObject();
+        while (reader.NextMember(name))
+        {
+            readMember(name);
+        }
+        return true;
+    }
+
+    // Walk the elements of an array, readElement has to read or skip each element.
+    // Returns false when the value isn't an array, it is skipped
+    template<typename ReadElement>
+    bool ReadArray(JsonStream::Reader& reader, ReadElement&& readElement)
+    {
+        if (reader.Peek() != ValueType::Array)
+        {
+            reader.SkipValue();
+            return false;
+        }
+
+        reader.BeginArray();
+        while (reader.NextElement())
+        {
+            readElement();
+        }
+        return true;
+    }
+
+    template<typename T>
+    std::optional<std::vector<T>> ReadNumberArray(JsonStream::Reader& reader)
+    {
+        std::vector<T> result;
+        bool valid = true;
+        valid = ReadArray(reader, [&] {
+            if (auto number = ReadNumber(reader); number.has_value())
+            {
+                result.push_back(static_cast<T>(*number));
+            }
+            else
+            {
+                valid = false;
+            }
+        }) && valid;
+
+        if (!valid)
+        {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    std::optional<std::vector<FancyZonesDataTypes::CanvasLayoutInfo::Rect>> ReadCanvasZones(JsonStream::Reader& reader)
+    {
+        std::vector<FancyZonesDataTypes::CanvasLayoutInfo::Rect> zones;
+        bool valid = true;
+        valid = ReadArray(reader, [&] {
+            std::optional<double> x, y, width, height;
+            const bool isObject = ReadObject(reader, [&](const std::wstring& name) {
+                if (name == NonLocalizable::XStr)
+                {
+                    x = ReadNumber(reader);
+                }
+                else if (name == NonLocalizable::YStr)
+                {
+                    y = ReadNumber(reader);
+                }
+                else if (name == NonLocalizable::WidthStr)
+                {
+                    width = ReadNumber(reader);
+                }
+                else if (name == NonLocalizable::HeightStr)
+                {
+                    height = ReadNumber(reader);
+                }
+                else
+                {
+                    reader.SkipValue();
+                }
+            });
+
+            if (isObject && x.has_value() && y.has_value() && width.has_value() && height.has_value())
+            {
+                zones.push_back(FancyZonesDataTypes::CanvasLayoutInfo::Rect{ static_cast<int>(*x), static_cast<int>(*y), static_cast<int>(*width), static_cast<int>(*height) });
+            }
+            else
+            {
+                valid = false;
+            }
+        }) && valid;
+
+        if (!valid)
+        {
+            return std::nullopt;
+        }
+        return zones;
+    }
+
+    // Members of the info of a custom zone set. The canvas and the grid members have different names, so the info
+    // is read before knowing the type of the zone set, which can come after it
+    struct CustomZoneSetInfoMembers
+    {
+        std::optional<double> refWidth;
+        std::optional<double> refHeight;
+        std::optional<std::vector<FancyZonesDataTypes::CanvasLayoutInfo::Rect>> zones;
+
+        std::optional<double> rows;
+        std::optional<double> columns;
+        std::optional<std::vector<int>> rowsPercents;
+        std::optional<std::vector<int>> columnsPercents;
+        std::optional<std::vector<std::vector<int>>> cellChildMap;
+
+        void Read(JsonStream::Reader& reader, const std::wstring& name)
+        {
+            if (name == NonLocalizable::RefWidthStr)
+            {
+                refWidth = ReadNumber(reader);
+            }
+            else if (name == NonLocalizable::RefHeightStr)
+            {
+                refHeight = ReadNumber(reader);
+            }
+            else if (name == NonLocalizable::ZonesStr)
+            {
+                zones = ReadCanvasZones(reader);
+            }
+            else if (name == NonLocalizable::RowsStr)
+            {
+                rows = ReadNumber(reader);
+            }
+            else if (name == NonLocalizable::ColumnsStr)
+            {
+                columns = ReadNumber(reader);
+            }
+            else if (name == NonLocalizable::RowsPercentageStr)
+            {
+                rowsPercents = ReadNumberArray<int>(reader);
+            }
+            else if (name == NonLocalizable::ColumnsPercentageStr)
+            {
+                columnsPercents = ReadNumberArray<int>(reader);
+            }
+            else if (name == NonLocalizable::CellChildMapStr)
+            {
+                std::vector<std::vector<int>> map;
+                bool valid = true;
+                valid = ReadArray(reader, [&] {
+                    if (auto cellsRow = ReadNumberArray<int>(reader); cellsRow.has_value())
+                    {
+                        map.push_back(std::move(*cellsRow));
+                    }
+                    else
+                    {
+                        valid = false;
+                    }
+                }) && valid;
+                cellChildMap = valid ? std::optional{ std::move(map) } : std::nullopt;
+            }
+            else
+            {
+                reader.SkipValue();
+            }
+        }
+
+        std::optional<FancyZonesDataTypes::CanvasLayoutInfo> ToCanvasLayoutInfo()
+        {
+            if (!refWidth.has_value() || !refHeight.has_value() || !zones.has_value())
+            {
+                return std::nullopt;
+            }
+            return FancyZonesDataTypes::CanvasLayoutInfo{ static_cast<int>(*refWidth), static_cast<int>(*refHeight), std::move(*zones) };
+        }
+
+        std::optional<FancyZonesDataTypes::GridLayoutInfo> ToGridLayoutInfo()
+        {
+            if (!rows.has_value() || !columns.has_value() || !rowsPercents.has_value() || !columnsPercents.has_value() || !cellChildMap.has_value())
+            {
+                return std::nullopt;
+            }
+
+            FancyZonesDataTypes::GridLayoutInfo info(FancyZonesDataTypes::GridLayoutInfo::Minimal{ static_cast<int>(*rows), static_cast<int>(*columns) });
+            if (rowsPercents->size() != static_cast<size_t>(info.m_rows) || columnsPercents->size() != static_cast<size_t>(info.m_columns) ||
+                cellChildMap->size() != static_cast<size_t>(info.m_rows))
+            {
+                return std::nullopt;
+            }
+            for (const auto& cellsRow : *cellChildMap)
+            {
+                if (cellsRow.size() != static_cast<size_t>(info.m_columns))
+                {
+                    return std::nullopt;
+                }
+            }
+
+            info.m_rowsPercents = std::move(*rowsPercents);
+            info.m_columnsPercents = std::move(*columnsPercents);
+            info.m_cellChildMap = std::move(*cellChildMap);
+            return info;
+        }
+    };
+
+    std::optional<JSONHelpers::CustomZoneSetJSON> ReadCustomZoneSet(JsonStream::Reader& reader)
+    {
+        std::optional<std::wstring> uuid;
+        std::optional<std::wstring> name;
+        std::optional<std::wstring> type;
+        std::optional<CustomZoneSetInfoMembers> info;
+        ReadObject(reader, [&](const std::wstring& member) {
+            if (member == NonLocalizable::UuidStr)
+            {
+                uuid = ReadString(reader);
+            }
+            else if (member == NonLocalizable::NameStr)
+            {
+                name = ReadString(reader);
+            }
+            else if (member == NonLocalizable::TypeStr)
+            {
+                type = ReadString(reader);
+            }
+            else if (member == NonLocalizable::InfoStr)
+            {
+                CustomZoneSetInfoMembers infoMembers;
+                const bool isObject = ReadObject(reader, [&](const std::wstring& infoMember) {
+                    infoMembers.Read(reader, infoMember);
+                });
+                info = isObject ? std::optional{ std::move(infoMembers) } : std::nullopt;
+            }
+            else
+            {
+                reader.SkipValue();
+            }
+        });
+
+        if (!uuid.has_value() || !FancyZonesUtils::IsValidGuid(*uuid) || !name.has_value() || !type.has_value() || !info.has_value())
+        {
+            return std::nullopt;
+        }
+
+        JSONHelpers::CustomZoneSetJSON result;
+        result.uuid = std::move(*uuid);
+        result.data.name = std::move(*name);
+        if (*type == NonLocalizable::CanvasStr)
+        {
+            auto canvasInfo = info->ToCanvasLayoutInfo();
+            if (!canvasInfo.has_value())
+            {
+                return std::nullopt;
+            }
+            result.data.type = FancyZonesDataTypes::CustomLayoutType::Canvas;
+            result.data.info = std::move(*canvasInfo);
+        }
+        else if (*type == NonLocalizable::GridStr)
+        {
+            auto gridInfo = info->ToGridLayoutInfo();
+            if (!gridInfo.has_value())
+            {
+                return std::nullopt;
+            }
+            result.data.type = FancyZonesDataTypes::CustomLayoutType::Grid;
+            result.data.info = std::move(*gridInfo);
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        return result;
+    }
+
+    std::optional<FancyZonesDataTypes::ZoneSetData> ReadZoneSetData(JsonStream::Reader& reader)
+    {
+        std::optional<std::wstring> uuid;
+        std::optional<std::wstring> type;
+        const bool isObject = ReadObject(reader, [&](const std::wstring& name) {
+            if (name == NonLocalizable::UuidStr)
+            {
+                uuid = ReadString(reader);
+            }
+            else if (name == NonLocalizable::TypeStr)
+            {
+                type = ReadString(reader);
+            }
+            else
+            {
+                reader.SkipValue();
+            }
+        });
+
+        if (!isObject || !uuid.has_value() || !type.has_value() || !FancyZonesUtils::IsValidGuid(*uuid))
+        {
+            return std::nullopt;
+        }
+        return FancyZonesDataTypes::ZoneSetData{ std::move(*uuid), FancyZonesDataTypes::TypeFromString(*type) };
+    }
+
+    std::optional<JSONHelpers::DeviceInfoJSON> ReadDeviceInfo(JsonStream::Reader& reader)
+    {
+        std::optional<std::wstring> deviceId;
+        std::optional<FancyZonesDataTypes::ZoneSetData> activeZoneSet;
+        std::optional<bool> showSpacing;
+        std::optional<double> spacing;
+        std::optional<double> zoneCount;
+        std::optional<double> sensitivityRadius = DefaultValues::SensitivityRadius;
+        ReadObject(reader, [&](const std::wstring& name) {
+            if (name == NonLocalizable::DeviceIdStr)
+            {
+                deviceId = ReadString(reader);
+            }
+            else if (name == NonLocalizable::ActiveZoneSetStr)
+            {
+                activeZoneSet = ReadZoneSetData(reader);
+            }
+            else if (name == NonLocalizable::EditorShowSpacingStr)
+            {
+                showSpacing = ReadBoolean(reader);
+            }
+            else if (name == NonLocalizable::EditorSpacingStr)
+            {
+                spacing = ReadNumber(reader);
+            }
+            else if (name == NonLocalizable::EditorZoneCountStr)
+            {
+                zoneCount = ReadNumber(reader);
+            }
+            else if (name == NonLocalizable::EditorSensitivityRadiusStr)
+            {
+                sensitivityRadius = ReadNumber(reader);
+            }
+            else
+            {
+                reader.SkipValue();
+            }
+        });
+
+        if (!deviceId.has_value() || !FancyZonesUtils::IsValidDeviceId(*deviceId) || !activeZoneSet.has_value() ||
+            !showSpacing.has_value() || !spacing.has_value() || !zoneCount.has_value() || !sensitivityRadius.has_value())
+        {
+            return std::nullopt;
+        }
+
+        JSONHelpers::DeviceInfoJSON result;
+        result.deviceId = std::move(*deviceId);
+        result.data.activeZoneSet = std::move(*activeZoneSet);
+        result.data.showSpacing = *showSpacing;
+        result.data.spacing = static_cast<int>(*spacing);
+        result.data.zoneCount = static_cast<int>(*zoneCount);
+        result.data.sensitivityRadius = static_cast<int>(*sensitivityRadius);
+        return result;
+    }
+
+    // Members of the app zone history of an application on a single desktop
+    struct AppZoneHistoryMembers
+    {
+        bool hasZoneIndexSet = false;
+        std::optional<std::vector<size_t>> zoneIndexSet;
+        bool hasZoneIndex = false;
+        std::optional<double> zoneIndex;
+        std::optional<std::wstring> deviceId;
+        std::optional<std::wstring> zoneSetUuid;
+
+        void Read(JsonStream::Reader& reader, const std::wstring& name)
+        {
+            if (name == NonLocalizable::ZoneIndexSetStr)
+            {
+                hasZoneIndexSet = true;
+                zoneIndexSet = ReadNumberArray<size_t>(reader);
+            }
+            else if (name == NonLocalizable::ZoneIndexStr)
+            {
+                hasZoneIndex = true;
+                zoneIndex = ReadNumber(reader);
+            }
+            else if (name == NonLocalizable::DeviceIdStr)
+            {
+                deviceId = ReadString(reader);
+            }
+            else if (name == NonLocalizable::ZoneSetUuidStr)
+            {
+                zoneSetUuid = ReadString(reader);
+            }
+            else
+            {
+                reader.SkipValue();
+            }
+        }
+
+        // Same outcomes as ParseSingleAppZoneHistoryItem. Returns false when the whole application entry is
+        // rejected, the data is left empty when only this desktop is skipped
+        bool ToAppZoneHistoryData(std::optional<FancyZonesDataTypes::AppZoneHistoryData>& data)
+        {
+            if ((hasZoneIndexSet && !zoneIndexSet.has_value()) || (!hasZoneIndexSet && hasZoneIndex && !zoneIndex.has_value()) ||
+                !deviceId.has_value() || !zoneSetUuid.has_value())
+            {
+                return false;
+            }
+
+            if (FancyZonesUtils::IsValidGuid(*zoneSetUuid) && FancyZonesUtils::IsValidDeviceId(*deviceId))
+            {
+                data.emplace();
+                data->zoneSetUuid = std::move(*zoneSetUuid);
+                data->deviceId = std::move(*deviceId);
+                if (hasZoneIndexSet)
+                {
+                    data->zoneIndexSet = std::move(*zoneIndexSet);
+                }
+                else if (hasZoneIndex)
+                {
+                    data->zoneIndexSet = { static_cast<size_t>(*zoneIndex) };
+                }
+            }
+            return true;
+        }
+    };
+
+    std::optional<JSONHelpers::AppZoneHistoryJSON> ReadAppZoneHistory(JsonStream::Reader& reader)
+    {
+        std::optional<std::wstring> appPath;
+        bool hasHistory = false;
+        bool historyValid = true;
+        std::vector<AppZoneHistoryMembers> history;
+        // Previous file format, with single desktop layout information per application
+        AppZoneHistoryMembers singleDesktop;
+        ReadObject(reader, [&](const std::wstring& name) {
+            if (name == NonLocalizable::AppPathStr)
+            {
+                appPath = ReadString(reader);
+            }
+            else if (name == NonLocalizable::HistoryStr)
+            {
+                hasHistory = true;
+                history.clear();
+                historyValid = true;
+                historyValid = ReadArray(reader, [&] {
+                    AppZoneHistoryMembers members;
+                    if (ReadObject(reader, [&](const std::wstring& member) { members.Read(reader, member); }))
+                    {
+                        history.push_back(std::move(members));
+                    }
+                    else
+                    {
+                        historyValid = false;
+                    }
+                }) && historyValid;
+            }
+            else
+            {
+                singleDesktop.Read(reader, name);
+            }
+        });
+
+        if (!appPath.has_value() || (hasHistory && !historyValid))
+        {
+            return std::nullopt;
+        }
+
+        JSONHelpers::AppZoneHistoryJSON result;
+        result.appPath = std::move(*appPath);
+        if (!hasHistory)
+        {
+            history.push_back(std::move(singleDesktop));
+        }
+        for (auto& members : history)
+        {
+            std::optional<FancyZonesDataTypes::AppZoneHistoryData> data;
+            if (!members.ToAppZoneHistoryData(data))
+            {
+                return std::nullopt;
+            }
+            if (data.has_value())
+            {
+                result.data.push_back(std::move(*data));
+            }
+        }
+
+        if (result.data.empty())
+        {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    // Read an array of entries into a map. The whole array is dropped when one of the entries isn't an object
+    template<typename Map, typename ReadEntry>
+    Map ReadEntries(JsonStream::Reader& reader, ReadEntry&& readEntry)
+    {
+        Map map{};
+        bool valid = true;
+        valid = ReadArray(reader, [&] {
+            if (reader.Peek() != ValueType::Object)
+            {
+                reader.SkipValue();
+                valid = false;
+                return;
+            }
+            readEntry(map);
+        }) && valid;
+
+        if (!valid)
+        {
+            return {};
+        }
+        return map;
+    }
+
+    std::optional<std::string> ReadFileContent(const std::wstring& fileName)
+    {
+        std::ifstream file{ std::filesystem::path{ fileName }, std::ios::binary };
+        if (!file.is_open())
+        {
+            return std::nullopt;
+        }
+
+        std::string content;
+        file.seekg(0, std::ios::end);
+        const auto size = file.tellg();
+        if (size > 0)
+        {
+            content.resize(static_cast<size_t>(size));
+            file.seekg(0, std::ios::beg);
+            file.read(content.data(), content.size());
+        }
+
+        if (file.bad())
+        {
+            return std::nullopt;
+        }
+        return content;
+    }
+
+    void WriteZoneSetData(JsonStream::Writer& writer, const FancyZonesDataTypes::ZoneSetData& zoneSet)
+    {
+        writer.BeginObject();
+        writer.Name(NonLocalizable::UuidStr);
+        writer.String(zoneSet.uuid);
+        writer.Name(NonLocalizable::TypeStr);
+        writer.String(FancyZonesDataTypes::TypeToString(zoneSet.type));
+        writer.EndObject();
+    }
+
+    void WriteDeviceInfo(JsonStream::Writer& writer, const std::wstring& deviceId, const FancyZonesDataTypes::DeviceInfoData& device)
+    {
+        writer.BeginObject();
+        writer.Name(NonLocalizable::DeviceIdStr);
+        writer.String(deviceId);
+        writer.Name(NonLocalizable::ActiveZoneSetStr);
+        WriteZoneSetData(writer, device.activeZoneSet);
+        writer.Name(NonLocalizable::EditorShowSpacingStr);
+        writer.Boolean(device.showSpacing);
+        writer.Name(NonLocalizable::EditorSpacingStr);
+        writer.Number(device.spacing);
+        writer.Name(NonLocalizable::EditorZoneCountStr);
+        writer.Number(device.zoneCount);
+        writer.Name(NonLocalizable::EditorSensitivityRadiusStr);
+        writer.Number(device.sensitivityRadius);
+        writer.EndObject();
+    }
+
+    void WriteNumberArray(JsonStream::Writer& writer, const std::vector<int>& numbers)
+    {
+        writer.BeginArray();
+        for (const int number : numbers)
+        {
+            writer.Number(number);
+        }
+        writer.EndArray();
+    }
+
+    void WriteCustomZoneSet(JsonStream::Writer& writer, const std::wstring& uuid, const FancyZonesDataTypes::CustomZoneSetData& customZoneSet)
+    {
+        writer.BeginObject();
+        writer.Name(NonLocalizable::UuidStr);
+        writer.String(uuid);
+        writer.Name(NonLocalizable::NameStr);
+        writer.String(customZoneSet.name);
+        switch (customZoneSet.type)
+        {
+        case FancyZonesDataTypes::CustomLayoutType::Canvas:
+        {
+            const auto& info = std::get<FancyZonesDataTypes::CanvasLayoutInfo>(customZoneSet.info);
+            writer.Name(NonLocalizable::TypeStr);
+            writer.String(NonLocalizable::CanvasStr);
+            writer.Name(NonLocalizable::InfoStr);
+            writer.BeginObject();
+            writer.Name(NonLocalizable::RefWidthStr);
+            writer.Number(info.lastWorkAreaWidth);
+            writer.Name(NonLocalizable::RefHeightStr);
+            writer.Number(info.lastWorkAreaHeight);
+            writer.Name(NonLocalizable::ZonesStr);
+            writer.BeginArray();
+            for (const auto& [x, y, width, height] : info.zones)
+            {
+                writer.BeginObject();
+                writer.Name(NonLocalizable::XStr);
+                writer.Number(x);
+                writer.Name(NonLocalizable::YStr);
+                writer.Number(y);
+                writer.Name(NonLocalizable::WidthStr);
+                writer.Number(width);
+                writer.Name(NonLocalizable::HeightStr);
+                writer.Number(height);
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.EndObject();
+            break;
+        }
+        case FancyZonesDataTypes::CustomLayoutType::Grid:
+        {
+            const auto& info = std::get<FancyZonesDataTypes::GridLayoutInfo>(customZoneSet.info);
+            writer.Name(NonLocalizable::TypeStr);
+            writer.String(NonLocalizable::GridStr);
+            writer.Name(NonLocalizable::InfoStr);
+            writer.BeginObject();
+            writer.Name(NonLocalizable::RowsStr);
+            writer.Number(info.m_rows);
+            writer.Name(NonLocalizable::ColumnsStr);
+            writer.Number(info.m_columns);
+            writer.Name(NonLocalizable::RowsPercentageStr);
+            WriteNumberArray(writer, info.m_rowsPercents);
+            writer.Name(NonLocalizable::ColumnsPercentageStr);
+            WriteNumberArray(writer, info.m_columnsPercents);
+            writer.Name(NonLocalizable::CellChildMapStr);
+            writer.BeginArray();
+            for (const auto& cellsRow : info.m_cellChildMap)
+            {
+                WriteNumberArray(writer, cellsRow);
+            }
+            writer.EndArray();
+            writer.EndObject();
+            break;
+        }
+        }
+        writer.EndObject();
+    }
+
+    void WriteAppZoneHistory(JsonStream::Writer& writer, const std::wstring& appPath, const std::vector<FancyZonesDataTypes::AppZoneHistoryData>& history)
+    {
+        writer.BeginObject();
+        writer.Name(NonLocalizable::AppPathStr);
+        writer.String(appPath);
+        writer.Name(NonLocalizable::HistoryStr);
+        writer.BeginArray();
+        for (const auto& data : history)
+        {
+            writer.BeginObject();
+            writer.Name(NonLocalizable::ZoneIndexSetStr);
+            writer.BeginArray();
+            for (const size_t index : data.zoneIndexSet)
+            {
+                writer.Number(static_cast<int>(index));
+            }
+            writer.EndArray();
+            writer.Name(NonLocalizable::DeviceIdStr);
+            writer.String(data.deviceId);
+            writer.Name(NonLocalizable::ZoneSetUuidStr);
+            writer.String(data.zoneSetUuid);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+}
+
 namespace JSONHelpers
 {
     json::JsonObject CanvasLayoutInfoJSON::ToJson(const FancyZonesDataTypes::CanvasLayoutInfo& canvasInfo)
@@ -470,28 +1184,44 @@ namespace JSONHelpers
         }
     }
 
-    void SaveFancyZonesData(const std::wstring& zonesSettingsFileName,
-                            const std::wstring& appZoneHistoryFileName,
-                            const TDeviceInfoMap& deviceInfoMap,
-                            const TCustomZoneSetsMap& customZoneSetsMap,
-                            const TAppZoneHistoryMap& appZoneHistoryMap)
-
+    json::JsonObject GetZoneSettingsJSON(const TDeviceInfoMap& deviceInfoMap, const TCustomZoneSetsMap& customZoneSetsMap)
     {
         json::JsonObject root{};
-        json::JsonObject appZoneHistoryRoot{};
-
-        appZoneHistoryRoot.SetNamedValue(NonLocalizable::AppZoneHistoryStr, JSONHelpers::SerializeAppZoneHistory(appZoneHistoryMap));
         root.SetNamedValue(NonLocalizable::DevicesStr, JSONHelpers::SerializeDeviceInfos(deviceInfoMap));
         root.SetNamedValue(NonLocalizable::CustomZoneSetsStr, JSONHelpers::SerializeCustomZoneSets(customZoneSetsMap));
+        return root;
+    }
+
+    json::JsonObject GetAppZoneHistoryJSON(const TAppZoneHistoryMap& appZoneHistoryMap)
+    {
+        json::JsonObject root{};
+        root.SetNamedValue(NonLocalizable::AppZoneHistoryStr, JSONHelpers::SerializeAppZoneHistory(appZoneHistoryMap));
+        return root;
+    }
+
+    bool WriteFileAtomically(const std::wstring& fileName, std::string_view content)
+    {
+        // Write the whole content next to the target first, so that a crash or a full disk never leaves a truncated file behind
+        const std::wstring tmpFileName = fileName + NonLocalizable::TmpFileExtension;
+        {
+            std::ofstream file{ tmpFileName, std::ios::binary | std::ios::trunc };
+            file.write(content.data(), content.size());
+            file.flush();
+            if (!file.good())
+            {
+                file.close();
+                DeleteFileW(tmpFileName.c_str());
+                return false;
+            }
+        }
 
-        auto before = json::from_file(zonesSettingsFileName);
-        if (!before.has_value() || before.value().Stringify() != root.Stringify())
+        if (!MoveFileExW(tmpFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
         {
-            Trace::FancyZones::DataChanged();
+            DeleteFileW(tmpFileName.c_str());
+            return false;
         }
 
-        json::to_file(zonesSettingsFileName, root);
-        json::to_file(appZoneHistoryFileName, appZoneHistoryRoot);
+        return true;
     }
 
     TAppZoneHistoryMap ParseAppZoneHistory(const json::JsonObject& fancyZonesDataJSON)
@@ -676,4 +1406,122 @@ namespace JSONHelpers
 
         return result;
     }
+
+    std::optional<PersistedFancyZonesData> ParsePersistedContent(std::string_view content)
+    {
+        try
+        {
+            JsonStream::Reader reader{ content };
+            if (reader.Peek() != ValueType::Object)
+            {
+                return std::nullopt;
+            }
+
+            PersistedFancyZonesData result;
+            ReadObject(reader, [&](const std::wstring& name) {
+                if (name == NonLocalizable::DevicesStr)
+                {
+                    result.deviceInfoMap = ReadEntries<TDeviceInfoMap>(reader, [&](TDeviceInfoMap& devices) {
+                        if (auto device = ReadDeviceInfo(reader); device.has_value())
+                        {
+                            devices[device->deviceId] = std::move(device->data);
+                        }
+                    });
+                }
+                else if (name == NonLocalizable::CustomZoneSetsStr)
+                {
+                    result.customZoneSetsMap = ReadEntries<TCustomZoneSetsMap>(reader, [&](TCustomZoneSetsMap& customZoneSets) {
+                        if (auto zoneSet = ReadCustomZoneSet(reader); zoneSet.has_value())
+                        {
+                            customZoneSets.insert_or_assign(zoneSet->uuid, std::move(zoneSet->data));
+                        }
+                    });
+                }
+                else if (name == NonLocalizable::AppZoneHistoryStr)
+                {
+                    result.hasAppZoneHistory = true;
+                    result.appZoneHistoryMap = ReadEntries<TAppZoneHistoryMap>(reader, [&](TAppZoneHistoryMap& appZoneHistory) {
+                        if (auto history = ReadAppZoneHistory(reader); history.has_value())
+                        {
+                            appZoneHistory[history->appPath] = std::move(history->data);
+                        }
+                    });
+                }
+                else
+                {
+                    reader.SkipValue();
+                }
+            });
+            reader.EndDocument();
+
+            return result;
+        }
+        catch (const JsonStream::SyntaxError&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    std::string SerializeZoneSettingsContent(const TDeviceInfoMap& deviceInfoMap, const TCustomZoneSetsMap& customZoneSetsMap)
+    {
+        JsonStream::Writer writer;
+        writer.BeginObject();
+        writer.Name(NonLocalizable::DevicesStr);
+        writer.BeginArray();
+        for (const auto& [deviceId, deviceData] : deviceInfoMap)
+        {
+            if (deviceData.activeZoneSet.type != FancyZonesDataTypes::ZoneSetLayoutType::Blank)
+            {
+                WriteDeviceInfo(writer, deviceId, deviceData);
+            }
+        }
+        writer.EndArray();
+        writer.Name(NonLocalizable::CustomZoneSetsStr);
+        writer.BeginArray();
+        for (const auto& [zoneSetId, zoneSetData] : customZoneSetsMap)
+        {
+            WriteCustomZoneSet(writer, zoneSetId, zoneSetData);
+        }
+        writer.EndArray();
+        writer.EndObject();
+        return writer.Release();
+    }
+
+    std::string SerializeAppZoneHistoryContent(const TAppZoneHistoryMap& appZoneHistoryMap)
+    {
+        JsonStream::Writer writer;
+        writer.BeginObject();
+        writer.Name(NonLocalizable::AppZoneHistoryStr);
+        writer.BeginArray();
+        for (const auto& [appPath, appZoneHistoryData] : appZoneHistoryMap)
+        {
+            WriteAppZoneHistory(writer, appPath, appZoneHistoryData);
+        }
+        writer.EndArray();
+        writer.EndObject();
+        return writer.Release();
+    }
+
+    PersistedFancyZonesData ReadPersistFancyZonesData(const std::wstring& zonesSettingsFileName, const std::wstring& appZoneHistoryFileName)
+    {
+        const auto zonesSettings = ReadFileContent(zonesSettingsFileName);
+        auto result = zonesSettings.has_value() ? ParsePersistedContent(*zonesSettings) : std::nullopt;
+        if (!result.has_value())
+        {
+            return {};
+        }
+
+        if (!result->hasAppZoneHistory)
+        {
+            if (const auto appZoneHistory = ReadFileContent(appZoneHistoryFileName); appZoneHistory.has_value())
+            {
+                if (auto appZoneHistoryData = ParsePersistedContent(*appZoneHistory); appZoneHistoryData.has_value())
+                {
+                    result->appZoneHistoryMap = std::move(appZoneHistoryData->appZoneHistoryMap);
+                }
+            }
+        }
+
+        return std::move(*result);
+    }
 }
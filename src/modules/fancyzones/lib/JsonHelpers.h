@@ -5,6 +5,7 @@
 #include <common/json.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -61,11 +62,10 @@ namespace JSONHelpers
     using TCustomZoneSetsMap = std::unordered_map<std::wstring, FancyZonesDataTypes::CustomZoneSetData>;
 
     json::JsonObject GetPersistFancyZonesJSON(const std::wstring& zonesSettingsFileName, const std::wstring& appZoneHistoryFileName);
-    void SaveFancyZonesData(const std::wstring& zonesSettingsFileName,
-                            const std::wstring& appZoneHistoryFileName,
-                            const TDeviceInfoMap& deviceInfoMap,
-                            const TCustomZoneSetsMap& customZoneSetsMap,
-                            const TAppZoneHistoryMap& appZoneHistoryMap);
+    json::JsonObject GetZoneSettingsJSON(const TDeviceInfoMap& deviceInfoMap, const TCustomZoneSetsMap& customZoneSetsMap);
+    json::JsonObject GetAppZoneHistoryJSON(const TAppZoneHistoryMap& appZoneHistoryMap);
+    // Writes the UTF-8 content next to the file and moves it over the file once it is complete
+    bool WriteFileAtomically(const std::wstring& fileName, std::string_view content);
 
     TAppZoneHistoryMap ParseAppZoneHistory(const json::JsonObject& fancyZonesDataJSON);
     json::JsonArray SerializeAppZoneHistory(const TAppZoneHistoryMap& appZoneHistoryMap);
@@ -80,4 +80,25 @@ namespace JSONHelpers
     std::optional<DeviceInfoJSON> ParseDeviceInfoFromTmpFile(std::wstring_view tmpFilePath);
     std::optional<CustomZoneSetJSON> ParseCustomZoneSetFromTmpFile(std::wstring_view tmpFilePath);
     std::vector<std::wstring> ParseDeletedCustomZoneSetsFromTmpFile(std::wstring_view tmpFilePath);
+
+    struct PersistedFancyZonesData
+    {
+        TDeviceInfoMap deviceInfoMap;
+        TCustomZoneSetsMap customZoneSetsMap;
+        TAppZoneHistoryMap appZoneHistoryMap;
+        // Whether the content had an app zone history, the zone settings of older versions include it
+        bool hasAppZoneHistory = false;
+    };
+
+    // Streaming parser of the zone settings and of the app zone history files. The UTF-8 content is read straight
+    // into the data types, without building a JSON document, and the same entries as with the Parse* functions
+    // above are kept. Returns nullopt when the content isn't a JSON object.
+    std::optional<PersistedFancyZonesData> ParsePersistedContent(std::string_view content);
+
+    // Streaming counterparts of GetZoneSettingsJSON and GetAppZoneHistoryJSON, returning the UTF-8 content
+    std::string SerializeZoneSettingsContent(const TDeviceInfoMap& deviceInfoMap, const TCustomZoneSetsMap& customZoneSetsMap);
+    std::string SerializeAppZoneHistoryContent(const TAppZoneHistoryMap& appZoneHistoryMap);
+
+    // Streaming counterpart of GetPersistFancyZonesJSON followed by the Parse* functions
+    PersistedFancyZonesData ReadPersistFancyZonesData(const std::wstring& zonesSettingsFileName, const std::wstring& appZoneHistoryFileName);
 }
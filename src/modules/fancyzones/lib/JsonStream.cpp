@@ -0,0 +1,605 @@
+#include "pch.h"
+#include "JsonStream.h"
+
+#include <charconv>
+#include <iterator>
+#include <utility>
+
+namespace
+{
+    // Deeper documents are rejected instead of overflowing the stack while they are skipped
+    constexpr int MaxDepth = 256;
+
+    constexpr uint32_t ReplacementCharacter = 0xFFFD;
+
+    void AppendCodePoint(std::wstring& str, uint32_t codePoint)
+    {
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            if (codePoint > 0xFFFF)
+            {
+                codePoint -= 0x10000;
+                str.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+                str.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+                return;
+            }
+        }
+        str.push_back(static_cast<wchar_t>(codePoint));
+    }
+
+    void AppendUtf8(std::string& str, uint32_t codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            str.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800)
+        {
+            str.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000)
+        {
+            str.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else
+        {
+            str.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            str.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    bool IsDigit(char c) noexcept
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    int HexValue(char c) noexcept
+    {
+        if (IsDigit(c))
+        {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+}
+
+namespace JsonStream
+{
+    SyntaxError::SyntaxError(size_t offset) :
+        std::runtime_error("Invalid JSON"), m_offset(offset)
+    {
+    }
+
+    Reader::Reader(std::string_view text) :
+        m_text(text)
+    {
+        // Tolerate the byte order mark some editors add to UTF-8 files
+        if (m_text.starts_with("\xEF\xBB\xBF"))
+        {
+            m_position = 3;
+        }
+    }
+
+    ValueType Reader::Peek()
+    {
+        SkipWhitespace();
+        if (m_position == m_text.size())
+        {
+            Fail();
+        }
+
+        switch (m_text[m_position])
+        {
+        case '{':
+            return ValueType::Object;
+        case '[':
+            return ValueType::Array;
+        case '"':
+            return ValueType::String;
+        case 't':
+        case 'f':
+            return ValueType::Boolean;
+        case 'n':
+            return ValueType::Null;
+        default:
+            if (m_text[m_position] == '-' || IsDigit(m_text[m_position]))
+            {
+                return ValueType::Number;
+            }
+            Fail();
+        }
+    }
+
+    void Reader::BeginObject()
+    {
+        SkipWhitespace();
+        Expect('{');
+        m_first = true;
+    }
+
+    bool Reader::NextMember(std::wstring& name)
+    {
+        SkipWhitespace();
+        if (m_position < m_text.size() && m_text[m_position] == '}')
+        {
+            m_position++;
+            m_first = false;
+            return false;
+        }
+
+        if (!m_first)
+        {
+            Expect(',');
+            SkipWhitespace();
+        }
+        m_first = false;
+
+        if (m_position == m_text.size() || m_text[m_position] != '"')
+        {
+            Fail();
+        }
+        name = ReadString();
+        SkipWhitespace();
+        Expect(':');
+        return true;
+    }
+
+    void Reader::BeginArray()
+    {
+        SkipWhitespace();
+        Expect('[');
+        m_first = true;
+    }
+
+    bool Reader::NextElement()
+    {
+        SkipWhitespace();
+        if (m_position < m_text.size() && m_text[m_position] == ']')
+        {
+            m_position++;
+            m_first = false;
+            return false;
+        }
+
+        if (!m_first)
+        {
+            Expect(',');
+        }
+        m_first = false;
+        return true;
+    }
+
+    std::wstring Reader::ReadString()
+    {
+        SkipWhitespace();
+        Expect('"');
+
+        std::wstring result;
+        while (true)
+        {
+            if (m_position == m_text.size())
+            {
+                Fail();
+            }
+
+            const auto byte = static_cast<unsigned char>(m_text[m_position]);
+            if (byte == '"')
+            {
+                m_position++;
+                return result;
+            }
+            else if (byte == '\\')
+            {
+                if (++m_position == m_text.size())
+                {
+                    Fail();
+                }
+
+                const char escaped = m_text[m_position++];
+                switch (escaped)
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    result.push_back(static_cast<wchar_t>(escaped));
+                    break;
+                case 'b':
+                    result.push_back(L'\b');
+                    break;
+                case 'f':
+                    result.push_back(L'\f');
+                    break;
+                case 'n':
+                    result.push_back(L'\n');
+                    break;
+                case 'r':
+                    result.push_back(L'\r');
+                    break;
+                case 't':
+                    result.push_back(L'\t');
+                    break;
+                case 'u':
+                {
+                    if (m_text.size() - m_position < 4)
+                    {
+                        Fail();
+                    }
+
+                    uint32_t codeUnit = 0;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        const int value = HexValue(m_text[m_position++]);
+                        if (value < 0)
+                        {
+                            Fail();
+                        }
+                        codeUnit = (codeUnit << 4) | static_cast<uint32_t>(value);
+                    }
+
+                    // Escaped UTF-16 code units are kept as they are, surrogate pairs included
+                    result.push_back(static_cast<wchar_t>(codeUnit));
+                    break;
+                }
+                default:
+                    m_position--;
+                    Fail();
+                }
+            }
+            else if (byte < 0x20)
+            {
+                Fail();
+            }
+            else if (byte < 0x80)
+            {
+                // Names and values are mostly ASCII, which is appended by runs
+                const size_t start = m_position;
+                while (m_position < m_text.size())
+                {
+                    const auto c = static_cast<unsigned char>(m_text[m_position]);
+                    if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\')
+                    {
+                        break;
+                    }
+                    m_position++;
+                }
+                result.append(m_text.begin() + start, m_text.begin() + m_position);
+            }
+            else
+            {
+                // Multi-byte UTF-8 sequence, invalid sequences are replaced like the system conversion does
+                size_t length = 0;
+                uint32_t codePoint = 0;
+                uint32_t minimum = 0;
+                if ((byte & 0xE0) == 0xC0)
+                {
+                    length = 2;
+                    codePoint = byte & 0x1F;
+                    minimum = 0x80;
+                }
+                else if ((byte & 0xF0) == 0xE0)
+                {
+                    length = 3;
+                    codePoint = byte & 0x0F;
+                    minimum = 0x800;
+                }
+                else if ((byte & 0xF8) == 0xF0)
+                {
+                    length = 4;
+                    codePoint = byte & 0x07;
+                    minimum = 0x10000;
+                }
+
+                size_t consumed = 1;
+                bool valid = length != 0 && m_text.size() - m_position >= length;
+                for (; valid && consumed < length; consumed++)
+                {
+                    const auto continuation = static_cast<unsigned char>(m_text[m_position + consumed]);
+                    if ((continuation & 0xC0) != 0x80)
+                    {
+                        valid = false;
+                        break;
+                    }
+                    codePoint = (codePoint << 6) | (continuation & 0x3F);
+                }
+
+                if (valid && codePoint >= minimum && codePoint <= 0x10FFFF && (codePoint < 0xD800 || codePoint > 0xDFFF))
+                {
+                    AppendCodePoint(result, codePoint);
+                }
+                else
+                {
+                    AppendCodePoint(result, ReplacementCharacter);
+                }
+                m_position += consumed;
+            }
+        }
+    }
+
+    double Reader::ReadNumber()
+    {
+        SkipWhitespace();
+        const size_t start = m_position;
+        const auto digits = [this] {
+            const size_t first = m_position;
+            while (m_position < m_text.size() && IsDigit(m_text[m_position]))
+            {
+                m_position++;
+            }
+            if (m_position == first)
+            {
+                Fail();
+            }
+        };
+
+        if (m_position < m_text.size() && m_text[m_position] == '-')
+        {
+            m_position++;
+        }
+        if (m_position < m_text.size() && m_text[m_position] == '0')
+        {
+            m_position++;
+        }
+        else
+        {
+            digits();
+        }
+        if (m_position < m_text.size() && m_text[m_position] == '.')
+        {
+            m_position++;
+            digits();
+        }
+        if (m_position < m_text.size() && (m_text[m_position] == 'e' || m_text[m_position] == 'E'))
+        {
+            m_position++;
+            if (m_position < m_text.size() && (m_text[m_position] == '+' || m_text[m_position] == '-'))
+            {
+                m_position++;
+            }
+            digits();
+        }
+
+        double value = 0;
+        const auto [end, error] = std::from_chars(m_text.data() + start, m_text.data() + m_position, value);
+        if (error != std::errc{} || end != m_text.data() + m_position)
+        {
+            m_position = start;
+            Fail();
+        }
+        return value;
+    }
+
+    bool Reader::ReadBoolean()
+    {
+        SkipWhitespace();
+        if (m_text.substr(m_position).starts_with('t'))
+        {
+            ExpectLiteral("true");
+            return true;
+        }
+        ExpectLiteral("false");
+        return false;
+    }
+
+    void Reader::ReadNull()
+    {
+        SkipWhitespace();
+        ExpectLiteral("null");
+    }
+
+    void Reader::SkipValue()
+    {
+        SkipValue(0);
+    }
+
+    void Reader::EndDocument()
+    {
+        SkipWhitespace();
+        if (m_position != m_text.size())
+        {
+            Fail();
+        }
+    }
+
+    void Reader::SkipWhitespace() noexcept
+    {
+        while (m_position < m_text.size())
+        {
+            const char c = m_text[m_position];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+            {
+                break;
+            }
+            m_position++;
+        }
+    }
+
+    void Reader::Expect(char c)
+    {
+        if (m_position == m_text.size() || m_text[m_position] != c)
+        {
+            Fail();
+        }
+        m_position++;
+    }
+
+    void Reader::ExpectLiteral(std::string_view literal)
+    {
+        if (!m_text.substr(m_position).starts_with(literal))
+        {
+            Fail();
+        }
+        m_position += literal.size();
+    }
+
+    void Reader::SkipValue(int depth)
+    {
+        if (depth > MaxDepth)
+        {
+            Fail();
+        }
+
+        switch (Peek())
+        {
+        case ValueType::Object:
+        {
+            std::wstring name;
+            BeginObject();
+            while (NextMember(name))
+            {
+                SkipValue(depth + 1);
+            }
+            break;
+        }
+        case ValueType::Array:
+            BeginArray();
+            while (NextElement())
+            {
+                SkipValue(depth + 1);
+            }
+            break;
+        case ValueType::String:
+            ReadString();
+            break;
+        case ValueType::Number:
+            ReadNumber();
+            break;
+        case ValueType::Boolean:
+            ReadBoolean();
+            break;
+        case ValueType::Null:
+            ReadNull();
+            break;
+        }
+    }
+
+    void Reader::Fail() const
+    {
+        throw SyntaxError(m_position);
+    }
+
+    void Writer::BeginObject()
+    {
+        Separate();
+        m_text.push_back('{');
+        m_needsComma = false;
+    }
+
+    void Writer::EndObject()
+    {
+        m_text.push_back('}');
+        m_needsComma = true;
+    }
+
+    void Writer::BeginArray()
+    {
+        Separate();
+        m_text.push_back('[');
+        m_needsComma = false;
+    }
+
+    void Writer::EndArray()
+    {
+        m_text.push_back(']');
+        m_needsComma = true;
+    }
+
+    void Writer::Name(std::wstring_view name)
+    {
+        String(name);
+        m_text.push_back(':');
+        m_needsComma = false;
+    }
+
+    void Writer::String(std::wstring_view value)
+    {
+        Separate();
+        m_text.push_back('"');
+        for (size_t i = 0; i < value.size(); i++)
+        {
+            auto codePoint = static_cast<uint32_t>(value[i]);
+            switch (codePoint)
+            {
+            case L'"':
+                m_text += "\\\"";
+                continue;
+            case L'\\':
+                m_text += "\\\\";
+                continue;
+            case L'\n':
+                m_text += "\\n";
+                continue;
+            case L'\r':
+                m_text += "\\r";
+                continue;
+            case L'\t':
+                m_text += "\\t";
+                continue;
+            }
+
+            if (codePoint < 0x20)
+            {
+                constexpr char hexDigits[] = "0123456789abcdef";
+                m_text += "\\u00";
+                m_text.push_back(hexDigits[codePoint >> 4]);
+                m_text.push_back(hexDigits[codePoint & 0xF]);
+                continue;
+            }
+
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < value.size() && value[i + 1] >= 0xDC00 && value[i + 1] <= 0xDFFF)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (static_cast<uint32_t>(value[i + 1]) - 0xDC00);
+                i++;
+            }
+            else if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+            {
+                codePoint = ReplacementCharacter;
+            }
+            AppendUtf8(m_text, codePoint);
+        }
+        m_text.push_back('"');
+        m_needsComma = true;
+    }
+
+    void Writer::Number(int64_t value)
+    {
+        Separate();
+        char buffer[24];
+        const auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+        m_text.append(buffer, end);
+        m_needsComma = true;
+    }
+
+    void Writer::Boolean(bool value)
+    {
+        Separate();
+        m_text += value ? "true" : "false";
+        m_needsComma = true;
+    }
+
+    std::string Writer::Release() noexcept
+    {
+        m_needsComma = false;
+        return std::exchange(m_text, {});
+    }
+
+    void Writer::Separate()
+    {
+        if (m_needsComma)
+        {
+            m_text.push_back(',');
+        }
+    }
+}
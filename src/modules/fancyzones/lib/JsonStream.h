@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/**
+ * Streaming reader and writer of UTF-8 JSON text, for files which are read straight into data structures.
+ *
+ * The reader walks the text in document order without building a document: the caller asks for the value it
+ * expects at the current position, and skips the values it doesn't know. The writer appends to a UTF-8 buffer.
+ */
+namespace JsonStream
+{
+    // Thrown when the text isn't valid JSON
+    class SyntaxError : public std::runtime_error
+    {
+    public:
+        explicit SyntaxError(size_t offset);
+
+        // Offset of the first byte which couldn't be parsed
+        size_t Offset() const noexcept { return m_offset; }
+
+    private:
+        size_t m_offset;
+    };
+
+    enum class ValueType
+    {
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    class Reader
+    {
+    public:
+        explicit Reader(std::string_view text);
+
+        /**
+         * @returns The type of the value at the current position, without consuming it.
+         */
+        ValueType Peek();
+
+        /**
+         * Enter the object at the current position, its members are then walked with NextMember.
+         */
+        void BeginObject();
+
+        /**
+         * Move to the next member of the current object and read its name. The value of the member has to be read
+         * or skipped before moving to the next one.
+         * @returns False after the last member, the object is left.
+         */
+        bool NextMember(std::wstring& name);
+
+        /**
+         * Enter the array at the current position, its elements are then walked with NextElement.
+         */
+        void BeginArray();
+
+        /**
+         * Move to the next element of the current array, which has to be read or skipped before moving further.
+         * @returns False after the last element, the array is left.
+         */
+        bool NextElement();
+
+        // The value at the current position has to be of the type read, check it with Peek first
+        std::wstring ReadString();
+        double ReadNumber();
+        bool ReadBoolean();
+        void ReadNull();
+
+        /**
+         * Skip the value at the current position, with everything it contains.
+         */
+        void SkipValue();
+
+        /**
+         * Check that only whitespace follows the top level value.
+         */
+        void EndDocument();
+
+    private:
+        void SkipWhitespace() noexcept;
+        void Expect(char c);
+        void ExpectLiteral(std::string_view literal);
+        void SkipValue(int depth);
+        [[noreturn]] void Fail() const;
+
+        std::string_view m_text;
+        size_t m_position = 0;
+        // Set when entering an array or an object, no comma is expected before its first element
+        bool m_first = false;
+    };
+
+    class Writer
+    {
+    public:
+        void BeginObject();
+        void EndObject();
+        void BeginArray();
+        void EndArray();
+
+        // Name of the next member of the current object, followed by its value
+        void Name(std::wstring_view name);
+
+        void String(std::wstring_view value);
+        void Number(int64_t value);
+        void Boolean(bool value);
+
+        /**
+         * @returns The text written so far, the writer is left empty.
+         */
+        std::string Release() noexcept;
+
+    private:
+        void Separate();
+
+        std::string m_text;
+        // Set after a value, the next element of the enclosing array or object has to be separated with a comma
+        bool m_needsComma = false;
+    };
+}
@@ -4,8 +4,9 @@
 
 winrt::com_ptr<IZoneWindow> MonitorWorkAreaHandler::GetWorkArea(const GUID& desktopId, HMONITOR monitor)
 {
-    auto desktopIt = workAreaMap.find(desktopId);
-    if (desktopIt != std::end(workAreaMap))
+    const auto workAreas = workAreaMap.Read();
+    auto desktopIt = workAreas->find(desktopId);
+    if (desktopIt != std::end(*workAreas))
     {
         auto& perDesktopData = desktopIt->second;
         auto monitorIt = perDesktopData.find(monitor);
@@ -39,20 +40,23 @@ winrt::com_ptr<IZoneWindow> MonitorWorkAreaHandler::GetWorkArea(HWND window)
     return nullptr;
 }
 
-const std::unordered_map<HMONITOR, winrt::com_ptr<IZoneWindow>>& MonitorWorkAreaHandler::GetWorkAreasByDesktopId(const GUID& desktopId)
+std::shared_ptr<const MonitorWorkAreaHandler::WorkAreasMap> MonitorWorkAreaHandler::GetWorkAreasByDesktopId(const GUID& desktopId)
 {
-    if (workAreaMap.contains(desktopId))
+    // The returned map shares the ownership of the whole snapshot
+    const auto workAreas = workAreaMap.Read();
+    auto desktopIt = workAreas->find(desktopId);
+    if (desktopIt != std::end(*workAreas))
     {
-        return workAreaMap[desktopId];
+        return { workAreas, &desktopIt->second };
     }
-    static const std::unordered_map<HMONITOR, winrt::com_ptr<IZoneWindow>> empty;
+    static const auto empty = std::make_shared<const WorkAreasMap>();
     return empty;
 }
 
 std::vector<winrt::com_ptr<IZoneWindow>> MonitorWorkAreaHandler::GetAllWorkAreas()
 {
     std::vector<winrt::com_ptr<IZoneWindow>> workAreas{};
-    for (const auto& [desktopId, perDesktopData] : workAreaMap)
+    for (const auto& [desktopId, perDesktopData] : *workAreaMap.Read())
     {
         std::transform(std::begin(perDesktopData),
                        std::end(perDesktopData),
@@ -64,20 +68,18 @@ std::vector<winrt::com_ptr<IZoneWindow>> MonitorWorkAreaHandler::GetAllWorkAreas
 
 void MonitorWorkAreaHandler::AddWorkArea(const GUID& desktopId, HMONITOR monitor, winrt::com_ptr<IZoneWindow>& workArea)
 {
-    if (!workAreaMap.contains(desktopId))
-    {
-        workAreaMap[desktopId] = {};
-    }
-    auto& perDesktopData = workAreaMap[desktopId];
-    perDesktopData[monitor] = std::move(workArea);
+    workAreaMap.Write([&](auto& workAreas) {
+        workAreas[desktopId][monitor] = std::move(workArea);
+    });
 }
 
 bool MonitorWorkAreaHandler::IsNewWorkArea(const GUID& desktopId, HMONITOR monitor)
 {
-    if (workAreaMap.contains(desktopId))
+    const auto workAreas = workAreaMap.Read();
+    auto desktopIt = workAreas->find(desktopId);
+    if (desktopIt != std::end(*workAreas))
     {
-        const auto& perDesktopData = workAreaMap[desktopId];
-        if (perDesktopData.contains(monitor))
+        if (desktopIt->second.contains(monitor))
         {
             return false;
         }
@@ -88,28 +90,30 @@ bool MonitorWorkAreaHandler::IsNewWorkArea(const GUID& desktopId, HMONITOR monit
 void MonitorWorkAreaHandler::RegisterUpdates(const std::vector<GUID>& active)
 {
     std::unordered_set<GUID> activeVirtualDesktops(std::begin(active), std::end(active));
-    for (auto desktopIt = std::begin(workAreaMap); desktopIt != std::end(workAreaMap);)
-    {
-        auto activeIt = activeVirtualDesktops.find(desktopIt->first);
-        if (activeIt == std::end(activeVirtualDesktops))
+    workAreaMap.Write([&](auto& workAreas) {
+        for (auto desktopIt = std::begin(workAreas); desktopIt != std::end(workAreas);)
         {
-            // virtual desktop deleted, remove entry from the map
-            desktopIt = workAreaMap.erase(desktopIt);
+            auto activeIt = activeVirtualDesktops.find(desktopIt->first);
+            if (activeIt == std::end(activeVirtualDesktops))
+            {
+                // virtual desktop deleted, remove entry from the map
+                desktopIt = workAreas.erase(desktopIt);
+            }
+            else
+            {
+                activeVirtualDesktops.erase(desktopIt->first); // virtual desktop already in map, skip it
+                ++desktopIt;
+            }
         }
-        else
+        // register new virtual desktops, if any
+        for (const auto& id : activeVirtualDesktops)
         {
-            activeVirtualDesktops.erase(desktopIt->first); // virtual desktop already in map, skip it
-            ++desktopIt;
+            workAreas[id] = {};
         }
-    }
-    // register new virtual desktops, if any
-    for (const auto& id : activeVirtualDesktops)
-    {
-        workAreaMap[id] = {};
-    }
+    });
 }
 
 void MonitorWorkAreaHandler::Clear()
 {
-    workAreaMap.clear();
+    workAreaMap.Assign({});
 }
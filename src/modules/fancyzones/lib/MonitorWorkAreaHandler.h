@@ -1,5 +1,7 @@
 #pragma once
 
+#include "CopyOnWrite.h"
+
 interface IZoneWindow;
 
 namespace std
@@ -15,9 +17,17 @@ namespace std
     };
 }
 
+/**
+ * Work areas of all monitors and virtual desktops.
+ *
+ * The work areas can be used from any thread. Lookups read a snapshot of the work areas and don't wait for
+ * work areas being added or removed.
+ */
 class MonitorWorkAreaHandler
 {
 public:
+    using WorkAreasMap = std::unordered_map<HMONITOR, winrt::com_ptr<IZoneWindow>>;
+
     /**
      * Get work area based on virtual desktop id and monitor handle.
      *
@@ -45,9 +55,10 @@ public:
      *
      * @param[in]  desktopId Virtual desktop identifier.
      *
-     * @returns    Map containing pairs of monitor and work area for that monitor (within same virtual desktop).
+     * @returns    Snapshot of the map containing pairs of monitor and work area for that monitor (within same
+     *             virtual desktop), which isn't changed by work areas added or removed later.
      */
-    const std::unordered_map<HMONITOR, winrt::com_ptr<IZoneWindow>>& GetWorkAreasByDesktopId(const GUID& desktopId);
+    std::shared_ptr<const WorkAreasMap> GetWorkAreasByDesktopId(const GUID& desktopId);
 
     /**
      * @returns    All registered work areas.
@@ -87,5 +98,5 @@ public:
 
 private:
     // Work area is uniquely defined by monitor and virtual desktop id.
-    std::unordered_map<GUID, std::unordered_map<HMONITOR, winrt::com_ptr<IZoneWindow>>> workAreaMap;
+    CopyOnWrite<std::unordered_map<GUID, WorkAreasMap>> workAreaMap;
 };
@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "PixelBuffer.h"
+
+#include <algorithm>
+
+namespace
+{
+    // x * y / 255, correctly rounded, for x and y in [0, 255]
+    inline uint32_t MulDiv255(uint32_t x, uint32_t y) noexcept
+    {
+        uint32_t product = x * y + 128;
+        return (product + (product >> 8)) >> 8;
+    }
+
+    // Source-over operator for premultiplied pixels: destination * (1 - source alpha) + source
+    inline PixelBuffer::Pixel BlendPixel(PixelBuffer::Pixel destination, PixelBuffer::Pixel source) noexcept
+    {
+        const uint32_t inverseAlpha = 255 - (source >> 24);
+        if (inverseAlpha == 0)
+        {
+            return source;
+        }
+
+        // Two channels at a time, each product fits in 16 bits so the channels don't interfere
+        uint32_t redBlue = (destination & 0x00FF00FF) * inverseAlpha + 0x00800080;
+        redBlue = ((redBlue + ((redBlue >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+        uint32_t alphaGreen = ((destination >> 8) & 0x00FF00FF) * inverseAlpha + 0x00800080;
+        alphaGreen = (alphaGreen + ((alphaGreen >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+
+        // Premultiplied channels never exceed the alpha, so the sum doesn't overflow into the next channel
+        return source + (redBlue | alphaGreen);
+    }
+}
+
+PixelRect PixelRect::Intersect(const PixelRect& other) const noexcept
+{
+    PixelRect result{ (std::max)(left, other.left), (std::max)(top, other.top), (std::min)(right, other.right), (std::min)(bottom, other.bottom) };
+    return result.IsEmpty() ? PixelRect{} : result;
+}
+
+PixelRect PixelRect::Union(const PixelRect& other) const noexcept
+{
+    if (IsEmpty())
+    {
+        return other;
+    }
+
+    if (other.IsEmpty())
+    {
+        return *this;
+    }
+
+    return PixelRect{ (std::min)(left, other.left), (std::min)(top, other.top), (std::max)(right, other.right), (std::max)(bottom, other.bottom) };
+}
+
+PixelBuffer::Pixel PixelBuffer::Premultiply(uint8_t alpha, uint8_t red, uint8_t green, uint8_t blue) noexcept
+{
+    return (static_cast<Pixel>(alpha) << 24) |
+           (MulDiv255(red, alpha) << 16) |
+           (MulDiv255(green, alpha) << 8) |
+           MulDiv255(blue, alpha);
+}
+
+PixelBuffer::PixelBuffer(int width, int height)
+{
+    Resize(width, height);
+}
+
+void PixelBuffer::Resize(int width, int height)
+{
+    m_width = (std::max)(width, 0);
+    m_height = (std::max)(height, 0);
+    m_pixels.assign(static_cast<size_t>(m_width) * m_height, 0);
+    ResetClip();
+}
+
+void PixelBuffer::SetClip(const PixelRect& clip) noexcept
+{
+    m_clip = clip.Intersect(Bounds());
+}
+
+void PixelBuffer::ResetClip() noexcept
+{
+    m_clip = Bounds();
+}
+
+void PixelBuffer::Clear(Pixel color) noexcept
+{
+    for (int y = m_clip.top; y < m_clip.bottom; y++)
+    {
+        std::fill_n(Row(y) + m_clip.left, m_clip.Width(), color);
+    }
+}
+
+void PixelBuffer::FillRect(const PixelRect& rect, Pixel color) noexcept
+{
+    const PixelRect target = rect.Intersect(m_clip);
+    const uint8_t alpha = Alpha(color);
+    if (target.IsEmpty() || color == 0)
+    {
+        return;
+    }
+
+    for (int y = target.top; y < target.bottom; y++)
+    {
+        Pixel* row = Row(y);
+        if (alpha == 255)
+        {
+            std::fill(row + target.left, row + target.right, color);
+        }
+        else
+        {
+            for (int x = target.left; x < target.right; x++)
+            {
+                row[x] = BlendPixel(row[x], color);
+            }
+        }
+    }
+}
+
+void PixelBuffer::DrawFrame(const PixelRect& rect, int thickness, Pixel color) noexcept
+{
+    if (rect.IsEmpty() || thickness <= 0)
+    {
+        return;
+    }
+
+    if (thickness * 2 >= rect.Width() || thickness * 2 >= rect.Height())
+    {
+        FillRect(rect, color);
+        return;
+    }
+
+    // Four rectangles which don't overlap, so translucent outlines are blended once
+    FillRect(PixelRect{ rect.left, rect.top, rect.right, rect.top + thickness }, color);
+    FillRect(PixelRect{ rect.left, rect.bottom - thickness, rect.right, rect.bottom }, color);
+    FillRect(PixelRect{ rect.left, rect.top + thickness, rect.left + thickness, rect.bottom - thickness }, color);
+    FillRect(PixelRect{ rect.right - thickness, rect.top + thickness, rect.right, rect.bottom - thickness }, color);
+}
+
+void PixelBuffer::Copy(const PixelBuffer& source, const PixelRect& sourceRect, int x, int y) noexcept
+{
+    int sourceX = x;
+    int sourceY = y;
+    const PixelRect target = ClipTransfer(source, sourceRect, sourceX, sourceY);
+    for (int row = 0; row < target.Height(); row++)
+    {
+        const Pixel* sourceRow = source.Row(sourceY + row) + sourceX;
+        std::copy(sourceRow, sourceRow + target.Width(), Row(target.top + row) + target.left);
+    }
+}
+
+void PixelBuffer::Blend(const PixelBuffer& source, const PixelRect& sourceRect, int x, int y) noexcept
+{
+    int sourceX = x;
+    int sourceY = y;
+    const PixelRect target = ClipTransfer(source, sourceRect, sourceX, sourceY);
+    for (int row = 0; row < target.Height(); row++)
+    {
+        const Pixel* sourceRow = source.Row(sourceY + row) + sourceX;
+        Pixel* destinationRow = Row(target.top + row) + target.left;
+        for (int column = 0; column < target.Width(); column++)
+        {
+            if (sourceRow[column] != 0)
+            {
+                destinationRow[column] = BlendPixel(destinationRow[column], sourceRow[column]);
+            }
+        }
+    }
+}
+
+void PixelBuffer::CopyTo(const PixelRect& rect, Pixel* destination, size_t destinationStride) const noexcept
+{
+    for (int y = rect.top; y < rect.bottom; y++)
+    {
+        const Pixel* row = Row(y);
+        std::copy(row + rect.left, row + rect.right, destination + static_cast<size_t>(y - rect.top) * destinationStride);
+    }
+}
+
+PixelRect PixelBuffer::ClipTransfer(const PixelBuffer& source, const PixelRect& sourceRect, int& x, int& y) const noexcept
+{
+    // Offset from source to destination coordinates
+    const int offsetX = x - sourceRect.left;
+    const int offsetY = y - sourceRect.top;
+
+    const PixelRect clippedSource = sourceRect.Intersect(source.Bounds());
+    const PixelRect target = PixelRect{ clippedSource.left + offsetX,
+                                        clippedSource.top + offsetY,
+                                        clippedSource.right + offsetX,
+                                        clippedSource.bottom + offsetY }
+                                 .Intersect(m_clip);
+
+    // On return x and y are the source coordinates of the top left corner of the target
+    x = target.left - offsetX;
+    y = target.top - offsetY;
+    return target;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Rectangle in pixel coordinates, the right and bottom edges are exclusive
+struct PixelRect
+{
+    int left{};
+    int top{};
+    int right{};
+    int bottom{};
+
+    int Width() const noexcept { return right - left; }
+    int Height() const noexcept { return bottom - top; }
+    bool IsEmpty() const noexcept { return right <= left || bottom <= top; }
+
+    PixelRect Intersect(const PixelRect& other) const noexcept;
+    // The union of an empty rectangle with another one is the other one
+    PixelRect Union(const PixelRect& other) const noexcept;
+
+    bool operator==(const PixelRect& other) const = default;
+};
+
+/**
+ * Premultiplied ARGB raster, independent of the platform graphics API.
+ *
+ * Pixels are stored top-down with the memory layout of a 32bpp DIB (blue, green, red and alpha bytes), so the
+ * content can be handed to GDI without conversion. All drawing is clipped to the buffer and to the clip rectangle,
+ * and blends with the source-over operator unless stated otherwise.
+ */
+class PixelBuffer
+{
+public:
+    using Pixel = uint32_t;
+
+    /**
+     * Convert a colour with straight alpha to a premultiplied pixel.
+     */
+    static Pixel Premultiply(uint8_t alpha, uint8_t red, uint8_t green, uint8_t blue) noexcept;
+    static uint8_t Alpha(Pixel pixel) noexcept { return static_cast<uint8_t>(pixel >> 24); }
+    static uint8_t Red(Pixel pixel) noexcept { return static_cast<uint8_t>(pixel >> 16); }
+    static uint8_t Green(Pixel pixel) noexcept { return static_cast<uint8_t>(pixel >> 8); }
+    static uint8_t Blue(Pixel pixel) noexcept { return static_cast<uint8_t>(pixel); }
+
+    PixelBuffer() = default;
+    PixelBuffer(int width, int height);
+
+    /**
+     * Change the size of the buffer. All pixels become transparent and the clip rectangle is reset.
+     */
+    void Resize(int width, int height);
+
+    int Width() const noexcept { return m_width; }
+    int Height() const noexcept { return m_height; }
+    PixelRect Bounds() const noexcept { return PixelRect{ 0, 0, m_width, m_height }; }
+    Pixel* Data() noexcept { return m_pixels.data(); }
+    const Pixel* Data() const noexcept { return m_pixels.data(); }
+
+    /**
+     * @returns The pixel at the given coordinates, which must be inside of the buffer.
+     */
+    Pixel GetPixel(int x, int y) const noexcept { return m_pixels[static_cast<size_t>(y) * m_width + x]; }
+
+    /**
+     * Restrict the following drawing operations to the given rectangle.
+     */
+    void SetClip(const PixelRect& clip) noexcept;
+    void ResetClip() noexcept;
+    PixelRect GetClip() const noexcept { return m_clip; }
+
+    /**
+     * Set every pixel of the clip rectangle, without blending.
+     */
+    void Clear(Pixel color) noexcept;
+    void FillRect(const PixelRect& rect, Pixel color) noexcept;
+    /**
+     * Draw the outline of the rectangle, inside of it.
+     *
+     * @param   thickness Width of the outline in pixels.
+     */
+    void DrawFrame(const PixelRect& rect, int thickness, Pixel color) noexcept;
+    /**
+     * Copy a part of another buffer, without blending.
+     *
+     * @param   source     Buffer to copy from, must not be this buffer.
+     * @param   sourceRect Part of the source buffer to copy.
+     * @param   x, y       Destination of the top left corner of sourceRect.
+     */
+    void Copy(const PixelBuffer& source, const PixelRect& sourceRect, int x, int y) noexcept;
+    /**
+     * Blend a part of another buffer over this one, with the same parameters as Copy.
+     */
+    void Blend(const PixelBuffer& source, const PixelRect& sourceRect, int x, int y) noexcept;
+    /**
+     * Copy a part of the buffer to external memory, ignoring the clip rectangle.
+     *
+     * @param   rect              Part of the buffer to copy, must be inside of the buffer.
+     * @param   destination       Memory receiving the top left pixel of rect.
+     * @param   destinationStride Distance between the rows of the destination, in pixels.
+     */
+    void CopyTo(const PixelRect& rect, Pixel* destination, size_t destinationStride) const noexcept;
+
+private:
+    // Clip the destination rectangle of a copy or blend and move the source origin by the same amount
+    PixelRect ClipTransfer(const PixelBuffer& source, const PixelRect& sourceRect, int& x, int& y) const noexcept;
+
+    Pixel* Row(int y) noexcept { return m_pixels.data() + static_cast<size_t>(y) * m_width; }
+    const Pixel* Row(int y) const noexcept { return m_pixels.data() + static_cast<size_t>(y) * m_width; }
+
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<Pixel> m_pixels;
+    PixelRect m_clip;
+};
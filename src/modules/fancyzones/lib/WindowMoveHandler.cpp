@@ -282,6 +282,16 @@ void WindowMoveHandler::MoveWindowIntoZoneByIndexSet(HWND window, const std::vec
     }
 }
 
+std::optional<RECT> WindowMoveHandler::PlaceWindowIntoZoneByIndexSet(HWND window, const std::vector<size_t>& indexSet, winrt::com_ptr<IZoneWindow> zoneWindow) noexcept
+{
+    if (window != m_windowMoveSize)
+    {
+        return zoneWindow->PlaceWindowIntoZoneByIndexSet(window, indexSet);
+    }
+
+    return std::nullopt;
+}
+
 bool WindowMoveHandler::MoveWindowIntoZoneByDirectionAndIndex(HWND window, DWORD vkCode, bool cycle, winrt::com_ptr<IZoneWindow> zoneWindow) noexcept
 {
     return zoneWindow && zoneWindow->MoveWindowIntoZoneByDirectionAndIndex(window, vkCode, cycle);
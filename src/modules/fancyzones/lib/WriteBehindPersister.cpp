@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "WriteBehindPersister.h"
+
+#include <algorithm>
+
+WriteBehindPersister::WriteBehindPersister(std::chrono::milliseconds debounceDelay, std::chrono::milliseconds maxDelay) :
+    debounceDelay(debounceDelay), maxDelay(maxDelay)
+{
+}
+
+WriteBehindPersister::~WriteBehindPersister()
+{
+    Flush();
+}
+
+WriteBehindPersister::SectionId WriteBehindPersister::AddSection(WriteCallback write)
+{
+    std::scoped_lock lock{ stateLock };
+    sections.push_back(Section{ .write = std::move(write) });
+    return sections.size() - 1;
+}
+
+void WriteBehindPersister::MarkDirty(SectionId section)
+{
+    std::scoped_lock lock{ stateLock };
+    auto now = std::chrono::steady_clock::now();
+    if (!hasPendingWrites)
+    {
+        hasPendingWrites = true;
+        firstDirtyTime = now;
+    }
+
+    lastDirtyTime = now;
+    sections[section].isDirty = true;
+
+    if (!isWriterRunning)
+    {
+        // The previous writer thread, if any, has already left its loop
+        if (writerThread.joinable())
+        {
+            writerThread.join();
+        }
+
+        isWriterRunning = true;
+        writerThread = std::jthread([this](std::stop_token stopToken) { WriterThread(stopToken); });
+    }
+}
+
+void WriteBehindPersister::Flush()
+{
+    std::jthread thread;
+    {
+        std::scoped_lock lock{ stateLock };
+        thread = std::move(writerThread);
+    }
+
+    if (thread.joinable())
+    {
+        thread.request_stop();
+        thread.join();
+    }
+
+    WritePending();
+}
+
+size_t WriteBehindPersister::GetWriteCount(SectionId section) const
+{
+    std::scoped_lock lock{ stateLock };
+    return sections[section].writeCount;
+}
+
+void WriteBehindPersister::WriterThread(std::stop_token stopToken)
+{
+    std::unique_lock lock{ stateLock };
+    while (!stopToken.stop_requested())
+    {
+        // Exit once everything is written, the next change starts a new thread. This keeps the thread
+        // from outliving a burst of changes, so it is rarely still running when the module is unloaded
+        if (!hasPendingWrites)
+        {
+            break;
+        }
+
+        // Sections marked while waiting move the deadline, up to the max delay after the first mark
+        auto deadline = (std::min)(lastDirtyTime + debounceDelay, firstDirtyTime + maxDelay);
+        if (std::chrono::steady_clock::now() < deadline)
+        {
+            writerWakeup.wait_until(lock, stopToken, deadline, [] { return false; });
+            continue;
+        }
+
+        lock.unlock();
+        WritePending();
+        lock.lock();
+    }
+
+    isWriterRunning = false;
+}
+
+void WriteBehindPersister::WritePending()
+{
+    // Hold the write lock while collecting the dirty sections, so that a section marked during a write is written again afterwards
+    std::scoped_lock write{ writeLock };
+
+    std::vector<SectionId> dirtySections;
+    {
+        std::scoped_lock lock{ stateLock };
+        for (SectionId id = 0; id < sections.size(); id++)
+        {
+            if (sections[id].isDirty)
+            {
+                sections[id].isDirty = false;
+                dirtySections.push_back(id);
+            }
+        }
+
+        hasPendingWrites = false;
+    }
+
+    // The callbacks are not modified once the sections are in use, so they can be called without the state lock
+    for (auto id : dirtySections)
+    {
+        sections[id].write();
+    }
+
+    std::scoped_lock lock{ stateLock };
+    for (auto id : dirtySections)
+    {
+        sections[id].writeCount++;
+    }
+}
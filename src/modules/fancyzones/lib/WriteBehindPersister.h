@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Persists independent sections of data on a background thread.
+// Mutations only mark their section dirty; the writer thread waits until no section has been marked
+// for the debounce delay (but no longer than the max delay) and then writes each dirty section once.
+// Writes are serialized, so a section's write callback never runs concurrently with itself or another section's.
+class WriteBehindPersister
+{
+public:
+    using WriteCallback = std::function<void()>;
+    using SectionId = size_t;
+
+    inline static const std::chrono::milliseconds DefaultDebounceDelay = std::chrono::milliseconds(500);
+    inline static const std::chrono::milliseconds DefaultMaxDelay = std::chrono::milliseconds(3000);
+
+    WriteBehindPersister(std::chrono::milliseconds debounceDelay = DefaultDebounceDelay, std::chrono::milliseconds maxDelay = DefaultMaxDelay);
+
+    // Writes the pending sections and stops the writer thread
+    ~WriteBehindPersister();
+
+    WriteBehindPersister(const WriteBehindPersister&) = delete;
+    WriteBehindPersister& operator=(const WriteBehindPersister&) = delete;
+
+    // Registers a section. All sections must be added before the first call to MarkDirty
+    SectionId AddSection(WriteCallback write);
+
+    // Schedules a write of the section. The writer thread only runs while there are pending writes
+    void MarkDirty(SectionId section);
+
+    // Writes the pending sections on the calling thread and stops the writer thread.
+    // Must not be called while holding a lock which the write callbacks acquire.
+    void Flush();
+
+    // Number of times the section has been written, used to verify the coalescing of writes
+    size_t GetWriteCount(SectionId section) const;
+
+private:
+    void WriterThread(std::stop_token stopToken);
+
+    // Writes the sections which are dirty and clears their dirty flag
+    void WritePending();
+
+    struct Section
+    {
+        WriteCallback write;
+        bool isDirty = false;
+        size_t writeCount = 0;
+    };
+
+    std::chrono::milliseconds debounceDelay;
+    std::chrono::milliseconds maxDelay;
+
+    // Guards the state below. Never held while a write callback is running
+    mutable std::mutex stateLock;
+    std::condition_variable_any writerWakeup;
+    std::vector<Section> sections;
+    bool hasPendingWrites = false;
+    bool isWriterRunning = false;
+    std::chrono::steady_clock::time_point firstDirtyTime;
+    std::chrono::steady_clock::time_point lastDirtyTime;
+
+    // Serializes the write callbacks
+    std::mutex writeLock;
+
+    std::jthread writerThread;
+};
@@ -13,13 +13,7 @@ namespace
 {
     bool ValidateZoneRect(const RECT& rect)
     {
-        int width  = rect.right - rect.left;
-        int height = rect.bottom - rect.top;
-        return rect.left   >= ZoneConstants::MAX_NEGATIVE_SPACING &&
-               rect.right  >= ZoneConstants::MAX_NEGATIVE_SPACING &&
-               rect.top    >= ZoneConstants::MAX_NEGATIVE_SPACING &&
-               rect.bottom >= ZoneConstants::MAX_NEGATIVE_SPACING &&
-               width >= 0 && height >= 0;
+        return LayoutEngine::IsValidZoneRect(LayoutEngine::ZoneRect{ rect.left, rect.top, rect.right, rect.bottom });
     }
 
     BOOL CALLBACK saveDisplayToVector(HMONITOR monitor, HDC hdc, LPRECT rect, LPARAM data)
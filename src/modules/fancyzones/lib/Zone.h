@@ -1,8 +1,10 @@
 #pragma once
 
+#include <layoutengine/LayoutEngine.h>
+
 namespace ZoneConstants
 {
-    constexpr int MAX_NEGATIVE_SPACING = -10;
+    constexpr int MAX_NEGATIVE_SPACING = LayoutEngine::MaxNegativeSpacing;
 }
 
 /**
@@ -6,9 +6,12 @@
 #include "FancyZonesDataTypes.h"
 #include "Settings.h"
 #include "Zone.h"
+#include "ZoneSpatialIndex.h"
 #include "util.h"
 
 #include <common/dpi_aware.h>
+#include <layoutengine/LayoutCache.h>
+#include <layoutengine/LayoutEngine.h>
 
 #include <limits>
 #include <map>
@@ -18,88 +21,48 @@ using namespace FancyZonesUtils;
 
 namespace
 {
-    constexpr int C_MULTIPLIER = 10000;
-
-    // PriorityGrid layout is unique for zoneCount <= 11. For zoneCount > 11 PriorityGrid is same as Grid
-    FancyZonesDataTypes::GridLayoutInfo predefinedPriorityGridLayouts[11] = {
-        /* 1 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 1,
-            .columns = 1,
-            .rowsPercents = { 10000 },
-            .columnsPercents = { 10000 },
-            .cellChildMap = { { 0 } } }),
-        /* 2 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 1,
-            .columns = 2,
-            .rowsPercents = { 10000 },
-            .columnsPercents = { 6667, 3333 },
-            .cellChildMap = { { 0, 1 } } }),
-        /* 3 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 1,
-            .columns = 3,
-            .rowsPercents = { 10000 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 } } }),
-        /* 4 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 2,
-            .columns = 3,
-            .rowsPercents = { 5000, 5000 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 }, { 0, 1, 3 } } }),
-        /* 5 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 2,
-            .columns = 3,
-            .rowsPercents = { 5000, 5000 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 }, { 3, 1, 4 } } }),
-        /* 6 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 3,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 }, { 0, 1, 3 }, { 4, 1, 5 } } }),
-        /* 7 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 3,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 }, { 3, 1, 4 }, { 5, 1, 6 } } }),
-        /* 8 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 4,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 2500, 2500, 2500 },
-            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 2, 5 }, { 6, 1, 2, 7 } } }),
-        /* 9 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 4,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 2500, 2500, 2500 },
-            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 2, 5 }, { 6, 1, 7, 8 } } }),
-        /* 10 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 4,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 2500, 2500, 2500 },
-            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 5, 6 }, { 7, 1, 8, 9 } } }),
-        /* 11 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 4,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 2500, 2500, 2500 },
-            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 5, 6 }, { 7, 8, 9, 10 } } }),
-    };
+    LayoutEngine::LayoutType ToLayoutType(FancyZonesDataTypes::ZoneSetLayoutType type) noexcept
+    {
+        switch (type)
+        {
+        case FancyZonesDataTypes::ZoneSetLayoutType::Focus:
+            return LayoutEngine::LayoutType::Focus;
+        case FancyZonesDataTypes::ZoneSetLayoutType::Columns:
+            return LayoutEngine::LayoutType::Columns;
+        case FancyZonesDataTypes::ZoneSetLayoutType::Rows:
+            return LayoutEngine::LayoutType::Rows;
+        case FancyZonesDataTypes::ZoneSetLayoutType::Grid:
+            return LayoutEngine::LayoutType::Grid;
+        default:
+            return LayoutEngine::LayoutType::PriorityGrid;
+        }
+    }
+
+    LayoutEngine::GridLayout ToGridLayout(const FancyZonesDataTypes::GridLayoutInfo& info)
+    {
+        return LayoutEngine::GridLayout{ .rows = info.rows(),
+                                         .columns = info.columns(),
+                                         .rowsPercents = info.rowsPercents(),
+                                         .columnsPercents = info.columnsPercents(),
+                                         .cellChildMap = info.cellChildMap() };
+    }
+
+    // Layouts computed by all zone sets, so that monitors and virtual desktops with the same layout and work area
+    // size don't compute it again, e.g. when a display change recreates every zone window
+    LayoutEngine::LayoutCache& SharedLayoutCache()
+    {
+        static LayoutEngine::LayoutCache cache;
+        return cache;
+    }
+
+    // DPI of the monitor, with the same fallbacks as DPIAware::Convert
+    LayoutEngine::Dpi GetMonitorDpi(HMONITOR monitor) noexcept
+    {
+        int dpiX = DPIAware::DEFAULT_DPI;
+        int dpiY = DPIAware::DEFAULT_DPI;
+        DPIAware::Convert(monitor, dpiX, dpiY);
+        return LayoutEngine::Dpi{ static_cast<unsigned>(dpiX), static_cast<unsigned>(dpiY) };
+    }
 
     inline void StampWindow(HWND window, size_t bitmask) noexcept
     {
@@ -132,10 +95,14 @@ public:
     GetZoneIndexSetFromWindow(HWND window) const noexcept;
     IFACEMETHODIMP_(ZonesMap)
     GetZones()const noexcept override { return m_zones; }
+    IFACEMETHODIMP_(size_t)
+    GetZonesCount() const noexcept override { return m_zones.size(); }
     IFACEMETHODIMP_(void)
     MoveWindowIntoZoneByIndex(HWND window, HWND workAreaWindow, size_t index) noexcept;
     IFACEMETHODIMP_(void)
     MoveWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const std::vector<size_t>& indexSet) noexcept;
+    IFACEMETHODIMP_(std::optional<RECT>)
+    PlaceWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const std::vector<size_t>& indexSet) noexcept;
     IFACEMETHODIMP_(bool)
     MoveWindowIntoZoneByDirectionAndIndex(HWND window, HWND workAreaWindow, DWORD vkCode, bool cycle) noexcept;
     IFACEMETHODIMP_(bool)
@@ -152,16 +119,16 @@ public:
     GetCombinedZoneRange(const std::vector<size_t>& initialZones, const std::vector<size_t>& finalZones) const noexcept;
 
 private:
-    bool CalculateFocusLayout(Rect workArea, int zoneCount) noexcept;
-    bool CalculateColumnsAndRowsLayout(Rect workArea, FancyZonesDataTypes::ZoneSetLayoutType type, int zoneCount, int spacing) noexcept;
-    bool CalculateGridLayout(Rect workArea, FancyZonesDataTypes::ZoneSetLayoutType type, int zoneCount, int spacing) noexcept;
-    bool CalculateUniquePriorityGridLayout(Rect workArea, int zoneCount, int spacing) noexcept;
-    bool CalculateCustomLayout(Rect workArea, int spacing) noexcept;
-    bool CalculateGridZones(Rect workArea, FancyZonesDataTypes::GridLayoutInfo gridLayoutInfo, int spacing);
+    std::optional<LayoutEngine::Zones> CalculateCustomLayout(Rect workArea, int spacing) const noexcept;
+    bool AddZones(const std::optional<LayoutEngine::Zones>& zones) noexcept;
 
     ZonesMap m_zones;
     std::map<HWND, std::vector<size_t>> m_windowIndexSet;
 
+    // Built by CalculateZones, or on the next query when zones were added directly
+    mutable ZoneSpatialIndex m_zoneIndex;
+    mutable bool m_isZoneIndexValid = false;
+
     // Needed for ExtendWindowByDirectionAndPosition
     std::map<HWND, std::vector<size_t>> m_windowInitialIndexSet;
     std::map<HWND, size_t> m_windowFinalIndex;
@@ -178,6 +145,7 @@ IFACEMETHODIMP ZoneSet::AddZone(winrt::com_ptr<IZone> zone) noexcept
         return S_FALSE;
     }
     m_zones[zoneId] = zone;
+    m_isZoneIndexValid = false;
 
     return S_OK;
 }
@@ -185,92 +153,13 @@ IFACEMETHODIMP ZoneSet::AddZone(winrt::com_ptr<IZone> zone) noexcept
 IFACEMETHODIMP_(std::vector<size_t>)
 ZoneSet::ZonesFromPoint(POINT pt) const noexcept
 {
-    std::vector<size_t> capturedZones;
-    std::vector<size_t> strictlyCapturedZones;
-    for (const auto& [zoneId, zone] : m_zones)
+    if (!m_isZoneIndexValid)
     {
-        const RECT& zoneRect = zone->GetZoneRect();
-        if (zoneRect.left - m_config.SensitivityRadius <= pt.x && pt.x <= zoneRect.right + m_config.SensitivityRadius &&
-            zoneRect.top - m_config.SensitivityRadius <= pt.y && pt.y <= zoneRect.bottom + m_config.SensitivityRadius)
-        {
-            capturedZones.emplace_back(zoneId);
-        }
-            
-        if (zoneRect.left <= pt.x && pt.x < zoneRect.right &&
-            zoneRect.top <= pt.y && pt.y < zoneRect.bottom)
-        {
-            strictlyCapturedZones.emplace_back(zoneId);
-        }
-    }
-
-    // If only one zone is captured, but it's not strictly captured
-    // don't consider it as captured
-    if (capturedZones.size() == 1 && strictlyCapturedZones.size() == 0)
-    {
-        return {};
+        m_zoneIndex.Build(m_zones, m_config.SensitivityRadius);
+        m_isZoneIndexValid = true;
     }
 
-    // If captured zones do not overlap, return all of them
-    // Otherwise, return the smallest one
-    bool overlap = false;
-    for (size_t i = 0; i < capturedZones.size(); ++i)
-    {
-        for (size_t j = i + 1; j < capturedZones.size(); ++j)
-        {
-            RECT rectI;
-            RECT rectJ;
-            try
-            {
-                rectI = m_zones.at(capturedZones[i])->GetZoneRect();
-                rectJ = m_zones.at(capturedZones[j])->GetZoneRect();
-            }
-            catch (std::out_of_range)
-            {
-                return {};
-            }
-
-            if (max(rectI.top, rectJ.top) + m_config.SensitivityRadius < min(rectI.bottom, rectJ.bottom) &&
-                max(rectI.left, rectJ.left) + m_config.SensitivityRadius < min(rectI.right, rectJ.right))
-            {
-                overlap = true;
-                break;
-            }
-        }
-        if (overlap)
-        {
-            break;
-        }
-    }
-
-    if (overlap)
-    {
-        size_t smallestIdx = 0;
-        for (size_t i = 1; i < capturedZones.size(); ++i)
-        {
-            RECT rectS;
-            RECT rectI;
-            try
-            {
-                rectS = m_zones.at(capturedZones[smallestIdx])->GetZoneRect();
-                rectI = m_zones.at(capturedZones[i])->GetZoneRect();
-            }
-            catch (std::out_of_range)
-            {
-                return {};
-            }
-            int smallestSize = (rectS.bottom - rectS.top) * (rectS.right - rectS.left);
-            int iSize = (rectI.bottom - rectI.top) * (rectI.right - rectI.left);
-
-            if (iSize <= smallestSize)
-            {
-                smallestIdx = i;
-            }
-        }
-
-        capturedZones = { capturedZones[smallestIdx] };
-    }
-
-    return capturedZones;
+    return m_zoneIndex.ZonesFromPoint(pt);
 }
 
 std::vector<size_t> ZoneSet::GetZoneIndexSetFromWindow(HWND window) const noexcept
@@ -294,10 +183,19 @@ ZoneSet::MoveWindowIntoZoneByIndex(HWND window, HWND workAreaWindow, size_t inde
 
 IFACEMETHODIMP_(void)
 ZoneSet::MoveWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const std::vector<size_t>& zoneIds) noexcept
+{
+    if (const auto rect = PlaceWindowIntoZoneByIndexSet(window, workAreaWindow, zoneIds))
+    {
+        SizeWindowToRect(window, *rect);
+    }
+}
+
+IFACEMETHODIMP_(std::optional<RECT>)
+ZoneSet::PlaceWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const std::vector<size_t>& zoneIds) noexcept
 {
     if (m_zones.empty())
     {
-        return;
+        return std::nullopt;
     }
 
     // Always clear the info related to SelectManyZones if it's not being used
@@ -341,12 +239,14 @@ ZoneSet::MoveWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const st
         }
     }
 
-    if (!sizeEmpty)
+    if (sizeEmpty)
     {
-        SaveWindowSizeAndOrigin(window);
-        SizeWindowToRect(window, size);
-        StampWindow(window, bitmask);
+        return std::nullopt;
     }
+
+    SaveWindowSizeAndOrigin(window);
+    StampWindow(window, bitmask);
+    return size;
 }
 
 IFACEMETHODIMP_(bool)
@@ -570,21 +470,21 @@ ZoneSet::CalculateZones(RECT workAreaRect, int zoneCount, int spacing) noexcept
     switch (m_config.LayoutType)
     {
     case FancyZonesDataTypes::ZoneSetLayoutType::Focus:
-        success = CalculateFocusLayout(workArea, zoneCount);
-        break;
     case FancyZonesDataTypes::ZoneSetLayoutType::Columns:
     case FancyZonesDataTypes::ZoneSetLayoutType::Rows:
-        success = CalculateColumnsAndRowsLayout(workArea, m_config.LayoutType, zoneCount, spacing);
-        break;
     case FancyZonesDataTypes::ZoneSetLayoutType::Grid:
     case FancyZonesDataTypes::ZoneSetLayoutType::PriorityGrid:
-        success = CalculateGridLayout(workArea, m_config.LayoutType, zoneCount, spacing);
+        success = AddZones(SharedLayoutCache().CalculateLayout(ToLayoutType(m_config.LayoutType), workArea.width(), workArea.height(), zoneCount, spacing));
         break;
     case FancyZonesDataTypes::ZoneSetLayoutType::Custom:
-        success = CalculateCustomLayout(workArea, spacing);
+        success = AddZones(CalculateCustomLayout(workArea, spacing));
         break;
     }
 
+    // Build the index now rather than on the first mouse move of a drag
+    m_zoneIndex.Build(m_zones, m_config.SensitivityRadius);
+    m_isZoneIndexValid = true;
+
     return success;
 }
 
@@ -601,170 +501,7 @@ bool ZoneSet::IsZoneEmpty(int zoneIndex) const noexcept
     return true;
 }
 
-bool ZoneSet::CalculateFocusLayout(Rect workArea, int zoneCount) noexcept
-{
-    long left{ 100 };
-    long top{ 100 };
-    long right{ left + long(workArea.width() * 0.4) };
-    long bottom{ top + long(workArea.height() * 0.4) };
-
-    RECT focusZoneRect{ left, top, right, bottom };
-
-    long focusRectXIncrement = (zoneCount <= 1) ? 0 : 50;
-    long focusRectYIncrement = (zoneCount <= 1) ? 0 : 50;
-
-    for (int i = 0; i < zoneCount; i++)
-    {
-        auto zone = MakeZone(focusZoneRect, m_zones.size());
-        if (zone)
-        {
-            AddZone(zone);
-        }
-        else
-        {
-            // All zones within zone set should be valid in order to use its functionality.
-            m_zones.clear();
-            return false;
-        }
-        focusZoneRect.left += focusRectXIncrement;
-        focusZoneRect.right += focusRectXIncrement;
-        focusZoneRect.bottom += focusRectYIncrement;
-        focusZoneRect.top += focusRectYIncrement;
-    }
-
-    return true;
-}
-
-bool ZoneSet::CalculateColumnsAndRowsLayout(Rect workArea, FancyZonesDataTypes::ZoneSetLayoutType type, int zoneCount, int spacing) noexcept
-{
-    long totalWidth;
-    long totalHeight;
-
-    if (type == FancyZonesDataTypes::ZoneSetLayoutType::Columns)
-    {
-        totalWidth = workArea.width() - (spacing * (zoneCount + 1));
-        totalHeight = workArea.height() - (spacing * 2);
-    }
-    else
-    { //Rows
-        totalWidth = workArea.width() - (spacing * 2);
-        totalHeight = workArea.height() - (spacing * (zoneCount + 1));
-    }
-
-    long top = spacing;
-    long left = spacing;
-    long bottom;
-    long right;
-
-    // Note: The expressions below are NOT equal to total{Width|Height} / zoneCount and are done
-    // like this to make the sum of all zones' sizes exactly total{Width|Height}.
-    for (int zoneIndex = 0; zoneIndex < zoneCount; ++zoneIndex)
-    {
-        if (type == FancyZonesDataTypes::ZoneSetLayoutType::Columns)
-        {
-            right = left + (zoneIndex + 1) * totalWidth / zoneCount - zoneIndex * totalWidth / zoneCount;
-            bottom = totalHeight + spacing;
-        }
-        else
-        { //Rows
-            right = totalWidth + spacing;
-            bottom = top + (zoneIndex + 1) * totalHeight / zoneCount - zoneIndex * totalHeight / zoneCount;
-        }
-
-
-        auto zone = MakeZone(RECT{ left, top, right, bottom }, m_zones.size());
-        if (zone)
-        {
-            AddZone(zone);
-        }
-        else
-        {
-            // All zones within zone set should be valid in order to use its functionality.
-            m_zones.clear();
-            return false;
-        }
-
-        if (type == FancyZonesDataTypes::ZoneSetLayoutType::Columns)
-        {
-            left = right + spacing;
-        }
-        else
-        { //Rows
-            top = bottom + spacing;
-        }
-    }
-
-    return true;
-}
-
-bool ZoneSet::CalculateGridLayout(Rect workArea, FancyZonesDataTypes::ZoneSetLayoutType type, int zoneCount, int spacing) noexcept
-{
-    const auto count = sizeof(predefinedPriorityGridLayouts) / sizeof(FancyZonesDataTypes::GridLayoutInfo);
-    if (type == FancyZonesDataTypes::ZoneSetLayoutType::PriorityGrid && zoneCount < count)
-    {
-        return CalculateUniquePriorityGridLayout(workArea, zoneCount, spacing);
-    }
-
-    int rows = 1, columns = 1;
-    while (zoneCount / rows >= rows)
-    {
-        rows++;
-    }
-    rows--;
-    columns = zoneCount / rows;
-    if (zoneCount % rows == 0)
-    {
-        // even grid
-    }
-    else
-    {
-        columns++;
-    }
-
-    FancyZonesDataTypes::GridLayoutInfo gridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Minimal{ .rows = rows, .columns = columns });
-
-    // Note: The expressions below are NOT equal to C_MULTIPLIER / {rows|columns} and are done
-    // like this to make the sum of all percents exactly C_MULTIPLIER
-    for (int row = 0; row < rows; row++)
-    {
-        gridLayoutInfo.rowsPercents()[row] = C_MULTIPLIER * (row + 1) / rows - C_MULTIPLIER * row / rows;
-    }
-    for (int col = 0; col < columns; col++)
-    {
-        gridLayoutInfo.columnsPercents()[col] = C_MULTIPLIER * (col + 1) / columns - C_MULTIPLIER * col / columns;
-    }
-
-    for (int i = 0; i < rows; ++i)
-    {
-        gridLayoutInfo.cellChildMap()[i] = std::vector<int>(columns);
-    }
-
-    int index = 0;
-    for (int row = 0; row < rows; row++)
-    {
-        for (int col = 0; col < columns; col++)
-        {
-            gridLayoutInfo.cellChildMap()[row][col] = index++;
-            if (index == zoneCount)
-            {
-                index--;
-            }
-        }
-    }
-    return CalculateGridZones(workArea, gridLayoutInfo, spacing);
-}
-
-bool ZoneSet::CalculateUniquePriorityGridLayout(Rect workArea, int zoneCount, int spacing) noexcept
-{
-    if (zoneCount <= 0 || zoneCount >= sizeof(predefinedPriorityGridLayouts))
-    {
-        return false;
-    }
-
-    return CalculateGridZones(workArea, predefinedPriorityGridLayouts[zoneCount - 1], spacing);
-}
-
-bool ZoneSet::CalculateCustomLayout(Rect workArea, int spacing) noexcept
+std::optional<LayoutEngine::Zones> ZoneSet::CalculateCustomLayout(Rect workArea, int spacing) const noexcept
 {
     wil::unique_cotaskmem_string guidStr;
     if (SUCCEEDED(StringFromCLSID(m_config.Id, &guidStr)))
@@ -775,122 +512,55 @@ bool ZoneSet::CalculateCustomLayout(Rect workArea, int spacing) noexcept
 
         if (!zoneSetSearchResult.has_value())
         {
-            return false;
+            return std::nullopt;
         }
 
         const auto& zoneSet = *zoneSetSearchResult;
         if (zoneSet.type == FancyZonesDataTypes::CustomLayoutType::Canvas && std::holds_alternative<FancyZonesDataTypes::CanvasLayoutInfo>(zoneSet.info))
         {
             const auto& zoneSetInfo = std::get<FancyZonesDataTypes::CanvasLayoutInfo>(zoneSet.info);
+            std::vector<LayoutEngine::CanvasZone> zones;
+            zones.reserve(zoneSetInfo.zones.size());
             for (const auto& zone : zoneSetInfo.zones)
             {
-                int x = zone.x;
-                int y = zone.y;
-                int width = zone.width;
-                int height = zone.height;
-
-                DPIAware::Convert(m_config.Monitor, x, y);
-                DPIAware::Convert(m_config.Monitor, width, height);
-
-                auto zone = MakeZone(RECT{ x, y, x + width, y + height }, m_zones.size());
-                if (zone)
-                {
-                    AddZone(zone);
-                }
-                else
-                {
-                    // All zones within zone set should be valid in order to use its functionality.
-                    m_zones.clear();
-                    return false;
-                }
+                zones.push_back(LayoutEngine::CanvasZone{ zone.x, zone.y, zone.width, zone.height });
             }
 
-            return true;
+            return SharedLayoutCache().CalculateCanvasZones(zones, GetMonitorDpi(m_config.Monitor));
         }
         else if (zoneSet.type == FancyZonesDataTypes::CustomLayoutType::Grid && std::holds_alternative<FancyZonesDataTypes::GridLayoutInfo>(zoneSet.info))
         {
             const auto& info = std::get<FancyZonesDataTypes::GridLayoutInfo>(zoneSet.info);
-            return CalculateGridZones(workArea, info, spacing);
+            return SharedLayoutCache().CalculateGridZones(ToGridLayout(info), workArea.width(), workArea.height(), spacing);
         }
     }
 
-    return false;
+    return std::nullopt;
 }
 
-bool ZoneSet::CalculateGridZones(Rect workArea, FancyZonesDataTypes::GridLayoutInfo gridLayoutInfo, int spacing)
+bool ZoneSet::AddZones(const std::optional<LayoutEngine::Zones>& zones) noexcept
 {
-    long totalWidth = workArea.width() - (spacing * (gridLayoutInfo.columns() + 1));
-    long totalHeight = workArea.height() - (spacing * (gridLayoutInfo.rows() + 1));
-    struct Info
-    {
-        long Extent;
-        long Start;
-        long End;
-    };
-    std::vector<Info> rowInfo(gridLayoutInfo.rows());
-    std::vector<Info> columnInfo(gridLayoutInfo.columns());
-
-    // Note: The expressions below are carefully written to 
-    // make the sum of all zones' sizes exactly total{Width|Height}
-    int totalPercents = 0;
-    for (int row = 0; row < gridLayoutInfo.rows(); row++)
-    {
-        rowInfo[row].Start = totalPercents * totalHeight / C_MULTIPLIER + (row + 1) * spacing;
-        totalPercents += gridLayoutInfo.rowsPercents()[row];
-        rowInfo[row].End = totalPercents * totalHeight / C_MULTIPLIER + (row + 1) * spacing;
-        rowInfo[row].Extent = rowInfo[row].End - rowInfo[row].Start;
-    }
-
-    totalPercents = 0;
-    for (int col = 0; col < gridLayoutInfo.columns(); col++)
-    {
-        columnInfo[col].Start = totalPercents * totalWidth / C_MULTIPLIER + (col + 1) * spacing;
-        totalPercents += gridLayoutInfo.columnsPercents()[col];
-        columnInfo[col].End = totalPercents * totalWidth / C_MULTIPLIER + (col + 1) * spacing;
-        columnInfo[col].Extent = columnInfo[col].End - columnInfo[col].Start;
-    }
-
-    for (int row = 0; row < gridLayoutInfo.rows(); row++)
+    if (zones.has_value())
     {
-        for (int col = 0; col < gridLayoutInfo.columns(); col++)
+        for (const auto& zone : *zones)
         {
-            int i = gridLayoutInfo.cellChildMap()[row][col];
-            if (((row == 0) || (gridLayoutInfo.cellChildMap()[row - 1][col] != i)) &&
-                ((col == 0) || (gridLayoutInfo.cellChildMap()[row][col - 1] != i)))
+            auto zoneObject = MakeZone(RECT{ zone.rect.left, zone.rect.top, zone.rect.right, zone.rect.bottom }, zone.id);
+            if (!zoneObject)
             {
-                long left = columnInfo[col].Start;
-                long top = rowInfo[row].Start;
-
-                int maxRow = row;
-                while (((maxRow + 1) < gridLayoutInfo.rows()) && (gridLayoutInfo.cellChildMap()[maxRow + 1][col] == i))
-                {
-                    maxRow++;
-                }
-                int maxCol = col;
-                while (((maxCol + 1) < gridLayoutInfo.columns()) && (gridLayoutInfo.cellChildMap()[row][maxCol + 1] == i))
-                {
-                    maxCol++;
-                }
-
-                long right = columnInfo[maxCol].End;
-                long bottom = rowInfo[maxRow].End;
-
-                auto zone = MakeZone(RECT{ left, top, right, bottom }, i);
-                if (zone)
-                {
-                    AddZone(zone);
-                }
-                else
-                {
-                    // All zones within zone set should be valid in order to use its functionality.
-                    m_zones.clear();
-                    return false;
-                }
+                // All zones within zone set should be valid in order to use its functionality.
+                m_zones.clear();
+                return false;
             }
+
+            AddZone(zoneObject);
         }
+
+        return true;
     }
 
-    return true;
+    // The layout engine returns no zones if one of them is invalid
+    m_zones.clear();
+    return false;
 }
 
 std::vector<size_t> ZoneSet::GetCombinedZoneRange(const std::vector<size_t>& initialZones, const std::vector<size_t>& finalZones) const noexcept
@@ -2,6 +2,8 @@
 
 #include "Zone.h"
 
+#include <optional>
+
 namespace FancyZonesDataTypes
 {
     enum class ZoneSetLayoutType;
@@ -48,6 +50,10 @@ interface __declspec(uuid("{E4839EB7-669D-49CF-84A9-71A2DFD851A3}")) IZoneSet :
      * @returns Array of zone objects (defining coordinates of the zone) inside this zone layout.
      */
     IFACEMETHOD_(ZonesMap, GetZones) () const = 0;
+    /**
+     * @returns Number of zones inside this zone layout, without copying them.
+     */
+    IFACEMETHOD_(size_t, GetZonesCount) () const = 0;
     /**
      * Assign window to the zone based on zone index inside zone layout.
      *
@@ -68,6 +74,19 @@ interface __declspec(uuid("{E4839EB7-669D-49CF-84A9-71A2DFD851A3}")) IZoneSet :
      */
     IFACEMETHOD_(void, MoveWindowIntoZoneByIndexSet)
     (HWND window, HWND workAreaWindow, const std::vector<size_t>& indexSet) = 0;
+    /**
+     * Assign window to the zones based on the set of zone indices inside zone layout, without moving it.
+     * Used to move several windows at once, the caller is responsible for sizing the window to the returned rect.
+     *
+     * @param   window         Handle of window which should be assigned to zone.
+     * @param   workAreaWindow The m_window of a ZoneWindow, it's a hidden window representing the
+     *                         current monitor desktop work area.
+     * @param   indexSet       The set of zone indices within zone layout.
+     *
+     * @returns Rect of the zones in workspace coordinates, or nullopt if no zone was found for the window.
+     */
+    IFACEMETHOD_(std::optional<RECT>, PlaceWindowIntoZoneByIndexSet)
+    (HWND window, HWND workAreaWindow, const std::vector<size_t>& indexSet) = 0;
     /**
      * Assign window to the zone based on direction (using WIN + LEFT/RIGHT arrow), based on zone index numbers,
      * not their on-screen position.
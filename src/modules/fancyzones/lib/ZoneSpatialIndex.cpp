@@ -0,0 +1,188 @@
+#include "pch.h"
+#include "ZoneSpatialIndex.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace
+{
+    // Upper bound of grid cells per side, so that huge layouts don't spread each zone over too many cells
+    constexpr size_t MaxCellsPerSide = 64;
+}
+
+void ZoneSpatialIndex::Build(const IZoneSet::ZonesMap& zones, int sensitivityRadius)
+{
+    Clear();
+    m_sensitivityRadius = sensitivityRadius;
+    if (zones.empty())
+    {
+        return;
+    }
+
+    m_zones.reserve(zones.size());
+    for (const auto& [zoneId, zone] : zones)
+    {
+        const RECT rect = zone->GetZoneRect();
+        m_zones.push_back(IndexedZone{ .id = zoneId,
+                                       .rect = rect,
+                                       .area = static_cast<int>((rect.bottom - rect.top) * (rect.right - rect.left)) });
+    }
+
+    // Zones overlap if their intersection is larger than the sensitivity radius in both directions
+    for (size_t i = 0; i < m_zones.size(); ++i)
+    {
+        for (size_t j = i + 1; j < m_zones.size(); ++j)
+        {
+            const RECT& rectI = m_zones[i].rect;
+            const RECT& rectJ = m_zones[j].rect;
+            if (max(rectI.top, rectJ.top) + sensitivityRadius < min(rectI.bottom, rectJ.bottom) &&
+                max(rectI.left, rectJ.left) + sensitivityRadius < min(rectI.right, rectJ.right))
+            {
+                m_zones[i].overlapping.push_back(j);
+                m_zones[j].overlapping.push_back(i);
+            }
+        }
+    }
+
+    // Zones are bucketed by the larger of their grown and their own rectangle, so that points strictly inside
+    // a zone are found even with a negative sensitivity radius
+    const LONG grow = max(sensitivityRadius, 0);
+    m_bounds = RECT{ LONG_MAX, LONG_MAX, LONG_MIN, LONG_MIN };
+    for (const auto& zone : m_zones)
+    {
+        m_bounds.left = min(m_bounds.left, zone.rect.left - grow);
+        m_bounds.top = min(m_bounds.top, zone.rect.top - grow);
+        m_bounds.right = max(m_bounds.right, zone.rect.right + grow);
+        m_bounds.bottom = max(m_bounds.bottom, zone.rect.bottom + grow);
+    }
+
+    if (m_bounds.left > m_bounds.right || m_bounds.top > m_bounds.bottom)
+    {
+        // Only degenerate zones
+        m_zones.clear();
+        return;
+    }
+
+    const size_t cellsPerSide = std::clamp(static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(m_zones.size())))) * 2, size_t(1), MaxCellsPerSide);
+    const LONG width = m_bounds.right - m_bounds.left + 1;
+    const LONG height = m_bounds.bottom - m_bounds.top + 1;
+    m_cellWidth = max(1L, static_cast<LONG>((width + cellsPerSide - 1) / cellsPerSide));
+    m_cellHeight = max(1L, static_cast<LONG>((height + cellsPerSide - 1) / cellsPerSide));
+    m_columns = static_cast<size_t>((width + m_cellWidth - 1) / m_cellWidth);
+    m_rows = static_cast<size_t>((height + m_cellHeight - 1) / m_cellHeight);
+    m_cells.resize(m_columns * m_rows);
+
+    for (size_t position = 0; position < m_zones.size(); ++position)
+    {
+        const RECT& rect = m_zones[position].rect;
+        if (rect.left - grow > rect.right + grow || rect.top - grow > rect.bottom + grow)
+        {
+            // Degenerate zone, it never captures a point
+            continue;
+        }
+
+        const size_t firstColumn = static_cast<size_t>((rect.left - grow - m_bounds.left) / m_cellWidth);
+        const size_t lastColumn = static_cast<size_t>((rect.right + grow - m_bounds.left) / m_cellWidth);
+        const size_t firstRow = static_cast<size_t>((rect.top - grow - m_bounds.top) / m_cellHeight);
+        const size_t lastRow = static_cast<size_t>((rect.bottom + grow - m_bounds.top) / m_cellHeight);
+        for (size_t row = firstRow; row <= lastRow; ++row)
+        {
+            for (size_t column = firstColumn; column <= lastColumn; ++column)
+            {
+                m_cells[row * m_columns + column].push_back(position);
+            }
+        }
+    }
+}
+
+void ZoneSpatialIndex::Clear() noexcept
+{
+    m_zones.clear();
+    m_cells.clear();
+    m_bounds = RECT{};
+    m_columns = 0;
+    m_rows = 0;
+}
+
+std::vector<size_t> ZoneSpatialIndex::ZonesFromPoint(POINT pt) const
+{
+    if (m_zones.empty() ||
+        pt.x < m_bounds.left || pt.x > m_bounds.right ||
+        pt.y < m_bounds.top || pt.y > m_bounds.bottom)
+    {
+        return {};
+    }
+
+    // Positions of the captured zones, in ascending order as the cell is
+    std::vector<size_t> capturedZones;
+    size_t strictlyCapturedCount = 0;
+    for (size_t position : m_cells[CellFromPoint(pt)])
+    {
+        const RECT& zoneRect = m_zones[position].rect;
+        if (zoneRect.left - m_sensitivityRadius <= pt.x && pt.x <= zoneRect.right + m_sensitivityRadius &&
+            zoneRect.top - m_sensitivityRadius <= pt.y && pt.y <= zoneRect.bottom + m_sensitivityRadius)
+        {
+            capturedZones.push_back(position);
+        }
+
+        if (zoneRect.left <= pt.x && pt.x < zoneRect.right &&
+            zoneRect.top <= pt.y && pt.y < zoneRect.bottom)
+        {
+            strictlyCapturedCount++;
+        }
+    }
+
+    // If only one zone is captured, but it's not strictly captured
+    // don't consider it as captured
+    if (capturedZones.size() == 1 && strictlyCapturedCount == 0)
+    {
+        return {};
+    }
+
+    bool overlap = false;
+    for (size_t position : capturedZones)
+    {
+        const auto& overlapping = m_zones[position].overlapping;
+        overlap = std::any_of(overlapping.begin(), overlapping.end(), [&](size_t other) {
+            return std::binary_search(capturedZones.begin(), capturedZones.end(), other);
+        });
+
+        if (overlap)
+        {
+            break;
+        }
+    }
+
+    // If captured zones do not overlap, return all of them
+    // Otherwise, return the smallest one, the last one in id order on ties
+    if (overlap)
+    {
+        size_t smallest = capturedZones[0];
+        for (size_t i = 1; i < capturedZones.size(); ++i)
+        {
+            if (m_zones[capturedZones[i]].area <= m_zones[smallest].area)
+            {
+                smallest = capturedZones[i];
+            }
+        }
+
+        return { m_zones[smallest].id };
+    }
+
+    std::vector<size_t> result;
+    result.reserve(capturedZones.size());
+    for (size_t position : capturedZones)
+    {
+        result.push_back(m_zones[position].id);
+    }
+
+    return result;
+}
+
+size_t ZoneSpatialIndex::CellFromPoint(POINT pt) const noexcept
+{
+    const size_t column = static_cast<size_t>((pt.x - m_bounds.left) / m_cellWidth);
+    const size_t row = static_cast<size_t>((pt.y - m_bounds.top) / m_cellHeight);
+    return min(row, m_rows - 1) * m_columns + min(column, m_columns - 1);
+}
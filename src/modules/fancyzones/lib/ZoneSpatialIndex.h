@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ZoneSet.h"
+
+#include <vector>
+
+/**
+ * Lookup structure answering IZoneSet::ZonesFromPoint queries without scanning every zone.
+ *
+ * Zones are bucketed into a uniform grid over their rectangles grown by the sensitivity radius, and the
+ * pairwise overlap relation between zones is precomputed, so a query only looks at the zones sharing the
+ * grid cell of the point. Zones are immutable, so the index only has to be rebuilt when the zone set changes.
+ */
+class ZoneSpatialIndex
+{
+public:
+    /**
+     * Build the index for the given zones, replacing any previous content.
+     *
+     * @param   zones             Zones of the zone layout.
+     * @param   sensitivityRadius Distance around a zone within which the cursor still captures it.
+     */
+    void Build(const IZoneSet::ZonesMap& zones, int sensitivityRadius);
+    /**
+     * Remove all zones from the index.
+     */
+    void Clear() noexcept;
+    /**
+     * Get zones from cursor coordinates, with the same result as the scan over all zones.
+     *
+     * @param   pt Cursor coordinates.
+     * @returns Vector of zone ids, the zones considered active.
+     */
+    std::vector<size_t> ZonesFromPoint(POINT pt) const;
+
+private:
+    struct IndexedZone
+    {
+        size_t id;
+        RECT rect;
+        int area;
+        // Positions of the zones which overlap this one by more than the sensitivity radius
+        std::vector<size_t> overlapping;
+    };
+
+    // Position of the grid cell containing the point, which must be inside the grid bounds
+    size_t CellFromPoint(POINT pt) const noexcept;
+
+    // Zones ordered by id, the order in which the scan visits them
+    std::vector<IndexedZone> m_zones;
+
+    // Positions of the zones whose grown rectangle intersects each cell, in ascending order
+    std::vector<std::vector<size_t>> m_cells;
+
+    // Union of the grown zone rectangles. Inclusive on all sides, as a zone captures points on its grown border
+    RECT m_bounds{};
+    LONG m_cellWidth = 1;
+    LONG m_cellHeight = 1;
+    size_t m_columns = 0;
+    size_t m_rows = 0;
+    int m_sensitivityRadius = 0;
+};
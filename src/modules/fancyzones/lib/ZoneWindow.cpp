@@ -69,9 +69,10 @@ namespace ZoneWindowUtils
                          COLORREF hostZoneBorderColor,
                          COLORREF hostZoneHighlightColor,
                          int hostZoneHighlightOpacity,
-                         IZoneSet::ZonesMap zones,
+                         std::shared_ptr<const IZoneSet::ZonesMap> zones,
                          std::vector<size_t> highlightZone,
-                         bool flashMode)
+                         bool flashMode,
+                         std::shared_ptr<ZoneWindowDrawing::OverlayRenderer> overlayRenderer)
     {
         PAINTSTRUCT ps;
         HDC oldHdc = hdc;
@@ -83,20 +84,31 @@ namespace ZoneWindowUtils
         RECT clientRect;
         GetClientRect(window, &clientRect);
 
+        // Only the invalidated part of the window has to be buffered and copied to the screen
+        RECT paintRect = clientRect;
+        if (!oldHdc)
+        {
+            IntersectRect(&paintRect, &clientRect, &ps.rcPaint);
+        }
+
         wil::unique_hdc hdcMem;
-        HPAINTBUFFER bufferedPaint = BeginBufferedPaint(hdc, &clientRect, BPBF_TOPDOWNDIB, nullptr, &hdcMem);
+        HPAINTBUFFER bufferedPaint = BeginBufferedPaint(hdc, &paintRect, BPBF_TOPDOWNDIB, nullptr, &hdcMem);
         if (bufferedPaint)
         {
-            ZoneWindowDrawing::DrawBackdrop(hdcMem, clientRect);
-
-            if (hasActiveZoneSet)
+            const ZoneWindowDrawing::OverlayStyle style{ hostZoneColor, hostZoneBorderColor, hostZoneHighlightColor, hostZoneHighlightOpacity, flashMode };
+            if (!hasActiveZoneSet || !zones)
+            {
+                ZoneWindowDrawing::DrawBackdrop(hdcMem, clientRect);
+            }
+            else if (!overlayRenderer || !overlayRenderer->Render(bufferedPaint, paintRect, clientRect, *zones, highlightZone, style))
             {
+                ZoneWindowDrawing::DrawBackdrop(hdcMem, clientRect);
                 ZoneWindowDrawing::DrawActiveZoneSet(hdcMem,
                                                      hostZoneColor,
                                                      hostZoneBorderColor,
                                                      hostZoneHighlightColor,
                                                      hostZoneHighlightOpacity,
-                                                     zones,
+                                                     *zones,
                                                      highlightZone,
                                                      flashMode);
             }
@@ -126,6 +138,8 @@ public:
     MoveWindowIntoZoneByIndex(HWND window, size_t index) noexcept;
     IFACEMETHODIMP_(void)
     MoveWindowIntoZoneByIndexSet(HWND window, const std::vector<size_t>& indexSet) noexcept;
+    IFACEMETHODIMP_(std::optional<RECT>)
+    PlaceWindowIntoZoneByIndexSet(HWND window, const std::vector<size_t>& indexSet) noexcept;
     IFACEMETHODIMP_(bool)
     MoveWindowIntoZoneByDirectionAndIndex(HWND window, DWORD vkCode, bool cycle) noexcept;
     IFACEMETHODIMP_(bool)
@@ -148,6 +162,8 @@ public:
     UpdateActiveZoneSet() noexcept;
     IFACEMETHODIMP_(void)
     ClearSelectedZones() noexcept;
+    IFACEMETHODIMP_(ZoneWindowRepaintStatistics)
+    GetRepaintStatistics() noexcept { return m_repaintStatistics; }
 
 protected:
     static LRESULT CALLBACK s_WndProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam) noexcept;
@@ -156,6 +172,8 @@ private:
     void InitializeZoneSets(const std::wstring& parentUniqueId) noexcept;
     void CalculateZoneSet() noexcept;
     void UpdateActiveZoneSet(_In_opt_ IZoneSet* zoneSet) noexcept;
+    void UpdateActiveZones() noexcept;
+    void SetHighlightZone(std::vector<size_t> highlightZone) noexcept;
     LRESULT WndProc(UINT message, WPARAM wparam, LPARAM lparam) noexcept;
     void OnPaint(HDC hdc) noexcept;
     void OnKeyUp(WPARAM wparam) noexcept;
@@ -170,9 +188,12 @@ private:
     HWND m_windowMoveSize{};
     bool m_flashMode{};
     winrt::com_ptr<IZoneSet> m_activeZoneSet;
+    std::shared_ptr<const IZoneSet::ZonesMap> m_activeZones; // Snapshot of the zones of m_activeZoneSet, shared with the paint thread
     std::vector<winrt::com_ptr<IZoneSet>> m_zoneSets;
     std::vector<size_t> m_initialHighlightZone;
     std::vector<size_t> m_highlightZone;
+    ZoneWindowRepaintStatistics m_repaintStatistics;
+    std::shared_ptr<ZoneWindowDrawing::OverlayRenderer> m_overlayRenderer = std::make_shared<ZoneWindowDrawing::OverlayRenderer>();
     WPARAM m_keyLast{};
     size_t m_keyCycle{};
     static const UINT m_showAnimationDuration = 200; // ms
@@ -265,13 +286,15 @@ IFACEMETHODIMP ZoneWindow::MoveSizeEnter(HWND window) noexcept
     m_windowMoveSize = window;
     m_highlightZone = {};
     m_initialHighlightZone = {};
+    UpdateActiveZones();
     ShowZoneWindow();
     return S_OK;
 }
 
 IFACEMETHODIMP ZoneWindow::MoveSizeUpdate(POINT const& ptScreen, bool dragEnabled, bool selectManyZones) noexcept
 {
-    bool redraw = false;
+    m_repaintStatistics.frames++;
+
     POINT ptClient = ptScreen;
     MapWindowPoints(nullptr, m_window.get(), &ptClient, 1);
 
@@ -296,19 +319,13 @@ IFACEMETHODIMP ZoneWindow::MoveSizeUpdate(POINT const& ptScreen, bool dragEnable
             m_initialHighlightZone = {};
         }
 
-        redraw = (highlightZone != m_highlightZone);
-        m_highlightZone = std::move(highlightZone);
+        SetHighlightZone(std::move(highlightZone));
     }
-    else if (m_highlightZone.size())
+    else
     {
-        m_highlightZone = {};
-        redraw = true;
+        SetHighlightZone({});
     }
 
-    if (redraw)
-    {
-        InvalidateRect(m_window.get(), nullptr, true);
-    }
     return S_OK;
 }
 
@@ -352,6 +369,17 @@ ZoneWindow::MoveWindowIntoZoneByIndexSet(HWND window, const std::vector<size_t>&
     }
 }
 
+IFACEMETHODIMP_(std::optional<RECT>)
+ZoneWindow::PlaceWindowIntoZoneByIndexSet(HWND window, const std::vector<size_t>& indexSet) noexcept
+{
+    if (m_activeZoneSet)
+    {
+        return m_activeZoneSet->PlaceWindowIntoZoneByIndexSet(window, m_window.get(), indexSet);
+    }
+
+    return std::nullopt;
+}
+
 IFACEMETHODIMP_(bool)
 ZoneWindow::MoveWindowIntoZoneByDirectionAndIndex(HWND window, DWORD vkCode, bool cycle) noexcept
 {
@@ -474,6 +502,9 @@ ZoneWindow::HideZoneWindow() noexcept
         m_keyLast = 0;
         m_windowMoveSize = nullptr;
         m_highlightZone = {};
+
+        // The overlay buffers cover the whole window, so they are only kept while it is shown
+        m_overlayRenderer->Release();
     }
 }
 
@@ -486,11 +517,7 @@ ZoneWindow::UpdateActiveZoneSet() noexcept
 IFACEMETHODIMP_(void)
 ZoneWindow::ClearSelectedZones() noexcept
 {
-    if (m_highlightZone.size())
-    {
-        m_highlightZone.clear();
-        InvalidateRect(m_window.get(), nullptr, true);
-    }
+    SetHighlightZone({});
 }
 
 #pragma region private
@@ -565,6 +592,7 @@ void ZoneWindow::CalculateZoneSet() noexcept
 void ZoneWindow::UpdateActiveZoneSet(_In_opt_ IZoneSet* zoneSet) noexcept
 {
     m_activeZoneSet.copy_from(zoneSet);
+    UpdateActiveZones();
 
     if (m_activeZoneSet)
     {
@@ -580,6 +608,40 @@ void ZoneWindow::UpdateActiveZoneSet(_In_opt_ IZoneSet* zoneSet) noexcept
     }
 }
 
+void ZoneWindow::UpdateActiveZones() noexcept
+{
+    if (m_activeZoneSet)
+    {
+        m_activeZones = std::make_shared<const IZoneSet::ZonesMap>(m_activeZoneSet->GetZones());
+    }
+    else
+    {
+        m_activeZones = nullptr;
+    }
+}
+
+void ZoneWindow::SetHighlightZone(std::vector<size_t> highlightZone) noexcept
+{
+    auto changedZones = ZoneWindowDrawing::GetChangedHighlightZones(m_highlightZone, highlightZone);
+    m_highlightZone = std::move(highlightZone);
+    if (changedZones.empty())
+    {
+        return;
+    }
+
+    m_repaintStatistics.invalidatedFrames++;
+    m_repaintStatistics.invalidatedZones += changedZones.size();
+
+    // Only the changed zones have to be repainted, the rest of the window stays the same
+    std::optional<RECT> updateRect;
+    if (m_activeZones)
+    {
+        updateRect = ZoneWindowDrawing::GetZonesUpdateRect(*m_activeZones, changedZones);
+    }
+
+    InvalidateRect(m_window.get(), updateRect.has_value() ? &updateRect.value() : nullptr, true);
+}
+
 LRESULT ZoneWindow::WndProc(UINT message, WPARAM wparam, LPARAM lparam) noexcept
 {
     switch (message)
@@ -621,9 +683,12 @@ void ZoneWindow::OnPaint(HDC hdc) noexcept
     COLORREF hostZoneBorderColor{};
     COLORREF hostZoneHighlightColor{};
     int hostZoneHighlightOpacity{};
-    IZoneSet::ZonesMap zones;
+    std::shared_ptr<const IZoneSet::ZonesMap> zones;
     std::vector<size_t> highlightZone = m_highlightZone;
     bool flashMode = m_flashMode;
+    auto overlayRenderer = m_overlayRenderer;
+
+    m_repaintStatistics.paints++;
 
     if (hasActiveZoneSet)
     {
@@ -631,7 +696,7 @@ void ZoneWindow::OnPaint(HDC hdc) noexcept
         hostZoneBorderColor = m_host->GetZoneBorderColor();
         hostZoneHighlightColor = m_host->GetZoneHighlightColor();
         hostZoneHighlightOpacity = m_host->GetZoneHighlightOpacity();
-        zones = m_activeZoneSet->GetZones();
+        zones = m_activeZones;
     }
 
     OnThreadExecutor::task_t task{
@@ -645,7 +710,8 @@ void ZoneWindow::OnPaint(HDC hdc) noexcept
                                          hostZoneHighlightOpacity,
                                          zones,
                                          highlightZone,
-                                         flashMode);
+                                         flashMode,
+                                         overlayRenderer);
         } };
 
     if (m_animating)
@@ -695,7 +761,7 @@ void ZoneWindow::CycleActiveZoneSetInternal(DWORD wparam, Trace::ZoneWindow::Inp
     size_t i = 0;
     for (auto zoneSet : m_zoneSets)
     {
-        if (zoneSet->GetZones().size() == val)
+        if (zoneSet->GetZonesCount() == val)
         {
             if (i < m_keyCycle)
             {
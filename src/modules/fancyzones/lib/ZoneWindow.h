@@ -8,6 +8,21 @@ namespace ZoneWindowUtils
     std::wstring GenerateUniqueIdAllMonitorsArea(const std::wstring& virtualDesktopId);
 }
 
+/**
+ * Counters of the zone highlight repaints of a work area, used to verify that unchanged frames are not repainted.
+ */
+struct ZoneWindowRepaintStatistics
+{
+    // Number of MoveSizeUpdate calls
+    size_t frames{};
+    // Number of calls in which the highlighted zones changed and part of the window was invalidated
+    size_t invalidatedFrames{};
+    // Number of zones which had to be redrawn, summed over all invalidations
+    size_t invalidatedZones{};
+    // Number of times the window was painted
+    size_t paints{};
+};
+
 /**
  * Class representing single work area, which is defined by monitor and virtual desktop.
  */
@@ -57,6 +72,15 @@ interface __declspec(uuid("{7F017528-8110-4FB3-BE41-F472969C2560}")) IZoneWindow
      * @param   indexSet The set of zone indices within zone layout.
      */
     IFACEMETHOD_(void, MoveWindowIntoZoneByIndexSet)(HWND window, const std::vector<size_t>& indexSet) = 0;
+    /**
+     * Assign window to the zones based on the set of zone indices inside zone layout, without moving it.
+     *
+     * @param   window   Handle of window which should be assigned to zone.
+     * @param   indexSet The set of zone indices within zone layout.
+     *
+     * @returns Rect the window should be sized to, in workspace coordinates, or nullopt if it isn't zoned.
+     */
+    IFACEMETHOD_(std::optional<RECT>, PlaceWindowIntoZoneByIndexSet)(HWND window, const std::vector<size_t>& indexSet) = 0;
     /**
      * Assign window to the zone based on direction (using WIN + LEFT/RIGHT arrow), based on zone index numbers,
      * not their on-screen position.
@@ -124,6 +148,10 @@ interface __declspec(uuid("{7F017528-8110-4FB3-BE41-F472969C2560}")) IZoneWindow
      * Clear the selected zones when this ZoneWindow loses focus.
      */
     IFACEMETHOD_(void, ClearSelectedZones)() = 0;
+    /**
+     * @returns Counters of the zone highlight repaints since the work area was created.
+     */
+    IFACEMETHOD_(ZoneWindowRepaintStatistics, GetRepaintStatistics)() = 0;
 };
 
 winrt::com_ptr<IZoneWindow> MakeZoneWindow(IZoneWindowHost* host, HINSTANCE hinstance, HMONITOR monitor,
@@ -2,6 +2,7 @@
 #include "ZoneWindowDrawing.h"
 
 #include <algorithm>
+#include <cmath>
 #include <map>
 #include <string>
 #include <vector>
@@ -59,6 +60,35 @@ namespace
         return static_cast<BYTE>(opacity * 2.55);
     }
 
+    // Width of the zone borders drawn by the overlay renderer, inside of the zone rectangle
+    constexpr int ZoneBorderThickness = 2;
+
+    ZoneWindowDrawing::ColorSetting GetColorSetting(ZoneWindowDrawing::OverlayStyle const& style, bool highlight) noexcept
+    {
+        //       { fillAlpha, fill, borderAlpha, border, thickness }
+        if (highlight)
+        {
+            return { OpacitySettingToAlpha(style.zoneOpacity), style.highlightColor, 255, style.zoneBorderColor, -2 };
+        }
+
+        if (style.flashMode)
+        {
+            return { OpacitySettingToAlpha(style.zoneOpacity), RGB(81, 92, 107), 200, RGB(104, 118, 138), -2 };
+        }
+
+        return { OpacitySettingToAlpha(style.zoneOpacity), style.zoneColor, 255, style.zoneBorderColor, -2 };
+    }
+
+    PixelBuffer::Pixel ToPixel(BYTE alpha, COLORREF color) noexcept
+    {
+        return PixelBuffer::Premultiply(alpha, GetRValue(color), GetGValue(color), GetBValue(color));
+    }
+
+    PixelRect ToPixelRect(RECT const& rect) noexcept
+    {
+        return PixelRect{ rect.left, rect.top, rect.right, rect.bottom };
+    }
+
     void DrawIndex(wil::unique_hdc& hdc, FancyZonesUtils::Rect rect, size_t index)
     {
         Gdiplus::Graphics g(hdc.get());
@@ -70,7 +100,7 @@ namespace
         std::wstring text = std::to_wstring(index);
 
         g.SetTextRenderingHint(Gdiplus::TextRenderingHintAntiAlias);
-        Gdiplus::StringFormat stringFormat = new Gdiplus::StringFormat();
+        Gdiplus::StringFormat stringFormat;
         stringFormat.SetAlignment(Gdiplus::StringAlignmentCenter);
         stringFormat.SetLineAlignment(Gdiplus::StringAlignmentCenter);
 
@@ -93,7 +123,8 @@ namespace
         Gdiplus::Rect rectangle(zoneRect.left, zoneRect.top, zoneRect.right - zoneRect.left - 1, zoneRect.bottom - zoneRect.top - 1);
 
         Gdiplus::Pen pen(borderColor, static_cast<Gdiplus::REAL>(colorSetting.thickness));
-        g.FillRectangle(new Gdiplus::SolidBrush(fillColor), rectangle);
+        Gdiplus::SolidBrush brush(fillColor);
+        g.FillRectangle(&brush, rectangle);
         g.DrawRectangle(&pen, rectangle);
 
         if (!flashMode)
@@ -162,4 +193,297 @@ namespace ZoneWindowDrawing
             }
         }
     }
+
+    std::vector<size_t> GetChangedHighlightZones(const std::vector<size_t>& previous, const std::vector<size_t>& current)
+    {
+        if (previous == current)
+        {
+            return {};
+        }
+
+        auto contains = [](const std::vector<size_t>& zones, size_t zoneId) {
+            return std::find(zones.begin(), zones.end(), zoneId) != zones.end();
+        };
+
+        std::vector<size_t> changed;
+        std::vector<size_t> commonPrevious;
+        std::vector<size_t> commonCurrent;
+        for (size_t zoneId : previous)
+        {
+            if (contains(current, zoneId))
+            {
+                commonPrevious.push_back(zoneId);
+            }
+            else
+            {
+                changed.push_back(zoneId);
+            }
+        }
+
+        for (size_t zoneId : current)
+        {
+            if (contains(previous, zoneId))
+            {
+                commonCurrent.push_back(zoneId);
+            }
+            else
+            {
+                changed.push_back(zoneId);
+            }
+        }
+
+        if (commonPrevious != commonCurrent)
+        {
+            changed.insert(changed.end(), commonCurrent.begin(), commonCurrent.end());
+        }
+
+        return changed;
+    }
+
+    std::optional<RECT> GetZonesUpdateRect(const IZoneSet::ZonesMap& zones, const std::vector<size_t>& zoneIds) noexcept
+    {
+        RECT updateRect{};
+        for (size_t zoneId : zoneIds)
+        {
+            auto zoneIt = zones.find(zoneId);
+            if (zoneIt == zones.end() || !zoneIt->second)
+            {
+                return std::nullopt;
+            }
+
+            // Zone borders and labels are drawn inside the zone rectangle
+            RECT zoneRect = zoneIt->second->GetZoneRect();
+            UnionRect(&updateRect, &updateRect, &zoneRect);
+        }
+
+        return updateRect;
+    }
+
+    bool OverlayRenderer::Render(HPAINTBUFFER bufferedPaint,
+                                 RECT const& paintRect,
+                                 RECT const& clientRect,
+                                 const IZoneSet::ZonesMap& zones,
+                                 const std::vector<size_t>& highlightZones,
+                                 OverlayStyle const& style) noexcept
+    {
+        RGBQUAD* bits = nullptr;
+        int rowWidth = 0;
+        if (FAILED(GetBufferedPaintBits(bufferedPaint, &bits, &rowWidth)) || !bits)
+        {
+            return false;
+        }
+
+        std::scoped_lock lock{ m_lock };
+        const PixelRect target = ToPixelRect(paintRect);
+        ComposeLocked(m_frame, target, ToPixelRect(clientRect), zones, highlightZones, style);
+
+        // The first pixel of the buffer is the top left corner of the paint rectangle
+        const PixelRect source = target.Intersect(m_frame.Bounds());
+        PixelBuffer::Pixel* destination = reinterpret_cast<PixelBuffer::Pixel*>(bits) +
+                                          static_cast<size_t>(source.top - target.top) * rowWidth +
+                                          (source.left - target.left);
+        m_frame.CopyTo(source, destination, rowWidth);
+        return true;
+    }
+
+    void OverlayRenderer::Compose(PixelBuffer& frame,
+                                  RECT const& paintRect,
+                                  RECT const& clientRect,
+                                  const IZoneSet::ZonesMap& zones,
+                                  const std::vector<size_t>& highlightZones,
+                                  OverlayStyle const& style)
+    {
+        std::scoped_lock lock{ m_lock };
+        ComposeLocked(frame, ToPixelRect(paintRect), ToPixelRect(clientRect), zones, highlightZones, style);
+    }
+
+    size_t OverlayRenderer::GetRasterizationCount() const noexcept
+    {
+        std::scoped_lock lock{ m_lock };
+        return m_rasterizationCount;
+    }
+
+    void OverlayRenderer::Release() noexcept
+    {
+        std::scoped_lock lock{ m_lock };
+
+        // Assigning empty buffers frees the pixels, resizing them would keep the capacity
+        m_staticLayer = PixelBuffer();
+        m_frame = PixelBuffer();
+        m_labels.clear();
+        m_layout.clear();
+        m_layout.shrink_to_fit();
+        m_nextLayout.clear();
+        m_nextLayout.shrink_to_fit();
+        m_isStaticLayerValid = false;
+    }
+
+    void OverlayRenderer::ComposeLocked(PixelBuffer& frame,
+                                        PixelRect paintRect,
+                                        PixelRect clientRect,
+                                        const IZoneSet::ZonesMap& zones,
+                                        const std::vector<size_t>& highlightZones,
+                                        OverlayStyle const& style)
+    {
+        UpdateStaticLayer(clientRect, zones, style);
+
+        if (frame.Width() != m_staticLayer.Width() || frame.Height() != m_staticLayer.Height())
+        {
+            frame.Resize(m_staticLayer.Width(), m_staticLayer.Height());
+        }
+
+        frame.ResetClip();
+        const PixelRect target = paintRect.Intersect(frame.Bounds());
+        frame.Copy(m_staticLayer, target, target.left, target.top);
+
+        auto findZone = [this](size_t zoneId) {
+            auto zoneIt = std::lower_bound(m_layout.begin(), m_layout.end(), zoneId, [](const auto& zone, size_t id) { return zone.first < id; });
+            return (zoneIt != m_layout.end() && zoneIt->first == zoneId) ? zoneIt : m_layout.end();
+        };
+
+        PixelRect highlightRect;
+        for (size_t zoneId : highlightZones)
+        {
+            auto zoneIt = findZone(zoneId);
+            if (zoneIt != m_layout.end())
+            {
+                highlightRect = highlightRect.Union(zoneIt->second);
+            }
+        }
+
+        highlightRect = highlightRect.Intersect(target);
+        if (highlightRect.IsEmpty())
+        {
+            return;
+        }
+
+        // Highlighted zones are drawn over all other zones, so the part of the frame they cover is drawn again
+        // from scratch, with the zones in the same order as DrawActiveZoneSet
+        frame.SetClip(highlightRect);
+        frame.Clear(0);
+        for (const auto& [zoneId, zoneRect] : m_layout)
+        {
+            if (!zoneRect.Intersect(highlightRect).IsEmpty() &&
+                std::find(highlightZones.begin(), highlightZones.end(), zoneId) == highlightZones.end())
+            {
+                DrawZone(frame, zoneRect, zoneId, false);
+            }
+        }
+
+        for (size_t zoneId : highlightZones)
+        {
+            auto zoneIt = findZone(zoneId);
+            if (zoneIt != m_layout.end())
+            {
+                DrawZone(frame, zoneIt->second, zoneId, true);
+            }
+        }
+
+        frame.ResetClip();
+    }
+
+    void OverlayRenderer::UpdateStaticLayer(PixelRect clientRect, const IZoneSet::ZonesMap& zones, OverlayStyle const& style)
+    {
+        // Zones are ordered by id in the map, so the layout is too. It is built in a member so that painting doesn't allocate
+        m_nextLayout.clear();
+        for (const auto& [zoneId, zone] : zones)
+        {
+            if (zone)
+            {
+                m_nextLayout.emplace_back(zoneId, ToPixelRect(zone->GetZoneRect()));
+            }
+        }
+
+        if (m_isStaticLayerValid && m_nextLayout == m_layout && clientRect == m_clientRect && style == m_style)
+        {
+            return;
+        }
+
+        m_layout.swap(m_nextLayout);
+        m_clientRect = clientRect;
+        m_style = style;
+
+        if (style.flashMode)
+        {
+            m_labels.clear();
+        }
+        else
+        {
+            RasterizeLabels(zones);
+        }
+
+        m_staticLayer.Resize(clientRect.Width(), clientRect.Height());
+        for (const auto& [zoneId, zoneRect] : m_layout)
+        {
+            DrawZone(m_staticLayer, zoneRect, zoneId, false);
+        }
+
+        m_isStaticLayerValid = true;
+        m_rasterizationCount++;
+    }
+
+    void OverlayRenderer::RasterizeLabels(const IZoneSet::ZonesMap& zones)
+    {
+        m_labels.clear();
+
+        Gdiplus::FontFamily fontFamily(NonLocalizable::SegoeUiFont);
+        Gdiplus::Font font(&fontFamily, 80, Gdiplus::FontStyleRegular, Gdiplus::UnitPixel);
+        Gdiplus::SolidBrush solidBrush(Gdiplus::Color(255, 0, 0, 0));
+        Gdiplus::StringFormat stringFormat;
+        stringFormat.SetAlignment(Gdiplus::StringAlignmentCenter);
+        stringFormat.SetLineAlignment(Gdiplus::StringAlignmentCenter);
+
+        Gdiplus::Bitmap measureBitmap(1, 1, PixelFormat32bppPARGB);
+        Gdiplus::Graphics measureGraphics(&measureBitmap);
+
+        for (const auto& [zoneId, zone] : zones)
+        {
+            if (!zone)
+            {
+                continue;
+            }
+
+            std::wstring text = std::to_wstring(zone->Id() + 1);
+            Gdiplus::RectF bounds;
+            measureGraphics.MeasureString(text.c_str(), -1, &font, Gdiplus::PointF(0, 0), &stringFormat, &bounds);
+
+            PixelBuffer label(static_cast<int>(std::ceil(bounds.Width)), static_cast<int>(std::ceil(bounds.Height)));
+            if (label.Bounds().IsEmpty())
+            {
+                continue;
+            }
+
+            // The bitmap draws straight into the label pixels, which have the same premultiplied layout
+            Gdiplus::Bitmap bitmap(label.Width(), label.Height(), label.Width() * sizeof(PixelBuffer::Pixel), PixelFormat32bppPARGB, reinterpret_cast<BYTE*>(label.Data()));
+            {
+                Gdiplus::Graphics g(&bitmap);
+                g.SetTextRenderingHint(Gdiplus::TextRenderingHintAntiAlias);
+                Gdiplus::RectF labelRect(0, 0, static_cast<Gdiplus::REAL>(label.Width()), static_cast<Gdiplus::REAL>(label.Height()));
+                g.DrawString(text.c_str(), -1, &font, labelRect, &stringFormat, &solidBrush);
+            }
+
+            m_labels.emplace(zoneId, std::move(label));
+        }
+    }
+
+    void OverlayRenderer::DrawZone(PixelBuffer& buffer, const PixelRect& zoneRect, size_t zoneId, bool highlight) const noexcept
+    {
+        const ColorSetting colorSetting = GetColorSetting(m_style, highlight);
+        buffer.FillRect(zoneRect, ToPixel(colorSetting.fillAlpha, colorSetting.fill));
+        buffer.DrawFrame(zoneRect, ZoneBorderThickness, ToPixel(colorSetting.borderAlpha, colorSetting.border));
+
+        auto labelIt = m_labels.find(zoneId);
+        if (labelIt != m_labels.end())
+        {
+            // The label is clipped to its zone, like text drawn into the zone rectangle
+            const PixelBuffer& label = labelIt->second;
+            const PixelRect clip = buffer.GetClip();
+            buffer.SetClip(clip.Intersect(zoneRect));
+            buffer.Blend(label,
+                         label.Bounds(),
+                         zoneRect.left + (zoneRect.Width() - label.Width()) / 2,
+                         zoneRect.top + (zoneRect.Height() - label.Height()) / 2);
+            buffer.SetClip(clip);
+        }
+    }
 }
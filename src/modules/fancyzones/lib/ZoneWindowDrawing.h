@@ -1,10 +1,15 @@
 #pragma once
 
 #include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
 #include <vector>
+#include <Uxtheme.h>
 #include <wil\resource.h>
 #include <winrt/base.h>
 
+#include "PixelBuffer.h"
 #include "util.h"
 #include "Zone.h"
 #include "ZoneSet.h"
@@ -29,4 +34,84 @@ namespace ZoneWindowDrawing
                            const IZoneSet::ZonesMap& zones,
                            const std::vector<size_t>& highlightZones,
                            bool flashMode) noexcept;
+
+    struct OverlayStyle
+    {
+        COLORREF zoneColor{};
+        COLORREF zoneBorderColor{};
+        COLORREF highlightColor{};
+        int zoneOpacity{};
+        bool flashMode{};
+
+        bool operator==(const OverlayStyle& other) const = default;
+    };
+
+    // Draws the zone overlay from a cached rasterization of the layout.
+    // The zones in their normal state and the index labels are rasterized once per layout, window size (and so DPI)
+    // and style. Each paint copies that layer and draws only the highlighted zones, and whatever they overlap, over it.
+    // The renderer can be shared by the threads painting the same window.
+    class OverlayRenderer
+    {
+    public:
+        // Draws the part of the window in paintRect into the buffered paint, which must target paintRect.
+        // Returns false if the buffer bits are not accessible, the caller then has to draw the overlay itself
+        bool Render(HPAINTBUFFER bufferedPaint,
+                    RECT const& paintRect,
+                    RECT const& clientRect,
+                    const IZoneSet::ZonesMap& zones,
+                    const std::vector<size_t>& highlightZones,
+                    OverlayStyle const& style) noexcept;
+
+        // Composes the part of the window in paintRect into frame, which is resized to the window if needed.
+        // The rest of the frame is left as it was
+        void Compose(PixelBuffer& frame,
+                     RECT const& paintRect,
+                     RECT const& clientRect,
+                     const IZoneSet::ZonesMap& zones,
+                     const std::vector<size_t>& highlightZones,
+                     OverlayStyle const& style);
+
+        // Number of times the static layer has been rasterized
+        size_t GetRasterizationCount() const noexcept;
+
+        // Frees the cached layer, the labels and the frame while the window is hidden.
+        // The next paint rasterizes the layer again
+        void Release() noexcept;
+
+    private:
+        void ComposeLocked(PixelBuffer& frame,
+                           PixelRect paintRect,
+                           PixelRect clientRect,
+                           const IZoneSet::ZonesMap& zones,
+                           const std::vector<size_t>& highlightZones,
+                           OverlayStyle const& style);
+
+        // Rasterizes the static layer again if the layout, the window size or the style changed
+        void UpdateStaticLayer(PixelRect clientRect, const IZoneSet::ZonesMap& zones, OverlayStyle const& style);
+        void RasterizeLabels(const IZoneSet::ZonesMap& zones);
+        void DrawZone(PixelBuffer& buffer, const PixelRect& zoneRect, size_t zoneId, bool highlight) const noexcept;
+
+        mutable std::mutex m_lock;
+
+        // Key of the cached static layer
+        std::vector<std::pair<size_t, PixelRect>> m_layout;
+        PixelRect m_clientRect;
+        OverlayStyle m_style;
+        bool m_isStaticLayerValid = false;
+        // Layout of the zones being painted, compared with the key and swapped into it when it changed
+        std::vector<std::pair<size_t, PixelRect>> m_nextLayout;
+
+        PixelBuffer m_staticLayer;
+        // Index label of each zone, drawn centered on the zone
+        std::map<size_t, PixelBuffer> m_labels;
+        PixelBuffer m_frame;
+        size_t m_rasterizationCount = 0;
+    };
+
+    // Returns the zones which have to be redrawn when the highlighted zones change from previous to current.
+    // Highlighted zones are drawn in order, so zones highlighted in both frames are included if their order changed
+    std::vector<size_t> GetChangedHighlightZones(const std::vector<size_t>& previous, const std::vector<size_t>& current);
+
+    // Returns the rectangle covering the given zones including their borders, or nullopt if a zone is unknown
+    std::optional<RECT> GetZonesUpdateRect(const IZoneSet::ZonesMap& zones, const std::vector<size_t>& zoneIds) noexcept;
 }
@@ -17,6 +17,7 @@
 #define EventZoneWindowKeyUpKey "FancyZones_ZoneWindowKeyUp"
 #define EventMoveSizeEndKey "FancyZones_MoveSizeEnd"
 #define EventCycleActiveZoneSetKey "FancyZones_CycleActiveZoneSet"
+#define EventWindowsPositionsUpdatedKey "FancyZones_WindowsPositionsUpdated"
 
 #define EventEnabledKey "Enabled"
 #define PressedKeyCodeKey "Hotkey"
@@ -55,6 +56,9 @@
 #define NumberOfZonesKey "NumberOfZones"
 #define NumberOfWindowsKey "NumberOfWindows"
 #define InputModeKey "InputMode"
+#define DeferredWindowsKey "NumberOfDeferredWindows"
+#define BatchesKey "NumberOfBatches"
+#define DurationKey "DurationMs"
 
 TRACELOGGING_DEFINE_PROVIDER(
     g_hProvider,
@@ -226,6 +230,19 @@ void Trace::FancyZones::Error(const DWORD errorCode, std::wstring errorMessage,
         TraceLoggingValue(errorMessage.c_str(), "ErrorMessage"));
 }
 
+void Trace::FancyZones::WindowsPositionsUpdated(size_t windowCount, size_t deferredCount, size_t batchCount, long long durationMs) noexcept
+{
+    TraceLoggingWrite(
+        g_hProvider,
+        EventWindowsPositionsUpdatedKey,
+        ProjectTelemetryPrivacyDataTag(ProjectTelemetryTag_ProductAndServicePerformance),
+        TraceLoggingKeyword(PROJECT_KEYWORD_MEASURE),
+        TraceLoggingValue(windowCount, NumberOfWindowsKey),
+        TraceLoggingValue(deferredCount, DeferredWindowsKey),
+        TraceLoggingValue(batchCount, BatchesKey),
+        TraceLoggingValue(durationMs, DurationKey));
+}
+
 void Trace::SettingsChanged(const Settings& settings) noexcept
 {
     const auto& editorHotkey = settings.editorHotkey;
@@ -17,6 +17,7 @@ public:
         static void DataChanged() noexcept;
         static void EditorLaunched(int value) noexcept;
         static void Error(const DWORD errorCode, std::wstring errorMessage, std::wstring methodName) noexcept;
+        static void WindowsPositionsUpdated(size_t windowCount, size_t deferredCount, size_t batchCount, long long durationMs) noexcept;
     };
 
     static void SettingsChanged(const Settings& settings) noexcept;
@@ -5,6 +5,7 @@
 #include <common/common.h>
 #include <common/dpi_aware.h>
 
+#include <algorithm>
 #include <array>
 #include <sstream>
 #include <complex>
@@ -205,6 +206,122 @@ namespace FancyZonesUtils
         ::SetWindowPlacement(window, &placement);
     }
 
+    WindowPlacementBatch::WindowApi WindowPlacementBatch::WindowApi::Default()
+    {
+        WindowApi api;
+        api.monitorFromWindow = [](HWND window) { return MonitorFromWindow(window, MONITOR_DEFAULTTONULL); };
+        api.monitorFromRect = [](const RECT& rect) { return MonitorFromRect(&rect, MONITOR_DEFAULTTONULL); };
+        api.getMonitorInfo = [](HMONITOR monitor, MONITORINFO& mi) { return GetMonitorInfoW(monitor, &mi) != FALSE; };
+        api.isMinimized = [](HWND window) { return IsIconic(window) != FALSE; };
+        api.isMaximized = [](HWND window) { return IsZoomed(window) != FALSE; };
+        api.isResponsive = [](HWND window) {
+            // IsHungAppWindow only reports windows which haven't answered for several seconds
+            return SendMessageTimeoutW(window, WM_NULL, 0, 0, SMTO_ABORTIFHUNG, ResponseTimeout, nullptr) != 0;
+        };
+        api.moveWindows = [](const std::vector<std::pair<HWND, RECT>>& windows) {
+            HDWP hdwp = BeginDeferWindowPos(static_cast<int>(windows.size()));
+            for (const auto& [window, rect] : windows)
+            {
+                if (!hdwp)
+                {
+                    break;
+                }
+
+                // On failure the batch is freed and the handle is invalid
+                hdwp = DeferWindowPos(hdwp, window, nullptr, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE);
+            }
+
+            return hdwp && EndDeferWindowPos(hdwp);
+        };
+        api.sizeWindowToRect = [](HWND window, RECT rect) { SizeWindowToRect(window, rect); };
+        return api;
+    }
+
+    WindowPlacementBatch::WindowPlacementBatch() :
+        m_api(WindowApi::Default())
+    {
+    }
+
+    WindowPlacementBatch::WindowPlacementBatch(WindowApi api) :
+        m_api(std::move(api))
+    {
+    }
+
+    void WindowPlacementBatch::Add(HWND window, RECT rect)
+    {
+        m_windows.emplace_back(window, rect);
+    }
+
+    WindowPlacementBatch::Result WindowPlacementBatch::Apply() noexcept
+    {
+        Result result{ .windows = m_windows.size() };
+
+        // Windows on each monitor with their screen rects and their positions in m_windows
+        struct MonitorWindows
+        {
+            HMONITOR monitor;
+            std::vector<std::pair<HWND, RECT>> windows;
+            std::vector<size_t> indices;
+        };
+        std::vector<MonitorWindows> monitorWindows;
+
+        // Positions in m_windows of the windows which are sized one by one
+        std::vector<size_t> fallbackWindows;
+
+        for (size_t i = 0; i < m_windows.size(); i++)
+        {
+            const auto& [window, rect] = m_windows[i];
+            const HMONITOR monitor = m_api.monitorFromWindow(window);
+            MONITORINFO mi{ sizeof(mi) };
+            if (!monitor || m_api.isMinimized(window) || m_api.isMaximized(window) || !m_api.getMonitorInfo(monitor, mi))
+            {
+                fallbackWindows.push_back(i);
+                continue;
+            }
+
+            // Workspace coordinates are offset by the taskbar, see Zone::ComputeActualZoneRect
+            RECT screenRect = rect;
+            OffsetRect(&screenRect, std::abs(mi.rcMonitor.left - mi.rcWork.left), std::abs(mi.rcMonitor.top - mi.rcWork.top));
+
+            // Windows changing monitor may have to be rescaled, which SizeWindowToRect takes care of.
+            // The probe is sent last, so that it's only sent to windows which would be batched
+            if (m_api.monitorFromRect(screenRect) != monitor || !m_api.isResponsive(window))
+            {
+                fallbackWindows.push_back(i);
+                continue;
+            }
+
+            auto it = std::find_if(monitorWindows.begin(), monitorWindows.end(), [monitor](const auto& entry) { return entry.monitor == monitor; });
+            if (it == monitorWindows.end())
+            {
+                it = monitorWindows.insert(monitorWindows.end(), { monitor, {}, {} });
+            }
+            it->windows.emplace_back(window, screenRect);
+            it->indices.push_back(i);
+        }
+
+        for (const auto& entry : monitorWindows)
+        {
+            if (m_api.moveWindows(entry.windows))
+            {
+                result.deferred += entry.windows.size();
+                result.batches++;
+            }
+            else
+            {
+                fallbackWindows.insert(fallbackWindows.end(), entry.indices.begin(), entry.indices.end());
+            }
+        }
+
+        for (const size_t i : fallbackWindows)
+        {
+            m_api.sizeWindowToRect(m_windows[i].first, m_windows[i].second);
+        }
+
+        m_windows.clear();
+        return result;
+    }
+
     bool HasNoVisibleOwner(HWND window) noexcept
     {
         auto owner = GetWindow(window, GW_OWNER);
@@ -3,6 +3,8 @@
 #include "gdiplus.h"
 #include <common/string_utils.h>
 
+#include <functional>
+
 namespace FancyZonesUtils
 {
     struct Rect
@@ -163,6 +165,64 @@ namespace FancyZonesUtils
     void OrderMonitors(std::vector<std::pair<HMONITOR, RECT>>& monitorInfo);
     void SizeWindowToRect(HWND window, RECT rect) noexcept;
 
+    /**
+     * Sizes several windows to their rects at once, e.g. all zoned windows after the layout changed.
+     *
+     * Windows are grouped by monitor and each group is moved with a single DeferWindowPos batch, so that the
+     * windows are repainted together instead of one after another. The batch keeps the z-order of the windows.
+     * EndDeferWindowPos waits for every window of the batch, so only windows which answer a message within
+     * ResponseTimeout are batched. Windows which can't be moved that way (minimized, maximized, not responding,
+     * moving to another monitor or in a failed batch) are sized with SizeWindowToRect, which doesn't block.
+     */
+    class WindowPlacementBatch
+    {
+    public:
+        struct Result
+        {
+            size_t windows = 0;
+            // Windows moved through DeferWindowPos
+            size_t deferred = 0;
+            // Number of DeferWindowPos batches
+            size_t batches = 0;
+        };
+
+        // Time a window has to answer the probe message to be moved in a batch
+        static constexpr UINT ResponseTimeout = 50;
+
+        /**
+         * Window functions used by Apply, which tests replace to control the monitors and the window states.
+         */
+        struct WindowApi
+        {
+            std::function<HMONITOR(HWND)> monitorFromWindow;
+            std::function<HMONITOR(const RECT&)> monitorFromRect;
+            std::function<bool(HMONITOR, MONITORINFO&)> getMonitorInfo;
+            std::function<bool(HWND)> isMinimized;
+            std::function<bool(HWND)> isMaximized;
+            std::function<bool(HWND)> isResponsive;
+            // Moves the windows of a monitor, in screen coordinates, in a single batch. Returns false if the batch failed
+            std::function<bool(const std::vector<std::pair<HWND, RECT>>&)> moveWindows;
+            std::function<void(HWND, RECT)> sizeWindowToRect;
+
+            static WindowApi Default();
+        };
+
+        WindowPlacementBatch();
+        explicit WindowPlacementBatch(WindowApi api);
+
+        /**
+         * @param   window Handle of the window.
+         * @param   rect   Rect in workspace coordinates, as for SizeWindowToRect.
+         */
+        void Add(HWND window, RECT rect);
+
+        Result Apply() noexcept;
+
+    private:
+        WindowApi m_api;
+        std::vector<std::pair<HWND, RECT>> m_windows;
+    };
+
     bool HasNoVisibleOwner(HWND window) noexcept;
     bool IsStandardWindow(HWND window);
     bool IsCandidateForLastKnownZone(HWND window, const std::vector<std::wstring>& excludedApps) noexcept;
@@ -0,0 +1,132 @@
+// Measures how long the layout engine takes to recompute the zones of every layout type, over a range of zone
+// counts, spacings, monitor sizes and DPI scales. It runs without a desktop session, so layout recomputation on
+// display changes can be profiled on build machines.
+//
+// Usage: LayoutEngineBenchmark [iterations]
+// Prints one CSV line per configuration, with the average time of a recomputation in microseconds.
+
+#include <layoutengine/LayoutEngine.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr int DefaultIterations = 1000;
+
+    struct MonitorSize
+    {
+        long width;
+        long height;
+    };
+
+    constexpr std::array MonitorSizes{
+        MonitorSize{ 1366, 768 },
+        MonitorSize{ 1920, 1080 },
+        MonitorSize{ 2560, 1440 },
+        MonitorSize{ 3440, 1440 },
+        MonitorSize{ 3840, 2160 },
+        MonitorSize{ 7680, 4320 },
+    };
+
+    constexpr std::array Dpis{ 96u, 120u, 144u, 192u };
+    constexpr std::array Spacings{ LayoutEngine::MaxNegativeSpacing, 0, 16, 64 };
+    constexpr std::array ZoneCounts{ 1, 2, 3, 4, 5, 8, 10, 11, 16, 20, 32, 64 };
+
+    constexpr std::array<std::pair<LayoutEngine::LayoutType, const char*>, 5> LayoutTypes{ {
+        { LayoutEngine::LayoutType::Focus, "Focus" },
+        { LayoutEngine::LayoutType::Columns, "Columns" },
+        { LayoutEngine::LayoutType::Rows, "Rows" },
+        { LayoutEngine::LayoutType::Grid, "Grid" },
+        { LayoutEngine::LayoutType::PriorityGrid, "PriorityGrid" },
+    } };
+
+    // Keeps the compiler from optimizing away the calculations
+    volatile size_t g_zoneSink = 0;
+
+    template<typename Calculate>
+    double Measure(int iterations, Calculate&& calculate)
+    {
+        size_t zones = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            const auto result = calculate();
+            zones += result ? result->size() : 0;
+        }
+        const auto end = std::chrono::steady_clock::now();
+        g_zoneSink = g_zoneSink + zones;
+
+        return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+    }
+
+    // Canvas layout tiling the unscaled work area, as the layout editor would save it
+    std::vector<LayoutEngine::CanvasZone> MakeCanvasZones(const MonitorSize& unscaledSize, int zoneCount)
+    {
+        std::vector<LayoutEngine::CanvasZone> zones;
+        const int width = static_cast<int>(unscaledSize.width);
+        const int height = static_cast<int>(unscaledSize.height);
+        for (int i = 0; i < zoneCount; i++)
+        {
+            const int zoneWidth = width / 2;
+            const int zoneHeight = height / 2;
+            zones.push_back(LayoutEngine::CanvasZone{ (i * 37) % (width - zoneWidth), (i * 23) % (height - zoneHeight), zoneWidth, zoneHeight });
+        }
+        return zones;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = DefaultIterations;
+    if (argc > 1)
+    {
+        iterations = std::atoi(argv[1]);
+        if (iterations <= 0)
+        {
+            std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("layout,width,height,dpi,spacing,zones,valid,microseconds\n");
+
+    for (const auto& monitor : MonitorSizes)
+    {
+        for (const int zoneCount : ZoneCounts)
+        {
+            // FancyZones is per monitor DPI aware, predefined layouts are computed in physical pixels and don't depend on the DPI
+            for (const auto& [type, name] : LayoutTypes)
+            {
+                for (const int spacing : Spacings)
+                {
+                    const bool valid = LayoutEngine::CalculateLayout(type, monitor.width, monitor.height, zoneCount, spacing).has_value();
+                    const double time = Measure(iterations, [&] {
+                        return LayoutEngine::CalculateLayout(type, monitor.width, monitor.height, zoneCount, spacing);
+                    });
+                    std::printf("%s,%ld,%ld,%u,%d,%d,%d,%.3f\n", name, monitor.width, monitor.height, LayoutEngine::DefaultDpi, spacing, zoneCount, valid, time);
+                }
+            }
+
+            // Canvas layouts are saved in unscaled pixels and scaled to the DPI of the monitor
+            for (const unsigned dpi : Dpis)
+            {
+                const MonitorSize unscaled{ monitor.width * static_cast<long>(LayoutEngine::DefaultDpi) / static_cast<long>(dpi),
+                                            monitor.height * static_cast<long>(LayoutEngine::DefaultDpi) / static_cast<long>(dpi) };
+                const auto canvasZones = MakeCanvasZones(unscaled, zoneCount);
+                const LayoutEngine::Dpi canvasDpi{ dpi, dpi };
+                const bool valid = LayoutEngine::CalculateCanvasZones(canvasZones, canvasDpi).has_value();
+                const double time = Measure(iterations, [&] {
+                    return LayoutEngine::CalculateCanvasZones(canvasZones, canvasDpi);
+                });
+                std::printf("Canvas,%ld,%ld,%u,0,%d,%d,%.3f\n", monitor.width, monitor.height, dpi, zoneCount, valid, time);
+            }
+        }
+    }
+
+    return 0;
+}
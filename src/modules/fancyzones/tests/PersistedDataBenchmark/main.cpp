@@ -0,0 +1,160 @@
+// Measures how long FancyZones takes to read its persisted data on startup and to write it back, with the JSON
+// document parser and with the streaming one. The zone settings and a large app zone history are generated in
+// a temporary folder.
+//
+// Usage: PersistedDataBenchmark [history entries] [iterations]
+// Prints one CSV line per measurement, with the average time in milliseconds.
+
+#include <Windows.h>
+
+#include <lib/JsonHelpers.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    constexpr int DefaultHistoryEntries = 50000;
+    constexpr int DefaultIterations = 5;
+
+    // Keeps the compiler from optimizing away the work
+    volatile size_t g_sink = 0;
+
+    template<typename Run>
+    double Measure(int iterations, Run&& run)
+    {
+        size_t result = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            result += run();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        g_sink = g_sink + result;
+
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    }
+
+    std::wstring MakeGuid(int index)
+    {
+        wchar_t guid[39];
+        swprintf_s(guid, L"{%08X-130D-4B5D-8851-4791D66B1539}", index);
+        return guid;
+    }
+
+    // Monitors on a few virtual desktops, each one with its own layout
+    JSONHelpers::TDeviceInfoMap MakeDevices(int count)
+    {
+        JSONHelpers::TDeviceInfoMap devices;
+        for (int i = 0; i < count; i++)
+        {
+            const std::wstring deviceId = L"DELA026#5&10a58c63&0&UID" + std::to_wstring(i % 4) + L"_1920_1080_" + MakeGuid(i / 4);
+            devices[deviceId] = FancyZonesDataTypes::DeviceInfoData{ { MakeGuid(i), FancyZonesDataTypes::ZoneSetLayoutType::Custom }, true, 16, 3, 20 };
+        }
+        return devices;
+    }
+
+    JSONHelpers::TCustomZoneSetsMap MakeCustomZoneSets(int count)
+    {
+        JSONHelpers::TCustomZoneSetsMap customZoneSets;
+        for (int i = 0; i < count; i++)
+        {
+            FancyZonesDataTypes::GridLayoutInfo grid(FancyZonesDataTypes::GridLayoutInfo::Full{
+                .rows = 2,
+                .columns = 3,
+                .rowsPercents = { 5000, 5000 },
+                .columnsPercents = { 2500, 5000, 2500 },
+                .cellChildMap = { { 0, 1, 2 }, { 3, 4, 5 } } });
+            customZoneSets[MakeGuid(i)] = FancyZonesDataTypes::CustomZoneSetData{ L"Layout " + std::to_wstring(i), FancyZonesDataTypes::CustomLayoutType::Grid, grid };
+        }
+        return customZoneSets;
+    }
+
+    JSONHelpers::TAppZoneHistoryMap MakeAppZoneHistory(const JSONHelpers::TDeviceInfoMap& devices, int count)
+    {
+        JSONHelpers::TAppZoneHistoryMap appZoneHistory;
+        auto device = devices.begin();
+        for (int i = 0; i < count; i++)
+        {
+            FancyZonesDataTypes::AppZoneHistoryData data{};
+            data.deviceId = device->first;
+            data.zoneSetUuid = device->second.activeZoneSet.uuid;
+            data.zoneIndexSet = { static_cast<size_t>(i % 6) };
+            appZoneHistory[L"C:\\Program Files\\Application " + std::to_wstring(i) + L"\\application.exe"] = { data };
+
+            if (++device == devices.end())
+            {
+                device = devices.begin();
+            }
+        }
+        return appZoneHistory;
+    }
+
+    void WriteFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream{ path, std::ios::binary } << content;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int historyEntries = DefaultHistoryEntries;
+    int iterations = DefaultIterations;
+    if (argc > 1)
+    {
+        historyEntries = std::atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        iterations = std::atoi(argv[2]);
+    }
+    if (historyEntries <= 0 || iterations <= 0)
+    {
+        std::fprintf(stderr, "Usage: %s [history entries] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    winrt::init_apartment();
+
+    const auto folder = std::filesystem::temp_directory_path() / L"PersistedDataBenchmark";
+    std::filesystem::create_directories(folder);
+    const std::wstring zonesSettingsFileName = (folder / L"zones-settings.json").wstring();
+    const std::wstring appZoneHistoryFileName = (folder / L"app-zone-history.json").wstring();
+
+    const auto devices = MakeDevices(16);
+    const auto customZoneSets = MakeCustomZoneSets(16);
+    const auto appZoneHistory = MakeAppZoneHistory(devices, historyEntries);
+    WriteFile(zonesSettingsFileName, JSONHelpers::SerializeZoneSettingsContent(devices, customZoneSets));
+    WriteFile(appZoneHistoryFileName, JSONHelpers::SerializeAppZoneHistoryContent(appZoneHistory));
+
+    std::printf("parser,operation,entries,milliseconds\n");
+
+    const double documentRead = Measure(iterations, [&] {
+        const auto json = JSONHelpers::GetPersistFancyZonesJSON(zonesSettingsFileName, appZoneHistoryFileName);
+        return JSONHelpers::ParseAppZoneHistory(json).size() + JSONHelpers::ParseDeviceInfos(json).size() + JSONHelpers::ParseCustomZoneSets(json).size();
+    });
+    std::printf("document,read,%d,%.3f\n", historyEntries, documentRead);
+
+    const double streamingRead = Measure(iterations, [&] {
+        const auto data = JSONHelpers::ReadPersistFancyZonesData(zonesSettingsFileName, appZoneHistoryFileName);
+        return data.appZoneHistoryMap.size() + data.deviceInfoMap.size() + data.customZoneSetsMap.size();
+    });
+    std::printf("streaming,read,%d,%.3f\n", historyEntries, streamingRead);
+
+    const double documentWrite = Measure(iterations, [&] {
+        return winrt::to_string(JSONHelpers::GetAppZoneHistoryJSON(appZoneHistory).Stringify()).size();
+    });
+    std::printf("document,write,%d,%.3f\n", historyEntries, documentWrite);
+
+    const double streamingWrite = Measure(iterations, [&] {
+        return JSONHelpers::SerializeAppZoneHistoryContent(appZoneHistory).size();
+    });
+    std::printf("streaming,write,%d,%.3f\n", historyEntries, streamingWrite);
+
+    std::filesystem::remove_all(folder);
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "pch.h"
+#include <lib/AppZoneHistoryStore.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace FancyZonesDataTypes;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (AppZoneHistoryStoreUnitTests)
+    {
+        static AppZoneHistoryData MakeData(const std::wstring& deviceId, const std::wstring& zoneSetId, size_t zoneIndex)
+        {
+            return AppZoneHistoryData{ .processIdToHandleMap = {}, .zoneSetUuid = zoneSetId, .deviceId = deviceId, .zoneIndexSet = { zoneIndex } };
+        }
+
+        TEST_METHOD (FindEmpty)
+        {
+            AppZoneHistoryStore store;
+            Assert::IsNull(store.Find(L"app.exe", L"device"));
+            Assert::IsTrue(store.GetMap().empty());
+        }
+
+        TEST_METHOD (InsertAndFind)
+        {
+            AppZoneHistoryStore store;
+            store.Insert(L"app.exe", MakeData(L"device-1", L"zone-set", 1));
+            store.Insert(L"app.exe", MakeData(L"device-2", L"zone-set", 2));
+            store.Insert(L"other.exe", MakeData(L"device-1", L"zone-set", 3));
+
+            Assert::AreEqual(size_t{ 2 }, store.GetMap().size());
+            Assert::AreEqual(size_t{ 2 }, store.GetMap().at(L"app.exe").size());
+            Assert::AreEqual(size_t{ 2 }, store.Find(L"app.exe", L"device-2")->zoneIndexSet[0]);
+            Assert::AreEqual(size_t{ 3 }, store.Find(L"other.exe", L"device-1")->zoneIndexSet[0]);
+            Assert::IsNull(store.Find(L"other.exe", L"device-2"));
+            Assert::IsNull(store.Find(L"unknown.exe", L"device-1"));
+        }
+
+        TEST_METHOD (InsertReplacesHistoryOnSameDevice)
+        {
+            AppZoneHistoryStore store;
+            store.Insert(L"app.exe", MakeData(L"device", L"zone-set-1", 1));
+            store.Insert(L"app.exe", MakeData(L"device", L"zone-set-2", 2));
+
+            Assert::AreEqual(size_t{ 1 }, store.GetMap().at(L"app.exe").size());
+            Assert::AreEqual(std::wstring{ L"zone-set-2" }, store.Find(L"app.exe", L"device")->zoneSetUuid);
+        }
+
+        TEST_METHOD (Erase)
+        {
+            AppZoneHistoryStore store;
+            store.Insert(L"app.exe", MakeData(L"device-1", L"zone-set", 1));
+            store.Insert(L"app.exe", MakeData(L"device-2", L"zone-set", 2));
+
+            Assert::IsTrue(store.Erase(L"app.exe", L"device-1"));
+            Assert::IsFalse(store.Erase(L"app.exe", L"device-1"));
+            Assert::IsNull(store.Find(L"app.exe", L"device-1"));
+            // The remaining entry moved in the history of the app and is still found
+            Assert::AreEqual(size_t{ 2 }, store.Find(L"app.exe", L"device-2")->zoneIndexSet[0]);
+
+            Assert::IsTrue(store.Erase(L"app.exe", L"device-2"));
+            Assert::IsTrue(store.GetMap().empty());
+
+            store.Insert(L"app.exe", MakeData(L"device-1", L"zone-set", 3));
+            Assert::AreEqual(size_t{ 3 }, store.Find(L"app.exe", L"device-1")->zoneIndexSet[0]);
+        }
+
+        TEST_METHOD (EraseDevices)
+        {
+            AppZoneHistoryStore store;
+            store.Insert(L"app.exe", MakeData(L"monitor-1_desktop-1", L"zone-set", 1));
+            store.Insert(L"app.exe", MakeData(L"monitor-1_desktop-2", L"zone-set", 2));
+            store.Insert(L"other.exe", MakeData(L"monitor-2_desktop-1", L"zone-set", 3));
+
+            store.EraseDevices([](const std::wstring& deviceId) { return deviceId.ends_with(L"desktop-1"); });
+
+            Assert::AreEqual(size_t{ 1 }, store.GetMap().size());
+            Assert::IsNull(store.Find(L"app.exe", L"monitor-1_desktop-1"));
+            Assert::IsNull(store.Find(L"other.exe", L"monitor-2_desktop-1"));
+            Assert::AreEqual(size_t{ 2 }, store.Find(L"app.exe", L"monitor-1_desktop-2")->zoneIndexSet[0]);
+        }
+
+        TEST_METHOD (RenameDevices)
+        {
+            AppZoneHistoryStore store;
+            store.Insert(L"app.exe", MakeData(L"monitor_old", L"zone-set", 1));
+            store.Insert(L"app.exe", MakeData(L"monitor_other", L"zone-set", 2));
+
+            store.RenameDevices([](const std::wstring& deviceId) -> std::optional<std::wstring> {
+                if (deviceId == L"monitor_old")
+                {
+                    return L"monitor_new";
+                }
+                return std::nullopt;
+            });
+
+            Assert::IsNull(store.Find(L"app.exe", L"monitor_old"));
+            Assert::AreEqual(size_t{ 1 }, store.Find(L"app.exe", L"monitor_new")->zoneIndexSet[0]);
+            Assert::AreEqual(std::wstring{ L"monitor_new" }, store.GetMap().at(L"app.exe")[0].deviceId);
+            Assert::AreEqual(size_t{ 2 }, store.Find(L"app.exe", L"monitor_other")->zoneIndexSet[0]);
+        }
+
+        TEST_METHOD (AssignKeepsFirstEntryOfDevice)
+        {
+            AppZoneHistoryStore::HistoryMap history;
+            history[L"app.exe"] = { MakeData(L"device-1", L"zone-set-1", 1), MakeData(L"device-2", L"zone-set-1", 2), MakeData(L"device-1", L"zone-set-2", 3) };
+
+            AppZoneHistoryStore store;
+            store.Insert(L"previous.exe", MakeData(L"device-1", L"zone-set-1", 4));
+            store.Assign(history);
+
+            Assert::IsNull(store.Find(L"previous.exe", L"device-1"));
+            Assert::AreEqual(size_t{ 2 }, store.GetMap().at(L"app.exe").size());
+            Assert::AreEqual(std::wstring{ L"zone-set-1" }, store.Find(L"app.exe", L"device-1")->zoneSetUuid);
+            Assert::AreEqual(size_t{ 2 }, store.Find(L"app.exe", L"device-2")->zoneIndexSet[0]);
+        }
+
+        TEST_METHOD (Clear)
+        {
+            AppZoneHistoryStore store;
+            store.Insert(L"app.exe", MakeData(L"device", L"zone-set", 1));
+            store.Clear();
+
+            Assert::IsTrue(store.GetMap().empty());
+            Assert::IsNull(store.Find(L"app.exe", L"device"));
+        }
+    };
+}
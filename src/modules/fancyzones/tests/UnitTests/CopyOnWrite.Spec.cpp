@@ -0,0 +1,93 @@
+#include "pch.h"
+#include <lib/CopyOnWrite.h>
+
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (CopyOnWriteUnitTests)
+    {
+        TEST_METHOD (DefaultValue)
+        {
+            CopyOnWrite<std::map<int, std::wstring>> value;
+            Assert::IsTrue(value.Read()->empty());
+        }
+
+        TEST_METHOD (WriteIsVisibleToLaterReads)
+        {
+            CopyOnWrite<std::map<int, std::wstring>> value;
+            value.Write([](auto& map) { map[1] = L"one"; });
+
+            Assert::AreEqual(std::wstring{ L"one" }, value.Read()->at(1));
+        }
+
+        TEST_METHOD (SnapshotIsNotChangedByWrites)
+        {
+            CopyOnWrite<std::map<int, std::wstring>> value{ { { 1, L"one" } } };
+            const auto snapshot = value.Read();
+
+            value.Write([](auto& map) {
+                map.erase(1);
+                map[2] = L"two";
+            });
+
+            Assert::AreEqual(size_t{ 1 }, snapshot->size());
+            Assert::AreEqual(std::wstring{ L"one" }, snapshot->at(1));
+            Assert::IsFalse(value.Read()->contains(1));
+            Assert::AreEqual(std::wstring{ L"two" }, value.Read()->at(2));
+        }
+
+        TEST_METHOD (WriteReturnsResultOfUpdate)
+        {
+            CopyOnWrite<std::map<int, std::wstring>> value;
+            const bool inserted = value.Write([](auto& map) { return map.emplace(1, L"one").second; });
+            const bool insertedAgain = value.Write([](auto& map) { return map.emplace(1, L"uno").second; });
+
+            Assert::IsTrue(inserted);
+            Assert::IsFalse(insertedAgain);
+            Assert::AreEqual(std::wstring{ L"one" }, value.Read()->at(1));
+        }
+
+        TEST_METHOD (Assign)
+        {
+            CopyOnWrite<std::map<int, std::wstring>> value{ { { 1, L"one" } } };
+            value.Assign({ { 2, L"two" } });
+
+            Assert::AreEqual(size_t{ 1 }, value.Read()->size());
+            Assert::AreEqual(std::wstring{ L"two" }, value.Read()->at(2));
+        }
+
+        TEST_METHOD (ConcurrentWritesAreNotLost)
+        {
+            CopyOnWrite<std::vector<int>> value;
+            const int threadCount = 4;
+            const int writesPerThread = 250;
+
+            std::vector<std::thread> threads;
+            for (int i = 0; i < threadCount; i++)
+            {
+                threads.emplace_back([&value, i] {
+                    for (int j = 0; j < writesPerThread; j++)
+                    {
+                        value.Write([&](auto& vector) { vector.push_back(i); });
+                        // Readers use their snapshot while the other threads keep writing
+                        const auto snapshot = value.Read();
+                        Assert::IsFalse(snapshot->empty());
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            Assert::AreEqual(size_t{ threadCount * writesPerThread }, value.Read()->size());
+        }
+    };
+}
@@ -1771,6 +1771,29 @@ namespace FancyZonesUnitTests
                 Assert::IsTrue(actual);
             }
 
+            TEST_METHOD (AppLastZonesAreWrittenBehind)
+            {
+                // Valid identifiers, so that the history survives parsing the written file
+                const std::wstring deviceId = m_defaultDeviceId;
+                const std::wstring zoneSetId = L"{33A2B101-06E0-437B-A61E-CDBECF502906}";
+                const auto window = Mocks::WindowCreate(m_hInst);
+                FancyZonesData data;
+                data.SetSettingsModulePath(m_moduleName);
+
+                Assert::IsTrue(data.SetAppLastZones(window, deviceId, zoneSetId, { 1 }));
+                Assert::IsFalse(std::filesystem::exists(data.appZoneHistoryFileName));
+
+                data.FlushPendingSaves();
+                Assert::IsTrue(std::filesystem::exists(data.appZoneHistoryFileName));
+
+                // Only the app zone history changed, so the zone settings file is not rewritten
+                Assert::IsFalse(std::filesystem::exists(data.zonesSettingsFileName));
+
+                auto appZoneHistory = JSONHelpers::ParseAppZoneHistory(json::from_file(data.appZoneHistoryFileName).value());
+                Assert::AreEqual(size_t(1), appZoneHistory.size());
+                Assert::IsTrue(std::vector<size_t>{ 1 } == appZoneHistory.begin()->second[0].zoneIndexSet);
+            }
+
             TEST_METHOD (AppLastZoneIndex)
             {
                 const std::wstring deviceId = L"device-id";
@@ -1959,4 +1982,195 @@ namespace FancyZonesUnitTests
                 Assert::IsFalse(data.RemoveAppLastZone(nullptr, deviceId, zoneSetId));
             }
     };
+
+    TEST_CLASS (StreamingParserUnitTests)
+    {
+        const std::wstring m_deviceId = L"AOC2460#4&fe3a015&0&UID65793_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}";
+        const std::wstring m_zoneSetId = L"{33A2B101-06E0-437B-A61E-CDBECF502906}";
+
+        const std::wstring m_devices = L"\"devices\": ["
+                                       L"{\"device-id\": \"AOC2460#4&fe3a015&0&UID65793_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}\", \"active-zoneset\": {\"type\": \"custom\", \"uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\"}, \"editor-show-spacing\": true, \"editor-spacing\": 16, \"editor-zone-count\": 3},"
+                                       L"{\"editor-sensitivity-radius\": 42, \"editor-zone-count\": 5, \"editor-spacing\": -10, \"editor-show-spacing\": false, \"active-zoneset\": {\"uuid\": \"{568EBC3A-C09C-483E-A64D-6F1F2AF4E48D}\", \"type\": \"priority-grid\"}, \"device-id\": \"AOC2460#4&fe3a015&0&UID65793_1920_1200_{8a0b9205-6128-45a2-934a-b97f5b271235}\"},"
+                                       L"{\"device-id\": \"device_id\"},"
+                                       L"{\"device-id\": \"AOC2460#4&fe3a015&0&UID65793_2560_1440_{39B25DD2-130D-4B5D-8851-4791D66B1539}\", \"active-zoneset\": {\"type\": \"rows\", \"uuid\": \"uuid\"}, \"editor-show-spacing\": true, \"editor-spacing\": 16, \"editor-zone-count\": 3},"
+                                       L"{\"device-id\": \"AOC2460#4&fe3a015&0&UID65793_3840_2160_{39B25DD2-130D-4B5D-8851-4791D66B1539}\", \"active-zoneset\": {\"type\": \"rows\", \"uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\"}, \"editor-show-spacing\": \"true\", \"editor-spacing\": 16, \"editor-zone-count\": 3}"
+                                       L"]";
+
+        const std::wstring m_customZoneSets = L"\"custom-zone-sets\": ["
+                                              L"{\"uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\", \"name\": \"grid \\\"quoted\\\" \\u0433\\u0440\\u0438\\u0434\", \"type\": \"grid\", \"info\": {\"rows\": 1, \"columns\": 3, \"rows-percentage\": [10000], \"columns-percentage\": [2500, 5000, 2500], \"cell-child-map\": [[0, 1, 2]]}},"
+                                              L"{\"info\": {\"zones\": [{\"X\": 0, \"Y\": 0, \"width\": 960, \"height\": 1080}, {\"X\": 960, \"Y\": 0, \"width\": 960, \"height\": 1080}], \"ref-width\": 1920, \"ref-height\": 1080}, \"type\": \"canvas\", \"name\": \"canvas\", \"uuid\": \"{568EBC3A-C09C-483E-A64D-6F1F2AF4E48D}\"},"
+                                              L"{\"uuid\": \"{8A0B9205-6128-45A2-934A-B97F5B271235}\", \"name\": \"cropped grid\", \"type\": \"grid\", \"info\": {\"rows\": 2, \"columns\": 3, \"rows-percentage\": [10000], \"columns-percentage\": [2500, 5000, 2500], \"cell-child-map\": [[0, 1, 2]]}},"
+                                              L"{\"uuid\": \"{39B25DD2-130D-4B5D-8851-4791D66B1539}\", \"name\": \"unknown\", \"type\": \"triangle\", \"info\": {}},"
+                                              L"{\"uuid\": \"uuid\", \"name\": \"invalid uuid\", \"type\": \"canvas\", \"info\": {\"ref-width\": 1920, \"ref-height\": 1080, \"zones\": []}}"
+                                              L"]";
+
+        const std::wstring m_appZoneHistory = L"\"app-zone-history\": ["
+                                              L"{\"app-path\": \"C:\\\\Program Files\\\\app.exe\", \"history\": ["
+                                              L"{\"zone-index-set\": [1, 2], \"device-id\": \"AOC2460#4&fe3a015&0&UID65793_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}\", \"zoneset-uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\"},"
+                                              L"{\"zone-index-set\": [3], \"device-id\": \"device-id\", \"zoneset-uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\"}]},"
+                                              L"{\"zoneset-uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\", \"zone-index\": 4, \"device-id\": \"AOC2460#4&fe3a015&0&UID65793_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}\", \"app-path\": \"C:\\\\single-desktop.exe\"},"
+                                              L"{\"app-path\": \"C:\\\\invalid-types.exe\", \"history\": [{\"zone-index-set\": [\"1\"], \"device-id\": \"AOC2460#4&fe3a015&0&UID65793_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}\", \"zoneset-uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\"}]},"
+                                              L"{\"app-path\": \"C:\\\\missing-device.exe\", \"history\": [{\"zone-index-set\": [1], \"zoneset-uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\"}]}"
+                                              L"]";
+
+        template<typename Map, typename ToJson>
+        static void AssertSameEntries(const Map& expected, const Map& actual, ToJson&& toJson)
+        {
+            Assert::AreEqual(expected.size(), actual.size());
+            for (const auto& [key, value] : expected)
+            {
+                const auto iter = actual.find(key);
+                Assert::IsTrue(iter != actual.end(), key.c_str());
+                Assert::AreEqual(std::wstring{ toJson(key, value).Stringify() }, std::wstring{ toJson(key, iter->second).Stringify() }, key.c_str());
+            }
+        }
+
+        static void AssertSameData(const TDeviceInfoMap& expectedDevices, const TCustomZoneSetsMap& expectedCustomZoneSets, const TAppZoneHistoryMap& expectedAppZoneHistory, const PersistedFancyZonesData& actual)
+        {
+            AssertSameEntries(expectedDevices, actual.deviceInfoMap, [](const auto& deviceId, const auto& data) {
+                return DeviceInfoJSON::ToJson(DeviceInfoJSON{ deviceId, data });
+            });
+            AssertSameEntries(expectedCustomZoneSets, actual.customZoneSetsMap, [](const auto& uuid, const auto& data) {
+                return CustomZoneSetJSON::ToJson(CustomZoneSetJSON{ uuid, data });
+            });
+            AssertSameEntries(expectedAppZoneHistory, actual.appZoneHistoryMap, [](const auto& appPath, const auto& data) {
+                return AppZoneHistoryJSON::ToJson(AppZoneHistoryJSON{ appPath, data });
+            });
+        }
+
+        // The streaming parser keeps the same entries as the document parser
+        static PersistedFancyZonesData AssertParity(const std::wstring& content)
+        {
+            const auto document = json::JsonObject::Parse(content);
+            const auto streamed = ParsePersistedContent(winrt::to_string(content));
+            Assert::IsTrue(streamed.has_value());
+
+            AssertSameData(ParseDeviceInfos(document), ParseCustomZoneSets(document), ParseAppZoneHistory(document), *streamed);
+            Assert::AreEqual(document.HasKey(L"app-zone-history"), streamed->hasAppZoneHistory);
+            return *streamed;
+        }
+
+    public:
+        TEST_METHOD (ParityEmpty)
+        {
+            const auto actual = AssertParity(L"{}");
+            Assert::IsTrue(actual.deviceInfoMap.empty());
+            Assert::IsFalse(actual.hasAppZoneHistory);
+        }
+
+        TEST_METHOD (ParityValidAndInvalidEntries)
+        {
+            const auto actual = AssertParity(L"{" + m_devices + L", " + m_customZoneSets + L", " + m_appZoneHistory + L"}");
+
+            Assert::AreEqual(size_t{ 2 }, actual.deviceInfoMap.size());
+            Assert::AreEqual(42, actual.deviceInfoMap.at(L"AOC2460#4&fe3a015&0&UID65793_1920_1200_{8a0b9205-6128-45a2-934a-b97f5b271235}").sensitivityRadius);
+            Assert::AreEqual(DefaultValues::SensitivityRadius, actual.deviceInfoMap.at(m_deviceId).sensitivityRadius);
+
+            Assert::AreEqual(size_t{ 2 }, actual.customZoneSetsMap.size());
+            Assert::AreEqual(std::wstring{ L"grid \"quoted\" \u0433\u0440\u0438\u0434" }, actual.customZoneSetsMap.at(m_zoneSetId).name);
+
+            Assert::AreEqual(size_t{ 2 }, actual.appZoneHistoryMap.size());
+            Assert::AreEqual(size_t{ 1 }, actual.appZoneHistoryMap.at(L"C:\\Program Files\\app.exe").size());
+            Assert::IsTrue(std::vector<size_t>{ 4 } == actual.appZoneHistoryMap.at(L"C:\\single-desktop.exe")[0].zoneIndexSet);
+        }
+
+        TEST_METHOD (ParityUnknownMembers)
+        {
+            AssertParity(L"{\"version\": 2, \"nested\": {\"array\": [1, [true, null], {\"key\": \"value\"}]}, " + m_devices + L"}");
+        }
+
+        TEST_METHOD (ParityInvalidSectionTypes)
+        {
+            const auto actual = AssertParity(L"{\"devices\": {}, \"custom-zone-sets\": \"\", \"app-zone-history\": null}");
+            Assert::IsTrue(actual.hasAppZoneHistory);
+            Assert::IsTrue(actual.appZoneHistoryMap.empty());
+        }
+
+        TEST_METHOD (ParityEntryNotAnObject)
+        {
+            // The document parser drops the whole array in that case
+            const auto actual = AssertParity(L"{" + m_devices.substr(0, m_devices.size() - 1) + L", 42], " + m_customZoneSets + L"}");
+            Assert::IsTrue(actual.deviceInfoMap.empty());
+            Assert::IsFalse(actual.customZoneSetsMap.empty());
+        }
+
+        TEST_METHOD (MalformedContent)
+        {
+            const std::vector<std::string> contents{
+                "",
+                "[]",
+                "\"devices\"",
+                "{\"devices\": [}",
+                "{\"devices\": [],}",
+                "{\"devices\": [{\"device-id\": \"",
+                "{\"editor-spacing\": 016}",
+                "{\"name\": \"\\x\"}",
+                "{} {}",
+            };
+
+            for (const auto& content : contents)
+            {
+                Assert::IsFalse(ParsePersistedContent(content).has_value(), winrt::to_hstring(content).c_str());
+            }
+        }
+
+        TEST_METHOD (WrittenContentParsedByDocumentParser)
+        {
+            const auto expected = AssertParity(L"{" + m_devices + L", " + m_customZoneSets + L", " + m_appZoneHistory + L"}");
+
+            const auto zoneSettings = json::JsonObject::Parse(winrt::to_hstring(SerializeZoneSettingsContent(expected.deviceInfoMap, expected.customZoneSetsMap)));
+            const auto appZoneHistory = json::JsonObject::Parse(winrt::to_hstring(SerializeAppZoneHistoryContent(expected.appZoneHistoryMap)));
+
+            AssertSameData(ParseDeviceInfos(zoneSettings), ParseCustomZoneSets(zoneSettings), ParseAppZoneHistory(appZoneHistory), expected);
+        }
+
+        TEST_METHOD (WrittenContentReadBack)
+        {
+            const auto expected = AssertParity(L"{" + m_devices + L", " + m_customZoneSets + L", " + m_appZoneHistory + L"}");
+
+            const auto zoneSettings = ParsePersistedContent(SerializeZoneSettingsContent(expected.deviceInfoMap, expected.customZoneSetsMap));
+            Assert::IsTrue(zoneSettings.has_value());
+            Assert::IsFalse(zoneSettings->hasAppZoneHistory);
+
+            const auto appZoneHistory = ParsePersistedContent(SerializeAppZoneHistoryContent(expected.appZoneHistoryMap));
+            Assert::IsTrue(appZoneHistory.has_value());
+
+            AssertSameData(zoneSettings->deviceInfoMap, zoneSettings->customZoneSetsMap, appZoneHistory->appZoneHistoryMap, expected);
+        }
+
+        TEST_METHOD (WriteSkipsBlankDevices)
+        {
+            TDeviceInfoMap devices;
+            devices[m_deviceId] = DeviceInfoData{ ZoneSetData{ m_zoneSetId, ZoneSetLayoutType::Blank }, true, 16, 3, 20 };
+
+            const auto actual = ParsePersistedContent(SerializeZoneSettingsContent(devices, {}));
+            Assert::IsTrue(actual.has_value());
+            Assert::IsTrue(actual->deviceInfoMap.empty());
+        }
+
+        TEST_METHOD (ReadAppZoneHistoryFromSeparateFile)
+        {
+            const auto folder = std::filesystem::temp_directory_path() / L"FancyZonesStreamingParserUnitTests";
+            std::filesystem::create_directories(folder);
+            const std::wstring zonesSettingsFileName = folder / L"zones-settings.json";
+            const std::wstring appZoneHistoryFileName = folder / L"app-zone-history.json";
+
+            std::ofstream{ zonesSettingsFileName, std::ios::binary } << winrt::to_string(L"{" + m_devices + L"}");
+            std::ofstream{ appZoneHistoryFileName, std::ios::binary } << winrt::to_string(L"{" + m_appZoneHistory + L"}");
+
+            const auto actual = ReadPersistFancyZonesData(zonesSettingsFileName, appZoneHistoryFileName);
+            std::filesystem::remove_all(folder);
+
+            Assert::AreEqual(size_t{ 2 }, actual.deviceInfoMap.size());
+            Assert::AreEqual(size_t{ 2 }, actual.appZoneHistoryMap.size());
+        }
+
+        TEST_METHOD (ReadMissingFile)
+        {
+            const auto actual = ReadPersistFancyZonesData(L"missing-zones-settings.json", L"missing-app-zone-history.json");
+            Assert::IsTrue(actual.deviceInfoMap.empty());
+            Assert::IsTrue(actual.customZoneSetsMap.empty());
+            Assert::IsTrue(actual.appZoneHistoryMap.empty());
+        }
+    };
 }
\ No newline at end of file
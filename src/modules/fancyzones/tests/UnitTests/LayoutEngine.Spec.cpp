@@ -0,0 +1,259 @@
+#include "pch.h"
+#include <layoutengine/LayoutCache.h>
+#include <layoutengine/LayoutEngine.h>
+
+#include <numeric>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LayoutEngine;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (LayoutEngineUnitTests)
+    {
+        TEST_METHOD (ValidZoneRect)
+        {
+            Assert::IsTrue(IsValidZoneRect(ZoneRect{ 0, 0, 0, 0 }));
+            Assert::IsTrue(IsValidZoneRect(ZoneRect{ MaxNegativeSpacing, MaxNegativeSpacing, 100, 100 }));
+            Assert::IsFalse(IsValidZoneRect(ZoneRect{ MaxNegativeSpacing - 1, 0, 100, 100 }));
+            Assert::IsFalse(IsValidZoneRect(ZoneRect{ 100, 0, 50, 100 }));
+            Assert::IsFalse(IsValidZoneRect(ZoneRect{ 0, 100, 100, 50 }));
+        }
+
+        TEST_METHOD (InvalidParameters)
+        {
+            for (auto type : { LayoutType::Focus, LayoutType::Columns, LayoutType::Rows, LayoutType::Grid, LayoutType::PriorityGrid })
+            {
+                Assert::IsFalse(CalculateLayout(type, 1920, 1080, 0, 0).has_value());
+                Assert::IsFalse(CalculateLayout(type, 1920, 1080, -1, 0).has_value());
+                Assert::IsFalse(CalculateLayout(type, 0, 1080, 3, 0).has_value());
+                Assert::IsFalse(CalculateLayout(type, 1920, 0, 3, 0).has_value());
+            }
+        }
+
+        TEST_METHOD (InvalidSpacing)
+        {
+            Assert::IsFalse(CalculateLayout(LayoutType::Columns, 1920, 1080, 3, MaxNegativeSpacing - 1).has_value());
+            Assert::IsFalse(CalculateLayout(LayoutType::Grid, 1920, 1080, 4, MaxNegativeSpacing - 1).has_value());
+            Assert::IsTrue(CalculateLayout(LayoutType::Columns, 1920, 1080, 3, MaxNegativeSpacing).has_value());
+        }
+
+        TEST_METHOD (FocusLayout)
+        {
+            auto zones = CalculateLayout(LayoutType::Focus, 1000, 500, 3, 0);
+            Assert::IsTrue(zones.has_value());
+            Assert::AreEqual(size_t{ 3 }, zones->size());
+            Assert::IsTrue(zones->at(0) == Zone{ 0, ZoneRect{ 100, 100, 500, 300 } });
+            Assert::IsTrue(zones->at(2) == Zone{ 2, ZoneRect{ 200, 200, 600, 400 } });
+        }
+
+        TEST_METHOD (ColumnsCoverWorkArea)
+        {
+            const long width = 1921;
+            const int spacing = 16;
+            auto zones = CalculateLayout(LayoutType::Columns, width, 1080, 7, spacing);
+            Assert::IsTrue(zones.has_value());
+            Assert::AreEqual(size_t{ 7 }, zones->size());
+
+            long left = spacing;
+            for (size_t i = 0; i < zones->size(); i++)
+            {
+                const auto& zone = zones->at(i);
+                Assert::AreEqual(i, zone.id);
+                Assert::IsTrue(zone.rect.left == left);
+                Assert::IsTrue(zone.rect.top == spacing && zone.rect.bottom == 1080 - spacing);
+                left = zone.rect.right + spacing;
+            }
+
+            Assert::IsTrue(zones->back().rect.right == width - spacing);
+        }
+
+        TEST_METHOD (RowsCoverWorkArea)
+        {
+            auto zones = CalculateLayout(LayoutType::Rows, 1920, 1081, 3, 0);
+            Assert::IsTrue(zones.has_value());
+            Assert::IsTrue(zones->at(0).rect == ZoneRect{ 0, 0, 1920, 360 });
+            Assert::IsTrue(zones->at(1).rect == ZoneRect{ 0, 360, 1920, 720 });
+            Assert::IsTrue(zones->at(2).rect == ZoneRect{ 0, 720, 1920, 1081 });
+        }
+
+        TEST_METHOD (MakeGridLayoutPercents)
+        {
+            for (int zoneCount = 1; zoneCount <= 64; zoneCount++)
+            {
+                const auto grid = MakeGridLayout(zoneCount);
+                Assert::AreEqual(grid.rows, static_cast<int>(grid.rowsPercents.size()));
+                Assert::AreEqual(grid.columns, static_cast<int>(grid.columnsPercents.size()));
+                Assert::AreEqual(PercentsMultiplier, std::accumulate(grid.rowsPercents.begin(), grid.rowsPercents.end(), 0));
+                Assert::AreEqual(PercentsMultiplier, std::accumulate(grid.columnsPercents.begin(), grid.columnsPercents.end(), 0));
+                Assert::IsTrue(grid.rows * grid.columns >= zoneCount);
+            }
+        }
+
+        TEST_METHOD (GridLayoutMergesLastCells)
+        {
+            // 5 zones are laid out on a 2x3 grid, the last zone covers the last two cells
+            auto zones = CalculateLayout(LayoutType::Grid, 1000, 600, 5, 0);
+            Assert::IsTrue(zones.has_value());
+            Assert::AreEqual(size_t{ 5 }, zones->size());
+            Assert::IsTrue(zones->at(0) == Zone{ 0, ZoneRect{ 0, 0, 333, 300 } });
+            Assert::IsTrue(zones->at(4) == Zone{ 4, ZoneRect{ 333, 300, 1000, 600 } });
+        }
+
+        TEST_METHOD (PriorityGridLayout)
+        {
+            auto zones = CalculateLayout(LayoutType::PriorityGrid, 1000, 500, 3, 0);
+            Assert::IsTrue(zones.has_value());
+            Assert::IsTrue(zones->at(0).rect == ZoneRect{ 0, 0, 250, 500 });
+            Assert::IsTrue(zones->at(1).rect == ZoneRect{ 250, 0, 750, 500 });
+            Assert::IsTrue(zones->at(2).rect == ZoneRect{ 750, 0, 1000, 500 });
+        }
+
+        TEST_METHOD (PriorityGridFallsBackToGrid)
+        {
+            Assert::IsNull(GetPriorityGridLayout(0));
+            Assert::IsNotNull(GetPriorityGridLayout(10));
+            Assert::IsNull(GetPriorityGridLayout(11));
+
+            for (int zoneCount : { 11, 12, 20 })
+            {
+                Assert::IsTrue(CalculateLayout(LayoutType::PriorityGrid, 1920, 1080, zoneCount, 8) == CalculateLayout(LayoutType::Grid, 1920, 1080, zoneCount, 8));
+            }
+        }
+
+        TEST_METHOD (GridZonesUseCellIds)
+        {
+            GridLayout grid;
+            grid.rows = 2;
+            grid.columns = 2;
+            grid.rowsPercents = { 5000, 5000 };
+            grid.columnsPercents = { 5000, 5000 };
+            grid.cellChildMap = { { 1, 0 }, { 1, 2 } };
+
+            auto zones = CalculateGridZones(grid, 100, 100, 0);
+            Assert::IsTrue(zones.has_value());
+            Assert::AreEqual(size_t{ 3 }, zones->size());
+            Assert::IsTrue(zones->at(0) == Zone{ 1, ZoneRect{ 0, 0, 50, 100 } });
+            Assert::IsTrue(zones->at(1) == Zone{ 0, ZoneRect{ 50, 0, 100, 50 } });
+            Assert::IsTrue(zones->at(2) == Zone{ 2, ZoneRect{ 50, 50, 100, 100 } });
+        }
+
+        TEST_METHOD (CanvasZonesScaleWithDpi)
+        {
+            const std::vector<CanvasZone> canvas{ CanvasZone{ 10, 20, 100, 200 }, CanvasZone{ 0, 0, 50, 50 } };
+
+            auto unscaled = CalculateCanvasZones(canvas, Dpi{});
+            Assert::IsTrue(unscaled.has_value());
+            Assert::IsTrue(unscaled->at(0) == Zone{ 0, ZoneRect{ 10, 20, 110, 220 } });
+
+            auto scaled = CalculateCanvasZones(canvas, Dpi{ 144, 192 });
+            Assert::IsTrue(scaled.has_value());
+            Assert::IsTrue(scaled->at(0) == Zone{ 0, ZoneRect{ 15, 40, 165, 440 } });
+            Assert::IsTrue(scaled->at(1) == Zone{ 1, ZoneRect{ 0, 0, 75, 100 } });
+        }
+
+        TEST_METHOD (InvalidCanvasZone)
+        {
+            Assert::IsFalse(CalculateCanvasZones({ CanvasZone{ -20, 0, 100, 100 } }, Dpi{}).has_value());
+            Assert::IsTrue(CalculateCanvasZones({}, Dpi{})->empty());
+        }
+    };
+
+    TEST_CLASS (LayoutCacheUnitTests)
+    {
+        TEST_METHOD (HitReturnsCalculatedZones)
+        {
+            LayoutCache cache;
+            auto expected = CalculateLayout(LayoutType::Grid, 1920, 1080, 5, 16);
+
+            Assert::IsTrue(cache.CalculateLayout(LayoutType::Grid, 1920, 1080, 5, 16) == expected);
+            Assert::IsTrue(cache.CalculateLayout(LayoutType::Grid, 1920, 1080, 5, 16) == expected);
+
+            Assert::AreEqual(size_t{ 1 }, cache.GetStatistics().hits);
+            Assert::AreEqual(size_t{ 1 }, cache.GetStatistics().misses);
+            Assert::AreEqual(size_t{ 1 }, cache.Size());
+        }
+
+        TEST_METHOD (EveryInputIsPartOfTheKey)
+        {
+            LayoutCache cache;
+            cache.CalculateLayout(LayoutType::Grid, 1920, 1080, 5, 16);
+            cache.CalculateLayout(LayoutType::PriorityGrid, 1920, 1080, 5, 16);
+            cache.CalculateLayout(LayoutType::Grid, 2560, 1080, 5, 16);
+            cache.CalculateLayout(LayoutType::Grid, 1920, 1440, 5, 16);
+            cache.CalculateLayout(LayoutType::Grid, 1920, 1080, 6, 16);
+            cache.CalculateLayout(LayoutType::Grid, 1920, 1080, 5, 0);
+
+            Assert::AreEqual(size_t{ 0 }, cache.GetStatistics().hits);
+            Assert::AreEqual(size_t{ 6 }, cache.Size());
+        }
+
+        TEST_METHOD (InvalidLayoutIsCached)
+        {
+            LayoutCache cache;
+            Assert::IsFalse(cache.CalculateLayout(LayoutType::Columns, 1920, 1080, 3, MaxNegativeSpacing - 1).has_value());
+            Assert::IsFalse(cache.CalculateLayout(LayoutType::Columns, 1920, 1080, 3, MaxNegativeSpacing - 1).has_value());
+            Assert::AreEqual(size_t{ 1 }, cache.GetStatistics().hits);
+        }
+
+        TEST_METHOD (EvictsLeastRecentlyUsed)
+        {
+            LayoutCache cache(2);
+            cache.CalculateLayout(LayoutType::Columns, 1920, 1080, 2, 0);
+            cache.CalculateLayout(LayoutType::Columns, 1920, 1080, 3, 0);
+            cache.CalculateLayout(LayoutType::Columns, 1920, 1080, 2, 0);
+            cache.CalculateLayout(LayoutType::Columns, 1920, 1080, 4, 0);
+            Assert::AreEqual(size_t{ 2 }, cache.Size());
+            Assert::AreEqual(size_t{ 1 }, cache.GetStatistics().hits);
+
+            // 2 zones were used more recently than 3 zones, so they are still cached
+            cache.CalculateLayout(LayoutType::Columns, 1920, 1080, 2, 0);
+            Assert::AreEqual(size_t{ 2 }, cache.GetStatistics().hits);
+            cache.CalculateLayout(LayoutType::Columns, 1920, 1080, 3, 0);
+            Assert::AreEqual(size_t{ 2 }, cache.GetStatistics().hits);
+        }
+
+        TEST_METHOD (EditedGridLayoutIsCalculatedAgain)
+        {
+            LayoutCache cache;
+            GridLayout grid = MakeGridLayout(4);
+            auto zones = cache.CalculateGridZones(grid, 1000, 1000, 0);
+            Assert::IsTrue(zones->at(0).rect == ZoneRect{ 0, 0, 500, 500 });
+
+            grid.columnsPercents = { 3000, 7000 };
+            zones = cache.CalculateGridZones(grid, 1000, 1000, 0);
+            Assert::IsTrue(zones->at(0).rect == ZoneRect{ 0, 0, 300, 500 });
+            Assert::AreEqual(size_t{ 0 }, cache.GetStatistics().hits);
+
+            grid.cellChildMap = { { 0, 0 }, { 1, 2 } };
+            zones = cache.CalculateGridZones(grid, 1000, 1000, 0);
+            Assert::AreEqual(size_t{ 3 }, zones->size());
+            Assert::AreEqual(size_t{ 0 }, cache.GetStatistics().hits);
+        }
+
+        TEST_METHOD (CanvasLayoutDependsOnDpi)
+        {
+            LayoutCache cache;
+            const std::vector<CanvasZone> canvas{ CanvasZone{ 10, 20, 100, 200 } };
+
+            cache.CalculateCanvasZones(canvas, Dpi{});
+            auto zones = cache.CalculateCanvasZones(canvas, Dpi{ 192, 192 });
+            Assert::IsTrue(zones->at(0).rect == ZoneRect{ 20, 40, 220, 440 });
+            Assert::AreEqual(size_t{ 0 }, cache.GetStatistics().hits);
+
+            cache.CalculateCanvasZones(canvas, Dpi{});
+            Assert::AreEqual(size_t{ 1 }, cache.GetStatistics().hits);
+        }
+
+        TEST_METHOD (Clear)
+        {
+            LayoutCache cache;
+            cache.CalculateLayout(LayoutType::Rows, 1920, 1080, 3, 0);
+            cache.Clear();
+            Assert::AreEqual(size_t{ 0 }, cache.Size());
+
+            cache.CalculateLayout(LayoutType::Rows, 1920, 1080, 3, 0);
+            Assert::AreEqual(size_t{ 2 }, cache.GetStatistics().misses);
+        }
+    };
+}
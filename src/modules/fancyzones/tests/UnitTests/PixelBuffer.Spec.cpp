@@ -0,0 +1,267 @@
+#include "pch.h"
+#include <lib/PixelBuffer.h>
+
+#include <chrono>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (PixelBufferUnitTests)
+    {
+        static constexpr PixelBuffer::Pixel Transparent = 0;
+        static constexpr PixelBuffer::Pixel OpaqueWhite = 0xFFFFFFFF;
+        static constexpr PixelBuffer::Pixel OpaqueBlue = 0xFF0000FF;
+
+        TEST_METHOD (Premultiply)
+        {
+            Assert::AreEqual(0xFF102030u, PixelBuffer::Premultiply(255, 0x10, 0x20, 0x30));
+            Assert::AreEqual(0x80800080u, PixelBuffer::Premultiply(128, 255, 0, 255));
+            Assert::AreEqual(0u, PixelBuffer::Premultiply(0, 255, 255, 255));
+        }
+
+        TEST_METHOD (ResizeClearsToTransparent)
+        {
+            PixelBuffer buffer(4, 3);
+            buffer.Clear(OpaqueWhite);
+            buffer.Resize(5, 6);
+
+            Assert::AreEqual(5, buffer.Width());
+            Assert::AreEqual(6, buffer.Height());
+            Assert::AreEqual(Transparent, buffer.GetPixel(4, 5));
+            Assert::IsTrue(buffer.GetClip() == buffer.Bounds());
+        }
+
+        TEST_METHOD (FillRectOpaque)
+        {
+            PixelBuffer buffer(10, 10);
+            buffer.FillRect(PixelRect{ 2, 3, 5, 7 }, OpaqueBlue);
+
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(2, 3));
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(4, 6));
+            Assert::AreEqual(Transparent, buffer.GetPixel(5, 6));
+            Assert::AreEqual(Transparent, buffer.GetPixel(4, 7));
+            Assert::AreEqual(Transparent, buffer.GetPixel(1, 3));
+        }
+
+        TEST_METHOD (FillRectBlendsSourceOver)
+        {
+            PixelBuffer buffer(1, 1);
+            buffer.Clear(OpaqueWhite);
+            buffer.FillRect(buffer.Bounds(), PixelBuffer::Premultiply(128, 0, 0, 0));
+
+            // Half transparent black over white is opaque grey
+            const auto pixel = buffer.GetPixel(0, 0);
+            Assert::AreEqual(uint8_t(255), PixelBuffer::Alpha(pixel));
+            Assert::AreEqual(uint8_t(127), PixelBuffer::Red(pixel));
+            Assert::AreEqual(uint8_t(127), PixelBuffer::Green(pixel));
+            Assert::AreEqual(uint8_t(127), PixelBuffer::Blue(pixel));
+        }
+
+        TEST_METHOD (FillRectBlendsOverTransparent)
+        {
+            PixelBuffer buffer(1, 1);
+            const auto color = PixelBuffer::Premultiply(100, 200, 150, 50);
+            buffer.FillRect(buffer.Bounds(), color);
+
+            Assert::AreEqual(color, buffer.GetPixel(0, 0));
+        }
+
+        TEST_METHOD (FillRectOutsideOfBuffer)
+        {
+            PixelBuffer buffer(4, 4);
+            buffer.FillRect(PixelRect{ -10, -10, 1, 1 }, OpaqueBlue);
+            buffer.FillRect(PixelRect{ 4, 0, 100, 4 }, OpaqueBlue);
+
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(0, 0));
+            Assert::AreEqual(Transparent, buffer.GetPixel(1, 1));
+            Assert::AreEqual(Transparent, buffer.GetPixel(3, 0));
+        }
+
+        TEST_METHOD (ClipRestrictsDrawing)
+        {
+            PixelBuffer buffer(10, 10);
+            buffer.SetClip(PixelRect{ 2, 2, 4, 4 });
+            buffer.FillRect(buffer.Bounds(), OpaqueBlue);
+            buffer.ResetClip();
+
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(2, 2));
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(3, 3));
+            Assert::AreEqual(Transparent, buffer.GetPixel(4, 4));
+            Assert::AreEqual(Transparent, buffer.GetPixel(1, 2));
+        }
+
+        TEST_METHOD (ClearOnlyClipRect)
+        {
+            PixelBuffer buffer(4, 4);
+            buffer.Clear(OpaqueWhite);
+            buffer.SetClip(PixelRect{ 1, 1, 3, 3 });
+            buffer.Clear(Transparent);
+
+            Assert::AreEqual(OpaqueWhite, buffer.GetPixel(0, 0));
+            Assert::AreEqual(Transparent, buffer.GetPixel(1, 1));
+            Assert::AreEqual(Transparent, buffer.GetPixel(2, 2));
+            Assert::AreEqual(OpaqueWhite, buffer.GetPixel(3, 3));
+        }
+
+        TEST_METHOD (DrawFrame)
+        {
+            PixelBuffer buffer(10, 10);
+            buffer.DrawFrame(PixelRect{ 1, 1, 9, 9 }, 2, OpaqueBlue);
+
+            Assert::AreEqual(Transparent, buffer.GetPixel(0, 0));
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(1, 1));
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(2, 5));
+            Assert::AreEqual(Transparent, buffer.GetPixel(3, 3));
+            Assert::AreEqual(Transparent, buffer.GetPixel(6, 6));
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(7, 5));
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(8, 8));
+            Assert::AreEqual(Transparent, buffer.GetPixel(9, 9));
+        }
+
+        TEST_METHOD (DrawFrameTranslucentBlendsOnce)
+        {
+            PixelBuffer buffer(10, 10);
+            const auto color = PixelBuffer::Premultiply(128, 255, 255, 255);
+            buffer.DrawFrame(buffer.Bounds(), 3, color);
+
+            // Corners are covered by a single side of the frame
+            Assert::AreEqual(color, buffer.GetPixel(0, 0));
+            Assert::AreEqual(color, buffer.GetPixel(9, 9));
+            Assert::AreEqual(color, buffer.GetPixel(0, 5));
+        }
+
+        TEST_METHOD (DrawFrameThickerThanRect)
+        {
+            PixelBuffer buffer(4, 4);
+            buffer.DrawFrame(buffer.Bounds(), 2, OpaqueBlue);
+
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(1, 1));
+            Assert::AreEqual(OpaqueBlue, buffer.GetPixel(2, 2));
+        }
+
+        TEST_METHOD (CopyClipped)
+        {
+            PixelBuffer source(4, 4);
+            source.Clear(OpaqueBlue);
+
+            PixelBuffer destination(10, 10);
+            destination.Clear(OpaqueWhite);
+            destination.SetClip(PixelRect{ 0, 0, 5, 5 });
+            destination.Copy(source, source.Bounds(), 3, 3);
+
+            Assert::AreEqual(OpaqueWhite, destination.GetPixel(2, 2));
+            Assert::AreEqual(OpaqueBlue, destination.GetPixel(3, 3));
+            Assert::AreEqual(OpaqueBlue, destination.GetPixel(4, 4));
+            Assert::AreEqual(OpaqueWhite, destination.GetPixel(5, 5));
+        }
+
+        TEST_METHOD (CopyReplacesPixels)
+        {
+            PixelBuffer source(2, 2);
+            PixelBuffer destination(2, 2);
+            destination.Clear(OpaqueWhite);
+            destination.Copy(source, source.Bounds(), 0, 0);
+
+            Assert::AreEqual(Transparent, destination.GetPixel(0, 0));
+            Assert::AreEqual(Transparent, destination.GetPixel(1, 1));
+        }
+
+        TEST_METHOD (CopySourceOutsideOfBuffer)
+        {
+            PixelBuffer source(4, 4);
+            source.Clear(OpaqueBlue);
+
+            // Only the part of the source rectangle inside of the source is copied, to the matching position
+            PixelBuffer destination(10, 10);
+            destination.Copy(source, PixelRect{ -2, -2, 2, 2 }, 0, 0);
+
+            Assert::AreEqual(Transparent, destination.GetPixel(1, 1));
+            Assert::AreEqual(OpaqueBlue, destination.GetPixel(2, 2));
+            Assert::AreEqual(OpaqueBlue, destination.GetPixel(3, 3));
+            Assert::AreEqual(Transparent, destination.GetPixel(4, 4));
+        }
+
+        TEST_METHOD (BlendKeepsDestinationUnderTransparentPixels)
+        {
+            PixelBuffer source(2, 1);
+            source.FillRect(PixelRect{ 0, 0, 1, 1 }, PixelBuffer::Premultiply(128, 0, 0, 0));
+
+            PixelBuffer destination(2, 1);
+            destination.Clear(OpaqueWhite);
+            destination.Blend(source, source.Bounds(), 0, 0);
+
+            Assert::AreEqual(uint8_t(127), PixelBuffer::Red(destination.GetPixel(0, 0)));
+            Assert::AreEqual(OpaqueWhite, destination.GetPixel(1, 0));
+        }
+
+        TEST_METHOD (BlendNegativePosition)
+        {
+            PixelBuffer source(4, 4);
+            source.Clear(OpaqueBlue);
+
+            PixelBuffer destination(10, 10);
+            destination.Blend(source, source.Bounds(), -3, 8);
+
+            Assert::AreEqual(OpaqueBlue, destination.GetPixel(0, 8));
+            Assert::AreEqual(OpaqueBlue, destination.GetPixel(0, 9));
+            Assert::AreEqual(Transparent, destination.GetPixel(1, 8));
+            Assert::AreEqual(Transparent, destination.GetPixel(0, 7));
+        }
+
+        TEST_METHOD (CopyToStride)
+        {
+            PixelBuffer buffer(4, 4);
+            buffer.FillRect(PixelRect{ 1, 1, 3, 3 }, OpaqueBlue);
+
+            std::vector<PixelBuffer::Pixel> memory(6 * 2, OpaqueWhite);
+            buffer.CopyTo(PixelRect{ 1, 1, 4, 3 }, memory.data(), 6);
+
+            Assert::AreEqual(OpaqueBlue, memory[0]);
+            Assert::AreEqual(OpaqueBlue, memory[1]);
+            Assert::AreEqual(Transparent, memory[2]);
+            Assert::AreEqual(OpaqueWhite, memory[3]);
+            Assert::AreEqual(OpaqueBlue, memory[6]);
+            Assert::AreEqual(Transparent, memory[8]);
+        }
+
+        TEST_METHOD (RectIntersectAndUnion)
+        {
+            const PixelRect first{ 0, 0, 10, 10 };
+            const PixelRect second{ 5, 5, 20, 20 };
+
+            Assert::IsTrue(PixelRect{ 5, 5, 10, 10 } == first.Intersect(second));
+            Assert::IsTrue(PixelRect{ 0, 0, 20, 20 } == first.Union(second));
+            Assert::IsTrue(first.Intersect(PixelRect{ 10, 10, 20, 20 }).IsEmpty());
+            Assert::IsTrue(first == PixelRect{}.Union(first));
+        }
+
+        // Micro-benchmark for the per-frame work of the overlay: copying a 4K static layer and drawing a highlighted zone
+        TEST_METHOD (Benchmark_ComposeHighlightFrame)
+        {
+            PixelBuffer staticLayer(3840, 2160);
+            staticLayer.FillRect(staticLayer.Bounds(), PixelBuffer::Premultiply(128, 0, 120, 215));
+            PixelBuffer frame(3840, 2160);
+
+            const int iterations = 100;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                const PixelRect zone{ (i % 4) * 960, 0, (i % 4 + 1) * 960, 2160 };
+                frame.Copy(staticLayer, staticLayer.Bounds(), 0, 0);
+                frame.SetClip(zone);
+                frame.Clear(Transparent);
+                frame.FillRect(zone, PixelBuffer::Premultiply(128, 0, 120, 215));
+                frame.DrawFrame(zone, 2, OpaqueWhite);
+                frame.ResetClip();
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            Assert::AreEqual(OpaqueWhite, frame.GetPixel(3 * 960, 0));
+
+            std::wstring message = L"Compose 4K highlight frame: " + std::to_wstring(elapsed / iterations) + L" us per frame\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
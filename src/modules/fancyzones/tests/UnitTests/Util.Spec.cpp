@@ -2,6 +2,9 @@
 #include "Util.h"
 #include "lib\util.h"
 
+#include <map>
+#include <set>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace FancyZonesUnitTests
@@ -38,6 +41,52 @@ namespace FancyZonesUnitTests
         }
     }
 
+    // Fake windows and monitors for WindowPlacementBatch. Monitor 1 spans x in [0, 1000) and monitor 2 x in [1000, 2000)
+    struct FakeWindowApi
+    {
+        std::map<HWND, HMONITOR> monitors;
+        std::set<HWND> minimized;
+        std::set<HWND> maximized;
+        std::set<HWND> unresponsive;
+        bool failBatches = false;
+        std::vector<std::vector<HWND>> batches;
+        std::vector<HWND> sizedWindows;
+
+        static HMONITOR Monitor(int id) { return reinterpret_cast<HMONITOR>(static_cast<intptr_t>(id)); }
+        static HWND Window(int id) { return reinterpret_cast<HWND>(static_cast<intptr_t>(id)); }
+
+        WindowPlacementBatch::WindowApi Api()
+        {
+            WindowPlacementBatch::WindowApi api;
+            api.monitorFromWindow = [this](HWND window) { return monitors[window]; };
+            api.monitorFromRect = [](const RECT& rect) { return rect.left < 1000 ? Monitor(1) : Monitor(2); };
+            api.getMonitorInfo = [](HMONITOR monitor, MONITORINFO& mi) {
+                const LONG left = monitor == Monitor(1) ? 0 : 1000;
+                mi.rcMonitor = mi.rcWork = RECT{ left, 0, left + 1000, 1000 };
+                return true;
+            };
+            api.isMinimized = [this](HWND window) { return minimized.contains(window); };
+            api.isMaximized = [this](HWND window) { return maximized.contains(window); };
+            api.isResponsive = [this](HWND window) { return !unresponsive.contains(window); };
+            api.moveWindows = [this](const std::vector<std::pair<HWND, RECT>>& windows) {
+                if (failBatches)
+                {
+                    return false;
+                }
+
+                std::vector<HWND> batch;
+                for (const auto& [window, rect] : windows)
+                {
+                    batch.push_back(window);
+                }
+                batches.push_back(batch);
+                return true;
+            };
+            api.sizeWindowToRect = [this](HWND window, RECT) { sizedWindows.push_back(window); };
+            return api;
+        }
+    };
+
     TEST_CLASS(UtilUnitTests)
     {
         TEST_METHOD(TestParseDeviceId)
@@ -253,6 +302,88 @@ namespace FancyZonesUnitTests
             const auto actual = HexToRGB(L"zzz");
             Assert::AreEqual(expected, actual);
         }
+
+        TEST_METHOD(WindowPlacementBatchGroupsWindowsByMonitor)
+        {
+            FakeWindowApi fake;
+            fake.monitors = { { FakeWindowApi::Window(1), FakeWindowApi::Monitor(1) }, { FakeWindowApi::Window(2), FakeWindowApi::Monitor(2) }, { FakeWindowApi::Window(3), FakeWindowApi::Monitor(1) } };
+
+            WindowPlacementBatch batch(fake.Api());
+            batch.Add(FakeWindowApi::Window(1), RECT{ 0, 0, 500, 500 });
+            batch.Add(FakeWindowApi::Window(2), RECT{ 1000, 0, 1500, 500 });
+            batch.Add(FakeWindowApi::Window(3), RECT{ 500, 0, 1000, 500 });
+            const auto result = batch.Apply();
+
+            Assert::AreEqual(size_t(3), result.windows);
+            Assert::AreEqual(size_t(3), result.deferred);
+            Assert::AreEqual(size_t(2), result.batches);
+            Assert::IsTrue(fake.batches == std::vector<std::vector<HWND>>{ { FakeWindowApi::Window(1), FakeWindowApi::Window(3) }, { FakeWindowApi::Window(2) } });
+            Assert::IsTrue(fake.sizedWindows.empty());
+        }
+
+        TEST_METHOD(WindowPlacementBatchSizesMinimizedAndMaximizedWindows)
+        {
+            FakeWindowApi fake;
+            fake.monitors = { { FakeWindowApi::Window(1), FakeWindowApi::Monitor(1) }, { FakeWindowApi::Window(2), FakeWindowApi::Monitor(1) }, { FakeWindowApi::Window(3), FakeWindowApi::Monitor(1) } };
+            fake.minimized = { FakeWindowApi::Window(1) };
+            fake.maximized = { FakeWindowApi::Window(2) };
+
+            WindowPlacementBatch batch(fake.Api());
+            batch.Add(FakeWindowApi::Window(1), RECT{ 0, 0, 500, 500 });
+            batch.Add(FakeWindowApi::Window(2), RECT{ 0, 0, 500, 500 });
+            batch.Add(FakeWindowApi::Window(3), RECT{ 0, 0, 500, 500 });
+            const auto result = batch.Apply();
+
+            Assert::AreEqual(size_t(1), result.deferred);
+            Assert::IsTrue(fake.batches == std::vector<std::vector<HWND>>{ { FakeWindowApi::Window(3) } });
+            Assert::IsTrue(fake.sizedWindows == std::vector<HWND>{ FakeWindowApi::Window(1), FakeWindowApi::Window(2) });
+        }
+
+        TEST_METHOD(WindowPlacementBatchSizesWindowMovingToAnotherMonitor)
+        {
+            FakeWindowApi fake;
+            fake.monitors = { { FakeWindowApi::Window(1), FakeWindowApi::Monitor(1) }, { FakeWindowApi::Window(2), FakeWindowApi::Monitor(1) } };
+
+            WindowPlacementBatch batch(fake.Api());
+            batch.Add(FakeWindowApi::Window(1), RECT{ 1200, 0, 1500, 500 });
+            batch.Add(FakeWindowApi::Window(2), RECT{ 0, 0, 500, 500 });
+            const auto result = batch.Apply();
+
+            Assert::AreEqual(size_t(1), result.deferred);
+            Assert::IsTrue(fake.sizedWindows == std::vector<HWND>{ FakeWindowApi::Window(1) });
+        }
+
+        TEST_METHOD(WindowPlacementBatchSizesUnresponsiveWindows)
+        {
+            FakeWindowApi fake;
+            fake.monitors = { { FakeWindowApi::Window(1), FakeWindowApi::Monitor(1) }, { FakeWindowApi::Window(2), FakeWindowApi::Monitor(1) } };
+            fake.unresponsive = { FakeWindowApi::Window(2) };
+
+            WindowPlacementBatch batch(fake.Api());
+            batch.Add(FakeWindowApi::Window(1), RECT{ 0, 0, 500, 500 });
+            batch.Add(FakeWindowApi::Window(2), RECT{ 500, 0, 1000, 500 });
+            const auto result = batch.Apply();
+
+            Assert::AreEqual(size_t(1), result.deferred);
+            Assert::IsTrue(fake.batches == std::vector<std::vector<HWND>>{ { FakeWindowApi::Window(1) } });
+            Assert::IsTrue(fake.sizedWindows == std::vector<HWND>{ FakeWindowApi::Window(2) });
+        }
+
+        TEST_METHOD(WindowPlacementBatchSizesWindowsOfFailedBatch)
+        {
+            FakeWindowApi fake;
+            fake.monitors = { { FakeWindowApi::Window(1), FakeWindowApi::Monitor(1) }, { FakeWindowApi::Window(2), FakeWindowApi::Monitor(1) } };
+            fake.failBatches = true;
+
+            WindowPlacementBatch batch(fake.Api());
+            batch.Add(FakeWindowApi::Window(1), RECT{ 0, 0, 500, 500 });
+            batch.Add(FakeWindowApi::Window(2), RECT{ 500, 0, 1000, 500 });
+            const auto result = batch.Apply();
+
+            Assert::AreEqual(size_t(2), result.windows);
+            Assert::AreEqual(size_t(0), result.deferred);
+            Assert::AreEqual(size_t(0), result.batches);
+            Assert::IsTrue(fake.sizedWindows == std::vector<HWND>{ FakeWindowApi::Window(1), FakeWindowApi::Window(2) });
+        }
     };
 }
-
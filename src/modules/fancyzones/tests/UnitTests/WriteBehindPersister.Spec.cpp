@@ -0,0 +1,122 @@
+#include "pch.h"
+#include <lib/WriteBehindPersister.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (WriteBehindPersisterUnitTests)
+    {
+        TEST_METHOD (NoWriteWithoutChanges)
+        {
+            std::atomic<int> writes = 0;
+            WriteBehindPersister persister{ 10ms };
+            auto section = persister.AddSection([&] { writes++; });
+
+            persister.Flush();
+
+            Assert::AreEqual(0, writes.load());
+            Assert::AreEqual(size_t(0), persister.GetWriteCount(section));
+        }
+
+        TEST_METHOD (BurstOfChangesIsWrittenOnce)
+        {
+            std::atomic<int> writes = 0;
+            WriteBehindPersister persister{ 200ms, 5000ms };
+            auto section = persister.AddSection([&] { writes++; });
+
+            for (int i = 0; i < 100; i++)
+            {
+                persister.MarkDirty(section);
+            }
+
+            // Nothing is written while the changes are still settling
+            Assert::AreEqual(0, writes.load());
+
+            std::this_thread::sleep_for(600ms);
+            Assert::AreEqual(1, writes.load());
+            Assert::AreEqual(size_t(1), persister.GetWriteCount(section));
+        }
+
+        TEST_METHOD (ContinuousChangesAreWrittenAfterMaxDelay)
+        {
+            std::atomic<int> writes = 0;
+            WriteBehindPersister persister{ 100ms, 300ms };
+            auto section = persister.AddSection([&] { writes++; });
+
+            // Changes keep coming faster than the debounce delay, the max delay still forces a write
+            auto start = std::chrono::steady_clock::now();
+            while (std::chrono::steady_clock::now() - start < 1000ms)
+            {
+                persister.MarkDirty(section);
+                std::this_thread::sleep_for(20ms);
+            }
+
+            Assert::IsTrue(writes.load() >= 1);
+        }
+
+        TEST_METHOD (SectionsAreWrittenIndependently)
+        {
+            std::atomic<int> firstWrites = 0;
+            std::atomic<int> secondWrites = 0;
+            WriteBehindPersister persister{ 10ms };
+            auto first = persister.AddSection([&] { firstWrites++; });
+            auto second = persister.AddSection([&] { secondWrites++; });
+
+            persister.MarkDirty(second);
+            persister.Flush();
+
+            Assert::AreEqual(0, firstWrites.load());
+            Assert::AreEqual(1, secondWrites.load());
+            Assert::AreEqual(size_t(0), persister.GetWriteCount(first));
+            Assert::AreEqual(size_t(1), persister.GetWriteCount(second));
+        }
+
+        TEST_METHOD (FlushWritesPendingChanges)
+        {
+            std::atomic<int> writes = 0;
+            WriteBehindPersister persister{ 10000ms, 10000ms };
+            auto section = persister.AddSection([&] { writes++; });
+
+            persister.MarkDirty(section);
+            persister.Flush();
+
+            Assert::AreEqual(1, writes.load());
+
+            // Flushing again doesn't write a section which hasn't changed
+            persister.Flush();
+            Assert::AreEqual(1, writes.load());
+        }
+
+        TEST_METHOD (ChangesAfterFlushAreWritten)
+        {
+            std::atomic<int> writes = 0;
+            WriteBehindPersister persister{ 10ms };
+            auto section = persister.AddSection([&] { writes++; });
+
+            persister.MarkDirty(section);
+            persister.Flush();
+            persister.MarkDirty(section);
+
+            std::this_thread::sleep_for(300ms);
+            Assert::AreEqual(2, writes.load());
+        }
+
+        TEST_METHOD (DestructorWritesPendingChanges)
+        {
+            std::atomic<int> writes = 0;
+            {
+                WriteBehindPersister persister{ 10000ms, 10000ms };
+                auto section = persister.AddSection([&] { writes++; });
+                persister.MarkDirty(section);
+            }
+
+            Assert::AreEqual(1, writes.load());
+        }
+    };
+}
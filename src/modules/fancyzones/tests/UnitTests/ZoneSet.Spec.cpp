@@ -5,6 +5,7 @@
 #include "lib\ZoneSet.h"
 
 #include <filesystem>
+#include <random>
 
 #include "Util.h"
 #include <common/settings_helpers.h>
@@ -15,6 +16,68 @@ using namespace FancyZonesDataTypes;
 
 namespace FancyZonesUnitTests
 {
+    namespace
+    {
+        // Scan over all zones which ZoneSet::ZonesFromPoint used before the spatial index, kept as the reference for the differential test
+        std::vector<size_t> ZonesFromPointByScan(const IZoneSet::ZonesMap& zones, POINT pt, int sensitivityRadius)
+        {
+            std::vector<size_t> capturedZones;
+            std::vector<size_t> strictlyCapturedZones;
+            for (const auto& [zoneId, zone] : zones)
+            {
+                const RECT& zoneRect = zone->GetZoneRect();
+                if (zoneRect.left - sensitivityRadius <= pt.x && pt.x <= zoneRect.right + sensitivityRadius &&
+                    zoneRect.top - sensitivityRadius <= pt.y && pt.y <= zoneRect.bottom + sensitivityRadius)
+                {
+                    capturedZones.emplace_back(zoneId);
+                }
+
+                if (zoneRect.left <= pt.x && pt.x < zoneRect.right &&
+                    zoneRect.top <= pt.y && pt.y < zoneRect.bottom)
+                {
+                    strictlyCapturedZones.emplace_back(zoneId);
+                }
+            }
+
+            if (capturedZones.size() == 1 && strictlyCapturedZones.size() == 0)
+            {
+                return {};
+            }
+
+            bool overlap = false;
+            for (size_t i = 0; i < capturedZones.size() && !overlap; ++i)
+            {
+                for (size_t j = i + 1; j < capturedZones.size() && !overlap; ++j)
+                {
+                    RECT rectI = zones.at(capturedZones[i])->GetZoneRect();
+                    RECT rectJ = zones.at(capturedZones[j])->GetZoneRect();
+                    overlap = max(rectI.top, rectJ.top) + sensitivityRadius < min(rectI.bottom, rectJ.bottom) &&
+                              max(rectI.left, rectJ.left) + sensitivityRadius < min(rectI.right, rectJ.right);
+                }
+            }
+
+            if (overlap)
+            {
+                size_t smallestIdx = 0;
+                for (size_t i = 1; i < capturedZones.size(); ++i)
+                {
+                    RECT rectS = zones.at(capturedZones[smallestIdx])->GetZoneRect();
+                    RECT rectI = zones.at(capturedZones[i])->GetZoneRect();
+                    int smallestSize = (rectS.bottom - rectS.top) * (rectS.right - rectS.left);
+                    int iSize = (rectI.bottom - rectI.top) * (rectI.right - rectI.left);
+                    if (iSize <= smallestSize)
+                    {
+                        smallestIdx = i;
+                    }
+                }
+
+                capturedZones = { capturedZones[smallestIdx] };
+            }
+
+            return capturedZones;
+        }
+    }
+
     TEST_CLASS (ZoneSetUnitTests)
     {
         GUID m_id;
@@ -293,6 +356,73 @@ namespace FancyZonesUnitTests
                 compareZones(zone4, m_set->GetZones()[actual[3]]);
             }
 
+            TEST_METHOD (ZoneFromPointAfterAddZone)
+            {
+                winrt::com_ptr<IZone> zone1 = MakeZone({ 0, 0, 100, 100 }, 1);
+                m_set->AddZone(zone1);
+                Assert::IsTrue(m_set->ZonesFromPoint(POINT{ 250, 250 }).size() == 0);
+
+                // Zones added after a query must be found as well
+                winrt::com_ptr<IZone> zone2 = MakeZone({ 200, 200, 300, 300 }, 2);
+                m_set->AddZone(zone2);
+
+                auto actual = m_set->ZonesFromPoint(POINT{ 250, 250 });
+                Assert::IsTrue(actual.size() == 1);
+                compareZones(zone2, m_set->GetZones()[actual[0]]);
+            }
+
+            TEST_METHOD (ZoneFromPointRandomizedDifferential)
+            {
+                std::mt19937 generator(20201017);
+                const int sensitivityRadiuses[] = { 0, 1, DefaultValues::SensitivityRadius, 60 };
+
+                for (int iteration = 0; iteration < 200; iteration++)
+                {
+                    const int sensitivityRadius = sensitivityRadiuses[iteration % ARRAYSIZE(sensitivityRadiuses)];
+                    ZoneSetConfig config(m_id, ZoneSetLayoutType::Custom, Mocks::Monitor(), sensitivityRadius);
+                    auto set = MakeZoneSet(config);
+
+                    // Mostly small layouts, with some large canvas layouts full of overlapping zones
+                    const int zoneCount = std::uniform_int_distribution<int>(1, iteration % 10 == 0 ? 80 : 12)(generator);
+                    std::uniform_int_distribution<int> coordinate(0, 1920);
+                    std::uniform_int_distribution<int> size(1, 800);
+                    for (int i = 0; i < zoneCount; i++)
+                    {
+                        const int left = coordinate(generator);
+                        const int top = coordinate(generator) / 2;
+                        set->AddZone(MakeZone({ left, top, left + size(generator), top + size(generator) }, i));
+                    }
+
+                    const auto zones = set->GetZones();
+                    std::vector<POINT> points;
+                    std::uniform_int_distribution<int> pointCoordinate(-100, 2800);
+                    for (int i = 0; i < 500; i++)
+                    {
+                        points.push_back(POINT{ pointCoordinate(generator), pointCoordinate(generator) });
+                    }
+
+                    // Points on and around the borders, where the inclusive and exclusive checks differ
+                    for (const auto& [zoneId, zone] : zones)
+                    {
+                        const RECT rect = zone->GetZoneRect();
+                        for (int offset : { -sensitivityRadius - 1, -sensitivityRadius, -1, 0, 1, sensitivityRadius, sensitivityRadius + 1 })
+                        {
+                            points.push_back(POINT{ rect.left + offset, rect.top + offset });
+                            points.push_back(POINT{ rect.right + offset, rect.bottom + offset });
+                            points.push_back(POINT{ rect.left + offset, (rect.top + rect.bottom) / 2 });
+                            points.push_back(POINT{ (rect.left + rect.right) / 2, rect.bottom + offset });
+                        }
+                    }
+
+                    for (const auto& point : points)
+                    {
+                        auto expected = ZonesFromPointByScan(zones, point, sensitivityRadius);
+                        auto actual = set->ZonesFromPoint(point);
+                        Assert::IsTrue(expected == actual, (L"Mismatch at " + std::to_wstring(point.x) + L", " + std::to_wstring(point.y)).c_str());
+                    }
+                }
+            }
+
             TEST_METHOD (ZoneIndexFromWindowUnknown)
             {
                 winrt::com_ptr<IZone> zone = MakeZone({ 0, 0, 100, 100 }, 1);
@@ -1,11 +1,13 @@
 #include "pch.h"
 
+#include <chrono>
 #include <filesystem>
 
 #include <common/common.h>
 #include <lib/util.h>
 #include <lib/ZoneSet.h>
 #include <lib/ZoneWindow.h>
+#include <lib/ZoneWindowDrawing.h>
 #include <lib/FancyZones.h>
 #include <lib/FancyZonesData.h>
 #include <lib/FancyZonesDataTypes.h>
@@ -679,7 +681,7 @@ namespace FancyZonesUnitTests
             // fill app zone history map
             Assert::IsTrue(m_fancyZonesData.SetAppLastZones(window, deviceId, Helpers::GuidToString(zoneSetId), { 0 }));
             Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap().size());
-            const auto& appHistoryArray1 = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
+            const auto appHistoryArray1 = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
             Assert::AreEqual((size_t)1, appHistoryArray1.size());
             Assert::IsTrue(std::vector<size_t>{ 0 } == appHistoryArray1[0].zoneIndexSet);
 
@@ -689,7 +691,7 @@ namespace FancyZonesUnitTests
 
             zoneWindow->SaveWindowProcessToZoneIndex(window);
             Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap().size());
-            const auto& appHistoryArray2 = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
+            const auto appHistoryArray2 = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
             Assert::AreEqual((size_t)1, appHistoryArray2.size());
             Assert::IsTrue(std::vector<size_t>{ 0 } == appHistoryArray2[0].zoneIndexSet);
         }
@@ -711,7 +713,7 @@ namespace FancyZonesUnitTests
             //fill app zone history map
             Assert::IsTrue(m_fancyZonesData.SetAppLastZones(window, deviceId, Helpers::GuidToString(zoneSetId), { 2 }));
             Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap().size());
-            const auto& appHistoryArray = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
+            const auto appHistoryArray = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
             Assert::AreEqual((size_t)1, appHistoryArray.size());
             Assert::IsTrue(std::vector<size_t>{ 2 } == appHistoryArray[0].zoneIndexSet);
 
@@ -747,5 +749,283 @@ namespace FancyZonesUnitTests
             Assert::AreEqual(originalWidth, (int)inZoneRect.right - (int) inZoneRect.left);
             Assert::AreEqual(originalHeight, (int)inZoneRect.bottom - (int)inZoneRect.top);
         }
+
+        TEST_METHOD(MoveSizeUpdateUnchangedHighlightIsNotRepainted)
+        {
+            auto zoneWindow = MakeZoneWindow(winrt::make_self<MockZoneWindowHost>().get(), m_hInst, m_monitor, m_uniqueId.str(), {}, false);
+            Assert::IsNotNull(zoneWindow->ActiveZoneSet());
+
+            // The default priority grid layout has three columns, the points are in the first and the last one
+            const RECT& workArea = m_monitorInfo.rcWork;
+            const LONG width = workArea.right - workArea.left;
+            const LONG middle = workArea.top + (workArea.bottom - workArea.top) / 2;
+            const POINT firstZonePoint{ workArea.left + width / 6, middle };
+            const POINT lastZonePoint{ workArea.left + width * 5 / 6, middle };
+
+            zoneWindow->MoveSizeEnter(Mocks::Window());
+            for (int i = 0; i < 10; i++)
+            {
+                zoneWindow->MoveSizeUpdate(firstZonePoint, true, false);
+            }
+
+            auto statistics = zoneWindow->GetRepaintStatistics();
+            Assert::AreEqual(size_t(10), statistics.frames);
+            Assert::AreEqual(size_t(1), statistics.invalidatedFrames);
+            Assert::AreEqual(size_t(1), statistics.invalidatedZones);
+
+            // Moving to another zone redraws the zone which lost the highlight and the one which got it
+            zoneWindow->MoveSizeUpdate(lastZonePoint, true, false);
+            statistics = zoneWindow->GetRepaintStatistics();
+            Assert::AreEqual(size_t(11), statistics.frames);
+            Assert::AreEqual(size_t(2), statistics.invalidatedFrames);
+            Assert::AreEqual(size_t(3), statistics.invalidatedZones);
+
+            // Disabling the drag clears the highlight once
+            zoneWindow->MoveSizeUpdate(lastZonePoint, false, false);
+            zoneWindow->MoveSizeUpdate(lastZonePoint, false, false);
+            statistics = zoneWindow->GetRepaintStatistics();
+            Assert::AreEqual(size_t(13), statistics.frames);
+            Assert::AreEqual(size_t(3), statistics.invalidatedFrames);
+            Assert::AreEqual(size_t(4), statistics.invalidatedZones);
+        }
+
+        TEST_METHOD(MoveSizeUpdateOutsideOfWorkAreaIsNotRepainted)
+        {
+            auto zoneWindow = MakeZoneWindow(winrt::make_self<MockZoneWindowHost>().get(), m_hInst, m_monitor, m_uniqueId.str(), {}, false);
+
+            zoneWindow->MoveSizeEnter(Mocks::Window());
+            for (int i = 0; i < 10; i++)
+            {
+                zoneWindow->MoveSizeUpdate(POINT{ m_monitorInfo.rcMonitor.right + 1000 + i, m_monitorInfo.rcMonitor.bottom + 1000 }, true, false);
+            }
+
+            const auto statistics = zoneWindow->GetRepaintStatistics();
+            Assert::AreEqual(size_t(10), statistics.frames);
+            Assert::AreEqual(size_t(0), statistics.invalidatedFrames);
+        }
+    };
+
+    TEST_CLASS(ZoneWindowDrawingUnitTests)
+    {
+    public:
+        TEST_METHOD(ChangedHighlightZonesSame)
+        {
+            Assert::IsTrue(ZoneWindowDrawing::GetChangedHighlightZones({ 1, 2 }, { 1, 2 }).empty());
+            Assert::IsTrue(ZoneWindowDrawing::GetChangedHighlightZones({}, {}).empty());
+        }
+
+        TEST_METHOD(ChangedHighlightZonesDifference)
+        {
+            const std::vector<size_t> expected{ 1, 3 };
+            Assert::IsTrue(expected == ZoneWindowDrawing::GetChangedHighlightZones({ 1, 2 }, { 2, 3 }));
+        }
+
+        TEST_METHOD(ChangedHighlightZonesOrder)
+        {
+            // The order decides which highlighted zone is drawn on top, so both have to be redrawn
+            const std::vector<size_t> expected{ 3, 2, 1 };
+            Assert::IsTrue(expected == ZoneWindowDrawing::GetChangedHighlightZones({ 1, 2 }, { 2, 1, 3 }));
+        }
+
+        TEST_METHOD(ZonesUpdateRect)
+        {
+            IZoneSet::ZonesMap zones;
+            zones[0] = MakeZone(RECT{ 0, 0, 100, 100 }, 0);
+            zones[1] = MakeZone(RECT{ 100, 0, 200, 100 }, 1);
+            zones[2] = MakeZone(RECT{ 0, 100, 200, 200 }, 2);
+
+            const auto actual = ZoneWindowDrawing::GetZonesUpdateRect(zones, { 1 });
+            Assert::IsTrue(actual.has_value());
+
+            // Borders are drawn inside the zone, so only the zone is covered
+            const RECT expected{ 100, 0, 200, 100 };
+            Assert::IsTrue(EqualRect(&expected, &actual.value()));
+        }
+
+        TEST_METHOD(ZonesUpdateRectEmpty)
+        {
+            IZoneSet::ZonesMap zones;
+            zones[0] = MakeZone(RECT{ 0, 0, 100, 100 }, 0);
+
+            const auto actual = ZoneWindowDrawing::GetZonesUpdateRect(zones, {});
+            Assert::IsTrue(actual.has_value());
+            Assert::IsTrue(IsRectEmpty(&actual.value()));
+        }
+
+        TEST_METHOD(ZonesUpdateRectUnknownZone)
+        {
+            IZoneSet::ZonesMap zones;
+            zones[0] = MakeZone(RECT{ 0, 0, 100, 100 }, 0);
+
+            Assert::IsFalse(ZoneWindowDrawing::GetZonesUpdateRect(zones, { 0, 5 }).has_value());
+        }
+
+        // Flash mode draws no index labels, so these tests don't depend on GDI+
+        TEST_METHOD(OverlayRendererRasterizesOncePerLayout)
+        {
+            IZoneSet::ZonesMap zones;
+            zones[0] = MakeZone(RECT{ 0, 0, 100, 200 }, 0);
+            zones[1] = MakeZone(RECT{ 100, 0, 200, 200 }, 1);
+            const RECT clientRect{ 0, 0, 200, 200 };
+            ZoneWindowDrawing::OverlayStyle style{ RGB(0, 120, 215), RGB(255, 255, 255), RGB(0, 90, 158), 50, true };
+
+            ZoneWindowDrawing::OverlayRenderer renderer;
+            PixelBuffer frame;
+            renderer.Compose(frame, clientRect, clientRect, zones, {}, style);
+            renderer.Compose(frame, clientRect, clientRect, zones, { 0 }, style);
+            renderer.Compose(frame, RECT{ 0, 0, 50, 50 }, clientRect, zones, { 1, 0 }, style);
+            Assert::AreEqual(size_t(1), renderer.GetRasterizationCount());
+
+            style.zoneOpacity = 80;
+            renderer.Compose(frame, clientRect, clientRect, zones, {}, style);
+            Assert::AreEqual(size_t(2), renderer.GetRasterizationCount());
+
+            renderer.Compose(frame, clientRect, RECT{ 0, 0, 300, 200 }, zones, {}, style);
+            Assert::AreEqual(size_t(3), renderer.GetRasterizationCount());
+            Assert::AreEqual(300, frame.Width());
+
+            zones[2] = MakeZone(RECT{ 200, 0, 300, 200 }, 2);
+            renderer.Compose(frame, clientRect, RECT{ 0, 0, 300, 200 }, zones, {}, style);
+            Assert::AreEqual(size_t(4), renderer.GetRasterizationCount());
+        }
+
+        TEST_METHOD(OverlayRendererHighlightIsDrawnOnTop)
+        {
+            IZoneSet::ZonesMap zones;
+            zones[0] = MakeZone(RECT{ 0, 0, 100, 100 }, 0);
+            zones[1] = MakeZone(RECT{ 50, 50, 150, 150 }, 1);
+            const RECT clientRect{ 0, 0, 200, 200 };
+            const ZoneWindowDrawing::OverlayStyle style{ RGB(0, 120, 215), RGB(255, 255, 255), RGB(0, 90, 158), 50, true };
+            const BYTE fillAlpha = static_cast<BYTE>(style.zoneOpacity * 2.55);
+            const auto flashFill = PixelBuffer::Premultiply(fillAlpha, 81, 92, 107);
+            const auto highlightFill = PixelBuffer::Premultiply(fillAlpha, 0, 90, 158);
+
+            ZoneWindowDrawing::OverlayRenderer renderer;
+            PixelBuffer frame;
+            renderer.Compose(frame, clientRect, clientRect, zones, {}, style);
+            Assert::AreEqual(flashFill, frame.GetPixel(25, 25));
+            Assert::AreEqual(0u, frame.GetPixel(175, 175));
+
+            // The highlighted zone is drawn over the zone it overlaps, although that one has a higher id
+            renderer.Compose(frame, clientRect, clientRect, zones, { 0 }, style);
+            PixelBuffer expected(1, 1);
+            expected.FillRect(expected.Bounds(), flashFill);
+            expected.FillRect(expected.Bounds(), highlightFill);
+            Assert::AreEqual(highlightFill, frame.GetPixel(25, 25));
+            Assert::AreEqual(expected.GetPixel(0, 0), frame.GetPixel(75, 75));
+            Assert::AreEqual(flashFill, frame.GetPixel(125, 125));
+
+            // Removing the highlight restores the static layer, where the zone with the higher id is on top
+            renderer.Compose(frame, clientRect, clientRect, zones, {}, style);
+            expected.Clear(0);
+            expected.FillRect(expected.Bounds(), flashFill);
+            expected.FillRect(expected.Bounds(), flashFill);
+            Assert::AreEqual(flashFill, frame.GetPixel(25, 25));
+            Assert::AreEqual(expected.GetPixel(0, 0), frame.GetPixel(75, 75));
+        }
+
+        TEST_METHOD(OverlayRendererComposesPaintRectOnly)
+        {
+            IZoneSet::ZonesMap zones;
+            zones[0] = MakeZone(RECT{ 0, 0, 100, 100 }, 0);
+            const RECT clientRect{ 0, 0, 100, 100 };
+            const ZoneWindowDrawing::OverlayStyle style{ RGB(0, 120, 215), RGB(255, 255, 255), RGB(0, 90, 158), 100, true };
+
+            ZoneWindowDrawing::OverlayRenderer renderer;
+            PixelBuffer frame(100, 100);
+            renderer.Compose(frame, RECT{ 0, 0, 50, 50 }, clientRect, zones, {}, style);
+
+            Assert::AreNotEqual(0u, frame.GetPixel(25, 25));
+            Assert::AreEqual(0u, frame.GetPixel(75, 75));
+        }
+
+        TEST_METHOD(OverlayRendererRasterizesAgainAfterRelease)
+        {
+            IZoneSet::ZonesMap zones;
+            zones[0] = MakeZone(RECT{ 0, 0, 100, 100 }, 0);
+            const RECT clientRect{ 0, 0, 100, 100 };
+            const ZoneWindowDrawing::OverlayStyle style{ RGB(0, 120, 215), RGB(255, 255, 255), RGB(0, 90, 158), 100, true };
+
+            ZoneWindowDrawing::OverlayRenderer renderer;
+            PixelBuffer frame;
+            renderer.Compose(frame, clientRect, clientRect, zones, {}, style);
+            const auto fill = frame.GetPixel(50, 50);
+            Assert::AreEqual(size_t(1), renderer.GetRasterizationCount());
+
+            renderer.Release();
+            frame = PixelBuffer();
+            renderer.Compose(frame, clientRect, clientRect, zones, {}, style);
+            Assert::AreEqual(size_t(2), renderer.GetRasterizationCount());
+            Assert::AreEqual(fill, frame.GetPixel(50, 50));
+        }
+
+        // Micro-benchmark comparing the GDI+ drawing of a 4K layout with the cached overlay renderer, while a drag moves the highlight
+        TEST_METHOD(Benchmark_OverlayRenderer)
+        {
+            ULONG_PTR gdiplusToken;
+            Gdiplus::GdiplusStartupInput gdiplusStartupInput;
+            Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, nullptr);
+
+            const LONG width = 3840;
+            const LONG height = 2160;
+            const RECT clientRect{ 0, 0, width, height };
+            IZoneSet::ZonesMap zones;
+            for (size_t i = 0; i < 16; i++)
+            {
+                const LONG left = static_cast<LONG>(i % 4) * width / 4;
+                const LONG top = static_cast<LONG>(i / 4) * height / 4;
+                zones[i] = MakeZone(RECT{ left, top, left + width / 4, top + height / 4 }, i);
+            }
+
+            const ZoneWindowDrawing::OverlayStyle style{ RGB(0, 120, 215), RGB(255, 255, 255), RGB(0, 90, 158), 50, false };
+            const int iterations = 50;
+
+            BITMAPINFO bitmapInfo{};
+            bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+            bitmapInfo.bmiHeader.biWidth = width;
+            bitmapInfo.bmiHeader.biHeight = -height;
+            bitmapInfo.bmiHeader.biPlanes = 1;
+            bitmapInfo.bmiHeader.biBitCount = 32;
+            bitmapInfo.bmiHeader.biCompression = BI_RGB;
+            void* bits = nullptr;
+            wil::unique_hdc hdc{ CreateCompatibleDC(nullptr) };
+            wil::unique_hbitmap bitmap{ CreateDIBSection(hdc.get(), &bitmapInfo, DIB_RGB_COLORS, &bits, nullptr, 0) };
+            Assert::IsNotNull(bitmap.get());
+            auto oldBitmap = SelectObject(hdc.get(), bitmap.get());
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                ZoneWindowDrawing::DrawBackdrop(hdc, clientRect);
+                ZoneWindowDrawing::DrawActiveZoneSet(hdc, style.zoneColor, style.zoneBorderColor, style.highlightColor, style.zoneOpacity, zones, { i % zones.size() }, false);
+            }
+            auto gdiplusElapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            SelectObject(hdc.get(), oldBitmap);
+
+            ZoneWindowDrawing::OverlayRenderer renderer;
+            PixelBuffer frame;
+            start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                // Only the zones whose highlight changed are repainted during a drag
+                const size_t zoneId = i % zones.size();
+                const size_t previousZoneId = (i + zones.size() - 1) % zones.size();
+                const RECT zoneRect = zones[zoneId]->GetZoneRect();
+                const RECT previousZoneRect = zones[previousZoneId]->GetZoneRect();
+                RECT paintRect;
+                UnionRect(&paintRect, &zoneRect, &previousZoneRect);
+                renderer.Compose(frame, paintRect, clientRect, zones, { zoneId }, style);
+            }
+            auto rendererElapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            Gdiplus::GdiplusShutdown(gdiplusToken);
+
+            Assert::AreEqual(size_t(1), renderer.GetRasterizationCount());
+
+            std::wstring message = L"Zone overlay with 16 zones at 4K: GDI+ " + std::to_wstring(gdiplusElapsed / iterations) +
+                                   L" us per frame, cached renderer " + std::to_wstring(rendererElapsed / iterations) + L" us per frame\n";
+            Logger::WriteMessage(message.c_str());
+        }
     };
 }
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Fixed capacity lock-free queue with multiple producers and a single consumer. Each cell has a sequence number which tells producers and the consumer whether the cell is free or holds a value for the current lap, so pushing only needs a compare-exchange on the enqueue position and popping needs no atomic read-modify-write at all
+template<typename T, size_t Capacity>
+class BoundedMpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    BoundedMpscQueue()
+    {
+        for (size_t i = 0; i < Capacity; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+    BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+    // Push a value to the queue. Can be called from any thread. Returns false if the queue is full
+    bool TryPush(const T& value)
+    {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells[position & (Capacity - 1)];
+            intptr_t difference = (intptr_t)cell.sequence.load(std::memory_order_acquire) - (intptr_t)position;
+            if (difference == 0)
+            {
+                // The cell is free for this lap, claim it
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The cell still holds the value of the previous lap
+                return false;
+            }
+            else
+            {
+                // Another producer claimed the cell
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Pop a value from the queue. Must only be called from the consumer thread. Returns false if the queue is empty
+    bool TryPop(T& value)
+    {
+        Cell& cell = cells[dequeuePosition & (Capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+        {
+            return false;
+        }
+
+        value = cell.value;
+        cell.sequence.store(dequeuePosition + Capacity, std::memory_order_release);
+        dequeuePosition++;
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    Cell cells[Capacity];
+
+    // Producers and the consumer write different positions, keep them on separate cache lines
+    alignas(64) std::atomic<size_t> enqueuePosition{ 0 };
+    alignas(64) size_t dequeuePosition{ 0 };
+};
@@ -0,0 +1,146 @@
+#include "pch.h"
+#include "ConfigurationWatcher.h"
+#include <filesystem>
+
+ConfigurationWatcher::ConfigurationWatcher(const std::wstring& folder, FileFilter fileFilter, ChangeCallback onChange, std::chrono::milliseconds debounceDelay) :
+    folder(folder), fileFilter(fileFilter), onChange(onChange), debounceDelay(debounceDelay), folderHandle(INVALID_HANDLE_VALUE), stopEvent(CreateEvent(nullptr, TRUE, FALSE, nullptr))
+{
+}
+
+ConfigurationWatcher::~ConfigurationWatcher()
+{
+    Stop();
+    CloseHandle(stopEvent);
+}
+
+bool ConfigurationWatcher::Start()
+{
+    if (watcherThread.joinable())
+    {
+        return true;
+    }
+
+    // Create the folder if it does not exist yet, so that configuration files which are added to it later are still picked up
+    std::error_code error;
+    std::filesystem::create_directories(folder, error);
+
+    folderHandle = CreateFileW(folder.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (folderHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    ResetEvent(stopEvent);
+    watcherThread = std::thread(&ConfigurationWatcher::WatcherThread, this);
+    return true;
+}
+
+void ConfigurationWatcher::Stop()
+{
+    if (!watcherThread.joinable())
+    {
+        return;
+    }
+
+    SetEvent(stopEvent);
+    watcherThread.join();
+    CloseHandle(folderHandle);
+    folderHandle = INVALID_HANDLE_VALUE;
+}
+
+bool ConfigurationWatcher::ContainsMatchingChange(const BYTE* buffer, DWORD size) const
+{
+    // An empty notification means that the buffer overflowed and the changes were lost, so assume that a matching file changed
+    if (size == 0)
+    {
+        return true;
+    }
+
+    const BYTE* entry = buffer;
+    while (true)
+    {
+        const FILE_NOTIFY_INFORMATION* notification = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(entry);
+        if (fileFilter(std::wstring(notification->FileName, notification->FileNameLength / sizeof(wchar_t))))
+        {
+            return true;
+        }
+
+        if (notification->NextEntryOffset == 0)
+        {
+            return false;
+        }
+
+        entry += notification->NextEntryOffset;
+    }
+}
+
+void ConfigurationWatcher::WatcherThread()
+{
+    // DWORD aligned buffer for the change notifications
+    alignas(DWORD) BYTE buffer[16 * 1024];
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+    const DWORD notifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+    bool isReadPending = ReadDirectoryChangesW(folderHandle, buffer, sizeof(buffer), FALSE, notifyFilter, nullptr, &overlapped, nullptr) != FALSE;
+
+    // Time of the first and the last matching change of the current burst
+    bool isChangePending = false;
+    std::chrono::steady_clock::time_point firstChangeTime;
+    std::chrono::steady_clock::time_point lastChangeTime;
+
+    while (isReadPending)
+    {
+        DWORD timeout = INFINITE;
+        if (isChangePending)
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastChangeTime);
+            timeout = elapsed < debounceDelay ? static_cast<DWORD>((debounceDelay - elapsed).count()) : 0;
+        }
+
+        HANDLE handles[] = { stopEvent, overlapped.hEvent };
+        DWORD waitResult = WaitForMultipleObjects(ARRAYSIZE(handles), handles, FALSE, timeout);
+        if (waitResult == WAIT_OBJECT_0 + 1)
+        {
+            DWORD bytesTransferred = 0;
+            isReadPending = false;
+            if (GetOverlappedResult(folderHandle, &overlapped, &bytesTransferred, FALSE))
+            {
+                if (ContainsMatchingChange(buffer, bytesTransferred))
+                {
+                    lastChangeTime = std::chrono::steady_clock::now();
+                    if (!isChangePending)
+                    {
+                        isChangePending = true;
+                        firstChangeTime = lastChangeTime;
+                    }
+                }
+
+                // Changes which happen before the next read is issued are buffered by the system, so none are lost
+                ResetEvent(overlapped.hEvent);
+                isReadPending = ReadDirectoryChangesW(folderHandle, buffer, sizeof(buffer), FALSE, notifyFilter, nullptr, &overlapped, nullptr) != FALSE;
+            }
+        }
+        else if (waitResult == WAIT_TIMEOUT)
+        {
+            // The changes have settled, changes which happen during the callback start a new burst
+            isChangePending = false;
+            onChange(firstChangeTime);
+        }
+        else
+        {
+            // Stop requested or the wait failed
+            break;
+        }
+    }
+
+    if (isReadPending)
+    {
+        // Cancel the pending read and wait for it to complete, as it writes to the buffer on this thread's stack
+        DWORD bytesTransferred = 0;
+        CancelIoEx(folderHandle, &overlapped);
+        GetOverlappedResult(folderHandle, &overlapped, &bytesTransferred, TRUE);
+    }
+
+    CloseHandle(overlapped.hEvent);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Watches a folder for changes to configuration files and calls a callback on a background thread.
+// Notifications are debounced: the callback runs once no matching file has changed for the debounce delay, so a burst of writes (e.g. a file copied in several chunks) results in a single call. Changes which happen while the callback is running are coalesced into one more call.
+class ConfigurationWatcher
+{
+public:
+    // Called with the time of the first change of the burst, which can be used to measure the reload latency
+    using ChangeCallback = std::function<void(std::chrono::steady_clock::time_point firstChangeTime)>;
+
+    // Returns true if a change to the file with the given name should trigger the callback
+    using FileFilter = std::function<bool(const std::wstring& fileName)>;
+
+    inline static const std::chrono::milliseconds DefaultDebounceDelay = std::chrono::milliseconds(250);
+
+    ConfigurationWatcher(const std::wstring& folder, FileFilter fileFilter, ChangeCallback onChange, std::chrono::milliseconds debounceDelay = DefaultDebounceDelay);
+    ~ConfigurationWatcher();
+    ConfigurationWatcher(const ConfigurationWatcher&) = delete;
+    ConfigurationWatcher& operator=(const ConfigurationWatcher&) = delete;
+
+    // Start watching the folder. The folder is created if it does not exist. Returns false if the folder cannot be created or opened
+    bool Start();
+
+    // Stop watching the folder and wait for the watcher thread. A callback which is running is completed first
+    void Stop();
+
+private:
+    // Waits for change notifications and calls the callback once the changes have settled
+    void WatcherThread();
+
+    // Returns true if the notification buffer contains a change to a file matching the filter
+    bool ContainsMatchingChange(const BYTE* buffer, DWORD size) const;
+
+    std::wstring folder;
+    FileFilter fileFilter;
+    ChangeCallback onChange;
+    std::chrono::milliseconds debounceDelay;
+
+    // Handle of the watched folder, opened for overlapped change notifications
+    HANDLE folderHandle;
+
+    // Manual-reset event signaled to stop the watcher thread
+    HANDLE stopEvent;
+
+    std::thread watcherThread;
+};
@@ -0,0 +1,56 @@
+#include "pch.h"
+#include "ForegroundAppResolver.h"
+#include "InputInterface.h"
+
+// Function to get the interned, lowercased name of the foreground process. Returns nullptr if the foreground process name could not be resolved
+const std::wstring* ForegroundAppResolver::GetForegroundApp(InputInterface& ii)
+{
+    // If no foreground change has been notified since the last call, the cached app is still valid
+    uint64_t changeCount = ii.GetForegroundChangeCount();
+    if (isCacheValid && changeCount == cachedChangeCount)
+    {
+        return cachedApp;
+    }
+
+    // The change count is read before the window so that a foreground change happening while the name is resolved causes the next call to validate the cache again
+    cachedChangeCount = changeCount;
+
+    HWND window = nullptr;
+    DWORD processId = 0;
+    ii.GetForegroundWindowInfo(window, processId);
+    if (isCacheValid && window == cachedWindow && processId == cachedProcessId)
+    {
+        return cachedApp;
+    }
+
+    std::wstring processName;
+
+    // Allocate MAX_PATH amount of memory
+    processName.resize(MAX_PATH);
+    ii.GetForegroundProcess(processName);
+
+    // Remove elements after null character
+    processName.erase(std::find(processName.begin(), processName.end(), L'\0'), processName.end());
+
+    // Convert process name to lower case
+    std::transform(processName.begin(), processName.end(), processName.begin(), towlower);
+
+    cachedApp = processName.empty() ? nullptr : InternApp(processName);
+    cachedWindow = window;
+    cachedProcessId = processId;
+    isCacheValid = true;
+
+    return cachedApp;
+}
+
+// Function to intern an app name. The returned pointer can be compared with the result of GetForegroundApp
+const std::wstring* ForegroundAppResolver::InternApp(const std::wstring& appName)
+{
+    return &*internedApps.insert(appName).first;
+}
+
+// Function to invalidate the cached foreground app
+void ForegroundAppResolver::Invalidate()
+{
+    isCacheValid = false;
+}
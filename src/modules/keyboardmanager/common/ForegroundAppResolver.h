@@ -0,0 +1,40 @@
+#pragma once
+#include <unordered_set>
+
+class InputInterface;
+
+// Class which resolves the name of the foreground process for app-specific remapping. The lowercased process name is cached per (window, process id) pair and only resolved again when a foreground change is notified, so that the hook does not have to query the process path on every key event
+class ForegroundAppResolver
+{
+private:
+    // Set of interned app names. Pointers to the elements are stable and are used as app ids
+    std::unordered_set<std::wstring> internedApps;
+
+    // Cached foreground app id. nullptr if the foreground process name is empty
+    const std::wstring* cachedApp;
+
+    // Window handle and process id for which the cached app id was resolved
+    HWND cachedWindow;
+    DWORD cachedProcessId;
+
+    // Foreground change count at the time the cache was last validated
+    uint64_t cachedChangeCount;
+
+    // Flag to check if the cache has been filled
+    bool isCacheValid;
+
+public:
+    ForegroundAppResolver() :
+        cachedApp(nullptr), cachedWindow(nullptr), cachedProcessId(0), cachedChangeCount(0), isCacheValid(false)
+    {
+    }
+
+    // Function to get the interned, lowercased name of the foreground process. Returns nullptr if the foreground process name could not be resolved
+    const std::wstring* GetForegroundApp(InputInterface& ii);
+
+    // Function to intern an app name. The returned pointer can be compared with the result of GetForegroundApp
+    const std::wstring* InternApp(const std::wstring& appName);
+
+    // Function to invalidate the cached foreground app
+    void Invalidate();
+};
@@ -0,0 +1,158 @@
+#include "pch.h"
+#include "HookEventRecording.h"
+#include <fstream>
+
+namespace
+{
+    // "KMHR" in little endian
+    const uint32_t RecordingMagic = 0x52484D4B;
+
+    // Header of a recording file. It is followed by the app table, where each app is stored as its length followed by its characters, and by the events
+    struct RecordingHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t appCount;
+        uint32_t eventCount;
+    };
+}
+
+// Function to get the index of an app in the app table, adding it if required
+uint16_t HookEventRecording::GetAppIndex(const std::wstring& app)
+{
+    auto it = appIndices.find(app);
+    if (it != appIndices.end())
+    {
+        return it->second;
+    }
+
+    uint16_t appIndex = (uint16_t)apps.size();
+    apps.push_back(app);
+    appIndices[app] = appIndex;
+    return appIndex;
+}
+
+// Function to append a key event received by the hook while the given app is in the foreground
+void HookEventRecording::AddEvent(const LowlevelKeyboardEvent& keyEvent, const std::wstring& foregroundApp)
+{
+    Event recordedEvent = {};
+    recordedEvent.extraInfo = keyEvent.lParam->dwExtraInfo;
+    recordedEvent.time = keyEvent.lParam->time;
+    recordedEvent.scanCode = (uint16_t)keyEvent.lParam->scanCode;
+    recordedEvent.appIndex = GetAppIndex(foregroundApp);
+    recordedEvent.vkCode = (uint8_t)keyEvent.lParam->vkCode;
+    recordedEvent.flags = (uint8_t)keyEvent.lParam->flags;
+    recordedEvent.message = (uint8_t)(keyEvent.wParam - WM_KEYFIRST);
+    events.push_back(recordedEvent);
+}
+
+// Function to append a key event with the given key code, message and timestamp. This is used to generate recordings
+void HookEventRecording::AddEvent(DWORD vkCode, WPARAM message, DWORD time, const std::wstring& foregroundApp, ULONG_PTR extraInfo)
+{
+    KBDLLHOOKSTRUCT lParam = {};
+    lParam.vkCode = vkCode;
+    lParam.time = time;
+    lParam.dwExtraInfo = extraInfo;
+    lParam.flags = (message == WM_KEYUP || message == WM_SYSKEYUP) ? LLKHF_UP : 0;
+    LowlevelKeyboardEvent keyEvent = { &lParam, message };
+    AddEvent(keyEvent, foregroundApp);
+}
+
+// Function to get the recorded events in the order they were received
+const std::vector<HookEventRecording::Event>& HookEventRecording::GetEvents() const
+{
+    return events;
+}
+
+// Function to get the name of the foreground app of an event
+const std::wstring& HookEventRecording::GetApp(const Event& keyEvent) const
+{
+    return apps[keyEvent.appIndex];
+}
+
+// Function to remove all the recorded events and apps
+void HookEventRecording::Clear()
+{
+    apps.clear();
+    appIndices.clear();
+    events.clear();
+}
+
+// Function to save the recording to a file. Returns false if the file cannot be written
+bool HookEventRecording::SaveToFile(const std::wstring& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    RecordingHeader header = { RecordingMagic, FileVersion, (uint32_t)apps.size(), (uint32_t)events.size() };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& app : apps)
+    {
+        uint32_t length = (uint32_t)app.size();
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(reinterpret_cast<const char*>(app.data()), length * sizeof(wchar_t));
+    }
+
+    file.write(reinterpret_cast<const char*>(events.data()), events.size() * sizeof(Event));
+    return file.good();
+}
+
+// Function to load a recording saved by SaveToFile. Returns false without modifying the recording if the file cannot be read, has another version or its size does not match its header
+bool HookEventRecording::LoadFromFile(const std::wstring& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    RecordingHeader header = {};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != RecordingMagic || header.version != FileVersion)
+    {
+        return false;
+    }
+
+    HookEventRecording recording;
+    for (uint32_t i = 0; i < header.appCount; i++)
+    {
+        uint32_t length = 0;
+        if (!file.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > MAX_PATH)
+        {
+            return false;
+        }
+
+        std::wstring app(length, L'\0');
+        if (!file.read(reinterpret_cast<char*>(app.data()), length * sizeof(wchar_t)))
+        {
+            return false;
+        }
+
+        recording.GetAppIndex(app);
+    }
+
+    // Check the event count against the rest of the file before allocating the events, so that a corrupt header cannot cause a huge allocation
+    std::streamoff eventsPosition = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff eventsSize = file.tellg() - eventsPosition;
+    file.seekg(eventsPosition);
+    if (!file || (uint64_t)eventsSize != (uint64_t)header.eventCount * sizeof(Event))
+    {
+        return false;
+    }
+
+    recording.events.resize(header.eventCount);
+    if (!file.read(reinterpret_cast<char*>(recording.events.data()), header.eventCount * sizeof(Event)))
+    {
+        return false;
+    }
+
+    // Check that all the events refer to an app of the table
+    for (const auto& recordedEvent : recording.events)
+    {
+        if (recordedEvent.appIndex >= recording.apps.size())
+        {
+            return false;
+        }
+    }
+
+    *this = std::move(recording);
+    return true;
+}
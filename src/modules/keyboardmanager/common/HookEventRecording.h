@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <LowlevelKeyboardEvent.h>
+
+// Recording of the key events received by the low level keyboard hook, used to replay a stream of events headlessly for benchmarks and regression tests.
+// The recording is stored in a compact binary file: a header, the table of the foreground apps and the events as fixed size records
+class HookEventRecording
+{
+public:
+    // Version of the recording file format. Recordings with another version are not loaded
+    inline static const uint32_t FileVersion = 1;
+
+#pragma pack(push, 1)
+    // Key event received by the hook. The fields of KBDLLHOOKSTRUCT are narrowed to the range they can take for a keyboard event
+    struct Event
+    {
+        // dwExtraInfo of the event, used to detect events injected by Keyboard Manager
+        uint64_t extraInfo;
+
+        // Timestamp of the event in milliseconds, as given by the system
+        uint32_t time;
+
+        uint16_t scanCode;
+
+        // Index of the foreground app in the app table of the recording
+        uint16_t appIndex;
+
+        uint8_t vkCode;
+
+        // LLKHF_* flags of the event
+        uint8_t flags;
+
+        // Key message of the event as an offset from WM_KEYFIRST
+        uint8_t message;
+
+        uint8_t reserved;
+    };
+#pragma pack(pop)
+
+private:
+    // Table of the foreground apps, indexed by Event::appIndex
+    std::vector<std::wstring> apps;
+
+    // Index of each app in the app table, used to avoid duplicates while recording
+    std::unordered_map<std::wstring, uint16_t> appIndices;
+
+    std::vector<Event> events;
+
+    // Function to get the index of an app in the app table, adding it if required
+    uint16_t GetAppIndex(const std::wstring& app);
+
+public:
+    // Function to append a key event received by the hook while the given app is in the foreground
+    void AddEvent(const LowlevelKeyboardEvent& keyEvent, const std::wstring& foregroundApp);
+
+    // Function to append a key event with the given key code, message and timestamp. This is used to generate recordings
+    void AddEvent(DWORD vkCode, WPARAM message, DWORD time, const std::wstring& foregroundApp, ULONG_PTR extraInfo = 0);
+
+    // Function to get the recorded events in the order they were received
+    const std::vector<Event>& GetEvents() const;
+
+    // Function to get the name of the foreground app of an event
+    const std::wstring& GetApp(const Event& keyEvent) const;
+
+    // Function to remove all the recorded events and apps
+    void Clear();
+
+    // Function to save the recording to a file. Returns false if the file cannot be written
+    bool SaveToFile(const std::wstring& path) const;
+
+    // Function to load a recording saved by SaveToFile. Returns false without modifying the recording if the file cannot be read, has another version or its size does not match its header
+    bool LoadFromFile(const std::wstring& path);
+};
@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "HookLatencyMetrics.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace HookLatencyMetrics
+{
+    namespace
+    {
+        const unsigned int StageCount = (unsigned int)Stage::Count;
+
+        // Names of the stages used in the json output
+        const wchar_t* const StageNames[StageCount] = {
+            L"hookEvent",
+            L"uiDetect",
+            L"keyDelay",
+            L"singleKeyRemap",
+            L"appSpecificShortcutRemap",
+            L"osLevelShortcutRemap"
+        };
+
+        // Counters owned by a single thread. Only the owning thread writes to them, other threads read them when the statistics are requested
+        struct ThreadCounters
+        {
+            std::atomic<uint64_t> buckets[StageCount][BucketCount];
+            std::atomic<uint64_t> max[StageCount];
+
+            ThreadCounters()
+            {
+                Clear();
+            }
+
+            void Clear()
+            {
+                for (unsigned int stage = 0; stage < StageCount; stage++)
+                {
+                    for (unsigned int bucket = 0; bucket < BucketCount; bucket++)
+                    {
+                        buckets[stage][bucket].store(0, std::memory_order_relaxed);
+                    }
+                    max[stage].store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        // Registry of the counters of all the threads which have recorded an event. The counters are owned by the registry so that they can still be read after the thread exits
+        std::mutex registryMutex;
+        std::vector<std::unique_ptr<ThreadCounters>> registry;
+
+        // Counters of the current thread, registered on the first recorded event
+        thread_local ThreadCounters* currentThreadCounters = nullptr;
+
+        ThreadCounters& GetCurrentThreadCounters()
+        {
+            if (currentThreadCounters == nullptr)
+            {
+                std::unique_ptr<ThreadCounters> counters = std::make_unique<ThreadCounters>();
+                currentThreadCounters = counters.get();
+                std::lock_guard<std::mutex> lock(registryMutex);
+                registry.push_back(std::move(counters));
+            }
+
+            return *currentThreadCounters;
+        }
+
+        // Reference point used to convert TSC cycles to nanoseconds, by comparing the elapsed TSC cycles with the elapsed performance counter ticks
+        struct ClockReference
+        {
+            LARGE_INTEGER performanceCounter;
+            uint64_t tsc;
+
+            ClockReference()
+            {
+                QueryPerformanceCounter(&performanceCounter);
+                tsc = __rdtsc();
+            }
+        };
+
+        const ClockReference startReference;
+
+        // Function to get the number of TSC cycles per nanosecond. Returns 0 if not enough time has elapsed to calibrate the TSC
+        double GetCyclesPerNanosecond()
+        {
+            ClockReference currentReference;
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+
+            LONGLONG elapsedTicks = currentReference.performanceCounter.QuadPart - startReference.performanceCounter.QuadPart;
+            if (elapsedTicks <= 0 || frequency.QuadPart <= 0)
+            {
+                return 0;
+            }
+
+            double elapsedNanoseconds = (double)elapsedTicks * 1e9 / (double)frequency.QuadPart;
+            return (double)(currentReference.tsc - startReference.tsc) / elapsedNanoseconds;
+        }
+
+        // Function to get the latency at a percentile from a histogram. The upper bound of the bucket is returned, capped to the maximum recorded latency
+        uint64_t GetPercentile(const uint64_t (&histogram)[BucketCount], uint64_t count, uint64_t max, unsigned int percentile)
+        {
+            // Rank of the event at the percentile, rounded up
+            uint64_t rank = (count * percentile + 99) / 100;
+            if (rank == 0)
+            {
+                rank = 1;
+            }
+
+            uint64_t cumulativeCount = 0;
+            for (unsigned int bucket = 0; bucket < BucketCount; bucket++)
+            {
+                cumulativeCount += histogram[bucket];
+                if (cumulativeCount >= rank)
+                {
+                    return (std::min)(GetBucketUpperBound(bucket), max);
+                }
+            }
+
+            return max;
+        }
+    }
+
+    // Function to get the largest latency which falls in a histogram bucket
+    uint64_t GetBucketUpperBound(unsigned int bucketIndex)
+    {
+        if (bucketIndex < SubBucketCount)
+        {
+            return bucketIndex;
+        }
+
+        unsigned int msb = bucketIndex / SubBucketCount + SubBucketBits - 1;
+        unsigned int shift = msb - SubBucketBits;
+        uint64_t lowerBound = (uint64_t)(SubBucketCount + bucketIndex % SubBucketCount) << shift;
+        return lowerBound + ((1ull << shift) - 1);
+    }
+
+    // Function to record a latency for a stage. This is lock free and only touches counters owned by the calling thread
+    void RecordLatency(Stage stage, uint64_t cycles)
+    {
+        ThreadCounters& counters = GetCurrentThreadCounters();
+        unsigned int stageIndex = (unsigned int)stage;
+
+        // Only the current thread writes to these counters, so a relaxed load and store is sufficient and avoids a locked instruction
+        std::atomic<uint64_t>& bucket = counters.buckets[stageIndex][GetBucketIndex(cycles)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (cycles > counters.max[stageIndex].load(std::memory_order_relaxed))
+        {
+            counters.max[stageIndex].store(cycles, std::memory_order_relaxed);
+        }
+    }
+
+    // Function to get the latency statistics for a stage, aggregated over all the threads
+    Statistics GetStatistics(Stage stage)
+    {
+        unsigned int stageIndex = (unsigned int)stage;
+        uint64_t histogram[BucketCount] = {};
+        Statistics statistics;
+
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const auto& counters : registry)
+            {
+                for (unsigned int bucket = 0; bucket < BucketCount; bucket++)
+                {
+                    uint64_t bucketCount = counters->buckets[stageIndex][bucket].load(std::memory_order_relaxed);
+                    histogram[bucket] += bucketCount;
+                    statistics.count += bucketCount;
+                }
+                statistics.max = (std::max)(statistics.max, counters->max[stageIndex].load(std::memory_order_relaxed));
+            }
+        }
+
+        if (statistics.count != 0)
+        {
+            statistics.p50 = GetPercentile(histogram, statistics.count, statistics.max, 50);
+            statistics.p99 = GetPercentile(histogram, statistics.count, statistics.max, 99);
+        }
+
+        return statistics;
+    }
+
+    // Function to reset the counters of all the threads. Events recorded concurrently with the reset may be lost
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& counters : registry)
+        {
+            counters->Clear();
+        }
+    }
+
+    // Function to get the statistics of all the stages as a json object, with latencies converted to nanoseconds
+    json::JsonObject GetStatisticsJson()
+    {
+        double cyclesPerNanosecond = GetCyclesPerNanosecond();
+        auto toNanoseconds = [cyclesPerNanosecond](uint64_t cycles) {
+            return cyclesPerNanosecond > 0 ? (double)cycles / cyclesPerNanosecond : 0.0;
+        };
+
+        json::JsonObject statisticsJson;
+        for (unsigned int stageIndex = 0; stageIndex < StageCount; stageIndex++)
+        {
+            Statistics statistics = GetStatistics((Stage)stageIndex);
+            json::JsonObject stageJson;
+            stageJson.SetNamedValue(L"count", json::value((double)statistics.count));
+            stageJson.SetNamedValue(L"p50Ns", json::value(toNanoseconds(statistics.p50)));
+            stageJson.SetNamedValue(L"p99Ns", json::value(toNanoseconds(statistics.p99)));
+            stageJson.SetNamedValue(L"maxNs", json::value(toNanoseconds(statistics.max)));
+            statisticsJson.SetNamedValue(StageNames[stageIndex], stageJson);
+        }
+
+        statisticsJson.SetNamedValue(L"cyclesPerNs", json::value(cyclesPerNanosecond));
+        return statisticsJson;
+    }
+}
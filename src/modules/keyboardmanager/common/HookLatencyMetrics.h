@@ -0,0 +1,167 @@
+#pragma once
+#include <atomic>
+#include <intrin.h>
+#include "../../../common/debug_control.h"
+#include "../../../common/json.h"
+
+// Low overhead latency instrumentation for the keyboard hook. Latencies are measured in TSC cycles and recorded in log-scale histograms which are stored per thread, so that recording an event does not require any locks or interlocked operations
+namespace HookLatencyMetrics
+{
+    // Stages of the keyboard hook which are measured
+    enum class Stage
+    {
+        HookEvent,
+        UIDetect,
+        KeyDelay,
+        SingleKeyRemap,
+        AppSpecificShortcutRemap,
+        OSLevelShortcutRemap,
+        Count
+    };
+
+    // Number of sub buckets per power of two. Each bucket covers at most 25% of its lower bound
+    const unsigned int SubBucketBits = 2;
+    const unsigned int SubBucketCount = 1 << SubBucketBits;
+
+    // Number of buckets in a histogram, enough to cover the whole 64 bit range
+    const unsigned int BucketCount = 64 * SubBucketCount;
+
+    // Latency statistics for a stage. Latencies are in TSC cycles
+    struct Statistics
+    {
+        uint64_t count = 0;
+        uint64_t p50 = 0;
+        uint64_t p99 = 0;
+        uint64_t max = 0;
+    };
+
+    // Function to get the histogram bucket for a latency
+    inline unsigned int GetBucketIndex(uint64_t value)
+    {
+        if (value < SubBucketCount)
+        {
+            return (unsigned int)value;
+        }
+
+        unsigned long msb;
+        _BitScanReverse64(&msb, value);
+        unsigned int subBucket = (unsigned int)(value >> (msb - SubBucketBits)) & (SubBucketCount - 1);
+        return (msb - SubBucketBits + 1) * SubBucketCount + subBucket;
+    }
+
+    // Function to get the largest latency which falls in a histogram bucket
+    uint64_t GetBucketUpperBound(unsigned int bucketIndex);
+
+    // Function to record a latency for a stage. This is lock free and only touches counters owned by the calling thread
+    void RecordLatency(Stage stage, uint64_t cycles);
+
+    // Function to get the latency statistics for a stage, aggregated over all the threads
+    Statistics GetStatistics(Stage stage);
+
+    // Function to reset the counters of all the threads. Events recorded concurrently with the reset may be lost
+    void Reset();
+
+    // Function to get the statistics of all the stages as a json object, with latencies converted to nanoseconds
+    json::JsonObject GetStatisticsJson();
+
+    class EventTimer;
+
+    // Event timer which is currently measuring on this thread. The stages measured inside it are excluded from its time
+    inline thread_local EventTimer* activeEventTimer = nullptr;
+
+    // Class which records the time spent in several scopes of a hook event as a single sample. The time of the stages measured with a ScopedTimer inside these scopes is excluded, so that it is not counted twice
+    class EventTimer
+    {
+    private:
+        Stage stage;
+        uint64_t elapsed = 0;
+        bool measured = false;
+
+    public:
+        // RAII class which adds the time spent in a scope to an event timer
+        class Part
+        {
+        private:
+            EventTimer& timer;
+            EventTimer* previous;
+            uint64_t start;
+
+        public:
+            Part(EventTimer& timer) :
+                timer(timer), previous(activeEventTimer), start(__rdtsc())
+            {
+                activeEventTimer = &timer;
+            }
+
+            ~Part()
+            {
+                timer.elapsed += __rdtsc() - start;
+                timer.measured = true;
+                activeEventTimer = previous;
+            }
+
+            Part(const Part&) = delete;
+            Part& operator=(const Part&) = delete;
+        };
+
+        EventTimer(Stage stage) :
+            stage(stage)
+        {
+        }
+
+        ~EventTimer()
+        {
+            if (measured)
+            {
+                RecordLatency(stage, elapsed);
+            }
+        }
+
+        // Function to remove the time of a nested stage. It may wrap around temporarily, but the nested time is contained in the part which is being measured
+        void Exclude(uint64_t cycles)
+        {
+            elapsed -= cycles;
+        }
+
+        EventTimer(const EventTimer&) = delete;
+        EventTimer& operator=(const EventTimer&) = delete;
+    };
+
+    // RAII class which records the time spent in a scope
+    class ScopedTimer
+    {
+    private:
+        Stage stage;
+        uint64_t start;
+
+    public:
+        ScopedTimer(Stage stage) :
+            stage(stage), start(__rdtsc())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            uint64_t cycles = __rdtsc() - start;
+            RecordLatency(stage, cycles);
+            if (activeEventTimer != nullptr)
+            {
+                activeEventTimer->Exclude(cycles);
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+}
+
+// Macros to measure the latency of the enclosing scope, or of several scopes of an event as a single sample. They are compiled out unless KEYBOARDMANAGER_HOOK_LATENCY_METRICS is defined in debug_control.h
+#ifdef KEYBOARDMANAGER_HOOK_LATENCY_METRICS
+#define KM_MEASURE_HOOK_LATENCY(stage) HookLatencyMetrics::ScopedTimer hookLatencyTimer_##stage(HookLatencyMetrics::Stage::stage)
+#define KM_MEASURE_HOOK_LATENCY_EVENT(stage) HookLatencyMetrics::EventTimer hookLatencyEventTimer_##stage(HookLatencyMetrics::Stage::stage)
+#define KM_MEASURE_HOOK_LATENCY_EVENT_PART(stage) HookLatencyMetrics::EventTimer::Part hookLatencyEventTimerPart_##stage(hookLatencyEventTimer_##stage)
+#else
+#define KM_MEASURE_HOOK_LATENCY(stage)
+#define KM_MEASURE_HOOK_LATENCY_EVENT(stage)
+#define KM_MEASURE_HOOK_LATENCY_EVENT_PART(stage)
+#endif
@@ -0,0 +1,44 @@
+#include "pch.h"
+#include "InputBatch.h"
+
+// Function to append a zero initialized event to the batch. Returns nullptr if the batch is full
+LPINPUT InputBatch::Append()
+{
+    if (count >= Capacity)
+    {
+        return nullptr;
+    }
+
+    inputs[count] = {};
+    return &inputs[count++];
+}
+
+// Function to remove all the events from the batch
+void InputBatch::Clear()
+{
+    count = 0;
+}
+
+// Function to get the number of events in the batch
+UINT InputBatch::Size() const
+{
+    return count;
+}
+
+// Function to check if the batch is empty
+bool InputBatch::IsEmpty() const
+{
+    return count == 0;
+}
+
+// Function to get a pointer to the events, in the format expected by SendInput
+LPINPUT InputBatch::Data()
+{
+    return inputs.data();
+}
+
+// Function to get the event at the given index
+const INPUT& InputBatch::operator[](size_t index) const
+{
+    return inputs[index];
+}
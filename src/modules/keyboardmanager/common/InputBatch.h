@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+
+// Class which stores a fixed number of key events on the stack, used by the remap handlers to build the input sent by SendInput without any heap allocations
+class InputBatch
+{
+public:
+    // Maximum number of key events in a batch. The largest batch is sent on releasing a modifier of an invoked shortcut to shortcut remap: key up for the target action key and 4 modifiers, key down for 4 modifiers and 2 dummy key events
+    static const size_t Capacity = 16;
+
+private:
+    // Storage for the key events. Elements are only initialized when they are appended
+    std::array<INPUT, Capacity> inputs;
+
+    // Number of key events in the batch
+    UINT count;
+
+public:
+    InputBatch() :
+        count(0)
+    {
+    }
+
+    // Function to append a zero initialized event to the batch. Returns nullptr if the batch is full
+    LPINPUT Append();
+
+    // Function to remove all the events from the batch
+    void Clear();
+
+    // Function to get the number of events in the batch
+    UINT Size() const;
+
+    // Function to check if the batch is empty
+    bool IsEmpty() const;
+
+    // Function to get a pointer to the events, in the format expected by SendInput
+    LPINPUT Data();
+
+    // Function to get the event at the given index
+    const INPUT& operator[](size_t index) const;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include "KeyboardStateSnapshot.h"
 
 // Interface used to wrap keyboard input library methods
 class InputInterface
@@ -10,6 +11,15 @@ public:
     // Function to get the state of a particular key
     virtual bool GetVirtualKeyState(int key) = 0;
 
+    // Function to get the state of all the keys at once
+    virtual KeyboardStateSnapshot GetKeyboardStateSnapshot() = 0;
+
     // Function to get the foreground process name
     virtual void GetForegroundProcess(_Out_ std::wstring& foregroundProcess) = 0;
+
+    // Function to get the handle of the foreground window and the id of the process which owns it
+    virtual void GetForegroundWindowInfo(_Out_ HWND& foregroundWindow, _Out_ DWORD& processId) = 0;
+
+    // Function to get the number of foreground window changes which have been notified. This is used to invalidate the cached foreground process name
+    virtual uint64_t GetForegroundChangeCount() = 0;
 };
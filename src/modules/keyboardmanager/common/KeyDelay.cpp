@@ -1,28 +1,49 @@
 #include "pch.h"
 #include "KeyDelay.h"
 
-// NOTE: The destructor should never be called on the DelayThread, i.e. from any of shortPress, longPress or longPressReleased, as it will re-enter the mutex. Even if the mutex is removed it will deadlock because of the join statement
-KeyDelay::~KeyDelay()
+void KeyDelay::KeyEvent(const KeyTimedEvent& ev)
 {
-    std::unique_lock<std::mutex> l(_queueMutex);
-    _quit = true;
-    _cv.notify_all();
-    l.unlock();
-    _delayThread.join();
+    switch (_state)
+    {
+    case KeyDelayState::RELEASED:
+        HandleRelease(ev);
+        break;
+    case KeyDelayState::ON_HOLD:
+        HandleOnHold(ev);
+        break;
+    case KeyDelayState::ON_HOLD_TIMEOUT:
+        HandleOnHoldTimeout(ev);
+        break;
+    }
 }
 
-void KeyDelay::KeyEvent(LowlevelKeyboardEvent* ev)
+void KeyDelay::LongPressTimeout()
 {
-    std::lock_guard guard(_queueMutex);
-    _queue.push({ ev->lParam->time, ev->wParam });
-    _cv.notify_all();
+    if (_state != KeyDelayState::ON_HOLD)
+    {
+        return;
+    }
+
+    if (_onLongPressDetected != nullptr)
+    {
+        _onLongPressDetected(_key);
+    }
+    _state = KeyDelayState::ON_HOLD_TIMEOUT;
 }
 
-KeyTimedEvent KeyDelay::NextEvent()
+bool KeyDelay::IsWaitingForLongPress() const
 {
-    auto ev = _queue.front();
-    _queue.pop();
-    return ev;
+    return _state == KeyDelayState::ON_HOLD;
+}
+
+DWORD64 KeyDelay::GetHoldStartTime() const
+{
+    return _initialHoldKeyDown;
+}
+
+DWORD KeyDelay::GetKey() const
+{
+    return _key;
 }
 
 bool KeyDelay::CheckIfMillisHaveElapsed(DWORD64 first, DWORD64 last, DWORD64 duration)
@@ -39,128 +60,68 @@ bool KeyDelay::CheckIfMillisHaveElapsed(DWORD64 first, DWORD64 last, DWORD64 dur
     }
 }
 
-bool KeyDelay::HasNextEvent()
-{
-    return !_queue.empty();
-}
-
-bool KeyDelay::HandleRelease()
+void KeyDelay::HandleRelease(const KeyTimedEvent& ev)
 {
-    while (HasNextEvent())
+    switch (ev.message)
     {
-        auto ev = NextEvent();
-        switch (ev.message)
-        {
-        case WM_KEYDOWN:
-        case WM_SYSKEYDOWN:
-            _state = KeyDelayState::ON_HOLD;
-            _initialHoldKeyDown = ev.time;
-            return false;
-        case WM_KEYUP:
-        case WM_SYSKEYUP:
-            break;
-        }
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN:
+        _state = KeyDelayState::ON_HOLD;
+        _initialHoldKeyDown = ev.time;
+        break;
+    case WM_KEYUP:
+    case WM_SYSKEYUP:
+        break;
     }
-
-    return true;
 }
 
-bool KeyDelay::HandleOnHold(std::unique_lock<std::mutex>& cvLock)
+void KeyDelay::HandleOnHold(const KeyTimedEvent& ev)
 {
-    while (HasNextEvent())
+    switch (ev.message)
     {
-        auto ev = NextEvent();
-        switch (ev.message)
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN:
+        break;
+    case WM_KEYUP:
+    case WM_SYSKEYUP:
+        // The key up event can be processed before the long press timer expires, so the event timestamps are used to detect a long press
+        if (CheckIfMillisHaveElapsed(_initialHoldKeyDown, ev.time, LONG_PRESS_DELAY_MILLIS))
         {
-        case WM_KEYDOWN:
-        case WM_SYSKEYDOWN:
-            break;
-        case WM_KEYUP:
-        case WM_SYSKEYUP:
-            if (CheckIfMillisHaveElapsed(_initialHoldKeyDown, ev.time, LONG_PRESS_DELAY_MILLIS))
+            if (_onLongPressDetected != nullptr)
             {
-                if (_onLongPressDetected != nullptr)
-                {
-                    _onLongPressDetected(_key);
-                }
-                if (_onLongPressReleased != nullptr)
-                {
-                    _onLongPressReleased(_key);
-                }
+                _onLongPressDetected(_key);
             }
-            else
+            if (_onLongPressReleased != nullptr)
             {
-                if (_onShortPress != nullptr)
-                {
-                    _onShortPress(_key);
-                }
+                _onLongPressReleased(_key);
             }
-            _state = KeyDelayState::RELEASED;
-            return false;
         }
-    }
-
-    if (CheckIfMillisHaveElapsed(_initialHoldKeyDown, GetTickCount64(), LONG_PRESS_DELAY_MILLIS))
-    {
-        if (_onLongPressDetected != nullptr)
-        {
-            _onLongPressDetected(_key);
-        }
-        _state = KeyDelayState::ON_HOLD_TIMEOUT;
-    }
-    else
-    {
-        _cv.wait_for(cvLock, std::chrono::milliseconds(ON_HOLD_WAIT_TIMEOUT_MILLIS));
-    }
-    return false;
-}
-
-bool KeyDelay::HandleOnHoldTimeout()
-{
-    while (HasNextEvent())
-    {
-        auto ev = NextEvent();
-        switch (ev.message)
+        else
         {
-        case WM_KEYDOWN:
-        case WM_SYSKEYDOWN:
-            break;
-        case WM_KEYUP:
-        case WM_SYSKEYUP:
-            if (_onLongPressReleased != nullptr)
+            if (_onShortPress != nullptr)
             {
-                _onLongPressReleased(_key);
+                _onShortPress(_key);
             }
-            _state = KeyDelayState::RELEASED;
-            return false;
         }
+        _state = KeyDelayState::RELEASED;
+        break;
     }
-
-    return true;
 }
 
-void KeyDelay::DelayThread()
+void KeyDelay::HandleOnHoldTimeout(const KeyTimedEvent& ev)
 {
-    std::unique_lock<std::mutex> qLock(_queueMutex);
-    bool shouldWait = true;
-    while (!_quit)
+    switch (ev.message)
     {
-        if (shouldWait)
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN:
+        break;
+    case WM_KEYUP:
+    case WM_SYSKEYUP:
+        if (_onLongPressReleased != nullptr)
         {
-            _cv.wait(qLock);
-        }
-
-        switch (_state)
-        {
-        case KeyDelayState::RELEASED:
-            shouldWait = HandleRelease();
-            break;
-        case KeyDelayState::ON_HOLD:
-            shouldWait = HandleOnHold(qLock);
-            break;
-        case KeyDelayState::ON_HOLD_TIMEOUT:
-            shouldWait = HandleOnHoldTimeout();
-            break;
+            _onLongPressReleased(_key);
         }
+        _state = KeyDelayState::RELEASED;
+        break;
     }
-}
\ No newline at end of file
+}
@@ -1,10 +1,8 @@
 #pragma once
 #include <functional>
-#include <thread>
-#include <queue>
-#include <mutex>
 
 #include <LowlevelKeyboardEvent.h>
+#include "TimerWheel.h"
 // Available states for the KeyDelay state machine.
 enum class KeyDelayState
 {
@@ -21,9 +19,9 @@ struct KeyTimedEvent
 };
 
 // Handles delayed key inputs.
-// Implemented as a state machine running on its own thread.
-// Thread stops on destruction.
-class KeyDelay
+// Implemented as a state machine driven by the KeyDelayScheduler thread, which feeds it key events and arms its long press timer.
+// All the methods must be called on the scheduler thread.
+class KeyDelay : public TimerWheelEntry
 {
 public:
     KeyDelay(
@@ -31,39 +29,39 @@ public:
         std::function<void(DWORD)> onShortPress,
         std::function<void(DWORD)> onLongPressDetected,
         std::function<void(DWORD)> onLongPressReleased) :
-        _quit(false),
         _state(KeyDelayState::RELEASED),
         _initialHoldKeyDown(0),
         _key(key),
         _onShortPress(onShortPress),
         _onLongPressDetected(onLongPressDetected),
-        _onLongPressReleased(onLongPressReleased),
-        _delayThread(&KeyDelay::DelayThread, this){};
+        _onLongPressReleased(onLongPressReleased){};
 
-    // Enque new KeyTimedEvent and notify the condition variable.
-    void KeyEvent(LowlevelKeyboardEvent* ev);
-    ~KeyDelay();
+    // Manage state transitions for a new key event and trigger callbacks on certain events.
+    void KeyEvent(const KeyTimedEvent& ev);
 
-private:
-    // Runs the state machine, waits if there is no events to process.
-    // Checks for _quit condition.
-    void DelayThread();
+    // Called when the key has been held down for LONG_PRESS_DELAY_MILLIS without a key up event.
+    void LongPressTimeout();
+
+    // Returns true if the key is held down and the long press has not been detected yet, i.e. the long press timer should be armed.
+    bool IsWaitingForLongPress() const;
+
+    // Timestamp of the key down event which started the current hold, in millis since Windows startup.
+    DWORD64 GetHoldStartTime() const;
 
-    // Manage state transitions and trigger callbacks on certain events.
-    // Returns whether or not the thread should wait on new events.
-    bool HandleRelease();
-    bool HandleOnHold(std::unique_lock<std::mutex>& cvLock);
-    bool HandleOnHoldTimeout();
+    // Virtual Key provided in the constructor.
+    DWORD GetKey() const;
 
-    // Get next key event in queue.
-    KeyTimedEvent NextEvent();
-    bool HasNextEvent();
+    static const DWORD64 LONG_PRESS_DELAY_MILLIS = 900;
+
+private:
+    void HandleRelease(const KeyTimedEvent& ev);
+    void HandleOnHold(const KeyTimedEvent& ev);
+    void HandleOnHoldTimeout(const KeyTimedEvent& ev);
 
     // Check if <duration> milliseconds passed since <first> millisecond.
     // Also checks for overflow conditions.
     bool CheckIfMillisHaveElapsed(DWORD64 first, DWORD64 last, DWORD64 duration);
 
-    bool _quit;
     KeyDelayState _state;
 
     // Callback functions, the key provided in the constructor is passed as an argument.
@@ -71,23 +69,9 @@ private:
     std::function<void(DWORD)> _onLongPressReleased;
     std::function<void(DWORD)> _onShortPress;
 
-    // Queue holding key events that are not processed yet. Should be kept synchronized
-    // using _queueMutex
-    std::queue<KeyTimedEvent> _queue;
-    std::mutex _queueMutex;
-
-    // DelayThread waits on this condition variable when there is no events to process.
-    std::condition_variable _cv;
-
     // Keeps track of the time at which the initial KEY_DOWN event happened.
     DWORD64 _initialHoldKeyDown;
 
     // Virtual Key provided in the constructor. Passed to callback functions.
     DWORD _key;
-
-    // Declare _delayThread after all other members so that it is the last to be initialized by the constructor
-    std::thread _delayThread;
-
-    static const DWORD64 LONG_PRESS_DELAY_MILLIS = 900;
-    static const DWORD64 ON_HOLD_WAIT_TIMEOUT_MILLIS = 50;
 };
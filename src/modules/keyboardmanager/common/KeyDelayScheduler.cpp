@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "KeyDelayScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+KeyDelayScheduler::KeyDelayScheduler() :
+    _wakeEvent(CreateEvent(nullptr, FALSE, FALSE, nullptr)),
+    _quit(false),
+    _timerWheel(GetCurrentTick())
+{
+}
+
+// NOTE: The destructor should never be called on the scheduler thread, i.e. from any of shortPress, longPress or longPressReleased, as it will deadlock on the join statement
+KeyDelayScheduler::~KeyDelayScheduler()
+{
+    {
+        std::lock_guard l(_schedulerThread_mutex);
+        if (_schedulerThread.joinable())
+        {
+            _quit = true;
+            SetEvent(_wakeEvent);
+            _schedulerThread.join();
+        }
+    }
+
+    // Release the commands which were not processed by the scheduler thread
+    Command command;
+    while (_commands.TryPop(command))
+    {
+        delete command.keyDelay;
+        if (command.completion != nullptr)
+        {
+            command.completion->set_value();
+        }
+    }
+
+    CloseHandle(_wakeEvent);
+}
+
+DWORD64 KeyDelayScheduler::GetCurrentTick()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void KeyDelayScheduler::Register(
+    DWORD key,
+    std::function<void(DWORD)> onShortPress,
+    std::function<void(DWORD)> onLongPressDetected,
+    std::function<void(DWORD)> onLongPressReleased)
+{
+    EnsureThreadStarted();
+
+    auto keyDelay = std::make_unique<KeyDelay>(key, onShortPress, onLongPressDetected, onLongPressReleased);
+    PostCommand({ CommandType::Register, key, {}, keyDelay.release(), nullptr });
+}
+
+void KeyDelayScheduler::Unregister(DWORD key)
+{
+    PostCommandAndWait(CommandType::Unregister, key);
+}
+
+void KeyDelayScheduler::Clear()
+{
+    PostCommandAndWait(CommandType::Clear, 0);
+}
+
+bool KeyDelayScheduler::KeyEvent(LowlevelKeyboardEvent* ev)
+{
+    if (!_commands.TryPush({ CommandType::KeyEvent, ev->lParam->vkCode, { ev->lParam->time, ev->wParam }, nullptr, nullptr }))
+    {
+        return false;
+    }
+
+    SetEvent(_wakeEvent);
+    return true;
+}
+
+void KeyDelayScheduler::PostCommand(const Command& command)
+{
+    while (!_commands.TryPush(command))
+    {
+        // The queue is full, let the scheduler thread catch up
+        SetEvent(_wakeEvent);
+        Sleep(1);
+    }
+
+    SetEvent(_wakeEvent);
+}
+
+void KeyDelayScheduler::PostCommandAndWait(CommandType type, DWORD key)
+{
+    {
+        std::lock_guard l(_schedulerThread_mutex);
+        if (!_schedulerThread.joinable())
+        {
+            return;
+        }
+    }
+
+    std::promise<void> completion;
+    PostCommand({ type, key, {}, nullptr, &completion });
+    completion.get_future().wait();
+}
+
+void KeyDelayScheduler::EnsureThreadStarted()
+{
+    std::lock_guard l(_schedulerThread_mutex);
+    if (!_schedulerThread.joinable())
+    {
+        _schedulerThread = std::thread(&KeyDelayScheduler::SchedulerThread, this);
+    }
+}
+
+void KeyDelayScheduler::UpdateTimer(KeyDelay& keyDelay)
+{
+    if (!keyDelay.IsWaitingForLongPress())
+    {
+        _timerWheel.Cancel(keyDelay);
+    }
+    else if (!keyDelay.IsArmed())
+    {
+        // The delay is counted from the key down event rather than from when it is processed, so that a backlog of events doesn't delay the long press.
+        // Event timestamps come from the GetTickCount clock, which wraps around, so only the time elapsed since the event is carried over to the scheduler clock
+        LONG elapsed = static_cast<LONG>(GetTickCount() - static_cast<DWORD>(keyDelay.GetHoldStartTime()));
+        DWORD64 elapsedMillis = std::clamp<LONG>(elapsed, 0, static_cast<LONG>(KeyDelay::LONG_PRESS_DELAY_MILLIS));
+        DWORD64 now = GetCurrentTick();
+        _timerWheel.Schedule(keyDelay, now + KeyDelay::LONG_PRESS_DELAY_MILLIS - elapsedMillis, now);
+    }
+}
+
+void KeyDelayScheduler::ProcessCommand(const Command& command)
+{
+    switch (command.type)
+    {
+    case CommandType::Register:
+    {
+        auto& keyDelay = _keyDelays[command.key];
+        if (keyDelay)
+        {
+            _timerWheel.Cancel(*keyDelay);
+        }
+
+        keyDelay.reset(command.keyDelay);
+        break;
+    }
+    case CommandType::Unregister:
+    {
+        auto it = _keyDelays.find(command.key);
+        if (it != _keyDelays.end())
+        {
+            _timerWheel.Cancel(*it->second);
+            _keyDelays.erase(it);
+        }
+
+        command.completion->set_value();
+        break;
+    }
+    case CommandType::Clear:
+        for (auto& it : _keyDelays)
+        {
+            _timerWheel.Cancel(*it.second);
+        }
+
+        _keyDelays.clear();
+        command.completion->set_value();
+        break;
+    case CommandType::KeyEvent:
+    {
+        auto it = _keyDelays.find(command.key);
+        if (it != _keyDelays.end())
+        {
+            it->second->KeyEvent(command.event);
+            UpdateTimer(*it->second);
+        }
+        break;
+    }
+    }
+}
+
+void KeyDelayScheduler::SchedulerThread()
+{
+    while (!_quit)
+    {
+        Command command;
+        while (_commands.TryPop(command))
+        {
+            ProcessCommand(command);
+        }
+
+        _timerWheel.Advance(GetCurrentTick(), [](TimerWheelEntry& entry) {
+            static_cast<KeyDelay&>(entry).LongPressTimeout();
+        });
+
+        // Sleep until the next command is posted or the next timer can expire
+        uint64_t ticksUntilNextExpiry = _timerWheel.GetTicksUntilNextExpiry();
+        WaitForSingleObject(_wakeEvent, ticksUntilNextExpiry >= INFINITE ? INFINITE : static_cast<DWORD>(ticksUntilNextExpiry));
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <LowlevelKeyboardEvent.h>
+#include "BoundedMpscQueue.h"
+#include "KeyDelay.h"
+#include "TimerWheel.h"
+
+// Runs all the KeyDelay state machines on a single thread.
+// Registrations and key events are posted to a lock-free queue, and the long press timeouts are driven by a timer wheel with millisecond ticks, so the thread only wakes up when there is an event to process or a timer to expire.
+// The thread is started on the first registration and stops on destruction.
+class KeyDelayScheduler
+{
+public:
+    KeyDelayScheduler();
+    ~KeyDelayScheduler();
+    KeyDelayScheduler(const KeyDelayScheduler&) = delete;
+    KeyDelayScheduler& operator=(const KeyDelayScheduler&) = delete;
+
+    // Add a KeyDelay for the given virtual key. An existing KeyDelay for the key is replaced.
+    void Register(
+        DWORD key,
+        std::function<void(DWORD)> onShortPress,
+        std::function<void(DWORD)> onLongPressDetected,
+        std::function<void(DWORD)> onLongPressReleased);
+
+    // Remove the KeyDelay for the given virtual key. No callback is called for the key once the method returns.
+    // NOTE: this method waits for the scheduler thread, so it must never be called from one of the callbacks.
+    void Unregister(DWORD key);
+
+    // Remove all the KeyDelay objects. No callback is called once the method returns.
+    // NOTE: this method waits for the scheduler thread, so it must never be called from one of the callbacks.
+    void Clear();
+
+    // Post a key event for a registered key. Safe to call from the hook thread, it does not block or allocate memory. Returns false if the event could not be queued because the queue is full.
+    bool KeyEvent(LowlevelKeyboardEvent* ev);
+
+    // Returns the current tick of the scheduler clock, in milliseconds.
+    static DWORD64 GetCurrentTick();
+
+private:
+    enum class CommandType
+    {
+        Register,
+        Unregister,
+        Clear,
+        KeyEvent,
+    };
+
+    struct Command
+    {
+        CommandType type;
+        DWORD key;
+        KeyTimedEvent event;
+
+        // New KeyDelay for Register commands, owned by the command until it is processed
+        KeyDelay* keyDelay;
+
+        // Signaled when Unregister and Clear commands are processed
+        std::promise<void>* completion;
+    };
+
+    // Runs the scheduler, waits if there are no commands to process and no timer to expire.
+    void SchedulerThread();
+
+    // Apply a command on the scheduler thread.
+    void ProcessCommand(const Command& command);
+
+    // Post a command from a thread which is allowed to block, waiting for free space in the queue if it is full.
+    void PostCommand(const Command& command);
+
+    // Post a command and wait until the scheduler thread has processed it. Does nothing if the thread is not running, as no KeyDelay can be registered in that case.
+    void PostCommandAndWait(CommandType type, DWORD key);
+
+    // Start the scheduler thread if it is not running yet.
+    void EnsureThreadStarted();
+
+    // Arm or cancel the long press timer of a KeyDelay according to its state.
+    void UpdateTimer(KeyDelay& keyDelay);
+
+    static const size_t QueueCapacity = 256;
+    BoundedMpscQueue<Command, QueueCapacity> _commands;
+
+    // Auto-reset event used to wake up the scheduler thread when a command is posted
+    HANDLE _wakeEvent;
+
+    // Set on destruction to stop the scheduler thread
+    std::atomic<bool> _quit;
+
+    // Only accessed by the scheduler thread, except on destruction once the thread has stopped
+    std::map<DWORD, std::unique_ptr<KeyDelay>> _keyDelays;
+    TimerWheel _timerWheel;
+
+    std::thread _schedulerThread;
+    std::mutex _schedulerThread_mutex;
+};
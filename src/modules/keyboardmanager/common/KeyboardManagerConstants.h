@@ -43,6 +43,12 @@ namespace KeyboardManagerConstants
     // Name of the named mutex used for configuration file.
     inline const std::wstring ConfigFileMutexName = L"PowerToys.KeyboardManager.ConfigMutex";
 
+    // Extension of the precompiled binary profile written next to the JSON file of a configuration.
+    inline const std::wstring BinaryProfileExtension = L".kmbin";
+
+    // Name of the file the hook events are recorded to when KEYBOARDMANAGER_RECORD_HOOK_EVENTS is defined.
+    inline const std::wstring HookEventRecordingFileName = L"hook_events.kmrec";
+
     // Name of the dummy update file.
     inline const std::wstring DummyUpdateFileName = L"settings-updated.json";
 
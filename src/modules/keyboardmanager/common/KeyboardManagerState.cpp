@@ -3,13 +3,17 @@
 #include "Shortcut.h"
 #include "RemapShortcut.h"
 #include <../common/settings_helpers.h>
-#include "KeyDelay.h"
+#include "KeyDelayScheduler.h"
 #include "Helpers.h"
+#include "HookLatencyMetrics.h"
+#include "RemapProfile.h"
 
 // Constructor
 KeyboardManagerState::KeyboardManagerState() :
-    uiState(KeyboardManagerUIState::Deactivated), currentUIWindow(nullptr), currentShortcutUI1(nullptr), currentShortcutUI2(nullptr), currentSingleKeyUI(nullptr), detectedRemapKey(NULL), remappingsEnabled(true)
+    uiState(KeyboardManagerUIState::Deactivated), currentUIWindow(nullptr), currentShortcutUI1(nullptr), currentShortcutUI2(nullptr), currentSingleKeyUI(nullptr), detectedRemapKey(NULL), keyDelayScheduler(std::make_unique<KeyDelayScheduler>()), remapSnapshot(std::make_shared<RemapSnapshot>(RemapConfiguration())), remapSnapshotVersion(0), hookRemapSnapshotVersion(0)
 {
+    hookRemapSnapshot = remapSnapshot;
+
     configFile_mutex = CreateMutex(
         NULL, // default security descriptor
         FALSE, // mutex not owned
@@ -101,133 +105,196 @@ void KeyboardManagerState::ResetUIState()
     detectedRemapKey_lock.unlock();
 }
 
+// Function to compile and publish a new remap configuration. The caller must hold remapConfigurationUpdate_mutex
+void KeyboardManagerState::PublishRemapConfiguration(RemapConfiguration configuration)
+{
+    // The configuration is compiled before the snapshot mutex is taken so that the hook is never blocked by the compilation
+    std::shared_ptr<RemapSnapshot> snapshot = std::make_shared<RemapSnapshot>(std::move(configuration));
+
+    std::unique_lock<std::mutex> lock(remapSnapshot_mutex);
+    remapSnapshot.swap(snapshot);
+    lock.unlock();
+
+    remapSnapshotVersion.fetch_add(1, std::memory_order_release);
+}
+
+// Function to get the latest published remap configuration. This can be called from any thread
+std::shared_ptr<const RemapConfiguration> KeyboardManagerState::GetRemapConfiguration()
+{
+    std::lock_guard<std::mutex> lock(remapSnapshot_mutex);
+    return std::shared_ptr<const RemapConfiguration>(remapSnapshot, &remapSnapshot->GetConfiguration());
+}
+
+// Function to replace the remap configuration. The new configuration is compiled and swapped in atomically, so remaps keep being applied by the hook while the configuration is built
+void KeyboardManagerState::SetRemapConfiguration(RemapConfiguration configuration)
+{
+    std::lock_guard<std::mutex> lock(remapConfigurationUpdate_mutex);
+    PublishRemapConfiguration(std::move(configuration));
+}
+
+// Function to update the remap configuration. The update is applied to a copy of the latest configuration, which is then compiled and swapped in atomically
+void KeyboardManagerState::UpdateRemapConfiguration(std::function<void(RemapConfiguration&)> update)
+{
+    // The batch configuration is only accessed by the thread which opened the batch
+    if (remapConfigurationBatchThreadId.load() == GetCurrentThreadId())
+    {
+        update(*remapConfigurationBatch);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(remapConfigurationUpdate_mutex);
+    RemapConfiguration configuration(*GetRemapConfiguration());
+    update(configuration);
+    PublishRemapConfiguration(std::move(configuration));
+}
+
+// Function to open a batch of remap configuration updates. The updates made by the calling thread until EndRemapConfigurationBatch is called are published as a single configuration, and updates from other threads wait until then
+void KeyboardManagerState::BeginRemapConfigurationBatch()
+{
+    remapConfigurationBatch_lock = std::unique_lock<std::mutex>(remapConfigurationUpdate_mutex);
+    remapConfigurationBatch.emplace(*GetRemapConfiguration());
+    remapConfigurationBatchThreadId = GetCurrentThreadId();
+}
+
+// Function to compile and publish the configuration of the batch opened by the calling thread
+void KeyboardManagerState::EndRemapConfigurationBatch()
+{
+    remapConfigurationBatchThreadId = 0;
+    PublishRemapConfiguration(std::move(*remapConfigurationBatch));
+    remapConfigurationBatch.reset();
+    remapConfigurationBatch_lock.unlock();
+}
+
+// Function to get the remap snapshot used by the hook. The published snapshot is only loaded when a new one has been published, in which case the invoked shortcuts are carried over from the previous snapshot. This must only be called by the hook thread
+std::shared_ptr<RemapSnapshot> KeyboardManagerState::GetHookRemapSnapshot()
+{
+    uint64_t version = remapSnapshotVersion.load(std::memory_order_acquire);
+    if (version != hookRemapSnapshotVersion)
+    {
+        std::unique_lock<std::mutex> lock(remapSnapshot_mutex);
+        std::shared_ptr<RemapSnapshot> snapshot = remapSnapshot;
+        lock.unlock();
+
+        if (snapshot != hookRemapSnapshot)
+        {
+            snapshot->CopyInvokedRemapsFrom(*hookRemapSnapshot);
+            hookRemapSnapshot = snapshot;
+            isAppSpecificShortcutTargetCached = false;
+        }
+
+        hookRemapSnapshotVersion = version;
+    }
+
+    return hookRemapSnapshot;
+}
+
 // Function to clear the OS Level shortcut remapping table
 void KeyboardManagerState::ClearOSLevelShortcuts()
 {
-    osLevelShortcutReMap.clear();
-    osLevelShortcutReMapSortedKeys.clear();
+    UpdateRemapConfiguration([](RemapConfiguration& configuration) {
+        configuration.ClearOSLevelShortcuts();
+    });
 }
 
 // Function to clear the Keys remapping table.
 void KeyboardManagerState::ClearSingleKeyRemaps()
 {
-    singleKeyReMap.clear();
+    UpdateRemapConfiguration([](RemapConfiguration& configuration) {
+        configuration.ClearSingleKeyRemaps();
+    });
 }
 
 // Function to clear the App specific shortcut remapping table
 void KeyboardManagerState::ClearAppSpecificShortcuts()
 {
-    appSpecificShortcutReMap.clear();
-    appSpecificShortcutReMapSortedKeys.clear();
+    UpdateRemapConfiguration([](RemapConfiguration& configuration) {
+        configuration.ClearAppSpecificShortcuts();
+    });
 }
 
 // Function to add a new OS level shortcut remapping
 bool KeyboardManagerState::AddOSLevelShortcut(const Shortcut& originalSC, const KeyShortcutUnion& newSC)
 {
-    // Check if the shortcut is already remapped
-    auto it = osLevelShortcutReMap.find(originalSC);
-    if (it != osLevelShortcutReMap.end())
-    {
-        return false;
-    }
-
-    osLevelShortcutReMap[originalSC] = RemapShortcut(newSC);
-    osLevelShortcutReMapSortedKeys.push_back(originalSC);
-    KeyboardManagerHelper::SortShortcutVectorBasedOnSize(osLevelShortcutReMapSortedKeys);
+    bool result = false;
+    UpdateRemapConfiguration([&](RemapConfiguration& configuration) {
+        result = configuration.AddOSLevelShortcut(originalSC, newSC);
+    });
 
-    return true;
+    return result;
 }
 
 // Function to add a new single key to key/shortcut remapping
 bool KeyboardManagerState::AddSingleKeyRemap(const DWORD& originalKey, const KeyShortcutUnion& newRemapKey)
 {
-    // Check if the key is already remapped
-    auto it = singleKeyReMap.find(originalKey);
-    if (it != singleKeyReMap.end())
-    {
-        return false;
-    }
+    bool result = false;
+    UpdateRemapConfiguration([&](RemapConfiguration& configuration) {
+        result = configuration.AddSingleKeyRemap(originalKey, newRemapKey);
+    });
 
-    singleKeyReMap[originalKey] = newRemapKey;
-    return true;
+    return result;
 }
 
 // Function to add a new App specific shortcut remapping
 bool KeyboardManagerState::AddAppSpecificShortcut(const std::wstring& app, const Shortcut& originalSC, const KeyShortcutUnion& newSC)
 {
-    // Convert app name to lower case
-    std::wstring process_name;
-    process_name.resize(app.length());
-    std::transform(app.begin(), app.end(), process_name.begin(), towlower);
-
-    // Check if there are any app specific shortcuts for this app
-    auto appIt = appSpecificShortcutReMap.find(process_name);
-    if (appIt != appSpecificShortcutReMap.end())
-    {
-        // Check if the shortcut is already remapped
-        auto shortcutIt = appSpecificShortcutReMap[process_name].find(originalSC);
-        if (shortcutIt != appSpecificShortcutReMap[process_name].end())
-        {
-            return false;
-        }
-    }
-    else
-    {
-        appSpecificShortcutReMapSortedKeys[process_name] = std::vector<Shortcut>();
-    }
+    bool result = false;
+    UpdateRemapConfiguration([&](RemapConfiguration& configuration) {
+        result = configuration.AddAppSpecificShortcut(app, originalSC, newSC);
+    });
 
-    appSpecificShortcutReMap[process_name][originalSC] = RemapShortcut(newSC);
-    appSpecificShortcutReMapSortedKeys[process_name].push_back(originalSC);
-    KeyboardManagerHelper::SortShortcutVectorBasedOnSize(appSpecificShortcutReMapSortedKeys[process_name]);
-    return true;
+    return result;
 }
 
-// Function to get the iterator of a single key remap given the source key. Returns nullopt if it isn't remapped
-std::optional<SingleKeyRemapTable::iterator> KeyboardManagerState::GetSingleKeyRemap(const DWORD& originalKey)
+// Function to check if a shortcut of the given app (or an os level shortcut if appName is nullopt) is currently invoked. This must only be called by the hook thread
+bool KeyboardManagerState::CheckShortcutRemapInvoked(const std::optional<std::wstring>& appName)
 {
-    auto it = singleKeyReMap.find(originalKey);
-    if (it != singleKeyReMap.end())
-    {
-        return it;
-    }
-
-    return std::nullopt;
+    std::shared_ptr<RemapSnapshot> snapshot = GetHookRemapSnapshot();
+    const ShortcutDispatchTable* dispatchTable = snapshot->GetConfiguration().GetShortcutDispatchTable(appName ? &*appName : nullptr);
+    return dispatchTable != nullptr && snapshot->GetInvokedRemap(*dispatchTable) != ShortcutDispatchTable::NoRemap;
 }
 
-bool KeyboardManagerState::CheckShortcutRemapInvoked(const std::optional<std::wstring>& appName)
+// Function to get the runtime state of a shortcut remap given the source shortcut. A default state is returned if it isn't remapped. This must only be called by the hook thread
+ShortcutRemapState KeyboardManagerState::GetShortcutRemapState(const Shortcut& originalSC, const std::optional<std::wstring>& appName)
 {
-    // Assumes appName exists in the app-specific remap table
-    ShortcutRemapTable& currentRemapTable = appName ? appSpecificShortcutReMap[*appName] : osLevelShortcutReMap;
-    for (auto& it : currentRemapTable)
+    std::shared_ptr<RemapSnapshot> snapshot = GetHookRemapSnapshot();
+    const ShortcutDispatchTable* dispatchTable = snapshot->GetConfiguration().GetShortcutDispatchTable(appName ? &*appName : nullptr);
+    if (dispatchTable != nullptr)
     {
-        if (it.second.isShortcutInvoked)
+        size_t stateIndex = dispatchTable->FindRemap(originalSC);
+        if (stateIndex != ShortcutDispatchTable::NoRemap)
         {
-            return true;
+            return snapshot->GetShortcutRemapState(stateIndex);
         }
     }
 
-    return false;
+    return ShortcutRemapState();
 }
 
-std::vector<Shortcut>& KeyboardManagerState::GetSortedShortcutRemapVector(const std::optional<std::wstring>& appName)
+// Function to get the interned, lowercased name of the foreground process. Returns nullptr if it could not be resolved
+const std::wstring* KeyboardManagerState::GetForegroundApp(InputInterface& ii)
 {
-    // Assumes appName exists in the app-specific remap table
-    return appName ? appSpecificShortcutReMapSortedKeys[*appName] : osLevelShortcutReMapSortedKeys;
+    return foregroundAppResolver.GetForegroundApp(ii);
 }
 
-// Function to get the source and target of a shortcut remap given the source shortcut. Returns nullopt if it isn't remapped
-ShortcutRemapTable& KeyboardManagerState::GetShortcutRemapTable(const std::optional<std::wstring>& appName)
+// Function to get the app name in the app-specific remap table of the configuration which matches the foreground app. Returns nullptr if there are no app-specific remaps for the app. This must only be called by the hook thread with the configuration of the hook remap snapshot
+const std::wstring* KeyboardManagerState::GetAppSpecificShortcutTarget(const RemapConfiguration& configuration, const std::wstring* foregroundApp)
 {
-    if (appName)
+    // The lookup only has to be done again if the foreground app or the remap snapshot changes
+    if (isAppSpecificShortcutTargetCached && foregroundApp == cachedTargetForegroundApp)
     {
-        auto itTable = appSpecificShortcutReMap.find(*appName);
-        if (itTable != appSpecificShortcutReMap.end())
-        {
-            return itTable->second;
-        }
+        return cachedAppSpecificShortcutTarget;
     }
 
-    return osLevelShortcutReMap;
+    const std::wstring* target = nullptr;
+    if (foregroundApp != nullptr)
+    {
+        target = configuration.FindAppSpecificShortcutTarget(*foregroundApp);
+    }
+
+    cachedTargetForegroundApp = foregroundApp;
+    cachedAppSpecificShortcutTarget = target;
+    isAppSpecificShortcutTargetCached = true;
+    return target;
 }
 
 // Function to set the textblock of the detect shortcut UI so that it can be accessed by the hook
@@ -458,29 +525,41 @@ void KeyboardManagerState::RegisterKeyDelay(
         throw std::invalid_argument("This key was already registered.");
     }
 
-    keyDelays[key] = std::make_unique<KeyDelay>(key, onShortPress, onLongPressDetected, onLongPressReleased);
+    keyDelays.insert(key);
+    keyDelayScheduler->Register(key, onShortPress, onLongPressDetected, onLongPressReleased);
 }
 
 void KeyboardManagerState::UnregisterKeyDelay(DWORD key)
 {
-    std::lock_guard l(keyDelays_mutex);
-
-    auto deleted = keyDelays.erase(key);
-    if (deleted == 0)
     {
-        throw std::invalid_argument("The key was not previously registered.");
+        std::lock_guard l(keyDelays_mutex);
+
+        auto deleted = keyDelays.erase(key);
+        if (deleted == 0)
+        {
+            throw std::invalid_argument("The key was not previously registered.");
+        }
     }
+
+    // Wait outside of the lock so that the hook is not blocked while the scheduler thread finishes the current callback
+    keyDelayScheduler->Unregister(key);
 }
 
 // Function to clear all the registered key delays
 void KeyboardManagerState::ClearRegisteredKeyDelays()
 {
-    std::lock_guard l(keyDelays_mutex);
-    keyDelays.clear();
+    {
+        std::lock_guard l(keyDelays_mutex);
+        keyDelays.clear();
+    }
+
+    keyDelayScheduler->Clear();
 }
 
 bool KeyboardManagerState::HandleKeyDelayEvent(LowlevelKeyboardEvent* ev)
 {
+    KM_MEASURE_HOOK_LATENCY(KeyDelay);
+
     if (currentUIWindow != GetForegroundWindow())
     {
         return false;
@@ -493,7 +572,8 @@ bool KeyboardManagerState::HandleKeyDelayEvent(LowlevelKeyboardEvent* ev)
         return false;
     }
 
-    keyDelays[ev->lParam->vkCode]->KeyEvent(ev);
+    // The key is suppressed even if the event could not be queued because the scheduler is overloaded, as passing it through would send the raw key in the middle of a delayed key sequence
+    keyDelayScheduler->KeyEvent(ev);
     return true;
 }
 
@@ -501,83 +581,7 @@ bool KeyboardManagerState::HandleKeyDelayEvent(LowlevelKeyboardEvent* ev)
 bool KeyboardManagerState::SaveConfigToFile()
 {
     bool result = true;
-    json::JsonObject configJson;
-    json::JsonObject remapShortcuts;
-    json::JsonObject remapKeys;
-    json::JsonArray inProcessRemapKeysArray;
-    json::JsonArray appSpecificRemapShortcutsArray;
-    json::JsonArray globalRemapShortcutsArray;
-    for (const auto& it : singleKeyReMap)
-    {
-        json::JsonObject keys;
-        keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(winrt::to_hstring((unsigned int)it.first)));
-
-        // For key to key remapping
-        if (it.second.index() == 0)
-        {
-            keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(winrt::to_hstring((unsigned int)std::get<DWORD>(it.second))));
-        }
-
-        // For key to shortcut remapping
-        else
-        {
-            keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(std::get<Shortcut>(it.second).ToHstringVK()));
-        }
-
-        inProcessRemapKeysArray.Append(keys);
-    }
-
-    for (const auto& it : osLevelShortcutReMap)
-    {
-        json::JsonObject keys;
-        keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(it.first.ToHstringVK()));
-
-        // For shortcut to key remapping
-        if (it.second.targetShortcut.index() == 0)
-        {
-            keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(winrt::to_hstring((unsigned int)std::get<DWORD>(it.second.targetShortcut))));
-        }
-
-        // For shortcut to shortcut remapping
-        else
-        {
-            keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(std::get<Shortcut>(it.second.targetShortcut).ToHstringVK()));
-        }
-
-        globalRemapShortcutsArray.Append(keys);
-    }
-
-    for (const auto& itApp : appSpecificShortcutReMap)
-    {
-        // Iterate over apps
-        for (const auto& itKeys : itApp.second)
-        {
-            json::JsonObject keys;
-            keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(itKeys.first.ToHstringVK()));
-
-            // For shortcut to key remapping
-            if (itKeys.second.targetShortcut.index() == 0)
-            {
-                keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(winrt::to_hstring((unsigned int)std::get<DWORD>(itKeys.second.targetShortcut))));
-            }
-
-            // For shortcut to shortcut remapping
-            else
-            {
-                keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(std::get<Shortcut>(itKeys.second.targetShortcut).ToHstringVK()));
-            }
-
-            keys.SetNamedValue(KeyboardManagerConstants::TargetAppSettingName, json::value(itApp.first));
-
-            appSpecificRemapShortcutsArray.Append(keys);
-        }
-    }
-
-    remapShortcuts.SetNamedValue(KeyboardManagerConstants::GlobalRemapShortcutsSettingName, globalRemapShortcutsArray);
-    remapShortcuts.SetNamedValue(KeyboardManagerConstants::AppSpecificRemapShortcutsSettingName, appSpecificRemapShortcutsArray);
-    remapKeys.SetNamedValue(KeyboardManagerConstants::InProcessRemapKeysSettingName, inProcessRemapKeysArray);
-    configJson.SetNamedValue(KeyboardManagerConstants::RemapKeysSettingName, remapKeys);
-    configJson.SetNamedValue(KeyboardManagerConstants::RemapShortcutsSettingName, remapShortcuts);
+    std::shared_ptr<const RemapConfiguration> remapConfiguration = GetRemapConfiguration();
 
     // Set timeout of 1sec to wait for file to get free.
     DWORD timeout = 1000;
@@ -588,7 +592,14 @@ bool KeyboardManagerState::SaveConfigToFile()
     {
         try
         {
-            json::to_file((PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + GetCurrentConfigName() + L".json"), configJson);
+            // The binary profile is written next to the JSON file so that the configuration can be loaded without parsing the JSON
+            std::wstring configPath = PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + GetCurrentConfigName() + L".json";
+            RemapProfile::SaveToFile(*remapConfiguration, configPath);
+
+            // Remember the write time of the saved file so that the configuration watcher does not reload it
+            std::lock_guard<std::mutex> lock(savedConfig_mutex);
+            savedConfigWriteTime = std::filesystem::last_write_time(configPath);
+            savedConfigPath = configPath;
         }
         catch (...)
         {
@@ -606,6 +617,16 @@ bool KeyboardManagerState::SaveConfigToFile()
     return result;
 }
 
+// Checks if the configuration file is unchanged since it was written by SaveConfigToFile.
+bool KeyboardManagerState::IsConfigFileUnchangedSinceSave(const std::wstring& configPath)
+{
+    std::error_code error;
+    auto writeTime = std::filesystem::last_write_time(configPath, error);
+
+    std::lock_guard<std::mutex> lock(savedConfig_mutex);
+    return !error && _wcsicmp(configPath.c_str(), savedConfigPath.c_str()) == 0 && writeTime == savedConfigWriteTime;
+}
+
 void KeyboardManagerState::SetCurrentConfigName(const std::wstring& configName)
 {
     std::lock_guard<std::mutex> lock(currentConfig_mutex);
@@ -625,24 +646,7 @@ void KeyboardManagerState::SetActivatedApp(const std::wstring& appName)
 }
 
 // Gets the activated target application in app-specfic shortcut
-std::wstring KeyboardManagerState::GetActivatedApp()
+const std::wstring& KeyboardManagerState::GetActivatedApp() const
 {
     return activatedAppSpecificShortcutTarget;
 }
-
-bool KeyboardManagerState::AreRemappingsEnabled()
-{
-    return remappingsEnabled;
-}
-
-void KeyboardManagerState::RemappingsDisabledWrapper(std::function<void()> method)
-{
-    // Disable keyboard remappings
-    remappingsEnabled = false;
-
-    // Run the method which requires the remappings to be disabled
-    method();
-
-    // Re-enable the keyboard remappings
-    remappingsEnabled = true;
-}
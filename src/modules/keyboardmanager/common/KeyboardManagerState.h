@@ -1,14 +1,23 @@
 #pragma once
 #include <mutex>
+#include <memory>
+#include <atomic>
 #include "KeyboardManagerConstants.h"
 #include "../common/keyboard_layout.h"
 #include "../common/LowlevelKeyboardEvent.h"
 #include <functional>
 #include <variant>
+#include <set>
+#include <filesystem>
 #include "Shortcut.h"
 #include "RemapShortcut.h"
+#include "ShortcutDispatchTable.h"
+#include "RemapConfiguration.h"
+#include "RemapSnapshot.h"
+#include "ForegroundAppResolver.h"
 
-class KeyDelay;
+class KeyDelayScheduler;
+class InputInterface;
 
 namespace KeyboardManagerHelper
 {
@@ -20,10 +29,6 @@ namespace winrt::Windows::UI::Xaml::Controls
     struct StackPanel;
 }
 
-using SingleKeyRemapTable = std::unordered_map<DWORD, KeyShortcutUnion>;
-using ShortcutRemapTable = std::map<Shortcut, RemapShortcut>;
-using AppSpecificShortcutRemapTable = std::map<std::wstring, ShortcutRemapTable>;
-
 // Enum type to store different states of the UI
 enum class KeyboardManagerUIState
 {
@@ -81,39 +86,55 @@ private:
     // Handle of named mutex used for configuration file.
     HANDLE configFile_mutex;
 
-    // Registered KeyDelay objects, used to notify delayed key events.
-    std::map<DWORD, std::unique_ptr<KeyDelay>> keyDelays;
+    // Path and last write time of the configuration file written by SaveConfigToFile, used to ignore the change notifications of the editor's own saves.
+    std::wstring savedConfigPath;
+    std::filesystem::file_time_type savedConfigWriteTime;
+    std::mutex savedConfig_mutex;
+
+    // Virtual keys with a registered KeyDelay, used to filter the key events sent to the key delay scheduler.
+    std::set<DWORD> keyDelays;
     std::mutex keyDelays_mutex;
 
+    // Single thread running the state machines of all the registered KeyDelay objects.
+    std::unique_ptr<KeyDelayScheduler> keyDelayScheduler;
+
     // Stores the activated target application in app-specfic shortcut
     std::wstring activatedAppSpecificShortcutTarget;
 
-    // Thread safe boolean value to check if remappings are currently enabled. This is used to disable remappings while the remap tables are being updated by the UI thread
-    std::atomic_bool remappingsEnabled;
+    // Resolves and caches the foreground process name used for app-specific shortcuts. Only accessed by the hook thread
+    ForegroundAppResolver foregroundAppResolver;
 
-    // Display a key by appending a border Control as a child of the panel.
-    void AddKeyToLayout(const winrt::Windows::UI::Xaml::Controls::StackPanel& panel, const winrt::hstring& key);
+    // Cached result of GetAppSpecificShortcutTarget for the last foreground app id. Reset whenever the hook switches to a new remap snapshot
+    const std::wstring* cachedTargetForegroundApp = nullptr;
+    const std::wstring* cachedAppSpecificShortcutTarget = nullptr;
+    bool isAppSpecificShortcutTargetCached = false;
 
-public:
-    // The map members and their mutexes are left as public since the maps are used extensively in dllmain.cpp.
-    // Maps which store the remappings for each of the features. The bool fields should be initialized to false. They are used to check the current state of the shortcut (i.e is that particular shortcut currently pressed down or not).
-    // Stores single key remappings
-    std::unordered_map<DWORD, KeyShortcutUnion> singleKeyReMap;
+    // Latest published remap snapshot. The pointer is only copied under the mutex, the snapshot itself is immutable apart from the runtime state which belongs to the hook
+    std::shared_ptr<RemapSnapshot> remapSnapshot;
+    std::mutex remapSnapshot_mutex;
 
-    /* This feature has not been enabled (code from proof of concept stage)
-    * 
-    // Stores keys which need to be changed from toggle behavior to modifier behavior. Eg. Caps Lock
-    std::unordered_map<DWORD, bool> singleKeyToggleToMod;
-    */
+    // Incremented every time a new remap snapshot is published. The hook compares it with the version of the snapshot it is using, so the published pointer only has to be copied when it changes
+    std::atomic<uint64_t> remapSnapshotVersion;
 
-    // Stores the os level shortcut remappings
-    ShortcutRemapTable osLevelShortcutReMap;
-    std::vector<Shortcut> osLevelShortcutReMapSortedKeys;
+    // Mutex used to serialize updates of the remap configuration, so that concurrent read-modify-write updates from the UI and load_config are not lost
+    std::mutex remapConfigurationUpdate_mutex;
 
-    // Stores the app-specific shortcut remappings. Maps application name to the shortcut map
-    AppSpecificShortcutRemapTable appSpecificShortcutReMap;
-    std::map<std::wstring, std::vector<Shortcut>> appSpecificShortcutReMapSortedKeys;
+    // Configuration collecting the changes made while a batch is open, along with the thread which opened the batch. The batch holds remapConfigurationUpdate_mutex until it is ended
+    std::optional<RemapConfiguration> remapConfigurationBatch;
+    std::unique_lock<std::mutex> remapConfigurationBatch_lock;
+    std::atomic<DWORD> remapConfigurationBatchThreadId{ 0 };
 
+    // Remap snapshot currently used by the hook and its version. Only accessed by the hook thread
+    std::shared_ptr<RemapSnapshot> hookRemapSnapshot;
+    uint64_t hookRemapSnapshotVersion;
+
+    // Function to compile and publish a new remap configuration. The caller must hold remapConfigurationUpdate_mutex
+    void PublishRemapConfiguration(RemapConfiguration configuration);
+
+    // Display a key by appending a border Control as a child of the panel.
+    void AddKeyToLayout(const winrt::Windows::UI::Xaml::Controls::StackPanel& panel, const winrt::hstring& key);
+
+public:
     // Stores the keyboard layout
     LayoutMap keyboardMap;
 
@@ -135,7 +156,25 @@ public:
     // Function to set the UI state. When a window is activated, the handle to the window can be passed in the windowHandle argument.
     void SetUIState(KeyboardManagerUIState state, HWND windowHandle = nullptr);
 
-    // Function to clear the OS Level shortcut remapping table
+    // Function to get the latest published remap configuration. This can be called from any thread
+    std::shared_ptr<const RemapConfiguration> GetRemapConfiguration();
+
+    // Function to replace the remap configuration. The new configuration is compiled and swapped in atomically, so remaps keep being applied by the hook while the configuration is built
+    void SetRemapConfiguration(RemapConfiguration configuration);
+
+    // Function to update the remap configuration. The update is applied to a copy of the latest configuration, which is then compiled and swapped in atomically. If the calling thread has opened a batch, the update is applied to the batch configuration instead
+    void UpdateRemapConfiguration(std::function<void(RemapConfiguration&)> update);
+
+    // Function to open a batch of remap configuration updates. The updates made by the calling thread until EndRemapConfigurationBatch is called are published as a single configuration, and updates from other threads wait until then
+    void BeginRemapConfigurationBatch();
+
+    // Function to compile and publish the configuration of the batch opened by the calling thread
+    void EndRemapConfigurationBatch();
+
+    // Function to get the remap snapshot used by the hook. The published snapshot is only loaded when a new one has been published, in which case the invoked shortcuts are carried over from the previous snapshot. This must only be called by the hook thread
+    std::shared_ptr<RemapSnapshot> GetHookRemapSnapshot();
+
+    // Function to clear the OS Level shortcut remapping table. Each of the clear and add functions below publishes a new configuration unless a batch is open, so a batch or UpdateRemapConfiguration should be used to apply multiple changes at once
     void ClearOSLevelShortcuts();
 
     // Function to clear the Keys remapping table
@@ -153,15 +192,17 @@ public:
     // Function to add a new App specific level shortcut remapping
     bool AddAppSpecificShortcut(const std::wstring& app, const Shortcut& originalSC, const KeyShortcutUnion& newSC);
 
-    // Function to get the iterator of a single key remap given the source key. Returns nullopt if it isn't remapped
-    std::optional<SingleKeyRemapTable::iterator> GetSingleKeyRemap(const DWORD& originalKey);
-
+    // Function to check if a shortcut of the given app (or an os level shortcut if appName is nullopt) is currently invoked. This must only be called by the hook thread
     bool CheckShortcutRemapInvoked(const std::optional<std::wstring>& appName);
 
-    std::vector<Shortcut>& GetSortedShortcutRemapVector(const std::optional<std::wstring>& appName);
+    // Function to get the runtime state of a shortcut remap given the source shortcut. A default state is returned if it isn't remapped. This must only be called by the hook thread
+    ShortcutRemapState GetShortcutRemapState(const Shortcut& originalSC, const std::optional<std::wstring>& appName = std::nullopt);
+
+    // Function to get the interned, lowercased name of the foreground process. Returns nullptr if it could not be resolved
+    const std::wstring* GetForegroundApp(InputInterface& ii);
 
-    // Function to get the source and target of a shortcut remap given the source shortcut. Returns nullopt if it isn't remapped
-    ShortcutRemapTable& GetShortcutRemapTable(const std::optional<std::wstring>& appName);
+    // Function to get the app name in the app-specific remap table of the configuration which matches the foreground app. Returns nullptr if there are no app-specific remaps for the app. This must only be called by the hook thread with the configuration of the hook remap snapshot
+    const std::wstring* GetAppSpecificShortcutTarget(const RemapConfiguration& configuration, const std::wstring* foregroundApp);
 
     // Function to set the textblock of the detect shortcut UI so that it can be accessed by the hook
     void ConfigureDetectShortcutUI(const winrt::Windows::UI::Xaml::Controls::StackPanel& textBlock1, const winrt::Windows::UI::Xaml::Controls::StackPanel& textBlock2);
@@ -219,6 +260,9 @@ public:
     // Save the updated configuration.
     bool SaveConfigToFile();
 
+    // Checks if the configuration file is unchanged since it was written by SaveConfigToFile.
+    bool IsConfigFileUnchangedSinceSave(const std::wstring& configPath);
+
     // Sets the Current Active Configuration Name.
     void SetCurrentConfigName(const std::wstring& configName);
 
@@ -229,9 +273,5 @@ public:
     void SetActivatedApp(const std::wstring& appName);
 
     // Gets the activated target application in app-specfic shortcut
-    std::wstring GetActivatedApp();
-
-    bool AreRemappingsEnabled();
-
-    void RemappingsDisabledWrapper(std::function<void()> method);
+    const std::wstring& GetActivatedApp() const;
 };
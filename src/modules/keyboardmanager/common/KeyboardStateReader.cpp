@@ -0,0 +1,32 @@
+#include "pch.h"
+#include "KeyboardStateReader.h"
+#include "InputInterface.h"
+
+// Function to check if a key is pressed down
+bool KeyboardStateReader::IsKeyPressed(DWORD key)
+{
+    if (key >= readKeys.size())
+    {
+        return false;
+    }
+
+    if (!readKeys[key])
+    {
+        pressedKeys[key] = ii.GetVirtualKeyState(key);
+        readKeys.set(key);
+    }
+
+    return pressedKeys[key];
+}
+
+// Function to get the state of all the keys. The keyboard state is only read the first time this is called
+const KeyboardStateSnapshot& KeyboardStateReader::GetSnapshot()
+{
+    if (!readKeys.all())
+    {
+        pressedKeys = ii.GetKeyboardStateSnapshot();
+        readKeys.set();
+    }
+
+    return pressedKeys;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "KeyboardStateSnapshot.h"
+
+class InputInterface;
+
+// Class which reads the key states needed by the shortcut checks of a single key event. Each key is queried at most once per event, and the state of all the keys is only read when a check needs it, e.g. to check that no other keys are pressed down
+class KeyboardStateReader
+{
+private:
+    InputInterface& ii;
+
+    // Keys which have already been queried, and the state of those keys
+    KeyboardStateSnapshot readKeys;
+    KeyboardStateSnapshot pressedKeys;
+
+public:
+    KeyboardStateReader(InputInterface& ii) :
+        ii(ii)
+    {
+    }
+
+    // Function to check if a key is pressed down
+    bool IsKeyPressed(DWORD key);
+
+    // Function to get the state of all the keys. The keyboard state is only read the first time this is called
+    const KeyboardStateSnapshot& GetSnapshot();
+};
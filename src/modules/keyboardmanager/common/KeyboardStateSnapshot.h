@@ -0,0 +1,5 @@
+#pragma once
+#include <bitset>
+
+// Snapshot of the state of all the virtual keys, where the bit at the index of a key code is set if the key is pressed down. This is used to check if any keys are pressed down apart from those of a shortcut with bitmask operations
+using KeyboardStateSnapshot = std::bitset<256>;
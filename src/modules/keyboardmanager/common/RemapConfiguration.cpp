@@ -0,0 +1,171 @@
+#include "pch.h"
+#include "RemapConfiguration.h"
+#include "Helpers.h"
+
+// Copy constructor. Only the remap tables are copied, Compile has to be called before the dispatch tables of the copy are used
+RemapConfiguration::RemapConfiguration(const RemapConfiguration& other) :
+    singleKeyReMap(other.singleKeyReMap), osLevelShortcutReMap(other.osLevelShortcutReMap), appSpecificShortcutReMap(other.appSpecificShortcutReMap)
+{
+}
+
+// Function to clear the OS Level shortcut remapping table
+void RemapConfiguration::ClearOSLevelShortcuts()
+{
+    osLevelShortcutReMap.clear();
+}
+
+// Function to clear the Keys remapping table.
+void RemapConfiguration::ClearSingleKeyRemaps()
+{
+    singleKeyReMap.clear();
+}
+
+// Function to clear the App specific shortcut remapping table
+void RemapConfiguration::ClearAppSpecificShortcuts()
+{
+    appSpecificShortcutReMap.clear();
+}
+
+// Function to add a new single key to key/shortcut remapping
+bool RemapConfiguration::AddSingleKeyRemap(const DWORD& originalKey, const KeyShortcutUnion& newRemapKey)
+{
+    // Check if the key is already remapped
+    auto it = singleKeyReMap.find(originalKey);
+    if (it != singleKeyReMap.end())
+    {
+        return false;
+    }
+
+    singleKeyReMap[originalKey] = newRemapKey;
+    return true;
+}
+
+// Function to add a new OS level shortcut remapping
+bool RemapConfiguration::AddOSLevelShortcut(const Shortcut& originalSC, const KeyShortcutUnion& newSC)
+{
+    // Check if the shortcut is already remapped
+    auto it = osLevelShortcutReMap.find(originalSC);
+    if (it != osLevelShortcutReMap.end())
+    {
+        return false;
+    }
+
+    osLevelShortcutReMap[originalSC] = RemapShortcut(newSC);
+    return true;
+}
+
+// Function to add a new App specific shortcut remapping
+bool RemapConfiguration::AddAppSpecificShortcut(const std::wstring& app, const Shortcut& originalSC, const KeyShortcutUnion& newSC)
+{
+    // Convert app name to lower case
+    std::wstring process_name;
+    process_name.resize(app.length());
+    std::transform(app.begin(), app.end(), process_name.begin(), towlower);
+
+    // Check if the shortcut is already remapped for this app
+    auto& appTable = appSpecificShortcutReMap[process_name];
+    auto shortcutIt = appTable.find(originalSC);
+    if (shortcutIt != appTable.end())
+    {
+        return false;
+    }
+
+    appTable[originalSC] = RemapShortcut(newSC);
+    return true;
+}
+
+// Function to build the dispatch table for a remap table, with the shortcuts sorted by size so that longer shortcuts have priority
+static void CompileDispatchTable(ShortcutDispatchTable& dispatchTable, const ShortcutRemapTable& remapTable, size_t& tableIndex, size_t& stateIndex)
+{
+    std::vector<Shortcut> sortedShortcuts;
+    sortedShortcuts.reserve(remapTable.size());
+    for (const auto& it : remapTable)
+    {
+        sortedShortcuts.push_back(it.first);
+    }
+    KeyboardManagerHelper::SortShortcutVectorBasedOnSize(sortedShortcuts);
+
+    dispatchTable.Build(tableIndex, sortedShortcuts, remapTable, stateIndex);
+    tableIndex++;
+    stateIndex += dispatchTable.Size();
+}
+
+// Function to build the dispatch tables and assign the state indices of the shortcut remaps. This has to be called after the remap tables are modified and before the configuration is published
+void RemapConfiguration::Compile()
+{
+    size_t tableIndex = 0;
+    size_t stateIndex = 0;
+
+    CompileDispatchTable(osLevelShortcutDispatch, osLevelShortcutReMap, tableIndex, stateIndex);
+
+    appSpecificShortcutDispatch.clear();
+    for (const auto& itApp : appSpecificShortcutReMap)
+    {
+        CompileDispatchTable(appSpecificShortcutDispatch[itApp.first], itApp.second, tableIndex, stateIndex);
+    }
+
+    dispatchTableCount = tableIndex;
+    shortcutRemapCount = stateIndex;
+}
+
+// Function to get the app name in the app-specific remap table which matches the foreground app, either by the process name or the process name without its file extension. Returns nullptr if there are no app-specific remaps for the app
+const std::wstring* RemapConfiguration::FindAppSpecificShortcutTarget(const std::wstring& foregroundApp) const
+{
+    auto it = appSpecificShortcutReMap.find(foregroundApp);
+
+    // If no entry is found, search for the process name without it's file extension
+    if (it == appSpecificShortcutReMap.end())
+    {
+        // Find index of the file extension
+        size_t extensionIndex = foregroundApp.find_last_of(L".");
+        it = appSpecificShortcutReMap.find(foregroundApp.substr(0, extensionIndex));
+    }
+
+    if (it != appSpecificShortcutReMap.end())
+    {
+        return &it->first;
+    }
+
+    return nullptr;
+}
+
+// Function to get the compiled dispatch table for the os level shortcut remaps
+const ShortcutDispatchTable& RemapConfiguration::GetOSLevelShortcutDispatchTable() const
+{
+    return osLevelShortcutDispatch;
+}
+
+// Function to get the compiled dispatch table for the shortcut remaps of an app. Returns nullptr if there are no app-specific remaps for the app
+const ShortcutDispatchTable* RemapConfiguration::GetAppSpecificShortcutDispatchTable(const std::wstring& appName) const
+{
+    auto itTable = appSpecificShortcutDispatch.find(appName);
+    if (itTable != appSpecificShortcutDispatch.end())
+    {
+        return &itTable->second;
+    }
+
+    return nullptr;
+}
+
+// Function to get the compiled dispatch table for the shortcut remaps of the given app, or the os level shortcut remaps if appName is nullptr. Returns nullptr if there are no app-specific remaps for the app
+const ShortcutDispatchTable* RemapConfiguration::GetShortcutDispatchTable(const std::wstring* appName) const
+{
+    if (appName)
+    {
+        return GetAppSpecificShortcutDispatchTable(*appName);
+    }
+
+    return &osLevelShortcutDispatch;
+}
+
+// Function to get the total number of shortcut remaps in the compiled configuration
+size_t RemapConfiguration::GetShortcutRemapCount() const
+{
+    return shortcutRemapCount;
+}
+
+// Function to get the number of compiled dispatch tables
+size_t RemapConfiguration::GetDispatchTableCount() const
+{
+    return dispatchTableCount;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include "Shortcut.h"
+#include "RemapShortcut.h"
+#include "ShortcutDispatchTable.h"
+
+using SingleKeyRemapTable = std::unordered_map<DWORD, KeyShortcutUnion>;
+using AppSpecificShortcutRemapTable = std::map<std::wstring, ShortcutRemapTable>;
+
+// Class which stores a complete remap configuration along with the dispatch tables compiled from it. A configuration is built by the UI or by load_config and is immutable once it has been compiled and published to the hook, so it can be read by the hook without any locks
+class RemapConfiguration
+{
+private:
+    // Compiled dispatch tables for the os level and app-specific shortcut remaps. The tables point into the remap tables below, so they are rebuilt by Compile instead of being copied
+    ShortcutDispatchTable osLevelShortcutDispatch;
+    std::map<std::wstring, ShortcutDispatchTable> appSpecificShortcutDispatch;
+
+    // Total number of shortcut remaps and dispatch tables, used to size the runtime state arrays of a snapshot
+    size_t shortcutRemapCount = 0;
+    size_t dispatchTableCount = 0;
+
+public:
+    // Stores single key remappings
+    SingleKeyRemapTable singleKeyReMap;
+
+    // Stores the os level shortcut remappings
+    ShortcutRemapTable osLevelShortcutReMap;
+
+    // Stores the app-specific shortcut remappings. Maps application name to the shortcut map
+    AppSpecificShortcutRemapTable appSpecificShortcutReMap;
+
+    RemapConfiguration() = default;
+
+    // Copy constructor. Only the remap tables are copied, Compile has to be called before the dispatch tables of the copy are used
+    RemapConfiguration(const RemapConfiguration& other);
+
+    RemapConfiguration(RemapConfiguration&&) = default;
+    RemapConfiguration& operator=(RemapConfiguration&&) = default;
+    RemapConfiguration& operator=(const RemapConfiguration&) = delete;
+
+    // Function to clear the OS Level shortcut remapping table
+    void ClearOSLevelShortcuts();
+
+    // Function to clear the Keys remapping table
+    void ClearSingleKeyRemaps();
+
+    // Function to clear the App specific shortcut remapping table
+    void ClearAppSpecificShortcuts();
+
+    // Function to add a new single key to key remapping
+    bool AddSingleKeyRemap(const DWORD& originalKey, const KeyShortcutUnion& newRemapKey);
+
+    // Function to add a new OS level shortcut remapping
+    bool AddOSLevelShortcut(const Shortcut& originalSC, const KeyShortcutUnion& newSC);
+
+    // Function to add a new App specific level shortcut remapping
+    bool AddAppSpecificShortcut(const std::wstring& app, const Shortcut& originalSC, const KeyShortcutUnion& newSC);
+
+    // Function to build the dispatch tables and assign the state indices of the shortcut remaps. This has to be called after the remap tables are modified and before the configuration is published
+    void Compile();
+
+    // Function to get the app name in the app-specific remap table which matches the foreground app, either by the process name or the process name without its file extension. Returns nullptr if there are no app-specific remaps for the app
+    const std::wstring* FindAppSpecificShortcutTarget(const std::wstring& foregroundApp) const;
+
+    // Function to get the compiled dispatch table for the os level shortcut remaps
+    const ShortcutDispatchTable& GetOSLevelShortcutDispatchTable() const;
+
+    // Function to get the compiled dispatch table for the shortcut remaps of an app. Returns nullptr if there are no app-specific remaps for the app
+    const ShortcutDispatchTable* GetAppSpecificShortcutDispatchTable(const std::wstring& appName) const;
+
+    // Function to get the compiled dispatch table for the shortcut remaps of the given app, or the os level shortcut remaps if appName is nullptr. Returns nullptr if there are no app-specific remaps for the app
+    const ShortcutDispatchTable* GetShortcutDispatchTable(const std::wstring* appName) const;
+
+    // Function to get the total number of shortcut remaps in the compiled configuration
+    size_t GetShortcutRemapCount() const;
+
+    // Function to get the number of compiled dispatch tables
+    size_t GetDispatchTableCount() const;
+};
@@ -0,0 +1,652 @@
+#include "pch.h"
+#include "RemapProfile.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include "KeyboardManagerConstants.h"
+
+namespace
+{
+    // "KMBN" in little endian
+    const uint32_t BinaryProfileMagic = 0x4E424D4B;
+
+    // Number of key codes stored for a shortcut: win, ctrl, alt, shift and action key, or 0 if the key is not part of the shortcut
+    const size_t ShortcutKeyCount = 5;
+
+    // Header of a binary profile. It is followed by the payload: the single key remaps, the os level shortcut remaps, the apps, the app-specific shortcut remaps grouped by app in the order of the apps, and the string table holding the app names
+    struct BinaryProfileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t jsonChecksum;
+        uint64_t payloadChecksum;
+        uint64_t payloadSize;
+        uint32_t singleKeyRemapCount;
+        uint32_t osLevelShortcutRemapCount;
+        uint32_t appCount;
+        uint32_t appSpecificShortcutRemapCount;
+        uint32_t stringTableLength;
+        uint32_t reserved;
+    };
+
+    // Remap target, either a key in keys[0] or a shortcut
+    struct BinaryKeyShortcut
+    {
+        uint32_t isShortcut;
+        uint32_t keys[ShortcutKeyCount];
+    };
+
+    struct BinarySingleKeyRemap
+    {
+        uint32_t originalKey;
+        BinaryKeyShortcut newRemapKey;
+    };
+
+    struct BinaryShortcutRemap
+    {
+        uint32_t originalKeys[ShortcutKeyCount];
+        BinaryKeyShortcut newRemapKeys;
+    };
+
+    // App name as an offset and length in the string table, in characters
+    struct BinaryApp
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t remapCount;
+    };
+
+    static_assert(sizeof(BinaryProfileHeader) == 56, "The binary profile header must not have padding.");
+    static_assert(sizeof(BinarySingleKeyRemap) == 28 && sizeof(BinaryShortcutRemap) == 44 && sizeof(BinaryApp) == 12, "The binary profile records must not have padding.");
+
+    void EncodeShortcut(const Shortcut& shortcut, uint32_t (&keys)[ShortcutKeyCount])
+    {
+        keys[0] = shortcut.GetWinKey(ModifierKey::Both);
+        keys[1] = shortcut.GetCtrlKey();
+        keys[2] = shortcut.GetAltKey();
+        keys[3] = shortcut.GetShiftKey();
+        keys[4] = shortcut.GetActionKey();
+    }
+
+    // The keys are set in the same way as when a shortcut is parsed from its JSON string
+    Shortcut DecodeShortcut(const uint32_t (&keys)[ShortcutKeyCount])
+    {
+        Shortcut shortcut;
+        for (uint32_t key : keys)
+        {
+            if (key != 0)
+            {
+                shortcut.SetKey(key);
+            }
+        }
+
+        return shortcut;
+    }
+
+    BinaryKeyShortcut EncodeKeyShortcut(const KeyShortcutUnion& keyShortcut)
+    {
+        BinaryKeyShortcut result = {};
+        if (keyShortcut.index() == 0)
+        {
+            result.keys[0] = std::get<DWORD>(keyShortcut);
+        }
+        else
+        {
+            result.isShortcut = 1;
+            EncodeShortcut(std::get<Shortcut>(keyShortcut), result.keys);
+        }
+
+        return result;
+    }
+
+    KeyShortcutUnion DecodeKeyShortcut(const BinaryKeyShortcut& keyShortcut)
+    {
+        if (keyShortcut.isShortcut)
+        {
+            return DecodeShortcut(keyShortcut.keys);
+        }
+
+        return (DWORD)keyShortcut.keys[0];
+    }
+
+    BinaryShortcutRemap EncodeShortcutRemap(const Shortcut& originalKeys, const RemapShortcut& remap)
+    {
+        BinaryShortcutRemap result = {};
+        EncodeShortcut(originalKeys, result.originalKeys);
+        result.newRemapKeys = EncodeKeyShortcut(remap.targetShortcut);
+        return result;
+    }
+
+    template<typename T>
+    void Append(std::vector<BYTE>& buffer, const T* data, size_t count)
+    {
+        const BYTE* bytes = reinterpret_cast<const BYTE*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    // Function to read the whole content of a file. Returns false if the file cannot be opened
+    bool ReadFileContent(const std::wstring& path, std::string& content)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        using isbi = std::istreambuf_iterator<char>;
+        content.assign(isbi{ file }, isbi{});
+        return true;
+    }
+
+    // Function to load the remaps of a mapped binary profile after its header has been validated
+    bool LoadBinaryPayload(const BinaryProfileHeader& header, const BYTE* payload, RemapConfiguration& remapConfiguration)
+    {
+        const BinarySingleKeyRemap* singleKeyRemaps = reinterpret_cast<const BinarySingleKeyRemap*>(payload);
+        const BinaryShortcutRemap* osLevelShortcutRemaps = reinterpret_cast<const BinaryShortcutRemap*>(singleKeyRemaps + header.singleKeyRemapCount);
+        const BinaryApp* apps = reinterpret_cast<const BinaryApp*>(osLevelShortcutRemaps + header.osLevelShortcutRemapCount);
+        const BinaryShortcutRemap* appSpecificShortcutRemaps = reinterpret_cast<const BinaryShortcutRemap*>(apps + header.appCount);
+        const wchar_t* stringTable = reinterpret_cast<const wchar_t*>(appSpecificShortcutRemaps + header.appSpecificShortcutRemapCount);
+
+        for (uint32_t i = 0; i < header.singleKeyRemapCount; i++)
+        {
+            remapConfiguration.AddSingleKeyRemap(singleKeyRemaps[i].originalKey, DecodeKeyShortcut(singleKeyRemaps[i].newRemapKey));
+        }
+
+        for (uint32_t i = 0; i < header.osLevelShortcutRemapCount; i++)
+        {
+            remapConfiguration.AddOSLevelShortcut(DecodeShortcut(osLevelShortcutRemaps[i].originalKeys), DecodeKeyShortcut(osLevelShortcutRemaps[i].newRemapKeys));
+        }
+
+        uint64_t remapIndex = 0;
+        for (uint32_t i = 0; i < header.appCount; i++)
+        {
+            if ((uint64_t)apps[i].nameOffset + apps[i].nameLength > header.stringTableLength || remapIndex + apps[i].remapCount > header.appSpecificShortcutRemapCount)
+            {
+                return false;
+            }
+
+            std::wstring appName(stringTable + apps[i].nameOffset, apps[i].nameLength);
+            for (uint32_t j = 0; j < apps[i].remapCount; j++, remapIndex++)
+            {
+                remapConfiguration.AddAppSpecificShortcut(appName, DecodeShortcut(appSpecificShortcutRemaps[remapIndex].originalKeys), DecodeKeyShortcut(appSpecificShortcutRemaps[remapIndex].newRemapKeys));
+            }
+        }
+
+        return remapIndex == header.appSpecificShortcutRemapCount;
+    }
+}
+
+namespace RemapProfile
+{
+    // Function to compute the FNV-1a checksum of a buffer
+    uint64_t ComputeChecksum(const void* data, size_t size)
+    {
+        const BYTE* bytes = static_cast<const BYTE*>(data);
+        uint64_t checksum = 14695981039346656037ull;
+        for (size_t i = 0; i < size; i++)
+        {
+            checksum ^= bytes[i];
+            checksum *= 1099511628211ull;
+        }
+
+        return checksum;
+    }
+
+    // Function to get the path of the binary profile for a JSON configuration file
+    std::wstring GetBinaryProfilePath(const std::wstring& jsonPath)
+    {
+        return std::filesystem::path(jsonPath).replace_extension(KeyboardManagerConstants::BinaryProfileExtension).wstring();
+    }
+
+    // Function to convert a remap configuration to its JSON representation
+    json::JsonObject ToJson(const RemapConfiguration& remapConfiguration)
+    {
+        json::JsonObject configJson;
+        json::JsonObject remapShortcuts;
+        json::JsonObject remapKeys;
+        json::JsonArray inProcessRemapKeysArray;
+        json::JsonArray appSpecificRemapShortcutsArray;
+        json::JsonArray globalRemapShortcutsArray;
+        for (const auto& it : remapConfiguration.singleKeyReMap)
+        {
+            json::JsonObject keys;
+            keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(winrt::to_hstring((unsigned int)it.first)));
+
+            // For key to key remapping
+            if (it.second.index() == 0)
+            {
+                keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(winrt::to_hstring((unsigned int)std::get<DWORD>(it.second))));
+            }
+
+            // For key to shortcut remapping
+            else
+            {
+                keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(std::get<Shortcut>(it.second).ToHstringVK()));
+            }
+
+            inProcessRemapKeysArray.Append(keys);
+        }
+
+        for (const auto& it : remapConfiguration.osLevelShortcutReMap)
+        {
+            json::JsonObject keys;
+            keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(it.first.ToHstringVK()));
+
+            // For shortcut to key remapping
+            if (it.second.targetShortcut.index() == 0)
+            {
+                keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(winrt::to_hstring((unsigned int)std::get<DWORD>(it.second.targetShortcut))));
+            }
+
+            // For shortcut to shortcut remapping
+            else
+            {
+                keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(std::get<Shortcut>(it.second.targetShortcut).ToHstringVK()));
+            }
+
+            globalRemapShortcutsArray.Append(keys);
+        }
+
+        for (const auto& itApp : remapConfiguration.appSpecificShortcutReMap)
+        {
+            // Iterate over apps
+            for (const auto& itKeys : itApp.second)
+            {
+                json::JsonObject keys;
+                keys.SetNamedValue(KeyboardManagerConstants::OriginalKeysSettingName, json::value(itKeys.first.ToHstringVK()));
+
+                // For shortcut to key remapping
+                if (itKeys.second.targetShortcut.index() == 0)
+                {
+                    keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(winrt::to_hstring((unsigned int)std::get<DWORD>(itKeys.second.targetShortcut))));
+                }
+
+                // For shortcut to shortcut remapping
+                else
+                {
+                    keys.SetNamedValue(KeyboardManagerConstants::NewRemapKeysSettingName, json::value(std::get<Shortcut>(itKeys.second.targetShortcut).ToHstringVK()));
+                }
+
+                keys.SetNamedValue(KeyboardManagerConstants::TargetAppSettingName, json::value(itApp.first));
+
+                appSpecificRemapShortcutsArray.Append(keys);
+            }
+        }
+
+        remapShortcuts.SetNamedValue(KeyboardManagerConstants::GlobalRemapShortcutsSettingName, globalRemapShortcutsArray);
+        remapShortcuts.SetNamedValue(KeyboardManagerConstants::AppSpecificRemapShortcutsSettingName, appSpecificRemapShortcutsArray);
+        remapKeys.SetNamedValue(KeyboardManagerConstants::InProcessRemapKeysSettingName, inProcessRemapKeysArray);
+        configJson.SetNamedValue(KeyboardManagerConstants::RemapKeysSettingName, remapKeys);
+        configJson.SetNamedValue(KeyboardManagerConstants::RemapShortcutsSettingName, remapShortcuts);
+        return configJson;
+    }
+
+    // Function to load the remaps of a JSON configuration. Each remap type is only replaced if it is present in the JSON, and improper entries are skipped
+    bool LoadFromJson(const json::JsonObject& jsonData, RemapConfiguration& remapConfiguration)
+    {
+        bool result = true;
+
+        // Load single key remaps
+        try
+        {
+            auto remapKeysData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapKeysSettingName);
+            remapConfiguration.ClearSingleKeyRemaps();
+
+            if (remapKeysData)
+            {
+                auto inProcessRemapKeys = remapKeysData.GetNamedArray(KeyboardManagerConstants::InProcessRemapKeysSettingName);
+                for (const auto& it : inProcessRemapKeys)
+                {
+                    try
+                    {
+                        auto originalKey = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
+                        auto newRemapKey = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
+
+                        // If remapped to a shortcut
+                        if (std::wstring(newRemapKey).find(L";") != std::string::npos)
+                        {
+                            remapConfiguration.AddSingleKeyRemap(std::stoul(originalKey.c_str()), Shortcut(newRemapKey.c_str()));
+                        }
+
+                        // If remapped to a key
+                        else
+                        {
+                            remapConfiguration.AddSingleKeyRemap(std::stoul(originalKey.c_str()), std::stoul(newRemapKey.c_str()));
+                        }
+                    }
+                    catch (...)
+                    {
+                        // Improper Key Data JSON. Try the next remap.
+                        result = false;
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            // Improper JSON format for single key remaps. Skip to next remap type
+            result = false;
+        }
+
+        // Load shortcut remaps
+        try
+        {
+            auto remapShortcutsData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapShortcutsSettingName);
+            remapConfiguration.ClearOSLevelShortcuts();
+            remapConfiguration.ClearAppSpecificShortcuts();
+            if (remapShortcutsData)
+            {
+                // Load os level shortcut remaps
+                try
+                {
+                    auto globalRemapShortcuts = remapShortcutsData.GetNamedArray(KeyboardManagerConstants::GlobalRemapShortcutsSettingName);
+                    for (const auto& it : globalRemapShortcuts)
+                    {
+                        try
+                        {
+                            auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
+                            auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
+
+                            // If remapped to a shortcut
+                            if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
+                            {
+                                remapConfiguration.AddOSLevelShortcut(Shortcut(originalKeys.c_str()), Shortcut(newRemapKeys.c_str()));
+                            }
+
+                            // If remapped to a key
+                            else
+                            {
+                                remapConfiguration.AddOSLevelShortcut(Shortcut(originalKeys.c_str()), std::stoul(newRemapKeys.c_str()));
+                            }
+                        }
+                        catch (...)
+                        {
+                            // Improper Key Data JSON. Try the next shortcut.
+                            result = false;
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    // Improper JSON format for os level shortcut remaps. Skip to next remap type
+                    result = false;
+                }
+
+                // Load app specific shortcut remaps
+                try
+                {
+                    auto appSpecificRemapShortcuts = remapShortcutsData.GetNamedArray(KeyboardManagerConstants::AppSpecificRemapShortcutsSettingName);
+                    for (const auto& it : appSpecificRemapShortcuts)
+                    {
+                        try
+                        {
+                            auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
+                            auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
+                            auto targetApp = it.GetObjectW().GetNamedString(KeyboardManagerConstants::TargetAppSettingName);
+
+                            // If remapped to a shortcut
+                            if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
+                            {
+                                remapConfiguration.AddAppSpecificShortcut(targetApp.c_str(), Shortcut(originalKeys.c_str()), Shortcut(newRemapKeys.c_str()));
+                            }
+
+                            // If remapped to a key
+                            else
+                            {
+                                remapConfiguration.AddAppSpecificShortcut(targetApp.c_str(), Shortcut(originalKeys.c_str()), std::stoul(newRemapKeys.c_str()));
+                            }
+                        }
+                        catch (...)
+                        {
+                            // Improper Key Data JSON. Try the next shortcut.
+                            result = false;
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    // Improper JSON format for os level shortcut remaps. Skip to next remap type
+                    result = false;
+                }
+            }
+        }
+        catch (...)
+        {
+            // Improper JSON format for shortcut remaps. Skip to next remap type
+            result = false;
+        }
+
+        return result;
+    }
+
+    // Function to write a binary profile for a configuration whose JSON has the given checksum
+    bool SaveBinaryProfile(const RemapConfiguration& remapConfiguration, uint64_t jsonChecksum, const std::wstring& binaryProfilePath)
+    {
+        std::vector<BinarySingleKeyRemap> singleKeyRemaps;
+        singleKeyRemaps.reserve(remapConfiguration.singleKeyReMap.size());
+        for (const auto& it : remapConfiguration.singleKeyReMap)
+        {
+            singleKeyRemaps.push_back({ it.first, EncodeKeyShortcut(it.second) });
+        }
+
+        std::vector<BinaryShortcutRemap> osLevelShortcutRemaps;
+        osLevelShortcutRemaps.reserve(remapConfiguration.osLevelShortcutReMap.size());
+        for (const auto& it : remapConfiguration.osLevelShortcutReMap)
+        {
+            osLevelShortcutRemaps.push_back(EncodeShortcutRemap(it.first, it.second));
+        }
+
+        std::vector<BinaryApp> apps;
+        std::vector<BinaryShortcutRemap> appSpecificShortcutRemaps;
+        std::wstring stringTable;
+        for (const auto& itApp : remapConfiguration.appSpecificShortcutReMap)
+        {
+            apps.push_back({ (uint32_t)stringTable.size(), (uint32_t)itApp.first.size(), (uint32_t)itApp.second.size() });
+            stringTable += itApp.first;
+            for (const auto& itKeys : itApp.second)
+            {
+                appSpecificShortcutRemaps.push_back(EncodeShortcutRemap(itKeys.first, itKeys.second));
+            }
+        }
+
+        std::vector<BYTE> payload;
+        Append(payload, singleKeyRemaps.data(), singleKeyRemaps.size());
+        Append(payload, osLevelShortcutRemaps.data(), osLevelShortcutRemaps.size());
+        Append(payload, apps.data(), apps.size());
+        Append(payload, appSpecificShortcutRemaps.data(), appSpecificShortcutRemaps.size());
+        Append(payload, stringTable.data(), stringTable.size());
+
+        BinaryProfileHeader header = {};
+        header.magic = BinaryProfileMagic;
+        header.version = BinaryProfileVersion;
+        header.jsonChecksum = jsonChecksum;
+        header.payloadChecksum = ComputeChecksum(payload.data(), payload.size());
+        header.payloadSize = payload.size();
+        header.singleKeyRemapCount = (uint32_t)singleKeyRemaps.size();
+        header.osLevelShortcutRemapCount = (uint32_t)osLevelShortcutRemaps.size();
+        header.appCount = (uint32_t)apps.size();
+        header.appSpecificShortcutRemapCount = (uint32_t)appSpecificShortcutRemaps.size();
+        header.stringTableLength = (uint32_t)stringTable.size();
+
+        std::wstring temporaryPath = binaryProfilePath + L".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+            if (!file.good())
+            {
+                return false;
+            }
+        }
+
+        return MoveFileExW(temporaryPath.c_str(), binaryProfilePath.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    }
+
+    // Function to load the remaps of a binary profile by memory-mapping it
+    bool LoadBinaryProfile(const std::wstring& binaryProfilePath, uint64_t jsonChecksum, RemapConfiguration& remapConfiguration)
+    {
+        HANDLE file = CreateFileW(binaryProfilePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || (uint64_t)fileSize.QuadPart < sizeof(BinaryProfileHeader))
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr)
+        {
+            return false;
+        }
+
+        const BYTE* view = static_cast<const BYTE*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (view == nullptr)
+        {
+            return false;
+        }
+
+        bool result = false;
+        const BinaryProfileHeader& header = *reinterpret_cast<const BinaryProfileHeader*>(view);
+        uint64_t expectedPayloadSize = header.singleKeyRemapCount * (uint64_t)sizeof(BinarySingleKeyRemap) +
+                                       (header.osLevelShortcutRemapCount + (uint64_t)header.appSpecificShortcutRemapCount) * sizeof(BinaryShortcutRemap) +
+                                       header.appCount * (uint64_t)sizeof(BinaryApp) +
+                                       header.stringTableLength * (uint64_t)sizeof(wchar_t);
+        if (header.magic == BinaryProfileMagic &&
+            header.version == BinaryProfileVersion &&
+            header.jsonChecksum == jsonChecksum &&
+            header.payloadSize == (uint64_t)fileSize.QuadPart - sizeof(BinaryProfileHeader) &&
+            header.payloadSize == expectedPayloadSize &&
+            header.payloadChecksum == ComputeChecksum(view + sizeof(BinaryProfileHeader), header.payloadSize))
+        {
+            try
+            {
+                RemapConfiguration loadedConfiguration;
+                if (LoadBinaryPayload(header, view + sizeof(BinaryProfileHeader), loadedConfiguration))
+                {
+                    remapConfiguration = std::move(loadedConfiguration);
+                    result = true;
+                }
+            }
+            catch (...)
+            {
+                // Unable to load the binary profile. The caller falls back to the JSON
+            }
+        }
+
+        UnmapViewOfFile(view);
+        return result;
+    }
+
+    // Function to save a configuration to a JSON file along with its binary profile
+    void SaveToFile(const RemapConfiguration& remapConfiguration, const std::wstring& jsonPath)
+    {
+        std::string jsonString = winrt::to_string(ToJson(remapConfiguration).Stringify());
+        {
+            std::ofstream file(jsonPath, std::ios::binary | std::ios::trunc);
+            file << jsonString;
+            file.flush();
+            if (!file.good())
+            {
+                throw std::runtime_error("Unable to write the remap configuration file");
+            }
+        }
+
+        SaveBinaryProfile(remapConfiguration, ComputeChecksum(jsonString.data(), jsonString.size()), GetBinaryProfilePath(jsonPath));
+    }
+
+    // Function to check that all the remaps of a configuration can be applied
+    bool ValidateConfiguration(const RemapConfiguration& remapConfiguration)
+    {
+        auto isValidTarget = [](const KeyShortcutUnion& target) {
+            return target.index() == 0 ? std::get<DWORD>(target) != NULL : std::get<Shortcut>(target).IsValidShortcut();
+        };
+
+        for (const auto& it : remapConfiguration.singleKeyReMap)
+        {
+            if (it.first == NULL || !isValidTarget(it.second))
+            {
+                return false;
+            }
+        }
+
+        for (const auto& it : remapConfiguration.osLevelShortcutReMap)
+        {
+            if (!it.first.IsValidShortcut() || !isValidTarget(it.second.targetShortcut))
+            {
+                return false;
+            }
+        }
+
+        for (const auto& itApp : remapConfiguration.appSpecificShortcutReMap)
+        {
+            if (itApp.first.empty())
+            {
+                return false;
+            }
+
+            for (const auto& itKeys : itApp.second)
+            {
+                if (!itKeys.first.IsValidShortcut() || !isValidTarget(itKeys.second.targetShortcut))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Function to load a configuration saved by SaveToFile
+    bool LoadFromFile(const std::wstring& jsonPath, RemapConfiguration& remapConfiguration, bool isStrict)
+    {
+        std::string jsonString;
+        if (!ReadFileContent(jsonPath, jsonString))
+        {
+            return false;
+        }
+
+        uint64_t jsonChecksum = ComputeChecksum(jsonString.data(), jsonString.size());
+        std::wstring binaryProfilePath = GetBinaryProfilePath(jsonPath);
+        RemapConfiguration loadedConfiguration;
+        if (LoadBinaryProfile(binaryProfilePath, jsonChecksum, loadedConfiguration))
+        {
+            if (isStrict && !ValidateConfiguration(loadedConfiguration))
+            {
+                return false;
+            }
+
+            remapConfiguration = std::move(loadedConfiguration);
+            return true;
+        }
+
+        // The binary profile is missing or stale, for example if the JSON was modified by another tool. The JSON is parsed into an empty configuration, so that the binary profile saved for it has the same remaps as the JSON
+        try
+        {
+            bool isJsonProper = LoadFromJson(json::JsonValue::Parse(winrt::to_hstring(jsonString)).GetObjectW(), loadedConfiguration);
+            if (isStrict && (!isJsonProper || !ValidateConfiguration(loadedConfiguration)))
+            {
+                return false;
+            }
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+        SaveBinaryProfile(loadedConfiguration, jsonChecksum, binaryProfilePath);
+        remapConfiguration = std::move(loadedConfiguration);
+        return true;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include "../../../common/json.h"
+#include "RemapConfiguration.h"
+
+// Functions to load and save remap configurations.
+// A configuration is stored as JSON, which is the source of truth, and as a precompiled binary profile written next to it. The binary profile stores the checksum of the JSON it was generated from, so it is only used while the JSON is unchanged
+namespace RemapProfile
+{
+    // Version of the binary profile format. Profiles with another version are ignored
+    inline const uint32_t BinaryProfileVersion = 1;
+
+    // Function to compute the FNV-1a checksum of a buffer
+    uint64_t ComputeChecksum(const void* data, size_t size);
+
+    // Function to get the path of the binary profile for a JSON configuration file
+    std::wstring GetBinaryProfilePath(const std::wstring& jsonPath);
+
+    // Function to convert a remap configuration to its JSON representation
+    json::JsonObject ToJson(const RemapConfiguration& remapConfiguration);
+
+    // Function to load the remaps of a JSON configuration. Each remap type is only replaced if it is present in the JSON, and improper entries are skipped. Returns false if any improper entry or remap type was skipped
+    bool LoadFromJson(const json::JsonObject& jsonData, RemapConfiguration& remapConfiguration);
+
+    // Function to check that all the remaps of a configuration can be applied: original shortcuts and target shortcuts must be valid shortcuts, keys must be set and app names must not be empty
+    bool ValidateConfiguration(const RemapConfiguration& remapConfiguration);
+
+    // Function to write a binary profile for a configuration whose JSON has the given checksum. The file is written to a temporary file first and then moved, so readers never see a partial profile. Returns false on failure
+    bool SaveBinaryProfile(const RemapConfiguration& remapConfiguration, uint64_t jsonChecksum, const std::wstring& binaryProfilePath);
+
+    // Function to load the remaps of a binary profile by memory-mapping it. Returns false without modifying the configuration if the profile is missing, has another version, is corrupted or was generated from a JSON with another checksum
+    bool LoadBinaryProfile(const std::wstring& binaryProfilePath, uint64_t jsonChecksum, RemapConfiguration& remapConfiguration);
+
+    // Function to save a configuration to a JSON file along with its binary profile. Throws if the JSON file cannot be written, failing to write the binary profile only makes the next load fall back to the JSON
+    void SaveToFile(const RemapConfiguration& remapConfiguration, const std::wstring& jsonPath);
+
+    // Function to load a configuration saved by SaveToFile. The binary profile is used if it matches the JSON, otherwise the JSON is parsed and the binary profile is generated again. Returns false if the JSON file cannot be read or parsed.
+    // If isStrict is true, the load also fails if the JSON has improper entries or the configuration does not pass ValidateConfiguration. The configuration is left unchanged when the load fails
+    bool LoadFromFile(const std::wstring& jsonPath, RemapConfiguration& remapConfiguration, bool isStrict = false);
+}
@@ -2,28 +2,33 @@
 #include "Shortcut.h"
 #include <variant>
 
-// This class stores all the variables associated with each shortcut remapping
+// This class stores the target of a shortcut remapping. It is part of the remap configuration, which is immutable once it has been published to the hook
 class RemapShortcut
 {
 public:
     KeyShortcutUnion targetShortcut;
-    bool isShortcutInvoked;
-    ModifierKey winKeyInvoked;
-    // This bool value is only required for remapping shortcuts to Disable
-    bool isOriginalActionKeyPressed;
 
     RemapShortcut(const KeyShortcutUnion& sc) :
-        targetShortcut(sc), isShortcutInvoked(false), winKeyInvoked(ModifierKey::Disabled), isOriginalActionKeyPressed(false)
+        targetShortcut(sc)
     {
     }
 
     RemapShortcut() :
-        targetShortcut(Shortcut()), isShortcutInvoked(false), winKeyInvoked(ModifierKey::Disabled), isOriginalActionKeyPressed(false)
+        targetShortcut(Shortcut())
     {
     }
 
     inline bool operator==(const RemapShortcut& sc) const
     {
-        return targetShortcut == sc.targetShortcut && isShortcutInvoked == sc.isShortcutInvoked && winKeyInvoked == sc.winKeyInvoked;
+        return targetShortcut == sc.targetShortcut;
     }
 };
+
+// This struct stores the runtime state associated with each shortcut remapping. It is kept separately from the remap configuration and is only accessed by the hook
+struct ShortcutRemapState
+{
+    bool isShortcutInvoked = false;
+    ModifierKey winKeyInvoked = ModifierKey::Disabled;
+    // This bool value is only required for remapping shortcuts to Disable
+    bool isOriginalActionKeyPressed = false;
+};
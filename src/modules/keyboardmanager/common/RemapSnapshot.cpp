@@ -0,0 +1,77 @@
+#include "pch.h"
+#include "RemapSnapshot.h"
+
+// Constructor. The configuration is compiled and the runtime state of all the shortcut remaps is reset
+RemapSnapshot::RemapSnapshot(RemapConfiguration configuration) :
+    configuration(std::move(configuration))
+{
+    this->configuration.Compile();
+    shortcutRemapStates.resize(this->configuration.GetShortcutRemapCount());
+    lastProcessedRemaps.resize(this->configuration.GetDispatchTableCount(), ShortcutDispatchTable::NoRemap);
+}
+
+// Function to get the compiled remap configuration
+const RemapConfiguration& RemapSnapshot::GetConfiguration() const
+{
+    return configuration;
+}
+
+// Function to get the runtime state of the shortcut remap with the given state index
+ShortcutRemapState& RemapSnapshot::GetShortcutRemapState(size_t stateIndex)
+{
+    return shortcutRemapStates[stateIndex];
+}
+
+// Function to get the state index of the shortcut which is currently in the invoked state in a dispatch table. Returns ShortcutDispatchTable::NoRemap if no shortcut is invoked
+size_t RemapSnapshot::GetInvokedRemap(const ShortcutDispatchTable& dispatchTable) const
+{
+    size_t stateIndex = lastProcessedRemaps[dispatchTable.GetTableIndex()];
+    if (stateIndex != ShortcutDispatchTable::NoRemap && shortcutRemapStates[stateIndex].isShortcutInvoked)
+    {
+        return stateIndex;
+    }
+
+    return ShortcutDispatchTable::NoRemap;
+}
+
+// Function to store the shortcut which is about to be processed by the hook. This has to be set before the remap is applied since the hook can be re-entered by SendInput
+void RemapSnapshot::SetLastProcessedRemap(const ShortcutDispatchTable& dispatchTable, size_t stateIndex)
+{
+    lastProcessedRemaps[dispatchTable.GetTableIndex()] = stateIndex;
+}
+
+// Function to copy the invoked shortcut of a dispatch table from the previous snapshot, if the same remap exists in this snapshot
+void RemapSnapshot::CopyInvokedRemap(const RemapSnapshot& previous, const ShortcutDispatchTable* previousTable, const ShortcutDispatchTable* table)
+{
+    if (previousTable == nullptr || table == nullptr)
+    {
+        return;
+    }
+
+    size_t previousStateIndex = previous.GetInvokedRemap(*previousTable);
+    if (previousStateIndex == ShortcutDispatchTable::NoRemap)
+    {
+        return;
+    }
+
+    // The state can only be carried over if the shortcut is remapped to the same target, otherwise the release would not match the keys which were sent
+    const ShortcutRemapEntry& previousRemap = previousTable->GetRemap(previousStateIndex);
+    size_t stateIndex = table->FindRemap(previousRemap.first);
+    if (stateIndex == ShortcutDispatchTable::NoRemap || !(table->GetRemap(stateIndex).second == previousRemap.second))
+    {
+        return;
+    }
+
+    shortcutRemapStates[stateIndex] = previous.shortcutRemapStates[previousStateIndex];
+    lastProcessedRemaps[table->GetTableIndex()] = stateIndex;
+}
+
+// Function to carry over the shortcuts which are invoked in the previous snapshot, so that a shortcut which is held down while a new configuration is published is still released correctly. Shortcuts are only carried over if the remap is unchanged in the new configuration
+void RemapSnapshot::CopyInvokedRemapsFrom(const RemapSnapshot& previous)
+{
+    CopyInvokedRemap(previous, &previous.configuration.GetOSLevelShortcutDispatchTable(), &configuration.GetOSLevelShortcutDispatchTable());
+    for (const auto& itApp : previous.configuration.appSpecificShortcutReMap)
+    {
+        CopyInvokedRemap(previous, previous.configuration.GetAppSpecificShortcutDispatchTable(itApp.first), configuration.GetAppSpecificShortcutDispatchTable(itApp.first));
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include "RemapConfiguration.h"
+
+// Class which stores a published remap configuration along with the runtime state of its shortcut remaps. The configuration is compiled when the snapshot is created and is never modified afterwards, so the state which is changed by the hook (such as which shortcut is currently invoked) is kept in small separate arrays. The state arrays are only accessed by the hook thread
+class RemapSnapshot
+{
+private:
+    // Compiled remap configuration
+    RemapConfiguration configuration;
+
+    // Runtime state of each shortcut remap, indexed by the state index of the remap
+    std::vector<ShortcutRemapState> shortcutRemapStates;
+
+    // State index of the last shortcut which was processed by the hook in each dispatch table, indexed by the table index. Only the shortcut being processed can change its invoked state, and while a shortcut is invoked no other shortcut in the table is processed, so this is the only entry of the table which can be invoked
+    std::vector<size_t> lastProcessedRemaps;
+
+    // Function to copy the invoked shortcut of a dispatch table from the previous snapshot, if the same remap exists in this snapshot
+    void CopyInvokedRemap(const RemapSnapshot& previous, const ShortcutDispatchTable* previousTable, const ShortcutDispatchTable* table);
+
+public:
+    // Constructor. The configuration is compiled and the runtime state of all the shortcut remaps is reset
+    RemapSnapshot(RemapConfiguration configuration);
+
+    RemapSnapshot(const RemapSnapshot&) = delete;
+    RemapSnapshot& operator=(const RemapSnapshot&) = delete;
+
+    // Function to get the compiled remap configuration
+    const RemapConfiguration& GetConfiguration() const;
+
+    // Function to get the runtime state of the shortcut remap with the given state index
+    ShortcutRemapState& GetShortcutRemapState(size_t stateIndex);
+
+    // Function to get the state index of the shortcut which is currently in the invoked state in a dispatch table. Returns ShortcutDispatchTable::NoRemap if no shortcut is invoked
+    size_t GetInvokedRemap(const ShortcutDispatchTable& dispatchTable) const;
+
+    // Function to store the shortcut which is about to be processed by the hook. This has to be set before the remap is applied since the hook can be re-entered by SendInput
+    void SetLastProcessedRemap(const ShortcutDispatchTable& dispatchTable, size_t stateIndex);
+
+    // Function to carry over the shortcuts which are invoked in the previous snapshot, so that a shortcut which is held down while a new configuration is published is still released correctly. Shortcuts are only carried over if the remap is unchanged in the new configuration
+    void CopyInvokedRemapsFrom(const RemapSnapshot& previous);
+};
@@ -3,7 +3,7 @@
 #include "../common/keyboard_layout.h"
 #include "../common/shared_constants.h"
 #include "Helpers.h"
-#include "InputInterface.h"
+#include "KeyboardStateReader.h"
 
 // Constructor to initialize Shortcut from it's virtual key code string representation.
 Shortcut::Shortcut(const std::wstring& shortcutVK) :
@@ -517,103 +517,39 @@ void Shortcut::SetKeyCodes(const std::vector<int32_t>& keys)
     }
 }
 
-// Function to check if all the modifiers in the shortcut have been pressed down
-bool Shortcut::CheckModifiersKeyboardState(InputInterface& ii) const
+// Function to set the key code which must be pressed down for a modifier of the shortcut in a key mask. If the modifier is set to both, the generic key code is set
+static void SetModifierKeyBits(KeyboardStateSnapshot& keys, ModifierKey modifier, DWORD leftKey, DWORD rightKey, DWORD genericKey)
 {
-    // Check the win key state
-    if (winKey == ModifierKey::Both)
+    if (modifier == ModifierKey::Left)
     {
-        // Since VK_WIN does not exist, we check both VK_LWIN and VK_RWIN
-        if ((!(ii.GetVirtualKeyState(VK_LWIN))) && (!(ii.GetVirtualKeyState(VK_RWIN))))
-        {
-            return false;
-        }
-    }
-    else if (winKey == ModifierKey::Left)
-    {
-        if (!(ii.GetVirtualKeyState(VK_LWIN)))
-        {
-            return false;
-        }
-    }
-    else if (winKey == ModifierKey::Right)
-    {
-        if (!(ii.GetVirtualKeyState(VK_RWIN)))
-        {
-            return false;
-        }
-    }
-
-    // Check the ctrl key state
-    if (ctrlKey == ModifierKey::Left)
-    {
-        if (!(ii.GetVirtualKeyState(VK_LCONTROL)))
-        {
-            return false;
-        }
+        keys.set(leftKey);
     }
-    else if (ctrlKey == ModifierKey::Right)
+    else if (modifier == ModifierKey::Right)
     {
-        if (!(ii.GetVirtualKeyState(VK_RCONTROL)))
-        {
-            return false;
-        }
+        keys.set(rightKey);
     }
-    else if (ctrlKey == ModifierKey::Both)
+    else if (modifier == ModifierKey::Both && genericKey != NULL)
     {
-        if (!(ii.GetVirtualKeyState(VK_CONTROL)))
-        {
-            return false;
-        }
+        keys.set(genericKey);
     }
+}
 
-    // Check the alt key state
-    if (altKey == ModifierKey::Left)
-    {
-        if (!(ii.GetVirtualKeyState(VK_LMENU)))
-        {
-            return false;
-        }
-    }
-    else if (altKey == ModifierKey::Right)
-    {
-        if (!(ii.GetVirtualKeyState(VK_RMENU)))
-        {
-            return false;
-        }
-    }
-    else if (altKey == ModifierKey::Both)
+// Function to check if all the modifiers in the shortcut have been pressed down
+bool Shortcut::CheckModifiersKeyboardState(const KeyboardStateSnapshot& keyboardState) const
+{
+    // Since VK_WIN does not exist, either VK_LWIN or VK_RWIN has to be pressed
+    if (winKey == ModifierKey::Both && !keyboardState[VK_LWIN] && !keyboardState[VK_RWIN])
     {
-        if (!(ii.GetVirtualKeyState(VK_MENU)))
-        {
-            return false;
-        }
+        return false;
     }
 
-    // Check the shift key state
-    if (shiftKey == ModifierKey::Left)
-    {
-        if (!(ii.GetVirtualKeyState(VK_LSHIFT)))
-        {
-            return false;
-        }
-    }
-    else if (shiftKey == ModifierKey::Right)
-    {
-        if (!(ii.GetVirtualKeyState(VK_RSHIFT)))
-        {
-            return false;
-        }
-    }
-    else if (shiftKey == ModifierKey::Both)
-    {
-        if (!(ii.GetVirtualKeyState(VK_SHIFT)))
-        {
-            return false;
-        }
-    }
+    KeyboardStateSnapshot requiredKeys;
+    SetModifierKeyBits(requiredKeys, winKey, VK_LWIN, VK_RWIN, NULL);
+    SetModifierKeyBits(requiredKeys, ctrlKey, VK_LCONTROL, VK_RCONTROL, VK_CONTROL);
+    SetModifierKeyBits(requiredKeys, altKey, VK_LMENU, VK_RMENU, VK_MENU);
+    SetModifierKeyBits(requiredKeys, shiftKey, VK_LSHIFT, VK_RSHIFT, VK_SHIFT);
 
-    return true;
+    return (keyboardState & requiredKeys) == requiredKeys;
 }
 
 // Helper method for checking if a key is in a range for cleaner code
@@ -668,154 +604,94 @@ bool IgnoreKeyCode(DWORD key)
     }
 }
 
-// Function to check if any keys are pressed down except those in the shortcut
-bool Shortcut::IsKeyboardStateClearExceptShortcut(InputInterface& ii) const
+// Function to get the mask of the key codes which are checked by IsKeyboardStateClearExceptShortcut. 0xFF is not checked because it is set to key down because of the Num Lock
+static const KeyboardStateSnapshot& GetCheckedKeys()
 {
-    // Iterate through all the virtual key codes - 0xFF is set to key down because of the Num Lock
-    for (int keyVal = 1; keyVal < 0xFF; keyVal++)
-    {
-        // Ignore problematic key codes
-        if (IgnoreKeyCode(keyVal))
-        {
-            continue;
-        }
-        // Check state of the key. If the key is pressed down but it is not part of the shortcut then the keyboard state is not clear
-        if (ii.GetVirtualKeyState(keyVal))
+    static const KeyboardStateSnapshot checkedKeys = [] {
+        KeyboardStateSnapshot keys;
+        for (int keyVal = 1; keyVal < 0xFF; keyVal++)
         {
-            // If one of the win keys is pressed check if it is part of the shortcut
-            if (keyVal == VK_LWIN)
-            {
-                if (winKey != ModifierKey::Left && winKey != ModifierKey::Both)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            else if (keyVal == VK_RWIN)
+            // Ignore problematic key codes
+            if (!IgnoreKeyCode(keyVal))
             {
-                if (winKey != ModifierKey::Right && winKey != ModifierKey::Both)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            // If one of the ctrl keys is pressed check if it is part of the shortcut
-            else if (keyVal == VK_LCONTROL)
-            {
-                if (ctrlKey != ModifierKey::Left && ctrlKey != ModifierKey::Both)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            else if (keyVal == VK_RCONTROL)
-            {
-                if (ctrlKey != ModifierKey::Right && ctrlKey != ModifierKey::Both)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            else if (keyVal == VK_CONTROL)
-            {
-                if (ctrlKey == ModifierKey::Disabled)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            // If one of the alt keys is pressed check if it is part of the shortcut
-            else if (keyVal == VK_LMENU)
-            {
-                if (altKey != ModifierKey::Left && altKey != ModifierKey::Both)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            else if (keyVal == VK_RMENU)
-            {
-                if (altKey != ModifierKey::Right && altKey != ModifierKey::Both)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            else if (keyVal == VK_MENU)
-            {
-                if (altKey == ModifierKey::Disabled)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            // If one of the shift keys is pressed check if it is part of the shortcut
-            else if (keyVal == VK_LSHIFT)
-            {
-                if (shiftKey != ModifierKey::Left && shiftKey != ModifierKey::Both)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            else if (keyVal == VK_RSHIFT)
-            {
-                if (shiftKey != ModifierKey::Right && shiftKey != ModifierKey::Both)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            else if (keyVal == VK_SHIFT)
-            {
-                if (shiftKey == ModifierKey::Disabled)
-                {
-                    return false;
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            // If any other key is pressed check if it is the action key
-            else if (keyVal != actionKey)
-            {
-                return false;
+                keys.set(keyVal);
             }
         }
+
+        return keys;
+    }();
+
+    return checkedKeys;
+}
+
+// Function to set the key codes which can be pressed down for a modifier of the shortcut in a key mask. The generic key code is allowed along with either of the left and right key codes
+static void SetAllowedModifierKeyBits(KeyboardStateSnapshot& keys, ModifierKey modifier, DWORD leftKey, DWORD rightKey, DWORD genericKey)
+{
+    if (modifier == ModifierKey::Disabled)
+    {
+        return;
     }
 
-    return true;
+    if (modifier != ModifierKey::Right)
+    {
+        keys.set(leftKey);
+    }
+    if (modifier != ModifierKey::Left)
+    {
+        keys.set(rightKey);
+    }
+    if (genericKey != NULL)
+    {
+        keys.set(genericKey);
+    }
+}
+
+// Function to check if any keys are pressed down except those in the shortcut
+bool Shortcut::IsKeyboardStateClearExceptShortcut(const KeyboardStateSnapshot& keyboardState) const
+{
+    KeyboardStateSnapshot shortcutKeys;
+    SetAllowedModifierKeyBits(shortcutKeys, winKey, VK_LWIN, VK_RWIN, NULL);
+    SetAllowedModifierKeyBits(shortcutKeys, ctrlKey, VK_LCONTROL, VK_RCONTROL, VK_CONTROL);
+    SetAllowedModifierKeyBits(shortcutKeys, altKey, VK_LMENU, VK_RMENU, VK_MENU);
+    SetAllowedModifierKeyBits(shortcutKeys, shiftKey, VK_LSHIFT, VK_RSHIFT, VK_SHIFT);
+    if (actionKey < shortcutKeys.size())
+    {
+        shortcutKeys.set(actionKey);
+    }
+
+    // The keyboard state is clear if none of the checked keys are pressed down apart from the keys of the shortcut
+    return (keyboardState & GetCheckedKeys() & ~shortcutKeys).none();
+}
+
+// Function to check if a modifier of the shortcut is pressed down. If the modifier is set to both, the generic key code is read, or either of the left and right key codes if there is no generic key code
+static bool IsModifierKeyPressed(KeyboardStateReader& keyboardState, ModifierKey modifier, DWORD leftKey, DWORD rightKey, DWORD genericKey)
+{
+    switch (modifier)
+    {
+    case ModifierKey::Left:
+        return keyboardState.IsKeyPressed(leftKey);
+    case ModifierKey::Right:
+        return keyboardState.IsKeyPressed(rightKey);
+    case ModifierKey::Both:
+        return genericKey != NULL ? keyboardState.IsKeyPressed(genericKey) : (keyboardState.IsKeyPressed(leftKey) || keyboardState.IsKeyPressed(rightKey));
+    default:
+        return true;
+    }
+}
+
+// Function to check if all the modifiers in the shortcut have been pressed down. Only the modifier keys of the shortcut are read
+bool Shortcut::CheckModifiersKeyboardState(KeyboardStateReader& keyboardState) const
+{
+    return IsModifierKeyPressed(keyboardState, winKey, VK_LWIN, VK_RWIN, NULL) &&
+           IsModifierKeyPressed(keyboardState, ctrlKey, VK_LCONTROL, VK_RCONTROL, VK_CONTROL) &&
+           IsModifierKeyPressed(keyboardState, altKey, VK_LMENU, VK_RMENU, VK_MENU) &&
+           IsModifierKeyPressed(keyboardState, shiftKey, VK_LSHIFT, VK_RSHIFT, VK_SHIFT);
+}
+
+// Function to check if any keys are pressed down except those in the shortcut. This reads the state of all the keys
+bool Shortcut::IsKeyboardStateClearExceptShortcut(KeyboardStateReader& keyboardState) const
+{
+    return IsKeyboardStateClearExceptShortcut(keyboardState.GetSnapshot());
 }
 
 // Function to get the number of modifiers that are common between the current shortcut and the shortcut in the argument
@@ -1,8 +1,9 @@
 #pragma once
 #include "ModifierKey.h"
+#include "KeyboardStateSnapshot.h"
 #include <variant>
-class InputInterface;
 class LayoutMap;
+class KeyboardStateReader;
 namespace KeyboardManagerHelper
 {
     enum class ErrorType;
@@ -155,11 +156,17 @@ public:
     // Function to set a shortcut from a vector of key codes
     void SetKeyCodes(const std::vector<int32_t>& keys);
 
-    // Function to check if all the modifiers in the shortcut have been pressed down
-    bool CheckModifiersKeyboardState(InputInterface& ii) const;
+    // Function to check if all the modifiers in the shortcut have been pressed down in the keyboard state
+    bool CheckModifiersKeyboardState(const KeyboardStateSnapshot& keyboardState) const;
 
-    // Function to check if any keys are pressed down except those in the shortcut
-    bool IsKeyboardStateClearExceptShortcut(InputInterface& ii) const;
+    // Function to check if any keys are pressed down in the keyboard state except those in the shortcut
+    bool IsKeyboardStateClearExceptShortcut(const KeyboardStateSnapshot& keyboardState) const;
+
+    // Function to check if all the modifiers in the shortcut have been pressed down. Only the modifier keys of the shortcut are read
+    bool CheckModifiersKeyboardState(KeyboardStateReader& keyboardState) const;
+
+    // Function to check if any keys are pressed down except those in the shortcut. This reads the state of all the keys
+    bool IsKeyboardStateClearExceptShortcut(KeyboardStateReader& keyboardState) const;
 
     // Function to get the number of modifiers that are common between the current shortcut and the shortcut in the argument
     int GetCommonModifiersCount(const Shortcut& input) const;
@@ -0,0 +1,206 @@
+#include "pch.h"
+#include "ShortcutDispatchTable.h"
+#include "../common/shared_constants.h"
+#include "KeyboardStateReader.h"
+
+// Function to compile a shortcut remap into a dispatch entry
+ShortcutDispatchTable::Entry ShortcutDispatchTable::CompileEntry(const ShortcutRemapEntry& remap, size_t stateIndex)
+{
+    const Shortcut& shortcut = remap.first;
+    Entry entry = { &remap, stateIndex, 0, false };
+
+    switch (shortcut.GetWinKey(ModifierKey::Both))
+    {
+    case VK_LWIN:
+        entry.requiredModifiers |= LWinBit;
+        break;
+    case VK_RWIN:
+        entry.requiredModifiers |= RWinBit;
+        break;
+    case CommonSharedConstants::VK_WIN_BOTH:
+        entry.isWinKeyBoth = true;
+        break;
+    }
+
+    switch (shortcut.GetCtrlKey())
+    {
+    case VK_LCONTROL:
+        entry.requiredModifiers |= LCtrlBit;
+        break;
+    case VK_RCONTROL:
+        entry.requiredModifiers |= RCtrlBit;
+        break;
+    case VK_CONTROL:
+        entry.requiredModifiers |= CtrlBit;
+        break;
+    }
+
+    switch (shortcut.GetAltKey())
+    {
+    case VK_LMENU:
+        entry.requiredModifiers |= LAltBit;
+        break;
+    case VK_RMENU:
+        entry.requiredModifiers |= RAltBit;
+        break;
+    case VK_MENU:
+        entry.requiredModifiers |= AltBit;
+        break;
+    }
+
+    switch (shortcut.GetShiftKey())
+    {
+    case VK_LSHIFT:
+        entry.requiredModifiers |= LShiftBit;
+        break;
+    case VK_RSHIFT:
+        entry.requiredModifiers |= RShiftBit;
+        break;
+    case VK_SHIFT:
+        entry.requiredModifiers |= ShiftBit;
+        break;
+    }
+
+    return entry;
+}
+
+// Function to build the dispatch table for a remap table. The shortcuts are read from the sorted vector so that the priority of longer shortcuts is preserved. The remaps are assigned consecutive state indices starting at firstStateIndex
+void ShortcutDispatchTable::Build(size_t tableIndex, const std::vector<Shortcut>& sortedShortcuts, const ShortcutRemapTable& remapTable, size_t firstStateIndex)
+{
+    Clear();
+    this->tableIndex = tableIndex;
+    this->firstStateIndex = firstStateIndex;
+
+    remaps.reserve(sortedShortcuts.size());
+    for (const auto& shortcut : sortedShortcuts)
+    {
+        auto it = remapTable.find(shortcut);
+        if (it != remapTable.end())
+        {
+            actionKeyIndex[shortcut.GetActionKey()].push_back(CompileEntry(*it, firstStateIndex + remaps.size()));
+            remaps.push_back(&*it);
+        }
+    }
+}
+
+// Function to clear the dispatch table
+void ShortcutDispatchTable::Clear()
+{
+    actionKeyIndex.clear();
+    remaps.clear();
+    firstStateIndex = 0;
+    tableIndex = 0;
+}
+
+// Function to get the candidate shortcuts for an action key. Returns nullptr if no shortcut uses the key as its action key
+const std::vector<ShortcutDispatchTable::Entry>* ShortcutDispatchTable::GetCandidates(DWORD actionKey) const
+{
+    auto it = actionKeyIndex.find(actionKey);
+    if (it != actionKeyIndex.end())
+    {
+        return &it->second;
+    }
+
+    return nullptr;
+}
+
+// Function to get the state index of a shortcut remap given the source shortcut. Returns NoRemap if it isn't remapped in this table
+size_t ShortcutDispatchTable::FindRemap(const Shortcut& shortcut) const
+{
+    const auto* candidates = GetCandidates(shortcut.GetActionKey());
+    if (candidates != nullptr)
+    {
+        for (const auto& candidate : *candidates)
+        {
+            if (candidate.remap->first == shortcut)
+            {
+                return candidate.stateIndex;
+            }
+        }
+    }
+
+    return NoRemap;
+}
+
+// Function to get the shortcut remap with the given state index. The index must belong to this table
+const ShortcutRemapEntry& ShortcutDispatchTable::GetRemap(size_t stateIndex) const
+{
+    return *remaps[stateIndex - firstStateIndex];
+}
+
+// Function to get the index of the table in the remap configuration
+size_t ShortcutDispatchTable::GetTableIndex() const
+{
+    return tableIndex;
+}
+
+// Function to get the number of shortcut remaps in the table
+size_t ShortcutDispatchTable::Size() const
+{
+    return remaps.size();
+}
+
+// Function to get the state of all the modifier keys from a snapshot of the keyboard state
+ModifierState ShortcutDispatchTable::GetModifierState(const KeyboardStateSnapshot& keyboardState)
+{
+    ModifierState state = 0;
+    state |= keyboardState[VK_LWIN] ? LWinBit : 0;
+    state |= keyboardState[VK_RWIN] ? RWinBit : 0;
+    state |= keyboardState[VK_LCONTROL] ? LCtrlBit : 0;
+    state |= keyboardState[VK_RCONTROL] ? RCtrlBit : 0;
+    state |= keyboardState[VK_CONTROL] ? CtrlBit : 0;
+    state |= keyboardState[VK_LMENU] ? LAltBit : 0;
+    state |= keyboardState[VK_RMENU] ? RAltBit : 0;
+    state |= keyboardState[VK_MENU] ? AltBit : 0;
+    state |= keyboardState[VK_LSHIFT] ? LShiftBit : 0;
+    state |= keyboardState[VK_RSHIFT] ? RShiftBit : 0;
+    state |= keyboardState[VK_SHIFT] ? ShiftBit : 0;
+    return state;
+}
+
+// Function to check if all the modifiers of a compiled shortcut are pressed in the given modifier state. This is equivalent to Shortcut::CheckModifiersKeyboardState
+bool ShortcutDispatchTable::CheckModifiers(const Entry& entry, ModifierState state)
+{
+    // Since VK_WIN does not exist, either VK_LWIN or VK_RWIN has to be pressed
+    if (entry.isWinKeyBoth && !(state & (LWinBit | RWinBit)))
+    {
+        return false;
+    }
+
+    return (state & entry.requiredModifiers) == entry.requiredModifiers;
+}
+
+// Function to check if all the modifiers of a compiled shortcut are pressed down. Only the modifier keys required by the shortcut are read
+bool ShortcutDispatchTable::CheckModifiers(const Entry& entry, KeyboardStateReader& keyboardState)
+{
+    static const std::pair<ModifierState, DWORD> modifierKeys[] = {
+        { LWinBit, VK_LWIN },
+        { RWinBit, VK_RWIN },
+        { LCtrlBit, VK_LCONTROL },
+        { RCtrlBit, VK_RCONTROL },
+        { CtrlBit, VK_CONTROL },
+        { LAltBit, VK_LMENU },
+        { RAltBit, VK_RMENU },
+        { AltBit, VK_MENU },
+        { LShiftBit, VK_LSHIFT },
+        { RShiftBit, VK_RSHIFT },
+        { ShiftBit, VK_SHIFT }
+    };
+
+    // Since VK_WIN does not exist, either VK_LWIN or VK_RWIN has to be pressed
+    if (entry.isWinKeyBoth && !keyboardState.IsKeyPressed(VK_LWIN) && !keyboardState.IsKeyPressed(VK_RWIN))
+    {
+        return false;
+    }
+
+    // Stop at the first required modifier which is not pressed, so that the remaining keys are not read
+    for (const auto& [modifierBit, key] : modifierKeys)
+    {
+        if ((entry.requiredModifiers & modifierBit) && !keyboardState.IsKeyPressed(key))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <unordered_map>
+#include "Shortcut.h"
+#include "RemapShortcut.h"
+
+using ShortcutRemapEntry = std::pair<const Shortcut, RemapShortcut>;
+using ShortcutRemapTable = std::map<Shortcut, RemapShortcut>;
+
+// Packed bitmask of the modifier keys which are currently pressed down
+using ModifierState = uint16_t;
+
+// Class which stores a compiled lookup structure for a shortcut remap table. Shortcuts are indexed by their action key, and the modifiers of each shortcut are stored as a packed bitmask so that the hook only has to read the modifier keys which are used by the candidate shortcuts
+class ShortcutDispatchTable
+{
+public:
+    // Bits used in the packed modifier state
+    static const ModifierState LWinBit = 1 << 0;
+    static const ModifierState RWinBit = 1 << 1;
+    static const ModifierState LCtrlBit = 1 << 2;
+    static const ModifierState RCtrlBit = 1 << 3;
+    static const ModifierState CtrlBit = 1 << 4;
+    static const ModifierState LAltBit = 1 << 5;
+    static const ModifierState RAltBit = 1 << 6;
+    static const ModifierState AltBit = 1 << 7;
+    static const ModifierState LShiftBit = 1 << 8;
+    static const ModifierState RShiftBit = 1 << 9;
+    static const ModifierState ShiftBit = 1 << 10;
+
+    // State index used when no shortcut remap is found
+    static const size_t NoRemap = SIZE_MAX;
+
+    // Compiled form of a single shortcut remap
+    struct Entry
+    {
+        // Pointer to the entry in the remap table. std::map nodes are stable and the remap configuration is immutable once compiled, so this stays valid for the lifetime of the configuration
+        const ShortcutRemapEntry* remap;
+
+        // Index of the runtime state of the shortcut remap in the state array of the remap snapshot
+        size_t stateIndex;
+
+        // Modifier bits which must all be pressed for the shortcut to be invoked
+        ModifierState requiredModifiers;
+
+        // True if the shortcut uses ModifierKey::Both for the win key, in which case either of the win keys can be pressed
+        bool isWinKeyBoth;
+    };
+
+private:
+    // Candidate shortcuts for each action key, in the same order as the size sorted shortcut vector
+    std::unordered_map<DWORD, std::vector<Entry>> actionKeyIndex;
+
+    // Shortcut remaps of the table, indexed by their state index relative to firstStateIndex
+    std::vector<const ShortcutRemapEntry*> remaps;
+
+    // State index of the first shortcut remap of the table. The state indices of the remaps in a configuration are contiguous across all of its tables
+    size_t firstStateIndex = 0;
+
+    // Index of the table in the remap configuration, used to store the runtime state of the table
+    size_t tableIndex = 0;
+
+    // Function to compile a shortcut remap into a dispatch entry
+    static Entry CompileEntry(const ShortcutRemapEntry& remap, size_t stateIndex);
+
+public:
+    // Function to build the dispatch table for a remap table. The shortcuts are read from the sorted vector so that the priority of longer shortcuts is preserved. The remaps are assigned consecutive state indices starting at firstStateIndex
+    void Build(size_t tableIndex, const std::vector<Shortcut>& sortedShortcuts, const ShortcutRemapTable& remapTable, size_t firstStateIndex);
+
+    // Function to clear the dispatch table
+    void Clear();
+
+    // Function to get the candidate shortcuts for an action key. Returns nullptr if no shortcut uses the key as its action key
+    const std::vector<Entry>* GetCandidates(DWORD actionKey) const;
+
+    // Function to get the state index of a shortcut remap given the source shortcut. Returns NoRemap if it isn't remapped in this table
+    size_t FindRemap(const Shortcut& shortcut) const;
+
+    // Function to get the shortcut remap with the given state index. The index must belong to this table
+    const ShortcutRemapEntry& GetRemap(size_t stateIndex) const;
+
+    // Function to get the index of the table in the remap configuration
+    size_t GetTableIndex() const;
+
+    // Function to get the number of shortcut remaps in the table
+    size_t Size() const;
+
+    // Function to get the state of all the modifier keys from a snapshot of the keyboard state
+    static ModifierState GetModifierState(const KeyboardStateSnapshot& keyboardState);
+
+    // Function to check if all the modifiers of a compiled shortcut are pressed in the given modifier state
+    static bool CheckModifiers(const Entry& entry, ModifierState state);
+
+    // Function to check if all the modifiers of a compiled shortcut are pressed down. Only the modifier keys required by the shortcut are read
+    static bool CheckModifiers(const Entry& entry, KeyboardStateReader& keyboardState);
+};
@@ -0,0 +1,115 @@
+#include "pch.h"
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(uint64_t currentTick) :
+    currentTick(currentTick)
+{
+}
+
+void TimerWheel::Schedule(TimerWheelEntry& entry, uint64_t deadline)
+{
+    Cancel(entry);
+    entry.deadline = deadline;
+
+    // The slot of the current tick has already been processed, so the earliest possible expiry is the next tick
+    Insert(entry, deadline > currentTick ? deadline : currentTick + 1);
+}
+
+void TimerWheel::Schedule(TimerWheelEntry& entry, uint64_t deadline, uint64_t now)
+{
+    Cancel(entry);
+    if (size == 0 && now > currentTick)
+    {
+        currentTick = now;
+    }
+
+    Schedule(entry, deadline);
+}
+
+void TimerWheel::Cancel(TimerWheelEntry& entry)
+{
+    if (entry.slot == nullptr)
+    {
+        return;
+    }
+
+    if (entry.previous != nullptr)
+    {
+        entry.previous->next = entry.next;
+    }
+    else
+    {
+        *entry.slot = entry.next;
+    }
+
+    if (entry.next != nullptr)
+    {
+        entry.next->previous = entry.previous;
+    }
+
+    entry.previous = nullptr;
+    entry.next = nullptr;
+    entry.slot = nullptr;
+    size--;
+}
+
+uint64_t TimerWheel::GetTicksUntilNextExpiry() const
+{
+    if (size == 0)
+    {
+        return UINT64_MAX;
+    }
+
+    // The higher levels cascade at the end of the current revolution of the first level, so no entry can expire later than that if the first level is empty
+    uint64_t ticksUntilCascade = SlotCount - (currentTick & (SlotCount - 1));
+    for (uint64_t ticks = 1; ticks < ticksUntilCascade; ticks++)
+    {
+        if (slots[0][(currentTick + ticks) & (SlotCount - 1)] != nullptr)
+        {
+            return ticks;
+        }
+    }
+
+    return ticksUntilCascade;
+}
+
+void TimerWheel::Insert(TimerWheelEntry& entry, uint64_t expiry)
+{
+    // Clamp timers beyond the range of the wheel, they are re-inserted with their real deadline when the last level cascades
+    if (expiry - currentTick >= MaxRange)
+    {
+        expiry = currentTick + MaxRange - 1;
+    }
+
+    uint64_t delta = expiry - currentTick;
+    unsigned int level = 0;
+    while (level < LevelCount - 1 && delta >= (1ull << (SlotBits * (level + 1))))
+    {
+        level++;
+    }
+
+    TimerWheelEntry*& head = slots[level][(expiry >> (SlotBits * level)) & (SlotCount - 1)];
+    entry.previous = nullptr;
+    entry.next = head;
+    if (head != nullptr)
+    {
+        head->previous = &entry;
+    }
+
+    head = &entry;
+    entry.slot = &head;
+    size++;
+}
+
+void TimerWheel::Cascade(unsigned int level)
+{
+    TimerWheelEntry*& head = slots[level][(currentTick >> (SlotBits * level)) & (SlotCount - 1)];
+    while (head != nullptr)
+    {
+        TimerWheelEntry& entry = *head;
+        Cancel(entry);
+
+        // Entries in this slot expire during the revolution of the lower level starting on the current tick, except for clamped ones which are further away
+        Insert(entry, entry.deadline > currentTick ? entry.deadline : currentTick);
+    }
+}
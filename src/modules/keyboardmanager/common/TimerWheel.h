@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+
+// Intrusive node for a timer stored in a TimerWheel. Classes which need a timer derive from this class
+class TimerWheelEntry
+{
+public:
+    // Returns true if the entry is currently scheduled on a timer wheel
+    bool IsArmed() const
+    {
+        return slot != nullptr;
+    }
+
+    // Returns the tick at which the entry expires
+    uint64_t GetDeadline() const
+    {
+        return deadline;
+    }
+
+private:
+    friend class TimerWheel;
+
+    uint64_t deadline = 0;
+    TimerWheelEntry* previous = nullptr;
+    TimerWheelEntry* next = nullptr;
+
+    // Head of the slot list containing the entry. nullptr if the entry is not scheduled
+    TimerWheelEntry** slot = nullptr;
+};
+
+// Hierarchical timing wheel. Each level has SlotCount slots and each slot of a level covers a full revolution of the level below, so scheduling and cancelling are O(1) and an entry is moved at most once per level before it expires.
+// Timers further away than the range of the wheel are kept in the last level and are re-inserted every time it cascades.
+// The class is not thread safe.
+class TimerWheel
+{
+public:
+    static const unsigned int SlotBits = 6;
+    static const unsigned int SlotCount = 1u << SlotBits;
+    static const unsigned int LevelCount = 4;
+
+    // Range of ticks covered by the wheel
+    static const uint64_t MaxRange = 1ull << (SlotBits * LevelCount);
+
+    explicit TimerWheel(uint64_t currentTick = 0);
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Schedule an entry to expire at the given tick. If the entry is already scheduled it is moved. Deadlines which are not after the current tick expire on the next tick
+    void Schedule(TimerWheelEntry& entry, uint64_t deadline);
+
+    // Same as Schedule, but an empty wheel is first moved to the given current time. Nothing can expire in an empty wheel, so this avoids stepping through every tick of an idle period on the next Advance
+    void Schedule(TimerWheelEntry& entry, uint64_t deadline, uint64_t now);
+
+    // Remove an entry from the wheel. Does nothing if the entry is not scheduled
+    void Cancel(TimerWheelEntry& entry);
+
+    // Advance the wheel to the given tick and call onExpired for each entry whose deadline has passed. The entry is removed from the wheel before the callback, so the callback can schedule it again
+    template<typename Callback>
+    void Advance(uint64_t tick, Callback&& onExpired)
+    {
+        while (currentTick < tick)
+        {
+            // Nothing can expire, so jump directly to the target tick
+            if (size == 0)
+            {
+                currentTick = tick;
+                return;
+            }
+
+            currentTick++;
+
+            // Cascade every level whose slot came around on this tick, highest level first so that its entries can move down to the lower levels before they cascade
+            unsigned int level = 1;
+            while (level < LevelCount && (currentTick & ((1ull << (SlotBits * level)) - 1)) == 0)
+            {
+                level++;
+            }
+
+            for (unsigned int cascadeLevel = level - 1; cascadeLevel > 0; cascadeLevel--)
+            {
+                Cascade(cascadeLevel);
+            }
+
+            TimerWheelEntry*& expiredSlot = slots[0][currentTick & (SlotCount - 1)];
+            while (expiredSlot != nullptr)
+            {
+                TimerWheelEntry& entry = *expiredSlot;
+                Cancel(entry);
+                onExpired(entry);
+            }
+        }
+    }
+
+    // Returns an upper bound of the number of ticks after the current tick before the next call to Advance can expire an entry, or UINT64_MAX if the wheel is empty
+    uint64_t GetTicksUntilNextExpiry() const;
+
+    // Returns the tick the wheel was last advanced to
+    uint64_t GetCurrentTick() const
+    {
+        return currentTick;
+    }
+
+    // Returns the number of scheduled entries
+    size_t Size() const
+    {
+        return size;
+    }
+
+private:
+    // Insert an entry in the slot corresponding to the given expiry tick, which must not be before the current tick
+    void Insert(TimerWheelEntry& entry, uint64_t expiry);
+
+    // Re-insert the entries of the current slot of the given level in the lower levels
+    void Cascade(unsigned int level);
+
+    TimerWheelEntry* slots[LevelCount][SlotCount] = {};
+    uint64_t currentTick;
+    size_t size = 0;
+};
@@ -132,6 +132,18 @@ void Trace::ShortcutRemapInvoked(bool isShortcutToShortcut, bool isAppSpecific)
     }
 }
 
+// Log the result of reloading the configuration after the configuration files were changed, and the time from the first file change to the new remaps being installed
+void Trace::ConfigurationReloaded(bool isSuccessful, const DWORD64 latencyMillis) noexcept
+{
+    TraceLoggingWrite(
+        g_hProvider,
+        "KeyboardManager_ConfigurationReloaded",
+        ProjectTelemetryPrivacyDataTag(ProjectTelemetryTag_ProductAndServicePerformance),
+        TraceLoggingKeyword(PROJECT_KEYWORD_MEASURE),
+        TraceLoggingBoolean(isSuccessful, "IsSuccessful"),
+        TraceLoggingValue(latencyMillis, "LatencyMillis"));
+}
+
 // Log if an error occurs in KBM
 void Trace::Error(const DWORD errorCode, std::wstring errorMessage, std::wstring methodName) noexcept
 {
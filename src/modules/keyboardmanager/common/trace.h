@@ -24,6 +24,9 @@ public:
     // Log if a shortcut remap has been invoked
     static void ShortcutRemapInvoked(bool isShortcutToShortcut, bool isAppSpecific) noexcept;
     
+    // Log the result of reloading the configuration after the configuration files were changed, and the time from the first file change to the new remaps being installed
+    static void ConfigurationReloaded(bool isSuccessful, const DWORD64 latencyMillis) noexcept;
+
     // Log if an error occurs in KBM
     static void Error(const DWORD errorCode, std::wstring errorMessage, std::wstring methodName) noexcept;
 };
@@ -14,8 +14,76 @@ bool Input::GetVirtualKeyState(int key)
     return (GetAsyncKeyState(key) & 0x8000);
 }
 
+// Function to get the state of all the keys at once
+KeyboardStateSnapshot Input::GetKeyboardStateSnapshot()
+{
+    // GetKeyboardState cannot be used since it returns the key state of the thread's input queue, which is not updated for the keys received by the low level hook
+    KeyboardStateSnapshot keyboardState;
+    for (int key = 1; key < (int)keyboardState.size(); key++)
+    {
+        if (GetAsyncKeyState(key) & 0x8000)
+        {
+            keyboardState.set(key);
+        }
+    }
+
+    return keyboardState;
+}
+
+HWINEVENTHOOK Input::foregroundEventHook = nullptr;
+std::atomic<uint64_t> Input::foregroundChangeCount = 0;
+
 // Function to get the foreground process name
 void Input::GetForegroundProcess(_Out_ std::wstring& foregroundProcess)
 {
     foregroundProcess = KeyboardManagerHelper::GetCurrentApplication(false);
 }
+
+// Function to get the handle of the foreground window and the id of the process which owns it
+void Input::GetForegroundWindowInfo(_Out_ HWND& foregroundWindow, _Out_ DWORD& processId)
+{
+    foregroundWindow = GetForegroundWindow();
+    processId = 0;
+    if (foregroundWindow != nullptr)
+    {
+        GetWindowThreadProcessId(foregroundWindow, &processId);
+    }
+}
+
+// Function to get the number of foreground window changes which have been notified
+uint64_t Input::GetForegroundChangeCount()
+{
+    // If the notifications are not available, return a new value on every call so that the foreground window is checked on every key event
+    if (foregroundEventHook == nullptr)
+    {
+        return ++foregroundChangeCount;
+    }
+
+    return foregroundChangeCount;
+}
+
+// WinEvent procedure for foreground change notifications
+void CALLBACK Input::ForegroundEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime)
+{
+    foregroundChangeCount++;
+}
+
+// Function to start receiving foreground change notifications. Should be called from a thread with a message loop (the same thread as the low level hook)
+void Input::StartForegroundChangeNotifications()
+{
+    if (!foregroundEventHook)
+    {
+        foregroundEventHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, ForegroundEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+        foregroundChangeCount++;
+    }
+}
+
+// Function to stop receiving foreground change notifications
+void Input::StopForegroundChangeNotifications()
+{
+    if (foregroundEventHook)
+    {
+        UnhookWinEvent(foregroundEventHook);
+        foregroundEventHook = nullptr;
+    }
+}
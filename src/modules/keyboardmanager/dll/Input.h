@@ -1,10 +1,21 @@
 #pragma once
+#include <atomic>
 #include <keyboardmanager/common/InputInterface.h>
 
 // Class used to wrap keyboard input library methods
 class Input :
     public InputInterface
 {
+private:
+    // Handle of the WinEvent hook used to get foreground change notifications
+    static HWINEVENTHOOK foregroundEventHook;
+
+    // Number of foreground change notifications received by the WinEvent hook
+    static std::atomic<uint64_t> foregroundChangeCount;
+
+    // WinEvent procedure for foreground change notifications
+    static void CALLBACK ForegroundEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime);
+
 public:
     // Function to simulate input
     UINT SendVirtualInput(UINT cInputs, LPINPUT pInputs, int cbSize);
@@ -12,6 +23,21 @@ public:
     // Function to get the state of a particular key
     bool GetVirtualKeyState(int key);
 
+    // Function to get the state of all the keys at once
+    KeyboardStateSnapshot GetKeyboardStateSnapshot();
+
     // Function to get the foreground process name
     void GetForegroundProcess(_Out_ std::wstring& foregroundProcess);
+
+    // Function to get the handle of the foreground window and the id of the process which owns it
+    void GetForegroundWindowInfo(_Out_ HWND& foregroundWindow, _Out_ DWORD& processId);
+
+    // Function to get the number of foreground window changes which have been notified
+    uint64_t GetForegroundChangeCount();
+
+    // Function to start receiving foreground change notifications. Should be called from a thread with a message loop (the same thread as the low level hook)
+    void StartForegroundChangeNotifications();
+
+    // Function to stop receiving foreground change notifications
+    void StopForegroundChangeNotifications();
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include <map>
 #include <mutex>
+#include <crtdbg.h>
 #include "keyboardmanager/common/KeyboardManagerConstants.h"
 
 #include <common/LowlevelKeyboardEvent.h>
@@ -22,7 +23,7 @@ namespace KeyboardEventHandlers
     */
 
     // Function to a handle a shortcut remap
-    __declspec(dllexport) intptr_t HandleShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState, const std::optional<std::wstring>& activatedApp = std::nullopt) noexcept;
+    __declspec(dllexport) intptr_t HandleShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState, const std::wstring* activatedApp = nullptr) noexcept;
 
     // Function to a handle an os-level shortcut remap
     __declspec(dllexport) intptr_t HandleOSLevelShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept;
@@ -30,9 +31,20 @@ namespace KeyboardEventHandlers
     // Function to a handle an app-specific shortcut remap
     __declspec(dllexport) intptr_t HandleAppSpecificShortcutRemapEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept;
 
+    // Function to handle a key event received by the low level hook by running it through the UI detection and all the remap handlers. This is the starting point function for remapping
+    __declspec(dllexport) intptr_t HandleKeyboardHookEvent(InputInterface& ii, LowlevelKeyboardEvent* data, KeyboardManagerState& keyboardManagerState) noexcept;
+
     // Function to ensure Num Lock state does not change when it is suppressed by the low level hook
     void SetNumLockToPreviousState(InputInterface& ii);
 
     // Function to ensure Ctrl/Shift/Alt modifier key state is not detected as pressed down by applications which detect keys at a lower level than hooks when it is remapped for scenarios where its required
     void ResetIfModifierKeyForLowerLevelKeyHandlers(InputInterface& ii, DWORD key, DWORD target);
+
+    // Function to reset the modifier key state for lower level key handlers for each of the keys in a shortcut
+    void ResetIfModifierKeysForLowerLevelKeyHandlers(InputInterface& ii, const Shortcut& shortcut, DWORD target);
+
+#ifdef _DEBUG
+    // Function to set the debug CRT allocation hook of the dll and return the previous one. The dll links its own CRT, so a hook set by the module which loads it does not see the allocations made by the handlers
+    __declspec(dllexport) _CRT_ALLOC_HOOK SetAllocationHook(_CRT_ALLOC_HOOK allocHook) noexcept;
+#endif
 };
@@ -13,6 +13,10 @@
 #include <common/debug_control.h>
 #include <keyboardmanager/common/trace.h>
 #include <keyboardmanager/common/Helpers.h>
+#include <keyboardmanager/common/HookLatencyMetrics.h>
+#include <keyboardmanager/common/RemapProfile.h>
+#include <keyboardmanager/common/ConfigurationWatcher.h>
+#include <keyboardmanager/common/HookEventRecording.h>
 #include "KeyboardEventHandlers.h"
 #include "Input.h"
 
@@ -63,6 +67,14 @@ private:
     // Object of class which implements InputInterface. Required for calling library functions while enabling testing
     Input inputHandler;
 
+    // Watches the module save folder to reload the configuration when it is changed outside of the editor. Declared after keyboardManagerState so that it is stopped first on destruction
+    std::unique_ptr<ConfigurationWatcher> configurationWatcher;
+
+#ifdef KEYBOARDMANAGER_RECORD_HOOK_EVENTS
+    // Recording of the key events received by the hook, saved when the hook is stopped
+    HookEventRecording hookEventRecording;
+#endif
+
 public:
     // Constructor
     KeyboardManager()
@@ -70,12 +82,28 @@ public:
         // Load the initial configuration.
         load_config();
 
+        // Reload the configuration when the active configuration file is changed, e.g. when a profile is deployed by copying its file. Changes to the settings file and to other configurations are ignored
+        configurationWatcher = std::make_unique<ConfigurationWatcher>(
+            PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName),
+            [this](const std::wstring& fileName) {
+                return _wcsicmp(fileName.c_str(), (keyboardManagerState.GetCurrentConfigName() + L".json").c_str()) == 0;
+            },
+            [this](std::chrono::steady_clock::time_point firstChangeTime) {
+                reload_config(firstChangeTime);
+            });
+        if (!configurationWatcher->Start())
+        {
+            DWORD errorCode = GetLastError();
+            auto errorMessage = get_last_error_message(errorCode);
+            Trace::Error(errorCode, errorMessage.has_value() ? errorMessage.value() : L"", L"KeyboardManager.ConfigurationWatcher.Start");
+        }
+
         // Set the static pointer to the newest object of the class
         keyboardmanager_object_ptr = this;
     };
 
-    // Load config from the saved settings.
-    void load_config()
+    // Load config from the saved settings. If isStrict is true, the configuration is only installed if the configuration file is valid, otherwise the current configuration is kept. Returns true if a configuration was installed
+    bool load_config(bool isStrict = false)
     {
         try
         {
@@ -85,135 +113,20 @@ public:
 
             if (current_config)
             {
-                keyboardManagerState.SetCurrentConfigName(*current_config);
-                // Read the config file and load the remaps.
-                auto configFile = json::from_file(PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + *current_config + L".json");
-                if (configFile)
+                if (!isStrict)
                 {
-                    auto jsonData = *configFile;
-
-                    // Load single key remaps
-                    try
-                    {
-                        auto remapKeysData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapKeysSettingName);
-                        keyboardManagerState.ClearSingleKeyRemaps();
-
-                        if (remapKeysData)
-                        {
-                            auto inProcessRemapKeys = remapKeysData.GetNamedArray(KeyboardManagerConstants::InProcessRemapKeysSettingName);
-                            for (const auto& it : inProcessRemapKeys)
-                            {
-                                try
-                                {
-                                    auto originalKey = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
-                                    auto newRemapKey = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
-
-                                    // If remapped to a shortcut
-                                    if (std::wstring(newRemapKey).find(L";") != std::string::npos)
-                                    {
-                                        keyboardManagerState.AddSingleKeyRemap(std::stoul(originalKey.c_str()), Shortcut(newRemapKey.c_str()));
-                                    }
-
-                                    // If remapped to a key
-                                    else
-                                    {
-                                        keyboardManagerState.AddSingleKeyRemap(std::stoul(originalKey.c_str()), std::stoul(newRemapKey.c_str()));
-                                    }
-                                }
-                                catch (...)
-                                {
-                                    // Improper Key Data JSON. Try the next remap.
-                                }
-                            }
-                        }
-                    }
-                    catch (...)
-                    {
-                        // Improper JSON format for single key remaps. Skip to next remap type
-                    }
-
-                    // Load shortcut remaps
-                    try
-                    {
-                        auto remapShortcutsData = jsonData.GetNamedObject(KeyboardManagerConstants::RemapShortcutsSettingName);
-                        keyboardManagerState.ClearOSLevelShortcuts();
-                        keyboardManagerState.ClearAppSpecificShortcuts();
-                        if (remapShortcutsData)
-                        {
-                            // Load os level shortcut remaps
-                            try
-                            {
-                                auto globalRemapShortcuts = remapShortcutsData.GetNamedArray(KeyboardManagerConstants::GlobalRemapShortcutsSettingName);
-                                for (const auto& it : globalRemapShortcuts)
-                                {
-                                    try
-                                    {
-                                        auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
-                                        auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
-
-                                        // If remapped to a shortcut
-                                        if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
-                                        {
-                                            keyboardManagerState.AddOSLevelShortcut(Shortcut(originalKeys.c_str()), Shortcut(newRemapKeys.c_str()));
-                                        }
-
-                                        // If remapped to a key
-                                        else
-                                        {
-                                            keyboardManagerState.AddOSLevelShortcut(Shortcut(originalKeys.c_str()), std::stoul(newRemapKeys.c_str()));
-                                        }
-                                    }
-                                    catch (...)
-                                    {
-                                        // Improper Key Data JSON. Try the next shortcut.
-                                    }
-                                }
-                            }
-                            catch (...)
-                            {
-                                // Improper JSON format for os level shortcut remaps. Skip to next remap type
-                            }
-
-                            // Load app specific shortcut remaps
-                            try
-                            {
-                                auto appSpecificRemapShortcuts = remapShortcutsData.GetNamedArray(KeyboardManagerConstants::AppSpecificRemapShortcutsSettingName);
-                                for (const auto& it : appSpecificRemapShortcuts)
-                                {
-                                    try
-                                    {
-                                        auto originalKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::OriginalKeysSettingName);
-                                        auto newRemapKeys = it.GetObjectW().GetNamedString(KeyboardManagerConstants::NewRemapKeysSettingName);
-                                        auto targetApp = it.GetObjectW().GetNamedString(KeyboardManagerConstants::TargetAppSettingName);
-
-                                        // If remapped to a shortcut
-                                        if (std::wstring(newRemapKeys).find(L";") != std::string::npos)
-                                        {
-                                            keyboardManagerState.AddAppSpecificShortcut(targetApp.c_str(), Shortcut(originalKeys.c_str()), Shortcut(newRemapKeys.c_str()));
-                                        }
-
-                                        // If remapped to a key
-                                        else
-                                        {
-                                            keyboardManagerState.AddAppSpecificShortcut(targetApp.c_str(), Shortcut(originalKeys.c_str()), std::stoul(newRemapKeys.c_str()));
-                                        }
-                                    }
-                                    catch (...)
-                                    {
-                                        // Improper Key Data JSON. Try the next shortcut.
-                                    }
-                                }
-                            }
-                            catch (...)
-                            {
-                                // Improper JSON format for os level shortcut remaps. Skip to next remap type
-                            }
-                        }
-                    }
-                    catch (...)
-                    {
-                        // Improper JSON format for shortcut remaps. Skip to next remap type
-                    }
+                    keyboardManagerState.SetCurrentConfigName(*current_config);
+                }
+
+                // Build the new remap configuration separately so that the current remaps stay active until it is swapped in
+                RemapConfiguration remapConfiguration;
+
+                // Read the config file and load the remaps. The precompiled binary profile is used instead of parsing the JSON if it is up to date
+                if (RemapProfile::LoadFromFile(PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + *current_config + L".json", remapConfiguration, isStrict))
+                {
+                    keyboardManagerState.SetCurrentConfigName(*current_config);
+                    keyboardManagerState.SetRemapConfiguration(std::move(remapConfiguration));
+                    return true;
                 }
             }
         }
@@ -221,6 +134,21 @@ public:
         {
             // Unable to load inital config.
         }
+
+        return false;
+    }
+
+    // Reload the configuration on the configuration watcher thread after the configuration files were changed. The new remaps are swapped in without blocking the hook, and invalid files are rejected without changing the current remaps
+    void reload_config(std::chrono::steady_clock::time_point firstChangeTime)
+    {
+        // The configuration saved by the editor is already installed, so it is not loaded again
+        if (keyboardManagerState.IsConfigFileUnchangedSinceSave(PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + keyboardManagerState.GetCurrentConfigName() + L".json"))
+        {
+            return;
+        }
+
+        bool result = load_config(true);
+        Trace::ConfigurationReloaded(result, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - firstChangeTime).count());
     }
 
     // Destroy the powertoy and free memory
@@ -252,6 +180,11 @@ public:
         settings.set_description(IDS_SETTINGS_DESCRIPTION);
         settings.set_overview_link(L"https://aka.ms/PowerToysOverview_KeyboardManager");
 
+#ifdef KEYBOARDMANAGER_HOOK_LATENCY_METRICS
+        // Add the hook latency statistics so that they can be read through the settings channel
+        settings.add_multiline_string(L"hookLatencyMetrics", L"Keyboard hook latency statistics", HookLatencyMetrics::GetStatisticsJson().Stringify().c_str());
+#endif
+
         return settings.serialize_to_buffer(buffer, buffer_size);
     }
 
@@ -344,6 +277,9 @@ public:
         {
             event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
             event.wParam = wParam;
+#ifdef KEYBOARDMANAGER_RECORD_HOOK_EVENTS
+            keyboardmanager_object_ptr->RecordHookEvent(event);
+#endif
             if (keyboardmanager_object_ptr->HandleKeyboardHookEvent(&event) == 1)
             {
                 // Reset Num Lock whenever a NumLock key down event is suppressed since Num Lock key state change occurs before it is intercepted by low level hooks
@@ -377,6 +313,11 @@ public:
                 auto errorMessage = get_last_error_message(errorCode);
                 Trace::Error(errorCode, errorMessage.has_value() ? errorMessage.value() : L"", L"start_lowlevel_keyboard_hook.SetWindowsHookEx");
             }
+            else
+            {
+                // Foreground change notifications are used to invalidate the cached foreground process name for app-specific remaps
+                inputHandler.StartForegroundChangeNotifications();
+            }
         }
     }
 
@@ -388,82 +329,31 @@ public:
             UnhookWindowsHookEx(hook_handle);
             hook_handle = nullptr;
         }
-    }
-
-    // Function called by the hook procedure to handle the events. This is the starting point function for remapping
-    intptr_t HandleKeyboardHookEvent(LowlevelKeyboardEvent* data) noexcept
-    {
-        // If remappings are disabled (due to the remap tables getting updated) skip the rest of the hook
-        if (!keyboardManagerState.AreRemappingsEnabled())
-        {
-            return 0;
-        }
 
-        // If key has suppress flag, then suppress it
-        if (data->lParam->dwExtraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
-        {
-            return 1;
-        }
-
-        // If the Detect Key Window is currently activated, then suppress the keyboard event
-        KeyboardManagerHelper::KeyboardHookDecision singleKeyRemapUIDetected = keyboardManagerState.DetectSingleRemapKeyUIBackend(data);
-        if (singleKeyRemapUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
-        {
-            return 1;
-        }
-        else if (singleKeyRemapUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
-        {
-            return 0;
-        }
-
-        // If the Detect Shortcut Window from Remap Keys is currently activated, then suppress the keyboard event
-        KeyboardManagerHelper::KeyboardHookDecision remapKeyShortcutUIDetected = keyboardManagerState.DetectShortcutUIBackend(data, true);
-        if (remapKeyShortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
-        {
-            return 1;
-        }
-        else if (remapKeyShortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
-        {
-            return 0;
-        }
-
-        // Remap a key
-        intptr_t SingleKeyRemapResult = KeyboardEventHandlers::HandleSingleKeyRemapEvent(inputHandler, data, keyboardManagerState);
-
-        // Single key remaps have priority. If a key is remapped, only the remapped version should be visible to the shortcuts and hence the event should be suppressed here.
-        if (SingleKeyRemapResult == 1)
-        {
-            return 1;
-        }
-
-        // If the Detect Shortcut Window is currently activated, then suppress the keyboard event
-        KeyboardManagerHelper::KeyboardHookDecision shortcutUIDetected = keyboardManagerState.DetectShortcutUIBackend(data, false);
-        if (shortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::Suppress)
-        {
-            return 1;
-        }
-        else if (shortcutUIDetected == KeyboardManagerHelper::KeyboardHookDecision::SkipHook)
-        {
-            return 0;
-        }
+        inputHandler.StopForegroundChangeNotifications();
 
-        /* This feature has not been enabled (code from proof of concept stage)
-        * 
-        //// Remap a key to behave like a modifier instead of a toggle
-        //intptr_t SingleKeyToggleToModResult = KeyboardEventHandlers::HandleSingleKeyToggleToModEvent(inputHandler, data, keyboardManagerState);
-        */
-
-        // Handle an app-specific shortcut remapping
-        intptr_t AppSpecificShortcutRemapResult = KeyboardEventHandlers::HandleAppSpecificShortcutRemapEvent(inputHandler, data, keyboardManagerState);
+#ifdef KEYBOARDMANAGER_RECORD_HOOK_EVENTS
+        hookEventRecording.SaveToFile(PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + KeyboardManagerConstants::HookEventRecordingFileName);
+#endif
+    }
 
-        // If an app-specific shortcut is remapped then the os-level shortcut remapping should be suppressed.
-        if (AppSpecificShortcutRemapResult == 1)
+#ifdef KEYBOARDMANAGER_RECORD_HOOK_EVENTS
+    // Function to record a key event received by the hook. Events injected by Keyboard Manager are not recorded since replaying the recording generates them again
+    void RecordHookEvent(const LowlevelKeyboardEvent& event)
+    {
+        ULONG_PTR extraInfo = event.lParam->dwExtraInfo;
+        if (extraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG && extraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG && extraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
         {
-            return 1;
+            const std::wstring* foregroundApp = keyboardManagerState.GetForegroundApp(inputHandler);
+            hookEventRecording.AddEvent(event, foregroundApp != nullptr ? *foregroundApp : L"");
         }
+    }
+#endif
 
-        // Handle an os-level shortcut remapping
-        return KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent(inputHandler, data, keyboardManagerState);
+    // Function called by the hook procedure to handle the events. This is the starting point function for remapping
+    intptr_t HandleKeyboardHookEvent(LowlevelKeyboardEvent* data) noexcept
+    {
+        return KeyboardEventHandlers::HandleKeyboardHookEvent(inputHandler, data, keyboardManagerState);
     }
 };
 
@@ -135,6 +135,109 @@ namespace RemappingLogicTests
             // Activated app should be empty string
             Assert::AreEqual(std::wstring(KeyboardManagerConstants::NoActivatedApp), testState.GetActivatedApp());
         }
+        // Test if the foreground process name is resolved only once when the foreground app does not change
+        TEST_METHOD (AppSpecificShortcut_ShouldNotResolveForegroundProcessAgain_WhenForegroundAppDoesNotChange)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddAppSpecificShortcut(testApp1, src, dest);
+
+            // Set the testApp as the foreground process
+            mockedInputHandler.SetForegroundProcess(testApp1);
+
+            const int nInputs = 4;
+            INPUT input[nInputs] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = VK_CONTROL;
+            input[1].type = INPUT_KEYBOARD;
+            input[1].ki.wVk = 0x41;
+            input[2].type = INPUT_KEYBOARD;
+            input[2].ki.wVk = 0x41;
+            input[2].ki.dwFlags = KEYEVENTF_KEYUP;
+            input[3].type = INPUT_KEYBOARD;
+            input[3].ki.wVk = VK_CONTROL;
+            input[3].ki.dwFlags = KEYEVENTF_KEYUP;
+
+            // Press and release Ctrl+A several times
+            for (int i = 0; i < 5; i++)
+            {
+                mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+            }
+
+            // The process name should be resolved once
+            Assert::AreEqual(1, mockedInputHandler.GetForegroundProcessCallCount());
+
+            // A foreground change notification for the same window should not resolve the process name again
+            mockedInputHandler.NotifyForegroundChange();
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+            Assert::AreEqual(1, mockedInputHandler.GetForegroundProcessCallCount());
+
+            // Remap should still take place
+            mockedInputHandler.SendVirtualInput(2, input, sizeof(INPUT));
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), true);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x56), true);
+        }
+
+        // Test if the foreground process name is resolved again when the foreground app changes
+        TEST_METHOD (AppSpecificShortcut_ShouldResolveForegroundProcessAgain_WhenForegroundAppChanges)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddAppSpecificShortcut(testApp1, src, dest);
+
+            // Set a process without remaps as the foreground process
+            mockedInputHandler.SetForegroundProcess(testApp2);
+
+            const int nInputs = 2;
+            INPUT input[nInputs] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = VK_CONTROL;
+            input[1].type = INPUT_KEYBOARD;
+            input[1].ki.wVk = 0x41;
+
+            // Send Ctrl+A keydown
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+            Assert::AreEqual(1, mockedInputHandler.GetForegroundProcessCallCount());
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), true);
+
+            input[0].ki.wVk = 0x41;
+            input[0].ki.dwFlags = KEYEVENTF_KEYUP;
+            input[1].ki.wVk = VK_CONTROL;
+            input[1].ki.dwFlags = KEYEVENTF_KEYUP;
+
+            // Release A then Ctrl
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+
+            // Switch the foreground to the testApp
+            mockedInputHandler.SetForegroundProcess(testApp1);
+
+            input[0].ki.wVk = VK_CONTROL;
+            input[0].ki.dwFlags = 0;
+            input[1].ki.wVk = 0x41;
+            input[1].ki.dwFlags = 0;
+
+            // Send Ctrl+A keydown
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+
+            // The process name should be resolved again and the remap should take place
+            Assert::AreEqual(2, mockedInputHandler.GetForegroundProcessCallCount());
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), true);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x56), true);
+        }
+
         // Test if the key states get cleared if foreground app changes after app-specific shortcut is invoked and then released
         TEST_METHOD (AppSpecificShortcut_ShouldClearKeyStates_WhenForegroundAppChangesAfterShortcutIsPressedOnRelease)
         {
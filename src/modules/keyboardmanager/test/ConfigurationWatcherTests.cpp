@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <keyboardmanager/common/ConfigurationWatcher.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace KeyboardManagerCommonTests
+{
+    // Tests for the ConfigurationWatcher class
+    TEST_CLASS (ConfigurationWatcherTests)
+    {
+    private:
+        std::filesystem::path testFolder;
+        std::atomic<int> changeCount;
+        std::chrono::steady_clock::time_point firstChangeTime;
+
+        // Function to create a watcher on the test folder which only reacts to JSON files
+        std::unique_ptr<ConfigurationWatcher> CreateWatcher()
+        {
+            return std::make_unique<ConfigurationWatcher>(
+                testFolder.wstring(),
+                [](const std::wstring& fileName) {
+                    return _wcsicmp(std::filesystem::path(fileName).extension().c_str(), L".json") == 0;
+                },
+                [this](std::chrono::steady_clock::time_point changeTime) {
+                    firstChangeTime = changeTime;
+                    changeCount++;
+                },
+                std::chrono::milliseconds(100));
+        }
+
+        // Function to write a file in the test folder
+        void WriteTestFile(const std::wstring& fileName, const std::string& content)
+        {
+            std::ofstream(testFolder / fileName, std::ios::binary) << content;
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            testFolder = std::filesystem::temp_directory_path() / (L"KeyboardManagerConfigurationWatcherTests" + std::to_wstring(GetCurrentProcessId()));
+            std::filesystem::create_directories(testFolder);
+            changeCount = 0;
+        }
+
+        TEST_METHOD_CLEANUP(CleanupTestEnv)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(testFolder, error);
+        }
+
+        // Test if a burst of writes to a matching file results in a single callback after the debounce delay
+        TEST_METHOD (Watcher_ShouldCallCallbackOnce_WhenMatchingFileIsWrittenSeveralTimes)
+        {
+            auto watcher = CreateWatcher();
+            Assert::IsTrue(watcher->Start());
+
+            auto writeTime = std::chrono::steady_clock::now();
+            for (int i = 0; i < 10; i++)
+            {
+                WriteTestFile(L"default.json", std::to_string(i));
+            }
+
+            Sleep(1000);
+            watcher->Stop();
+
+            Assert::AreEqual(1, changeCount.load());
+            Assert::IsTrue(firstChangeTime >= writeTime);
+        }
+
+        // Test if changes to files which do not match the filter are ignored
+        TEST_METHOD (Watcher_ShouldNotCallCallback_WhenNonMatchingFileIsWritten)
+        {
+            auto watcher = CreateWatcher();
+            Assert::IsTrue(watcher->Start());
+
+            WriteTestFile(L"default.kmbin", "profile");
+
+            Sleep(500);
+            watcher->Stop();
+
+            Assert::AreEqual(0, changeCount.load());
+        }
+
+        // Test if Start creates the folder when it does not exist and reports the changes to files added to it
+        TEST_METHOD (Start_ShouldCreateFolderAndWatchIt_WhenFolderDoesNotExist)
+        {
+            std::filesystem::remove_all(testFolder);
+            auto watcher = CreateWatcher();
+            Assert::IsTrue(watcher->Start());
+            Assert::IsTrue(std::filesystem::is_directory(testFolder));
+
+            WriteTestFile(L"default.json", "{}");
+
+            Sleep(1000);
+            watcher->Stop();
+
+            Assert::AreEqual(1, changeCount.load());
+        }
+
+        // Test if Start fails when the folder cannot be created
+        TEST_METHOD (Start_ShouldReturnFalse_WhenFolderCannotBeCreated)
+        {
+            WriteTestFile(L"file", "content");
+            ConfigurationWatcher watcher((testFolder / L"file" / L"missing").wstring(), [](const std::wstring&) { return true; }, [](std::chrono::steady_clock::time_point) {});
+            Assert::IsFalse(watcher.Start());
+        }
+    };
+}
@@ -0,0 +1,306 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "HookEventReplayer.h"
+#include "TestHelpers.h"
+#include <keyboardmanager/common/HookEventRecording.h>
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for recording hook events and replaying them with HookEventReplayer, along with the replay benchmarks on canonical traces
+    TEST_CLASS (HookEventReplayTests)
+    {
+    private:
+        MockedInput mockedInputHandler;
+        KeyboardManagerState testState;
+        std::filesystem::path testFolder;
+
+        // Timestamp of the next generated event, events are 10 ms apart
+        DWORD time = 0;
+
+        // Function to create a shortcut from a list of keys
+        static Shortcut CreateShortcut(std::initializer_list<DWORD> keys)
+        {
+            Shortcut shortcut;
+            for (DWORD key : keys)
+            {
+                shortcut.SetKey(key);
+            }
+
+            return shortcut;
+        }
+
+        // Function to add a key down and key up event to a recording
+        void AddKeyPress(HookEventRecording& recording, DWORD key, const std::wstring& app = L"")
+        {
+            recording.AddEvent(key, WM_KEYDOWN, time += 10, app);
+            recording.AddEvent(key, WM_KEYUP, time += 10, app);
+        }
+
+        // Function to add a chord to a recording: the modifiers are pressed in order, the action key is pressed and the modifiers are released in reverse order
+        void AddChord(HookEventRecording& recording, std::initializer_list<DWORD> modifiers, DWORD key, const std::wstring& app = L"")
+        {
+            for (DWORD modifier : modifiers)
+            {
+                recording.AddEvent(modifier, WM_KEYDOWN, time += 10, app);
+            }
+
+            AddKeyPress(recording, key, app);
+            for (auto it = std::rbegin(modifiers); it != std::rend(modifiers); it++)
+            {
+                recording.AddEvent(*it, WM_KEYUP, time += 10, app);
+            }
+        }
+
+        // Canonical trace: heavy typing of text with occasional capitals while 500 os level shortcut remaps are configured, none of which match plain typing
+        HookEventRecording CreateHeavyTypingTrace()
+        {
+            const std::vector<std::vector<DWORD>> modifiers = { { VK_LCONTROL }, { VK_LMENU }, { VK_LCONTROL, VK_LSHIFT }, { VK_LMENU, VK_LSHIFT }, { VK_RCONTROL }, { VK_RMENU }, { VK_RCONTROL, VK_RSHIFT }, { VK_RMENU, VK_RSHIFT }, { VK_LWIN }, { VK_LWIN, VK_LSHIFT }, { VK_LCONTROL, VK_LMENU }, { VK_RCONTROL, VK_RMENU }, { VK_LCONTROL, VK_LMENU, VK_LSHIFT }, { VK_LWIN, VK_LCONTROL } };
+            const DWORD keyCount = 36;
+            for (DWORD i = 0; i < 500; i++)
+            {
+                DWORD key = (i % keyCount < 10) ? 0x30 + i % keyCount : 0x41 + i % keyCount - 10;
+                Shortcut shortcut;
+                for (DWORD modifier : modifiers[i / keyCount])
+                {
+                    shortcut.SetKey(modifier);
+                }
+                shortcut.SetKey(key);
+                testState.AddOSLevelShortcut(shortcut, (DWORD)(VK_F1 + i % 12));
+            }
+
+            HookEventRecording recording;
+            for (int i = 0; i < 20000; i++)
+            {
+                DWORD key = 0x41 + (DWORD)(i * 7 % 26);
+                if (i % 15 == 0)
+                {
+                    AddChord(recording, { VK_LSHIFT }, key);
+                }
+                else
+                {
+                    AddKeyPress(recording, i % 6 == 5 ? VK_SPACE : key);
+                }
+            }
+
+            return recording;
+        }
+
+        // Canonical trace: shortcut chords which are remapped to other shortcuts, pressed one at a time or several while holding the modifiers
+        HookEventRecording CreateShortcutChordTrace()
+        {
+            for (DWORD key = 0x41; key <= 0x5A; key++)
+            {
+                testState.AddOSLevelShortcut(CreateShortcut({ VK_LCONTROL, key }), CreateShortcut({ VK_LCONTROL, 0x41 + (key - 0x41 + 1) % 26 }));
+                testState.AddOSLevelShortcut(CreateShortcut({ VK_LCONTROL, VK_LSHIFT, key }), CreateShortcut({ VK_LMENU, key }));
+            }
+
+            HookEventRecording recording;
+            for (int i = 0; i < 2000; i++)
+            {
+                DWORD key = 0x41 + (DWORD)(i * 11 % 26);
+                if (i % 4 == 0)
+                {
+                    AddChord(recording, { VK_LCONTROL, VK_LSHIFT }, key);
+                }
+                else if (i % 4 == 1)
+                {
+                    // Hold Ctrl for several action keys
+                    recording.AddEvent(VK_LCONTROL, WM_KEYDOWN, time += 10, L"");
+                    AddKeyPress(recording, key);
+                    AddKeyPress(recording, 0x41 + (key - 0x41 + 5) % 26);
+                    recording.AddEvent(VK_LCONTROL, WM_KEYUP, time += 10, L"");
+                }
+                else
+                {
+                    AddChord(recording, { VK_LCONTROL }, key);
+                }
+            }
+
+            return recording;
+        }
+
+        // Canonical trace: typing and app-specific shortcut chords while switching between apps with their own remaps
+        HookEventRecording CreateAppSwitchingTrace()
+        {
+            const std::vector<std::wstring> apps = { L"msedge.exe", L"code.exe", L"notepad.exe" };
+            for (size_t app = 0; app < 2; app++)
+            {
+                for (DWORD key = 0x41; key <= 0x5A; key++)
+                {
+                    testState.AddAppSpecificShortcut(apps[app], CreateShortcut({ VK_LCONTROL, key }), (DWORD)(VK_F1 + (key + app) % 12));
+                }
+            }
+
+            HookEventRecording recording;
+            for (int i = 0; i < 5000; i++)
+            {
+                const std::wstring& app = apps[i / 50 % apps.size()];
+                DWORD key = 0x41 + (DWORD)(i * 3 % 26);
+                if (i % 5 == 0)
+                {
+                    AddChord(recording, { VK_LCONTROL }, key, app);
+                }
+                else
+                {
+                    AddKeyPress(recording, key, app);
+                }
+            }
+
+            return recording;
+        }
+
+        // Function to save a trace to a file, load it back and replay it, logging the report
+        HookEventReplayer::Report RunBenchmark(const HookEventRecording& trace, const std::wstring& name)
+        {
+            std::wstring tracePath = (testFolder / (name + KeyboardManagerConstants::HookEventRecordingFileName)).wstring();
+            Assert::IsTrue(trace.SaveToFile(tracePath));
+            HookEventRecording loadedTrace;
+            Assert::IsTrue(loadedTrace.LoadFromFile(tracePath));
+
+            HookEventReplayer replayer(mockedInputHandler, testState);
+            HookEventReplayer::Report report = replayer.Replay(loadedTrace);
+            Logger::WriteMessage((winrt::to_string(name) + ": " + HookEventReplayer::GetSummary(report) + "\n").c_str());
+            Assert::AreEqual(trace.GetEvents().size(), report.eventCount);
+            return report;
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+            time = 0;
+            testFolder = std::filesystem::temp_directory_path() / (L"KeyboardManagerHookEventReplayTests" + std::to_wstring(GetCurrentProcessId()));
+            std::filesystem::create_directories(testFolder);
+        }
+
+        TEST_METHOD_CLEANUP(CleanupTestEnv)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(testFolder, error);
+        }
+
+        // Test if a recording saved to a file is loaded with the same events and apps
+        TEST_METHOD (LoadFromFile_ShouldReturnSameEvents_WhenRecordingIsSaved)
+        {
+            HookEventRecording recording;
+            AddChord(recording, { VK_LCONTROL }, 0x41, L"msedge.exe");
+            AddKeyPress(recording, 0x42, L"notepad.exe");
+            recording.AddEvent(0x43, WM_SYSKEYDOWN, time += 10, L"msedge.exe", KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG);
+            std::wstring path = (testFolder / KeyboardManagerConstants::HookEventRecordingFileName).wstring();
+            Assert::IsTrue(recording.SaveToFile(path));
+
+            HookEventRecording loadedRecording;
+            Assert::IsTrue(loadedRecording.LoadFromFile(path));
+
+            Assert::AreEqual(recording.GetEvents().size(), loadedRecording.GetEvents().size());
+            for (size_t i = 0; i < recording.GetEvents().size(); i++)
+            {
+                const auto& expected = recording.GetEvents()[i];
+                const auto& actual = loadedRecording.GetEvents()[i];
+                Assert::AreEqual(0, memcmp(&expected, &actual, sizeof(HookEventRecording::Event)));
+                Assert::AreEqual(recording.GetApp(expected), loadedRecording.GetApp(actual));
+            }
+        }
+
+        // Test if a truncated recording is rejected without modifying the recording
+        TEST_METHOD (LoadFromFile_ShouldReturnFalse_WhenRecordingIsTruncated)
+        {
+            HookEventRecording recording;
+            AddKeyPress(recording, 0x41, L"msedge.exe");
+            std::wstring path = (testFolder / KeyboardManagerConstants::HookEventRecordingFileName).wstring();
+            Assert::IsTrue(recording.SaveToFile(path));
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+            HookEventRecording loadedRecording;
+            AddKeyPress(loadedRecording, 0x42);
+            Assert::IsFalse(loadedRecording.LoadFromFile(path));
+            Assert::AreEqual((size_t)2, loadedRecording.GetEvents().size());
+            Assert::AreEqual(0x42, (int)loadedRecording.GetEvents()[0].vkCode);
+        }
+
+        // Test if a recording whose header has more events than the file contains is rejected without modifying the recording
+        TEST_METHOD (LoadFromFile_ShouldReturnFalse_WhenEventCountExceedsFileSize)
+        {
+            HookEventRecording recording;
+            AddKeyPress(recording, 0x41, L"msedge.exe");
+            std::wstring path = (testFolder / KeyboardManagerConstants::HookEventRecordingFileName).wstring();
+            Assert::IsTrue(recording.SaveToFile(path));
+
+            // Overwrite the event count, which is the fourth field of the header
+            uint32_t eventCount = UINT32_MAX;
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(3 * sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(&eventCount), sizeof(eventCount));
+            file.close();
+
+            HookEventRecording loadedRecording;
+            AddKeyPress(loadedRecording, 0x42);
+            Assert::IsFalse(loadedRecording.LoadFromFile(path));
+            Assert::AreEqual((size_t)2, loadedRecording.GetEvents().size());
+            Assert::AreEqual(0x42, (int)loadedRecording.GetEvents()[0].vkCode);
+        }
+
+        // Test if the transcript has the decision of the hook for each replayed event and the events injected by a shortcut remap
+        TEST_METHOD (Replay_ShouldRecordInjectedEventsInTranscript_WhenShortcutIsRemapped)
+        {
+            // Remap Ctrl+A to Alt+V
+            testState.AddOSLevelShortcut(CreateShortcut({ VK_LCONTROL, 0x41 }), CreateShortcut({ VK_LMENU, 0x56 }));
+            HookEventRecording recording;
+            recording.AddEvent(VK_LCONTROL, WM_KEYDOWN, time += 10, L"");
+            recording.AddEvent(0x41, WM_KEYDOWN, time += 10, L"");
+
+            HookEventReplayer replayer(mockedInputHandler, testState);
+            HookEventReplayer::Report report = replayer.Replay(recording);
+
+            // Ctrl is passed, A is suppressed and replaced by the target shortcut, with the dummy key event
+            Assert::AreEqual((size_t)2, report.eventCount);
+            Assert::AreEqual(std::string("replayed A2 down 0 passed"), report.transcript[0]);
+            Assert::AreEqual(std::string("replayed 41 down 0 suppressed"), report.transcript[1]);
+            bool isTargetKeyInjected = false;
+            for (size_t i = 2; i < report.transcript.size(); i++)
+            {
+                Assert::AreEqual(0, (int)report.transcript[i].find("  injected"));
+                isTargetKeyInjected = isTargetKeyInjected || report.transcript[i].find("  injected 56 down 101") == 0;
+            }
+
+            Assert::IsTrue(isTargetKeyInjected);
+        }
+
+        // Test if replaying the same trace twice gives the same transcript, so that transcripts of two builds can be compared
+        TEST_METHOD (Replay_ShouldReturnSameTranscript_WhenTraceIsReplayedTwice)
+        {
+            HookEventRecording trace = CreateShortcutChordTrace();
+            HookEventReplayer replayer(mockedInputHandler, testState);
+
+            HookEventReplayer::Report firstReport = replayer.Replay(trace);
+            HookEventReplayer::Report secondReport = replayer.Replay(trace);
+
+            Assert::IsTrue(firstReport.transcript == secondReport.transcript);
+            Assert::IsTrue(HookEventReplayer::SaveReport(firstReport, (testFolder / L"transcript.txt").wstring()));
+        }
+
+        // Benchmark replaying heavy typing with 500 shortcut remaps configured
+        TEST_METHOD (Replay_Benchmark_HeavyTypingWith500Remaps)
+        {
+            RunBenchmark(CreateHeavyTypingTrace(), L"HeavyTyping");
+        }
+
+        // Benchmark replaying remapped shortcut chords
+        TEST_METHOD (Replay_Benchmark_ShortcutChords)
+        {
+            RunBenchmark(CreateShortcutChordTrace(), L"ShortcutChords");
+        }
+
+        // Benchmark replaying typing and app-specific shortcuts while switching between apps
+        TEST_METHOD (Replay_Benchmark_AppSwitching)
+        {
+            RunBenchmark(CreateAppSwitchingTrace(), L"AppSwitching");
+        }
+    };
+}
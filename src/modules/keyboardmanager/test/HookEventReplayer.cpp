@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "HookEventReplayer.h"
+#include <keyboardmanager/common/HookEventRecording.h>
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include <keyboardmanager/dll/KeyboardEventHandlers.h>
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+    // Function to format a key event for the transcript
+    std::string FormatKeyEvent(const char* prefix, const LowlevelKeyboardEvent* data)
+    {
+        bool isKeyUp = (data->wParam == WM_KEYUP || data->wParam == WM_SYSKEYUP);
+        char line[64];
+        sprintf_s(line, "%s %02X %s %llX", prefix, data->lParam->vkCode, isKeyUp ? "up" : "down", (unsigned long long)data->lParam->dwExtraInfo);
+        return line;
+    }
+
+    // Function to get a percentile of sorted latencies
+    uint64_t GetPercentile(const std::vector<uint64_t>& sortedLatencies, size_t percentile)
+    {
+        return sortedLatencies.empty() ? 0 : sortedLatencies[(sortedLatencies.size() - 1) * percentile / 100];
+    }
+}
+
+HookEventReplayer::HookEventReplayer(MockedInput& mockedInputHandler, KeyboardManagerState& keyboardManagerState) :
+    mockedInputHandler(mockedInputHandler), keyboardManagerState(keyboardManagerState)
+{
+}
+
+// Function to replay all the events of a recording. The keyboard state of the mocked input is reset before the replay, and its hook procedure is replaced during the replay
+HookEventReplayer::Report HookEventReplayer::Replay(const HookEventRecording& recording)
+{
+    Report report;
+    const auto& events = recording.GetEvents();
+    report.transcript.reserve(events.size() * 2);
+
+    // Events received by the hook while a replayed event is handled have been injected by the handlers
+    int hookDepth = 0;
+    mockedInputHandler.ResetKeyboardState();
+    mockedInputHandler.SetHookProc([this, &report, &hookDepth](LowlevelKeyboardEvent* data) {
+        size_t lineIndex = report.transcript.size();
+        report.transcript.push_back(FormatKeyEvent(hookDepth == 0 ? "replayed" : "  injected", data));
+
+        hookDepth++;
+        intptr_t result = KeyboardEventHandlers::HandleKeyboardHookEvent(mockedInputHandler, data, keyboardManagerState);
+        hookDepth--;
+
+        report.transcript[lineIndex] += (result == 1) ? " suppressed" : " passed";
+        return result;
+    });
+
+    HookLatencyMetrics::Reset();
+    std::vector<uint64_t> latencies;
+    latencies.reserve(events.size());
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    const std::wstring* foregroundApp = nullptr;
+    LARGE_INTEGER replayStart;
+    QueryPerformanceCounter(&replayStart);
+    for (const auto& recordedEvent : events)
+    {
+        // Only notify a foreground change when the app changes, as the system does
+        const std::wstring& app = recording.GetApp(recordedEvent);
+        if (foregroundApp == nullptr || *foregroundApp != app)
+        {
+            mockedInputHandler.SetForegroundProcess(app);
+            foregroundApp = &app;
+        }
+
+        WPARAM message = WM_KEYFIRST + recordedEvent.message;
+        INPUT input = {};
+        input.type = INPUT_KEYBOARD;
+        input.ki.wVk = recordedEvent.vkCode;
+        input.ki.dwFlags = (message == WM_KEYUP || message == WM_SYSKEYUP) ? KEYEVENTF_KEYUP : 0;
+        input.ki.time = recordedEvent.time;
+        input.ki.dwExtraInfo = (ULONG_PTR)recordedEvent.extraInfo;
+
+        LARGE_INTEGER eventStart;
+        LARGE_INTEGER eventEnd;
+        QueryPerformanceCounter(&eventStart);
+        mockedInputHandler.SendVirtualInput(1, &input, sizeof(INPUT));
+        QueryPerformanceCounter(&eventEnd);
+        latencies.push_back((uint64_t)((eventEnd.QuadPart - eventStart.QuadPart) * 1000000000 / frequency.QuadPart));
+    }
+
+    LARGE_INTEGER replayEnd;
+    QueryPerformanceCounter(&replayEnd);
+    mockedInputHandler.SetHookProc(nullptr);
+
+    report.eventCount = events.size();
+    double replaySeconds = (double)(replayEnd.QuadPart - replayStart.QuadPart) / frequency.QuadPart;
+    report.eventsPerSecond = replaySeconds > 0 ? report.eventCount / replaySeconds : 0;
+
+    std::sort(latencies.begin(), latencies.end());
+    report.latencyP50 = GetPercentile(latencies, 50);
+    report.latencyP99 = GetPercentile(latencies, 99);
+    report.latencyMax = latencies.empty() ? 0 : latencies.back();
+
+    for (size_t stage = 0; stage < (size_t)HookLatencyMetrics::Stage::Count; stage++)
+    {
+        report.handlerStatistics[stage] = HookLatencyMetrics::GetStatistics((HookLatencyMetrics::Stage)stage);
+    }
+
+    return report;
+}
+
+// Function to write a report to a text file, with the statistics followed by the transcript. Returns false if the file cannot be written
+bool HookEventReplayer::SaveReport(const Report& report, const std::wstring& path)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    file << GetSummary(report) << "\n";
+    for (size_t stage = 0; stage < (size_t)HookLatencyMetrics::Stage::Count; stage++)
+    {
+        const auto& statistics = report.handlerStatistics[stage];
+        file << "stage " << stage << ": count " << statistics.count << ", p50 " << statistics.p50 << ", p99 " << statistics.p99 << ", max " << statistics.max << " cycles\n";
+    }
+
+    for (const auto& line : report.transcript)
+    {
+        file << line << "\n";
+    }
+
+    return file.good();
+}
+
+// Function to get a one line summary of the statistics of a report
+std::string HookEventReplayer::GetSummary(const Report& report)
+{
+    return std::to_string(report.eventCount) + " events, " + std::to_string((uint64_t)report.eventsPerSecond) + " events/s, latency p50 " + std::to_string(report.latencyP50) + " ns, p99 " + std::to_string(report.latencyP99) + " ns, max " + std::to_string(report.latencyMax) + " ns";
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "MockedInput.h"
+#include <keyboardmanager/common/HookLatencyMetrics.h>
+
+class KeyboardManagerState;
+class HookEventRecording;
+
+// Headless replayer which pushes the events of a hook event recording through KeyboardEventHandlers::HandleKeyboardHookEvent as fast as possible, using MockedInput to simulate the keyboard
+class HookEventReplayer
+{
+public:
+    // Result of a replay
+    struct Report
+    {
+        // Number of replayed events, excluding the events injected by the handlers
+        size_t eventCount = 0;
+
+        double eventsPerSecond = 0;
+
+        // Latency distribution of the hook for the replayed events, in nanoseconds. This includes the handling of the events injected by the handlers, since MockedInput sends them to the hook synchronously
+        uint64_t latencyP50 = 0;
+        uint64_t latencyP99 = 0;
+        uint64_t latencyMax = 0;
+
+        // Latency statistics of each hook handler, in TSC cycles. These are only recorded if KEYBOARDMANAGER_HOOK_LATENCY_METRICS is defined in debug_control.h
+        HookLatencyMetrics::Statistics handlerStatistics[(size_t)HookLatencyMetrics::Stage::Count];
+
+        // Transcript of the replay: a line for each replayed event with the decision of the hook, followed by a line for each event injected while handling it. The transcripts of two builds can be diffed to find behavior changes
+        std::vector<std::string> transcript;
+    };
+
+private:
+    MockedInput& mockedInputHandler;
+    KeyboardManagerState& keyboardManagerState;
+
+public:
+    HookEventReplayer(MockedInput& mockedInputHandler, KeyboardManagerState& keyboardManagerState);
+
+    // Function to replay all the events of a recording. The keyboard state of the mocked input is reset before the replay, and its hook procedure is replaced during the replay
+    Report Replay(const HookEventRecording& recording);
+
+    // Function to write a report to a text file, with the statistics followed by the transcript. Returns false if the file cannot be written
+    static bool SaveReport(const Report& report, const std::wstring& path);
+
+    // Function to get a one line summary of the statistics of a report
+    static std::string GetSummary(const Report& report);
+};
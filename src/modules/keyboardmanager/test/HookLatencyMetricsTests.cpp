@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <keyboardmanager/common/HookLatencyMetrics.h>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace KeyboardManagerCommonTests
+{
+    // Tests for the hook latency histograms
+    TEST_CLASS (HookLatencyMetricsTests)
+    {
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            HookLatencyMetrics::Reset();
+        }
+
+        // Test if every latency falls in a bucket whose upper bound is at least the latency and within 25% of it
+        TEST_METHOD (GetBucketIndex_ShouldReturnBucketContainingLatency_WhenLatencyIsRecorded)
+        {
+            for (uint64_t value : { 0ull, 1ull, 3ull, 4ull, 7ull, 8ull, 9ull, 10ull, 1000ull, 123456789ull, 0xFFFFFFFFFFFFFFFFull })
+            {
+                unsigned int bucketIndex = HookLatencyMetrics::GetBucketIndex(value);
+                uint64_t upperBound = HookLatencyMetrics::GetBucketUpperBound(bucketIndex);
+
+                // Assert that the value is in the bucket and not in the previous one
+                Assert::IsTrue(bucketIndex < HookLatencyMetrics::BucketCount);
+                Assert::IsTrue(value <= upperBound);
+                Assert::IsTrue(bucketIndex == 0 || value > HookLatencyMetrics::GetBucketUpperBound(bucketIndex - 1));
+                Assert::IsTrue(upperBound - value <= value / 4);
+            }
+        }
+
+        // Test if the statistics are empty when no latency is recorded
+        TEST_METHOD (GetStatistics_ShouldReturnZeroCount_WhenNoLatencyIsRecorded)
+        {
+            HookLatencyMetrics::Statistics statistics = HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::SingleKeyRemap);
+
+            Assert::AreEqual(0ull, statistics.count);
+            Assert::AreEqual(0ull, statistics.p50);
+            Assert::AreEqual(0ull, statistics.p99);
+            Assert::AreEqual(0ull, statistics.max);
+        }
+
+        // Test if the percentiles are computed from the recorded latencies of a stage
+        TEST_METHOD (GetStatistics_ShouldReturnPercentilesAndMax_WhenLatenciesAreRecorded)
+        {
+            // Record 98 events of 100 cycles, 1 event of 1000 cycles and 1 event of 100000 cycles
+            for (int i = 0; i < 98; i++)
+            {
+                HookLatencyMetrics::RecordLatency(HookLatencyMetrics::Stage::OSLevelShortcutRemap, 100);
+            }
+            HookLatencyMetrics::RecordLatency(HookLatencyMetrics::Stage::OSLevelShortcutRemap, 1000);
+            HookLatencyMetrics::RecordLatency(HookLatencyMetrics::Stage::OSLevelShortcutRemap, 100000);
+
+            HookLatencyMetrics::Statistics statistics = HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::OSLevelShortcutRemap);
+
+            // Percentiles are reported as the upper bound of the bucket
+            Assert::AreEqual(100ull, statistics.count);
+            Assert::AreEqual(HookLatencyMetrics::GetBucketUpperBound(HookLatencyMetrics::GetBucketIndex(100)), statistics.p50);
+            Assert::AreEqual(HookLatencyMetrics::GetBucketUpperBound(HookLatencyMetrics::GetBucketIndex(1000)), statistics.p99);
+            Assert::AreEqual(100000ull, statistics.max);
+
+            // Other stages should not be affected
+            Assert::AreEqual(0ull, HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::SingleKeyRemap).count);
+        }
+
+        // Test if the percentiles are capped to the maximum recorded latency
+        TEST_METHOD (GetStatistics_ShouldNotReturnPercentileAboveMax_WhenLatencyIsNotABucketUpperBound)
+        {
+            HookLatencyMetrics::RecordLatency(HookLatencyMetrics::Stage::KeyDelay, 1000);
+
+            HookLatencyMetrics::Statistics statistics = HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::KeyDelay);
+
+            Assert::AreEqual(1000ull, statistics.p50);
+            Assert::AreEqual(1000ull, statistics.p99);
+            Assert::AreEqual(1000ull, statistics.max);
+        }
+
+        // Test if the latencies recorded on different threads are aggregated
+        TEST_METHOD (GetStatistics_ShouldAggregateAllThreads_WhenLatenciesAreRecordedOnMultipleThreads)
+        {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < 4; i++)
+            {
+                threads.emplace_back([i]() {
+                    for (int j = 0; j < 1000; j++)
+                    {
+                        HookLatencyMetrics::RecordLatency(HookLatencyMetrics::Stage::HookEvent, 50 + i);
+                    }
+                });
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            HookLatencyMetrics::Statistics statistics = HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::HookEvent);
+
+            Assert::AreEqual(4000ull, statistics.count);
+            Assert::AreEqual(53ull, statistics.max);
+        }
+
+        // Test if Reset clears the recorded latencies
+        TEST_METHOD (Reset_ShouldClearStatistics_WhenLatenciesAreRecorded)
+        {
+            HookLatencyMetrics::RecordLatency(HookLatencyMetrics::Stage::UIDetect, 500);
+
+            HookLatencyMetrics::Reset();
+
+            Assert::AreEqual(0ull, HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::UIDetect).count);
+            Assert::AreEqual(0ull, HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::UIDetect).max);
+        }
+
+        // Test if the json statistics contain an entry for every stage
+        TEST_METHOD (GetStatisticsJson_ShouldContainAllStages_WhenCalled)
+        {
+            HookLatencyMetrics::RecordLatency(HookLatencyMetrics::Stage::AppSpecificShortcutRemap, 200);
+
+            json::JsonObject statisticsJson = HookLatencyMetrics::GetStatisticsJson();
+
+            for (auto stageName : { L"hookEvent", L"uiDetect", L"keyDelay", L"singleKeyRemap", L"appSpecificShortcutRemap", L"osLevelShortcutRemap" })
+            {
+                Assert::IsTrue(json::has(statisticsJson, stageName));
+            }
+            Assert::AreEqual(1.0, statisticsJson.GetNamedObject(L"appSpecificShortcutRemap").GetNamedNumber(L"count"));
+        }
+
+        // Test if an event timer records its parts as a single sample which excludes the nested stages
+        TEST_METHOD (EventTimer_ShouldRecordOneSampleWithoutNestedStages_WhenMeasuredInSeveralParts)
+        {
+            {
+                HookLatencyMetrics::EventTimer eventTimer(HookLatencyMetrics::Stage::UIDetect);
+                for (int i = 0; i < 3; i++)
+                {
+                    HookLatencyMetrics::EventTimer::Part part(eventTimer);
+                    HookLatencyMetrics::ScopedTimer nestedTimer(HookLatencyMetrics::Stage::KeyDelay);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+
+            HookLatencyMetrics::Statistics eventStatistics = HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::UIDetect);
+            HookLatencyMetrics::Statistics nestedStatistics = HookLatencyMetrics::GetStatistics(HookLatencyMetrics::Stage::KeyDelay);
+
+            Assert::AreEqual(1ull, eventStatistics.count);
+            Assert::AreEqual(3ull, nestedStatistics.count);
+            Assert::IsTrue(eventStatistics.max < nestedStatistics.max);
+        }
+    };
+}
@@ -0,0 +1,232 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include <keyboardmanager/common/InputBatch.h>
+#include <keyboardmanager/dll/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+#include "../common/shared_constants.h"
+#include <crtdbg.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    // Allocation tracking used to check that the remap handlers do not allocate memory. The test module and the keyboard manager dll each link their own CRT, so a debug CRT allocation hook is set in both of them and their allocations are counted separately. Only allocations on the thread which enabled the tracking are counted
+    DWORD trackedThreadId = 0;
+    size_t testAllocationCount = 0;
+    size_t dllAllocationCount = 0;
+
+#ifdef _DEBUG
+    bool IsTrackedAllocation(int allocType)
+    {
+        return (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && GetCurrentThreadId() == trackedThreadId;
+    }
+
+    int TestAllocationHook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber)
+    {
+        if (IsTrackedAllocation(allocType))
+        {
+            testAllocationCount++;
+        }
+
+        return TRUE;
+    }
+
+    int DllAllocationHook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber)
+    {
+        if (IsTrackedAllocation(allocType))
+        {
+            dllAllocationCount++;
+        }
+
+        return TRUE;
+    }
+#endif
+}
+
+namespace RemappingLogicTests
+{
+    // Tests for the InputBatch used by the remap handlers
+    TEST_CLASS (InputBatchTests)
+    {
+    private:
+        MockedInput mockedInputHandler;
+        KeyboardManagerState testState;
+        std::wstring testApp = L"testprocess.exe";
+
+        // Function to send a key event through the mocked input
+        void SendKeyEvent(WORD key, DWORD flags)
+        {
+            INPUT input = {};
+            input.type = INPUT_KEYBOARD;
+            input.ki.wVk = key;
+            input.ki.dwFlags = flags;
+            mockedInputHandler.SendVirtualInput(1, &input, sizeof(INPUT));
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+
+            // Set the single key, app-specific and os level shortcut remap handlers as the hook procedure, in the same order as the keyboard manager hook
+            mockedInputHandler.SetHookProc([this](LowlevelKeyboardEvent* data) {
+                if (data->lParam->dwExtraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return (intptr_t)1;
+                }
+
+                if (KeyboardEventHandlers::HandleSingleKeyRemapEvent(mockedInputHandler, data, testState) == 1)
+                {
+                    return (intptr_t)1;
+                }
+
+                if (KeyboardEventHandlers::HandleAppSpecificShortcutRemapEvent(mockedInputHandler, data, testState) == 1)
+                {
+                    return (intptr_t)1;
+                }
+
+                return KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent(mockedInputHandler, data, testState);
+            });
+        }
+
+        // Test if Clear removes all the events from the batch
+        TEST_METHOD (Clear_ShouldRemoveAllEvents_WhenBatchIsNotEmpty)
+        {
+            InputBatch batch;
+            Assert::IsNotNull(batch.Append());
+            Assert::IsNotNull(batch.Append());
+            Assert::AreEqual(2u, batch.Size());
+
+            batch.Clear();
+            Assert::AreEqual(true, batch.IsEmpty());
+
+            // Appended events should be zero initialized even if the storage was used before
+            LPINPUT keyEvent = batch.Append();
+            Assert::AreEqual<unsigned int>(0, keyEvent->ki.wVk);
+            Assert::AreEqual<unsigned int>(0, keyEvent->ki.dwFlags);
+        }
+
+#ifdef _DEBUG
+        // Function to send the key events of all the remaps set by the allocation test
+        void SendRemapEvents()
+        {
+            // Single key remaps
+            SendKeyEvent(0x41, 0);
+            SendKeyEvent(0x41, KEYEVENTF_KEYUP);
+            SendKeyEvent(0x43, 0);
+            SendKeyEvent(0x43, KEYEVENTF_KEYUP);
+
+            // Shortcut to shortcut, released in order
+            SendKeyEvent(VK_LCONTROL, 0);
+            SendKeyEvent(0x44, 0);
+            SendKeyEvent(0x44, 0);
+            SendKeyEvent(0x44, KEYEVENTF_KEYUP);
+            SendKeyEvent(VK_LCONTROL, KEYEVENTF_KEYUP);
+
+            // Shortcut to shortcut, modifier released first
+            SendKeyEvent(VK_LCONTROL, 0);
+            SendKeyEvent(0x44, 0);
+            SendKeyEvent(VK_LCONTROL, KEYEVENTF_KEYUP);
+            SendKeyEvent(0x44, KEYEVENTF_KEYUP);
+
+            // Shortcut to shortcut, interrupted by another key
+            SendKeyEvent(VK_LCONTROL, 0);
+            SendKeyEvent(0x44, 0);
+            SendKeyEvent(0x47, 0);
+            SendKeyEvent(0x47, KEYEVENTF_KEYUP);
+            SendKeyEvent(0x44, KEYEVENTF_KEYUP);
+            SendKeyEvent(VK_LCONTROL, KEYEVENTF_KEYUP);
+
+            // Shortcut to key
+            SendKeyEvent(VK_LWIN, 0);
+            SendKeyEvent(0x45, 0);
+            SendKeyEvent(0x45, KEYEVENTF_KEYUP);
+            SendKeyEvent(VK_LWIN, KEYEVENTF_KEYUP);
+
+            // App-specific shortcut to shortcut
+            SendKeyEvent(VK_LCONTROL, 0);
+            SendKeyEvent(0x48, 0);
+            SendKeyEvent(0x48, KEYEVENTF_KEYUP);
+            SendKeyEvent(VK_LCONTROL, KEYEVENTF_KEYUP);
+        }
+
+        // Test if the remap handlers do not make any heap allocations while remapping keys and shortcuts. Allocation tracking requires the debug CRT, so the test only exists in debug builds
+        TEST_METHOD (RemapHandlers_ShouldNotAllocate_WhenRemappingKeysAndShortcuts)
+        {
+            // Remap A to B and C to Ctrl+V
+            testState.AddSingleKeyRemap(0x41, (DWORD)0x42);
+            Shortcut singleKeyTarget;
+            singleKeyTarget.SetKey(VK_CONTROL);
+            singleKeyTarget.SetKey(0x56);
+            testState.AddSingleKeyRemap(0x43, singleKeyTarget);
+
+            // Remap Ctrl+D to Alt+Shift+V and Win+E to F
+            Shortcut src1;
+            src1.SetKey(VK_CONTROL);
+            src1.SetKey(0x44);
+            Shortcut dest1;
+            dest1.SetKey(VK_MENU);
+            dest1.SetKey(VK_SHIFT);
+            dest1.SetKey(0x56);
+            testState.AddOSLevelShortcut(src1, dest1);
+            Shortcut src2;
+            src2.SetKey(CommonSharedConstants::VK_WIN_BOTH);
+            src2.SetKey(0x45);
+            testState.AddOSLevelShortcut(src2, (DWORD)0x46);
+
+            // Remap Ctrl+H to Ctrl+J for the test app
+            Shortcut src3;
+            src3.SetKey(VK_CONTROL);
+            src3.SetKey(0x48);
+            Shortcut dest3;
+            dest3.SetKey(VK_CONTROL);
+            dest3.SetKey(0x4A);
+            testState.AddAppSpecificShortcut(testApp, src3, dest3);
+            mockedInputHandler.SetForegroundProcess(testApp);
+
+            // Run the events once so that the allocations made on first use, such as resolving the foreground app, are not counted
+            SendRemapEvents();
+
+            trackedThreadId = GetCurrentThreadId();
+            testAllocationCount = 0;
+            dllAllocationCount = 0;
+            _CRT_ALLOC_HOOK previousTestHook = _CrtSetAllocHook(TestAllocationHook);
+            _CRT_ALLOC_HOOK previousDllHook = KeyboardEventHandlers::SetAllocationHook(DllAllocationHook);
+
+            // A new foreground window makes the handlers resolve the foreground app again, which allocates in the dll. This checks that the allocations of the handlers are seen by the hook
+            mockedInputHandler.SetForegroundProcess(testApp);
+            SendKeyEvent(0x47, 0);
+            SendKeyEvent(0x47, KEYEVENTF_KEYUP);
+            size_t foregroundChangeAllocationCount = dllAllocationCount;
+            testAllocationCount = 0;
+            dllAllocationCount = 0;
+
+            const int iterations = 1000;
+            for (int i = 0; i < iterations; i++)
+            {
+                SendRemapEvents();
+            }
+
+            KeyboardEventHandlers::SetAllocationHook(previousDllHook);
+            _CrtSetAllocHook(previousTestHook);
+            trackedThreadId = 0;
+
+            Assert::AreNotEqual<size_t>(0, foregroundChangeAllocationCount);
+            Assert::AreEqual<size_t>(0, dllAllocationCount);
+            Assert::AreEqual<size_t>(0, testAllocationCount);
+
+            // All the keys should be released at the end of the run
+            std::vector<WORD> keys = { 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x4A, 0x56, VK_CONTROL, VK_LCONTROL, VK_MENU, VK_SHIFT, VK_LWIN };
+            for (auto key : keys)
+            {
+                Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(key));
+            }
+            Assert::AreEqual(false, testState.CheckShortcutRemapInvoked(std::nullopt));
+            Assert::AreEqual(KeyboardManagerConstants::NoActivatedApp, testState.GetActivatedApp());
+        }
+#endif
+    };
+}
@@ -0,0 +1,319 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include <keyboardmanager/common/KeyDelayScheduler.h>
+#include <keyboardmanager/common/TimerWheel.h>
+#include <tlhelp32.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace KeyboardManagerCommonTests
+{
+    // Tests for the KeyDelay state machines and the scheduler thread which runs them
+    TEST_CLASS (KeyDelayTests)
+    {
+    private:
+        // Number of keys registered by the scale tests
+        static const DWORD KeyCount = 100;
+
+        // Function to count the threads of the test process
+        static size_t GetThreadCount()
+        {
+            size_t threadCount = 0;
+            HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+            THREADENTRY32 threadEntry = {};
+            threadEntry.dwSize = sizeof(threadEntry);
+            if (Thread32First(snapshot, &threadEntry))
+            {
+                do
+                {
+                    if (threadEntry.th32OwnerProcessID == GetCurrentProcessId())
+                    {
+                        threadCount++;
+                    }
+                } while (Thread32Next(snapshot, &threadEntry));
+            }
+
+            CloseHandle(snapshot);
+            return threadCount;
+        }
+
+        // Function to post a key event with the given timestamp to the scheduler
+        static void SendKeyEvent(KeyDelayScheduler& scheduler, DWORD key, WPARAM message, DWORD time)
+        {
+            KBDLLHOOKSTRUCT hookStruct = {};
+            hookStruct.vkCode = key;
+            hookStruct.time = time;
+            LowlevelKeyboardEvent ev = { &hookStruct, message };
+            Assert::IsTrue(scheduler.KeyEvent(&ev));
+        }
+
+        // Function to wait until the counter reaches the expected value, returns false on timeout
+        static bool WaitForCount(const std::atomic<int>& counter, int expected, DWORD timeoutMillis)
+        {
+            ULONGLONG start = GetTickCount64();
+            while (counter.load() < expected)
+            {
+                if (GetTickCount64() - start > timeoutMillis)
+                {
+                    return false;
+                }
+
+                std::this_thread::yield();
+            }
+
+            return true;
+        }
+
+    public:
+        // Test if registering many delayed keys does not create one thread per key
+        TEST_METHOD (RegisterKeyDelay_ShouldKeepThreadCountConstant_When100KeysAreRegistered)
+        {
+            KeyboardManagerState testState;
+
+            // The scheduler thread is started by the first registration
+            testState.RegisterKeyDelay(0x100, nullptr, nullptr, nullptr);
+            size_t threadCount = GetThreadCount();
+
+            for (DWORD key = 1; key < KeyCount; key++)
+            {
+                testState.RegisterKeyDelay(0x100 + key, nullptr, nullptr, nullptr);
+            }
+
+            // Assert that no thread was created for the other keys
+            Assert::AreEqual(threadCount, GetThreadCount());
+            testState.ClearRegisteredKeyDelays();
+        }
+
+        // Test if short presses on 100 delayed keys are dispatched with sub-millisecond jitter
+        TEST_METHOD (KeyEvent_ShouldDispatchShortPressWithSubMillisecondJitter_When100KeysArePressed)
+        {
+            KeyDelayScheduler scheduler;
+            std::atomic<int> shortPressCount = 0;
+            std::vector<LARGE_INTEGER> dispatchTimes(KeyCount);
+            for (DWORD key = 0; key < KeyCount; key++)
+            {
+                scheduler.Register(
+                    key,
+                    [&shortPressCount, &dispatchTimes](DWORD pressedKey) {
+                        QueryPerformanceCounter(&dispatchTimes[pressedKey]);
+                        shortPressCount++;
+                    },
+                    nullptr,
+                    nullptr);
+            }
+
+            std::vector<LONGLONG> latencies;
+            for (DWORD key = 0; key < KeyCount; key++)
+            {
+                DWORD time = GetTickCount();
+                SendKeyEvent(scheduler, key, WM_KEYDOWN, time);
+
+                LARGE_INTEGER keyUpTime;
+                QueryPerformanceCounter(&keyUpTime);
+                SendKeyEvent(scheduler, key, WM_KEYUP, time + 10);
+                Assert::IsTrue(WaitForCount(shortPressCount, (int)key + 1, 1000));
+                latencies.push_back(dispatchTimes[key].QuadPart - keyUpTime.QuadPart);
+            }
+
+            // Assert that the 95th percentile of the dispatch latency is within a millisecond of the fastest dispatch
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            std::sort(latencies.begin(), latencies.end());
+            LONGLONG jitter = latencies[latencies.size() * 95 / 100] - latencies[0];
+            Logger::WriteMessage(("Short press dispatch jitter (us): " + std::to_string(jitter * 1000000 / frequency.QuadPart)).c_str());
+            Assert::IsTrue(jitter * 1000 < frequency.QuadPart);
+        }
+
+        // Test if a key held down past the long press delay triggers the long press callbacks but not the short press one
+        TEST_METHOD (KeyEvent_ShouldDetectLongPress_WhenKeyIsHeldPastTheDelay)
+        {
+            KeyDelayScheduler scheduler;
+            std::atomic<int> shortPressCount = 0;
+            std::atomic<int> longPressDetectedCount = 0;
+            std::atomic<int> longPressReleasedCount = 0;
+            scheduler.Register(
+                0x41,
+                [&shortPressCount](DWORD) { shortPressCount++; },
+                [&longPressDetectedCount](DWORD) { longPressDetectedCount++; },
+                [&longPressReleasedCount](DWORD) { longPressReleasedCount++; });
+
+            ULONGLONG start = GetTickCount64();
+            SendKeyEvent(scheduler, 0x41, WM_KEYDOWN, GetTickCount());
+            Assert::IsTrue(WaitForCount(longPressDetectedCount, 1, 5000));
+
+            // Assert that the long press was detected by the timer, after the delay and before the key was released
+            Assert::IsTrue(GetTickCount64() - start >= KeyDelay::LONG_PRESS_DELAY_MILLIS - 20);
+            Assert::AreEqual(0, longPressReleasedCount.load());
+
+            SendKeyEvent(scheduler, 0x41, WM_KEYUP, GetTickCount());
+            Assert::IsTrue(WaitForCount(longPressReleasedCount, 1, 1000));
+            Assert::AreEqual(0, shortPressCount.load());
+            Assert::AreEqual(1, longPressDetectedCount.load());
+        }
+
+        // Test if a key up event timestamped after the long press delay triggers both long press callbacks even if the timer has not expired yet
+        TEST_METHOD (KeyEvent_ShouldCallBothLongPressCallbacks_WhenKeyUpTimestampIsPastTheDelay)
+        {
+            KeyDelayScheduler scheduler;
+            std::atomic<int> shortPressCount = 0;
+            std::atomic<int> longPressDetectedCount = 0;
+            std::atomic<int> longPressReleasedCount = 0;
+            scheduler.Register(
+                0x41,
+                [&shortPressCount](DWORD) { shortPressCount++; },
+                [&longPressDetectedCount](DWORD) { longPressDetectedCount++; },
+                [&longPressReleasedCount](DWORD) { longPressReleasedCount++; });
+
+            DWORD time = GetTickCount();
+            SendKeyEvent(scheduler, 0x41, WM_KEYDOWN, time);
+            SendKeyEvent(scheduler, 0x41, WM_KEYUP, time + (DWORD)KeyDelay::LONG_PRESS_DELAY_MILLIS + 100);
+
+            Assert::IsTrue(WaitForCount(longPressReleasedCount, 1, 1000));
+            Assert::AreEqual(1, longPressDetectedCount.load());
+            Assert::AreEqual(0, shortPressCount.load());
+        }
+
+        // Test if the long press delay is counted from the key down timestamp rather than from when the scheduler processes the event
+        TEST_METHOD (KeyEvent_ShouldDetectLongPressOnTime_WhenKeyDownIsProcessedLate)
+        {
+            KeyDelayScheduler scheduler;
+            std::atomic<int> longPressDetectedCount = 0;
+            scheduler.Register(
+                0x41,
+                nullptr,
+                [&longPressDetectedCount](DWORD) { longPressDetectedCount++; },
+                nullptr);
+
+            // The key down event happened most of the delay ago
+            ULONGLONG start = GetTickCount64();
+            SendKeyEvent(scheduler, 0x41, WM_KEYDOWN, GetTickCount() - (DWORD)KeyDelay::LONG_PRESS_DELAY_MILLIS + 100);
+            Assert::IsTrue(WaitForCount(longPressDetectedCount, 1, 5000));
+
+            // Assert that the long press was detected when the delay elapsed since the key down event, not a full delay after it was processed
+            Assert::IsTrue(GetTickCount64() - start < KeyDelay::LONG_PRESS_DELAY_MILLIS / 2);
+        }
+
+        // Test if no callback is called for a key after it is unregistered
+        TEST_METHOD (Unregister_ShouldStopCallbacks_WhenKeyIsHeldDown)
+        {
+            KeyDelayScheduler scheduler;
+            std::atomic<int> callbackCount = 0;
+            auto callback = [&callbackCount](DWORD) { callbackCount++; };
+            scheduler.Register(0x41, callback, callback, callback);
+
+            SendKeyEvent(scheduler, 0x41, WM_KEYDOWN, GetTickCount());
+            scheduler.Unregister(0x41);
+            Sleep((DWORD)KeyDelay::LONG_PRESS_DELAY_MILLIS + 100);
+
+            Assert::AreEqual(0, callbackCount.load());
+        }
+    };
+
+    // Tests for the hierarchical timer wheel
+    TEST_CLASS (TimerWheelTests)
+    {
+    private:
+        struct TestTimer : TimerWheelEntry
+        {
+            uint64_t expiredAt = 0;
+        };
+
+    public:
+        // Test if timers on every level of the wheel, and beyond its range, expire exactly on their deadline
+        TEST_METHOD (Advance_ShouldExpireTimersOnTheirDeadline_WhenDeadlinesSpanAllLevels)
+        {
+            TimerWheel timerWheel(1000);
+            std::mt19937_64 random(42);
+            std::vector<TestTimer> timers(1000);
+            for (size_t i = 0; i < timers.size(); i++)
+            {
+                // Deadlines up to a bit more than the range of the wheel, with more of them on the lower levels
+                uint64_t range = 1ull << (4 + random() % 22);
+                timerWheel.Schedule(timers[i], 1001 + random() % range);
+            }
+
+            timerWheel.Advance(1000 + TimerWheel::MaxRange * 2, [&timerWheel](TimerWheelEntry& entry) {
+                static_cast<TestTimer&>(entry).expiredAt = timerWheel.GetCurrentTick();
+            });
+
+            Assert::AreEqual((size_t)0, timerWheel.Size());
+            for (const auto& timer : timers)
+            {
+                Assert::AreEqual(timer.GetDeadline(), timer.expiredAt);
+                Assert::IsFalse(timer.IsArmed());
+            }
+        }
+
+        // Test if a cancelled timer does not expire
+        TEST_METHOD (Cancel_ShouldRemoveTimer_WhenTimerIsScheduled)
+        {
+            TimerWheel timerWheel;
+            TestTimer cancelledTimer;
+            TestTimer timer;
+            timerWheel.Schedule(cancelledTimer, 100);
+            timerWheel.Schedule(timer, 100);
+            timerWheel.Cancel(cancelledTimer);
+
+            int expiredCount = 0;
+            timerWheel.Advance(200, [&expiredCount](TimerWheelEntry&) { expiredCount++; });
+
+            Assert::AreEqual(1, expiredCount);
+            Assert::IsFalse(cancelledTimer.IsArmed());
+        }
+
+        // Test if scheduling into an empty wheel after an idle period moves the wheel to the current time instead of stepping through the idle ticks
+        TEST_METHOD (Schedule_ShouldResyncCurrentTick_WhenWheelIsEmpty)
+        {
+            TimerWheel timerWheel(1000);
+            TestTimer timer;
+            timerWheel.Schedule(timer, 10000100, 10000000);
+            Assert::AreEqual((uint64_t)10000000, timerWheel.GetCurrentTick());
+            Assert::IsTrue(timerWheel.GetTicksUntilNextExpiry() <= 100);
+
+            timerWheel.Advance(10000100, [&timerWheel](TimerWheelEntry& entry) {
+                static_cast<TestTimer&>(entry).expiredAt = timerWheel.GetCurrentTick();
+            });
+            Assert::AreEqual((uint64_t)10000100, timer.expiredAt);
+
+            // A wheel with scheduled entries is not moved, so that they still expire on their deadline
+            TestTimer earlyTimer;
+            TestTimer lateTimer;
+            timerWheel.Schedule(earlyTimer, 10000200);
+            timerWheel.Schedule(lateTimer, 10000300, 10000250);
+            Assert::AreEqual((uint64_t)10000100, timerWheel.GetCurrentTick());
+            timerWheel.Advance(10000300, [&timerWheel](TimerWheelEntry& entry) {
+                static_cast<TestTimer&>(entry).expiredAt = timerWheel.GetCurrentTick();
+            });
+            Assert::AreEqual((uint64_t)10000200, earlyTimer.expiredAt);
+            Assert::AreEqual((uint64_t)10000300, lateTimer.expiredAt);
+        }
+
+        // Test if the wheel is advanced at least up to the first deadline when the returned number of ticks elapses
+        TEST_METHOD (GetTicksUntilNextExpiry_ShouldNotSkipTheFirstDeadline_WhenTimersAreScheduled)
+        {
+            TimerWheel timerWheel;
+            Assert::AreEqual(UINT64_MAX, timerWheel.GetTicksUntilNextExpiry());
+
+            TestTimer timer;
+            timerWheel.Schedule(timer, 5000);
+            int wakeUpCount = 0;
+            while (timerWheel.Size() > 0)
+            {
+                uint64_t ticks = timerWheel.GetTicksUntilNextExpiry();
+                Assert::IsTrue(timerWheel.GetCurrentTick() + ticks <= timer.GetDeadline());
+                timerWheel.Advance(timerWheel.GetCurrentTick() + ticks, [](TimerWheelEntry&) {});
+                wakeUpCount++;
+            }
+
+            // Assert that the wheel only woke up on the cascades of the first level and on the deadline
+            Assert::AreEqual((uint64_t)5000, timerWheel.GetCurrentTick());
+            Assert::IsTrue(wakeUpCount <= 5000 / TimerWheel::SlotCount + 2);
+        }
+    };
+}
@@ -40,9 +40,10 @@ UINT MockedInput::SendVirtualInput(UINT cInputs, LPINPUT pInputs, int cbSize)
         }
         KBDLLHOOKSTRUCT lParam = {};
 
-        // Set only vkCode and dwExtraInfo since other values are unused
+        // Set only vkCode, dwExtraInfo and time since other values are unused. The time is used by the key delay state machines
         lParam.vkCode = pInputs[i].ki.wVk;
         lParam.dwExtraInfo = pInputs[i].ki.dwExtraInfo;
+        lParam.time = pInputs[i].ki.time;
         keyEvent.lParam = &lParam;
 
         // If the SendVirtualInput call condition is true, increment the count. If no condition is set then always increment the count
@@ -129,6 +130,18 @@ bool MockedInput::GetVirtualKeyState(int key)
     return keyboardState[key];
 }
 
+// Function to get the state of all the keys at once
+KeyboardStateSnapshot MockedInput::GetKeyboardStateSnapshot()
+{
+    KeyboardStateSnapshot snapshot;
+    for (size_t key = 0; key < keyboardState.size(); key++)
+    {
+        snapshot[key] = keyboardState[key];
+    }
+
+    return snapshot;
+}
+
 // Function to reset the mocked keyboard state
 void MockedInput::ResetKeyboardState()
 {
@@ -148,14 +161,43 @@ int MockedInput::GetSendVirtualInputCallCount()
     return sendVirtualInputCallCount;
 }
 
-// Function to get the foreground process name
+// Function to set the foreground process name. This simulates a new foreground window owned by the process and notifies the foreground change
 void MockedInput::SetForegroundProcess(std::wstring process)
 {
     currentProcess = process;
+    foregroundProcessId++;
+    foregroundWindow = reinterpret_cast<HWND>(static_cast<uintptr_t>(foregroundProcessId));
+    NotifyForegroundChange();
 }
 
 // Function to get the foreground process name
 void MockedInput::GetForegroundProcess(_Out_ std::wstring& foregroundProcess)
 {
+    getForegroundProcessCallCount++;
     foregroundProcess = currentProcess;
 }
+
+// Function to get the handle of the foreground window and the id of the process which owns it
+void MockedInput::GetForegroundWindowInfo(_Out_ HWND& window, _Out_ DWORD& processId)
+{
+    window = foregroundWindow;
+    processId = foregroundProcessId;
+}
+
+// Function to get the number of foreground window changes which have been notified
+uint64_t MockedInput::GetForegroundChangeCount()
+{
+    return foregroundChangeCount;
+}
+
+// Function to simulate a foreground change notification without changing the foreground window
+void MockedInput::NotifyForegroundChange()
+{
+    foregroundChangeCount++;
+}
+
+// Function to get GetForegroundProcess call count
+int MockedInput::GetForegroundProcessCallCount()
+{
+    return getForegroundProcessCallCount;
+}
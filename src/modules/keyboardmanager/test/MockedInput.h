@@ -22,6 +22,16 @@ private:
 
     std::wstring currentProcess;
 
+    // Simulated foreground window and process id
+    HWND foregroundWindow = nullptr;
+    DWORD foregroundProcessId = 0;
+
+    // Stores the number of simulated foreground change notifications
+    uint64_t foregroundChangeCount = 0;
+
+    // Stores the count of GetForegroundProcess calls, i.e. the number of times the foreground process name was resolved
+    int getForegroundProcessCallCount = 0;
+
 public:
     MockedInput()
     {
@@ -40,6 +50,9 @@ public:
     // Function to get the state of a particular key
     bool GetVirtualKeyState(int key);
 
+    // Function to get the state of all the keys at once
+    KeyboardStateSnapshot GetKeyboardStateSnapshot();
+
     // Function to reset the mocked keyboard state
     void ResetKeyboardState();
 
@@ -49,9 +62,21 @@ public:
     // Function to get SendVirtualInput call count
     int GetSendVirtualInputCallCount();
 
-    // Function to get the foreground process name
+    // Function to set the foreground process name. This simulates a new foreground window owned by the process and notifies the foreground change
     void SetForegroundProcess(std::wstring process);
 
     // Function to get the foreground process name
     void GetForegroundProcess(_Out_ std::wstring& foregroundProcess);
+
+    // Function to get the handle of the foreground window and the id of the process which owns it
+    void GetForegroundWindowInfo(_Out_ HWND& window, _Out_ DWORD& processId);
+
+    // Function to get the number of foreground window changes which have been notified
+    uint64_t GetForegroundChangeCount();
+
+    // Function to simulate a foreground change notification without changing the foreground window
+    void NotifyForegroundChange();
+
+    // Function to get GetForegroundProcess call count
+    int GetForegroundProcessCallCount();
 };
@@ -45,5 +45,26 @@ namespace RemappingLogicTests
             // A key state should be false
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
         }
+
+        // Test if the keyboard state snapshot matches the state of each key
+        TEST_METHOD (MockedInput_ShouldReturnSameStateInSnapshot_OnKeyEvent)
+        {
+            // Send Ctrl and A keydown
+            const int nInputs = 2;
+            INPUT input[nInputs] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = VK_LCONTROL;
+            input[1].type = INPUT_KEYBOARD;
+            input[1].ki.wVk = 0x41;
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+
+            // The snapshot should have the same state as each key
+            KeyboardStateSnapshot keyboardState = mockedInputHandler.GetKeyboardStateSnapshot();
+            Assert::IsTrue(keyboardState[0x41]);
+            for (int key = 0; key < (int)keyboardState.size(); key++)
+            {
+                Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(key), (bool)keyboardState[key]);
+            }
+        }
     };
 }
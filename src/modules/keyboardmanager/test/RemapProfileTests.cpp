@@ -0,0 +1,262 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <keyboardmanager/common/RemapProfile.h>
+#include <keyboardmanager/common/KeyboardManagerConstants.h>
+#include "../common/shared_constants.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace KeyboardManagerCommonTests
+{
+    // Tests for saving and loading remap configurations as JSON and binary profiles
+    TEST_CLASS (RemapProfileTests)
+    {
+    private:
+        std::filesystem::path testFolder;
+        std::wstring jsonPath;
+        std::wstring binaryProfilePath;
+
+        // Function to create a shortcut from a list of keys
+        static Shortcut CreateShortcut(std::initializer_list<DWORD> keys)
+        {
+            Shortcut shortcut;
+            for (DWORD key : keys)
+            {
+                shortcut.SetKey(key);
+            }
+
+            return shortcut;
+        }
+
+        // Function to create a configuration with all the remap types and target types
+        static RemapConfiguration CreateTestConfiguration()
+        {
+            RemapConfiguration remapConfiguration;
+            remapConfiguration.AddSingleKeyRemap(0x41, (DWORD)0x42);
+            remapConfiguration.AddSingleKeyRemap(VK_CAPITAL, CreateShortcut({ VK_LCONTROL, VK_LSHIFT, 0x56 }));
+            remapConfiguration.AddOSLevelShortcut(CreateShortcut({ VK_CONTROL, 0x43 }), CreateShortcut({ CommonSharedConstants::VK_WIN_BOTH, VK_RMENU, 0x44 }));
+            remapConfiguration.AddOSLevelShortcut(CreateShortcut({ VK_LWIN, VK_SHIFT, 0x45 }), (DWORD)VK_ESCAPE);
+            remapConfiguration.AddAppSpecificShortcut(L"msedge.exe", CreateShortcut({ VK_MENU, 0x46 }), CreateShortcut({ VK_CONTROL, 0x47 }));
+            remapConfiguration.AddAppSpecificShortcut(L"notepad", CreateShortcut({ VK_CONTROL, VK_SHIFT, 0x48 }), (DWORD)VK_F5);
+            return remapConfiguration;
+        }
+
+        // Function to create a configuration with the given number of app-specific shortcut remaps, spread over apps with 100 remaps each
+        static RemapConfiguration CreateLargeConfiguration(size_t remapCount)
+        {
+            const DWORD modifiers[][2] = { { VK_LCONTROL, 0 }, { VK_LMENU, 0 }, { VK_LCONTROL, VK_LSHIFT }, { VK_LMENU, VK_LSHIFT } };
+            RemapConfiguration remapConfiguration;
+            for (size_t i = 0; i < remapCount; i++)
+            {
+                std::wstring app = L"app" + std::to_wstring(i / 100) + L".exe";
+                const DWORD* modifier = modifiers[i % 4];
+                Shortcut originalShortcut = modifier[1] != 0 ? CreateShortcut({ modifier[0], modifier[1], 0x41 + (DWORD)(i / 4 % 25) }) : CreateShortcut({ modifier[0], 0x41 + (DWORD)(i / 4 % 25) });
+                if (i % 2 == 0)
+                {
+                    remapConfiguration.AddAppSpecificShortcut(app, originalShortcut, CreateShortcut({ VK_RCONTROL, 0x30 + (DWORD)(i % 10) }));
+                }
+                else
+                {
+                    remapConfiguration.AddAppSpecificShortcut(app, originalShortcut, (DWORD)(VK_F1 + i % 12));
+                }
+            }
+
+            return remapConfiguration;
+        }
+
+        // Function to check if two configurations have the same remaps
+        static bool AreRemapsEqual(const RemapConfiguration& first, const RemapConfiguration& second)
+        {
+            return first.singleKeyReMap == second.singleKeyReMap && first.osLevelShortcutReMap == second.osLevelShortcutReMap && first.appSpecificShortcutReMap == second.appSpecificShortcutReMap;
+        }
+
+        // Function to compute the checksum of the JSON file
+        uint64_t GetJsonChecksum()
+        {
+            std::ifstream file(jsonPath, std::ios::binary);
+            std::string content{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+            return RemapProfile::ComputeChecksum(content.data(), content.size());
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            testFolder = std::filesystem::temp_directory_path() / (L"KeyboardManagerRemapProfileTests" + std::to_wstring(GetCurrentProcessId()));
+            std::filesystem::create_directories(testFolder);
+            jsonPath = (testFolder / L"default.json").wstring();
+            binaryProfilePath = RemapProfile::GetBinaryProfilePath(jsonPath);
+        }
+
+        TEST_METHOD_CLEANUP(CleanupTestEnv)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(testFolder, error);
+        }
+
+        // Test if the binary profile is written next to the JSON file with the binary profile extension
+        TEST_METHOD (GetBinaryProfilePath_ShouldReplaceJsonExtension_WhenPathIsAJsonFile)
+        {
+            Assert::AreEqual((testFolder / (L"default" + KeyboardManagerConstants::BinaryProfileExtension)).wstring(), binaryProfilePath);
+        }
+
+        // Test if a binary profile written by SaveToFile contains the same remaps as the JSON file
+        TEST_METHOD (LoadBinaryProfile_ShouldReturnSameRemapsAsJson_WhenProfileIsSavedToFile)
+        {
+            RemapConfiguration savedConfiguration = CreateTestConfiguration();
+            RemapProfile::SaveToFile(savedConfiguration, jsonPath);
+
+            RemapConfiguration binaryConfiguration;
+            Assert::IsTrue(RemapProfile::LoadBinaryProfile(binaryProfilePath, GetJsonChecksum(), binaryConfiguration));
+            RemapConfiguration jsonConfiguration;
+            RemapProfile::LoadFromJson(*json::from_file(jsonPath), jsonConfiguration);
+
+            Assert::IsTrue(AreRemapsEqual(savedConfiguration, binaryConfiguration));
+            Assert::IsTrue(AreRemapsEqual(jsonConfiguration, binaryConfiguration));
+        }
+
+        // Test if the JSON is used and the binary profile is generated again when the JSON was modified after the binary profile was written
+        TEST_METHOD (LoadFromFile_ShouldFallBackToJson_WhenBinaryProfileIsStale)
+        {
+            RemapProfile::SaveToFile(CreateTestConfiguration(), jsonPath);
+
+            // Modify the JSON without updating the binary profile, as another tool would
+            RemapConfiguration modifiedConfiguration;
+            modifiedConfiguration.AddSingleKeyRemap(0x43, (DWORD)0x44);
+            json::to_file(jsonPath, RemapProfile::ToJson(modifiedConfiguration));
+
+            RemapConfiguration binaryConfiguration;
+            Assert::IsFalse(RemapProfile::LoadBinaryProfile(binaryProfilePath, GetJsonChecksum(), binaryConfiguration));
+
+            RemapConfiguration loadedConfiguration;
+            Assert::IsTrue(RemapProfile::LoadFromFile(jsonPath, loadedConfiguration));
+            Assert::IsTrue(AreRemapsEqual(modifiedConfiguration, loadedConfiguration));
+
+            // Assert that the binary profile was generated again from the JSON
+            Assert::IsTrue(RemapProfile::LoadBinaryProfile(binaryProfilePath, GetJsonChecksum(), binaryConfiguration));
+            Assert::IsTrue(AreRemapsEqual(modifiedConfiguration, binaryConfiguration));
+        }
+
+        // Test if remap types which are not in the JSON are not taken from the configuration passed to LoadFromFile, so that the binary profile generated from the JSON has the same remaps as the JSON
+        TEST_METHOD (LoadFromFile_ShouldOnlyLoadRemapsOfJson_WhenJsonHasNoShortcuts)
+        {
+            RemapConfiguration savedConfiguration;
+            savedConfiguration.AddSingleKeyRemap(0x43, (DWORD)0x44);
+            json::JsonObject jsonObject = RemapProfile::ToJson(savedConfiguration);
+            jsonObject.Remove(KeyboardManagerConstants::RemapShortcutsSettingName);
+            json::to_file(jsonPath, jsonObject);
+
+            RemapConfiguration loadedConfiguration = CreateTestConfiguration();
+            Assert::IsTrue(RemapProfile::LoadFromFile(jsonPath, loadedConfiguration));
+            Assert::IsTrue(AreRemapsEqual(savedConfiguration, loadedConfiguration));
+
+            // Assert that the binary profile generated from the JSON gives the same remaps
+            RemapConfiguration binaryConfiguration = CreateTestConfiguration();
+            Assert::IsTrue(RemapProfile::LoadFromFile(jsonPath, binaryConfiguration));
+            Assert::IsTrue(RemapProfile::LoadBinaryProfile(binaryProfilePath, GetJsonChecksum(), binaryConfiguration));
+            Assert::IsTrue(AreRemapsEqual(savedConfiguration, binaryConfiguration));
+        }
+
+        // Test if SaveToFile throws when the JSON file cannot be written
+        TEST_METHOD (SaveToFile_ShouldThrow_WhenJsonFileCannotBeWritten)
+        {
+            std::wstring missingFolderPath = (testFolder / L"missing" / L"default.json").wstring();
+            Assert::ExpectException<std::runtime_error>([&missingFolderPath] {
+                RemapProfile::SaveToFile(CreateTestConfiguration(), missingFolderPath);
+            });
+            Assert::IsFalse(std::filesystem::exists(RemapProfile::GetBinaryProfilePath(missingFolderPath)));
+        }
+
+        // Test if a corrupted binary profile is rejected and the JSON is used instead
+        TEST_METHOD (LoadFromFile_ShouldFallBackToJson_WhenBinaryProfileIsCorrupted)
+        {
+            RemapConfiguration savedConfiguration = CreateTestConfiguration();
+            RemapProfile::SaveToFile(savedConfiguration, jsonPath);
+
+            // Flip a bit in the last byte of the payload
+            {
+                std::fstream file(binaryProfilePath, std::ios::binary | std::ios::in | std::ios::out);
+                file.seekg(-1, std::ios::end);
+                char lastByte = (char)file.get();
+                file.seekp(-1, std::ios::end);
+                file.put(lastByte ^ 1);
+            }
+
+            RemapConfiguration binaryConfiguration;
+            Assert::IsFalse(RemapProfile::LoadBinaryProfile(binaryProfilePath, GetJsonChecksum(), binaryConfiguration));
+
+            RemapConfiguration loadedConfiguration;
+            Assert::IsTrue(RemapProfile::LoadFromFile(jsonPath, loadedConfiguration));
+            Assert::IsTrue(AreRemapsEqual(savedConfiguration, loadedConfiguration));
+        }
+
+        // Test if LoadFromFile fails when there is no configuration file
+        TEST_METHOD (LoadFromFile_ShouldReturnFalse_WhenJsonFileDoesNotExist)
+        {
+            RemapConfiguration loadedConfiguration;
+            Assert::IsFalse(RemapProfile::LoadFromFile(jsonPath, loadedConfiguration));
+        }
+
+        // Test if a strict load rejects a JSON file which cannot be parsed and keeps the current remaps
+        TEST_METHOD (LoadFromFile_ShouldRejectFileAndKeepRemaps_WhenStrictAndJsonIsTruncated)
+        {
+            RemapProfile::SaveToFile(CreateTestConfiguration(), jsonPath);
+            std::string jsonString = winrt::to_string(RemapProfile::ToJson(CreateTestConfiguration()).Stringify());
+            std::ofstream(jsonPath, std::ios::binary) << jsonString.substr(0, jsonString.size() / 2);
+
+            RemapConfiguration currentConfiguration;
+            currentConfiguration.AddSingleKeyRemap(0x43, (DWORD)0x44);
+            Assert::IsFalse(RemapProfile::LoadFromFile(jsonPath, currentConfiguration, true));
+
+            // Assert that the current remaps were not modified
+            RemapConfiguration expectedConfiguration;
+            expectedConfiguration.AddSingleKeyRemap(0x43, (DWORD)0x44);
+            Assert::IsTrue(AreRemapsEqual(expectedConfiguration, currentConfiguration));
+        }
+
+        // Test if a strict load rejects a JSON file with an invalid remap, while a non strict load skips it
+        TEST_METHOD (LoadFromFile_ShouldRejectFile_WhenStrictAndJsonHasInvalidRemap)
+        {
+            // A shortcut without modifier is not a valid shortcut
+            RemapConfiguration invalidConfiguration = CreateTestConfiguration();
+            invalidConfiguration.AddOSLevelShortcut(CreateShortcut({ 0x49 }), (DWORD)0x4A);
+            json::to_file(jsonPath, RemapProfile::ToJson(invalidConfiguration));
+
+            RemapConfiguration strictConfiguration;
+            Assert::IsFalse(RemapProfile::LoadFromFile(jsonPath, strictConfiguration, true));
+            Assert::IsTrue(AreRemapsEqual(RemapConfiguration(), strictConfiguration));
+
+            RemapConfiguration loadedConfiguration;
+            Assert::IsTrue(RemapProfile::LoadFromFile(jsonPath, loadedConfiguration));
+            Assert::IsFalse(RemapProfile::ValidateConfiguration(loadedConfiguration));
+        }
+
+        // Benchmark comparing the time to load a configuration with 10k app-specific shortcut remaps from the JSON file and from the binary profile
+        TEST_METHOD (LoadFromFile_ShouldBeFasterThanJson_WhenConfigurationHas10kRemaps)
+        {
+            RemapConfiguration savedConfiguration = CreateLargeConfiguration(10000);
+            RemapProfile::SaveToFile(savedConfiguration, jsonPath);
+
+            // JSON path, as load_config did before the binary profile was introduced
+            auto start = std::chrono::high_resolution_clock::now();
+            RemapConfiguration jsonConfiguration;
+            RemapProfile::LoadFromJson(*json::from_file(jsonPath), jsonConfiguration);
+            auto jsonDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            // Binary profile path, including reading and checksumming the JSON file to validate the profile
+            start = std::chrono::high_resolution_clock::now();
+            RemapConfiguration binaryConfiguration;
+            Assert::IsTrue(RemapProfile::LoadFromFile(jsonPath, binaryConfiguration));
+            auto binaryDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            Logger::WriteMessage(("JSON load of 10000 remaps (us): " + std::to_string(jsonDuration.count()) + "\n").c_str());
+            Logger::WriteMessage(("Binary profile load of 10000 remaps (us): " + std::to_string(binaryDuration.count()) + "\n").c_str());
+
+            Assert::IsTrue(AreRemapsEqual(savedConfiguration, jsonConfiguration));
+            Assert::IsTrue(AreRemapsEqual(savedConfiguration, binaryConfiguration));
+            Assert::IsTrue(binaryDuration < jsonDuration);
+        }
+    };
+}
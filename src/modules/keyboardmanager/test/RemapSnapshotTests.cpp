@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include <keyboardmanager/dll/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+#include <atomic>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for publishing remap configurations to the hook through remap snapshots
+    TEST_CLASS (RemapSnapshotTests)
+    {
+    private:
+        MockedInput mockedInputHandler;
+        KeyboardManagerState testState;
+
+        // Function to send a key event through the mocked input
+        void SendKeyEvent(WORD key, DWORD flags)
+        {
+            INPUT input = {};
+            input.type = INPUT_KEYBOARD;
+            input.ki.wVk = key;
+            input.ki.dwFlags = flags;
+            mockedInputHandler.SendVirtualInput(1, &input, sizeof(INPUT));
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+
+            // Set the single key and os level shortcut remap handlers as the hook procedure, in the same order as the keyboard manager hook
+            mockedInputHandler.SetHookProc([this](LowlevelKeyboardEvent* data) {
+                if (data->lParam->dwExtraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return (intptr_t)1;
+                }
+
+                if (KeyboardEventHandlers::HandleSingleKeyRemapEvent(mockedInputHandler, data, testState) == 1)
+                {
+                    return (intptr_t)1;
+                }
+
+                return KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent(mockedInputHandler, data, testState);
+            });
+        }
+
+        // Test if the existing remaps are still applied while a new configuration is being built
+        TEST_METHOD (UpdateRemapConfiguration_ShouldKeepExistingRemapsActive_WhileConfigurationIsBuilt)
+        {
+            // Remap A to B
+            testState.AddSingleKeyRemap(0x41, 0x42);
+
+            testState.UpdateRemapConfiguration([this](RemapConfiguration& remapConfiguration) {
+                // Replace A->B with A->C
+                remapConfiguration.ClearSingleKeyRemaps();
+                remapConfiguration.AddSingleKeyRemap(0x41, 0x43);
+
+                // Send A keydown and keyup while the new configuration has not been published
+                SendKeyEvent(0x41, 0);
+                Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
+                SendKeyEvent(0x41, KEYEVENTF_KEYUP);
+                Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x42));
+            });
+
+            // Send A keydown after the new configuration is published
+            SendKeyEvent(0x41, 0);
+
+            // C key state should be true
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x42));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x43));
+        }
+
+        // Test if the changes made while a batch is open are published as a single configuration when the batch ends
+        TEST_METHOD (EndRemapConfigurationBatch_ShouldPublishAllChangesOnce_WhenChangesAreBatched)
+        {
+            std::shared_ptr<const RemapConfiguration> initialConfiguration = testState.GetRemapConfiguration();
+
+            // Remap each letter to the next one
+            testState.BeginRemapConfigurationBatch();
+            for (DWORD key = 0x41; key < 0x5A; key++)
+            {
+                Assert::AreEqual(true, testState.AddSingleKeyRemap(key, (DWORD)(key + 1)));
+            }
+
+            // No configuration should be published while the batch is open
+            Assert::IsTrue(testState.GetRemapConfiguration() == initialConfiguration);
+            testState.EndRemapConfigurationBatch();
+
+            std::shared_ptr<const RemapConfiguration> batchConfiguration = testState.GetRemapConfiguration();
+            Assert::IsTrue(batchConfiguration != initialConfiguration);
+            Assert::AreEqual<size_t>(25, batchConfiguration->singleKeyReMap.size());
+
+            // Send A keydown, B key state should be true
+            SendKeyEvent(0x41, 0);
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
+            SendKeyEvent(0x41, KEYEVENTF_KEYUP);
+        }
+
+        // Test if a published configuration is not modified by later updates
+        TEST_METHOD (GetRemapConfiguration_ShouldReturnUnchangedConfiguration_WhenNewConfigurationIsPublished)
+        {
+            testState.AddSingleKeyRemap(0x41, 0x42);
+            std::shared_ptr<const RemapConfiguration> remapConfiguration = testState.GetRemapConfiguration();
+
+            testState.AddSingleKeyRemap(0x43, 0x44);
+
+            Assert::AreEqual((size_t)1, remapConfiguration->singleKeyReMap.size());
+            Assert::AreEqual((size_t)2, testState.GetRemapConfiguration()->singleKeyReMap.size());
+        }
+
+        // Test if a shortcut which is held down while a new configuration is published is still released correctly
+        TEST_METHOD (InvokedShortcut_ShouldBeReleased_WhenConfigurationIsPublishedWhileShortcutIsHeldDown)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+
+            // Send Ctrl+A keydown
+            SendKeyEvent(VK_CONTROL, 0);
+            SendKeyEvent(0x41, 0);
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_MENU));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+
+            // Publish a new configuration which keeps the shortcut remap
+            testState.AddSingleKeyRemap(0x42, 0x43);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(src).isShortcutInvoked);
+
+            // Release A then Ctrl
+            SendKeyEvent(0x41, KEYEVENTF_KEYUP);
+            SendKeyEvent(VK_CONTROL, KEYEVENTF_KEYUP);
+
+            // All the keys should be released
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_MENU));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(false, testState.CheckShortcutRemapInvoked(std::nullopt));
+        }
+
+        // Test if the invoked state is not carried over when the target of the shortcut remap changes
+        TEST_METHOD (InvokedShortcut_ShouldBeReset_WhenShortcutTargetChanges)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+
+            // Send Ctrl+A keydown
+            SendKeyEvent(VK_CONTROL, 0);
+            SendKeyEvent(0x41, 0);
+            Assert::AreEqual(true, testState.GetShortcutRemapState(src).isShortcutInvoked);
+
+            // Remap Ctrl+A to B instead
+            testState.UpdateRemapConfiguration([&src](RemapConfiguration& remapConfiguration) {
+                remapConfiguration.ClearOSLevelShortcuts();
+                remapConfiguration.AddOSLevelShortcut(src, (DWORD)0x42);
+            });
+
+            Assert::AreEqual(false, testState.GetShortcutRemapState(src).isShortcutInvoked);
+            Assert::AreEqual(false, testState.CheckShortcutRemapInvoked(std::nullopt));
+        }
+
+        // Test if remaps are applied on every key event while configurations are published concurrently
+        TEST_METHOD (RemappedKey_ShouldAlwaysBeRemapped_WhenConfigurationsArePublishedConcurrently)
+        {
+            // Remap A to B
+            testState.AddSingleKeyRemap(0x41, 0x42);
+
+            // Keep publishing configurations which all contain A->B from another thread
+            std::atomic_bool isRunning = true;
+            std::thread publisher([this, &isRunning]() {
+                DWORD key = 0x30;
+                while (isRunning)
+                {
+                    RemapConfiguration remapConfiguration;
+                    remapConfiguration.AddSingleKeyRemap(0x41, 0x42);
+                    remapConfiguration.AddSingleKeyRemap(key, 0x43);
+                    Shortcut src;
+                    src.SetKey(VK_CONTROL);
+                    src.SetKey(key);
+                    remapConfiguration.AddOSLevelShortcut(src, (DWORD)0x44);
+                    testState.SetRemapConfiguration(std::move(remapConfiguration));
+                    key = key == 0x39 ? 0x30 : key + 1;
+                }
+            });
+
+            bool isAlwaysRemapped = true;
+            for (int i = 0; i < 10000; i++)
+            {
+                SendKeyEvent(0x41, 0);
+                isAlwaysRemapped = isAlwaysRemapped && mockedInputHandler.GetVirtualKeyState(0x42) && !mockedInputHandler.GetVirtualKeyState(0x41);
+                SendKeyEvent(0x41, KEYEVENTF_KEYUP);
+                isAlwaysRemapped = isAlwaysRemapped && !mockedInputHandler.GetVirtualKeyState(0x42);
+            }
+
+            isRunning = false;
+            publisher.join();
+
+            Assert::AreEqual(true, isAlwaysRemapped);
+        }
+    };
+}
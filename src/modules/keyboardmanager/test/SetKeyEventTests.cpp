@@ -4,6 +4,7 @@
 #include <keyboardmanager/common/KeyboardManagerState.h>
 #include <keyboardmanager/dll/KeyboardEventHandlers.h>
 #include <keyboardmanager/common/Helpers.h>
+#include <keyboardmanager/common/InputBatch.h>
 #include "TestHelpers.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
@@ -28,7 +29,7 @@ namespace RemappingLogicTests
         TEST_METHOD (SetKeyEvent_ShouldUseExtendedKeyFlag_WhenArgumentIsExtendedKey)
         {
             const int nInputs = 15;
-            INPUT input[nInputs] = {};
+            InputBatch input;
 
             // List of extended keys
             WORD keyCodes[nInputs] = { VK_RCONTROL, VK_RMENU, VK_NUMLOCK, VK_SNAPSHOT, VK_CANCEL, VK_INSERT, VK_HOME, VK_PRIOR, VK_DELETE, VK_END, VK_NEXT, VK_LEFT, VK_DOWN, VK_RIGHT, VK_UP };
@@ -36,7 +37,7 @@ namespace RemappingLogicTests
             for (int i = 0; i < nInputs; i++)
             {
                 // Set key events for all the extended keys
-                KeyboardManagerHelper::SetKeyEvent(input, i, INPUT_KEYBOARD, keyCodes[i], 0, 0);
+                KeyboardManagerHelper::SetKeyEvent(input, INPUT_KEYBOARD, keyCodes[i], 0, 0);
                 // Extended key flag should be set
                 Assert::AreEqual(true, bool(input[i].ki.dwFlags & KEYEVENTF_EXTENDEDKEY));
             }
@@ -45,15 +46,28 @@ namespace RemappingLogicTests
         // Test if SetKeyEvent sets the scan code field to 0 for dummy key
         TEST_METHOD (SetKeyEvent_ShouldSetScanCodeFieldTo0_WhenArgumentIsDummyKey)
         {
-            const int nInputs = KeyboardManagerConstants::DUMMY_KEY_EVENT_SIZE;
-            INPUT input[nInputs] = {};
-
-            int index = 0;
-            KeyboardManagerHelper::SetDummyKeyEvent(input, index, 0);
+            InputBatch input;
+            KeyboardManagerHelper::SetDummyKeyEvent(input, 0);
 
             // Assert that wScan for both inputs is 0
+            Assert::AreEqual<size_t>(KeyboardManagerConstants::DUMMY_KEY_EVENT_SIZE, input.Size());
             Assert::AreEqual<unsigned int>(0, input[0].ki.wScan);
             Assert::AreEqual<unsigned int>(0, input[1].ki.wScan);
         }
+
+        // Test if SetKeyEvent does not write past the end of the batch when it is full
+        TEST_METHOD (SetKeyEvent_ShouldReturnFalse_WhenBatchIsFull)
+        {
+            InputBatch input;
+            for (size_t i = 0; i < InputBatch::Capacity; i++)
+            {
+                Assert::AreEqual(true, KeyboardManagerHelper::SetKeyEvent(input, INPUT_KEYBOARD, 0x41, 0, 0));
+            }
+
+            // Key event should not be added and the size should be unchanged
+            Assert::AreEqual(false, KeyboardManagerHelper::SetKeyEvent(input, INPUT_KEYBOARD, 0x42, 0, 0));
+            Assert::AreEqual<size_t>(InputBatch::Capacity, input.Size());
+            Assert::AreEqual<unsigned int>(0x41, input[InputBatch::Capacity - 1].ki.wVk);
+        }
     };
 }
@@ -0,0 +1,218 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/common/KeyboardManagerState.h>
+#include <keyboardmanager/common/ShortcutDispatchTable.h>
+#include <keyboardmanager/common/KeyboardStateReader.h>
+#include <keyboardmanager/dll/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+#include "../common/shared_constants.h"
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for the compiled shortcut dispatch table used by the hook
+    TEST_CLASS (ShortcutDispatchTableTests)
+    {
+    private:
+        MockedInput mockedInputHandler;
+        KeyboardManagerState testState;
+
+        // Function to send a key event through the mocked input
+        void SendKeyEvent(WORD key, DWORD flags)
+        {
+            INPUT input = {};
+            input.type = INPUT_KEYBOARD;
+            input.ki.wVk = key;
+            input.ki.dwFlags = flags;
+            mockedInputHandler.SendVirtualInput(1, &input, sizeof(INPUT));
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+
+            // Set HandleOSLevelShortcutRemapEvent as the hook procedure
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc([currentHookProc](LowlevelKeyboardEvent* data) {
+                if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return currentHookProc(data);
+                }
+                else
+                {
+                    return (intptr_t)1;
+                }
+            });
+        }
+
+        // Test if the compiled modifier checks match Shortcut::CheckModifiersKeyboardState for all modifier types
+        TEST_METHOD (CheckModifiers_ShouldMatchCheckModifiersKeyboardState_ForAllModifierTypes)
+        {
+            std::vector<DWORD> modifiers = { VK_LWIN, VK_RWIN, CommonSharedConstants::VK_WIN_BOTH, VK_LCONTROL, VK_RCONTROL, VK_CONTROL, VK_LMENU, VK_RMENU, VK_MENU, VK_LSHIFT, VK_RSHIFT, VK_SHIFT };
+            std::vector<std::vector<WORD>> pressedKeys = { {}, { VK_LWIN }, { VK_RWIN }, { VK_LCONTROL }, { VK_RCONTROL }, { VK_LMENU }, { VK_RMENU }, { VK_LSHIFT }, { VK_RSHIFT }, { VK_LCONTROL, VK_LSHIFT }, { VK_RWIN, VK_RMENU } };
+
+            for (auto modifier : modifiers)
+            {
+                Shortcut src;
+                src.SetKey(modifier);
+                src.SetKey(0x41);
+                testState.ClearOSLevelShortcuts();
+                testState.AddOSLevelShortcut(src, (DWORD)0x42);
+                std::shared_ptr<const RemapConfiguration> remapConfiguration = testState.GetRemapConfiguration();
+                const auto* candidates = remapConfiguration->GetOSLevelShortcutDispatchTable().GetCandidates(0x41);
+                Assert::IsNotNull(candidates);
+                Assert::AreEqual((size_t)1, candidates->size());
+
+                for (const auto& keys : pressedKeys)
+                {
+                    // Set the keyboard state without the hook
+                    mockedInputHandler.ResetKeyboardState();
+                    mockedInputHandler.SetHookProc(nullptr);
+                    for (auto key : keys)
+                    {
+                        SendKeyEvent(key, 0);
+                    }
+
+                    KeyboardStateSnapshot keyboardState = mockedInputHandler.GetKeyboardStateSnapshot();
+                    ModifierState state = ShortcutDispatchTable::GetModifierState(keyboardState);
+                    Assert::AreEqual(src.CheckModifiersKeyboardState(keyboardState), ShortcutDispatchTable::CheckModifiers((*candidates)[0], state));
+
+                    KeyboardStateReader dispatchTableReader(mockedInputHandler);
+                    KeyboardStateReader shortcutReader(mockedInputHandler);
+                    Assert::AreEqual(src.CheckModifiersKeyboardState(keyboardState), ShortcutDispatchTable::CheckModifiers((*candidates)[0], dispatchTableReader));
+                    Assert::AreEqual(src.CheckModifiersKeyboardState(keyboardState), src.CheckModifiersKeyboardState(shortcutReader));
+                }
+            }
+        }
+
+        // Test if the candidates for an action key are ordered with the longest shortcut first
+        TEST_METHOD (GetCandidates_ShouldReturnLongerShortcutsFirst_WhenShortcutsShareActionKey)
+        {
+            Shortcut src1;
+            src1.SetKey(VK_CONTROL);
+            src1.SetKey(0x41);
+            Shortcut src2;
+            src2.SetKey(VK_CONTROL);
+            src2.SetKey(VK_SHIFT);
+            src2.SetKey(0x41);
+            Shortcut src3;
+            src3.SetKey(VK_CONTROL);
+            src3.SetKey(0x42);
+            testState.AddOSLevelShortcut(src1, (DWORD)0x43);
+            testState.AddOSLevelShortcut(src2, (DWORD)0x44);
+            testState.AddOSLevelShortcut(src3, (DWORD)0x45);
+
+            std::shared_ptr<const RemapConfiguration> remapConfiguration = testState.GetRemapConfiguration();
+            const auto* candidates = remapConfiguration->GetOSLevelShortcutDispatchTable().GetCandidates(0x41);
+            Assert::IsNotNull(candidates);
+            Assert::AreEqual((size_t)2, candidates->size());
+            Assert::IsTrue(src2 == (*candidates)[0].remap->first);
+            Assert::IsTrue(src1 == (*candidates)[1].remap->first);
+            Assert::IsNull(remapConfiguration->GetOSLevelShortcutDispatchTable().GetCandidates(0x43));
+        }
+
+        // Test if the invoked shortcut is tracked by the remap snapshot and reset when the shortcut is released
+        TEST_METHOD (GetInvokedRemap_ShouldReturnInvokedShortcut_WhenShortcutIsHeldDown)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+
+            // Send Ctrl+A keydown
+            SendKeyEvent(VK_CONTROL, 0);
+            SendKeyEvent(0x41, 0);
+
+            std::shared_ptr<RemapSnapshot> remapSnapshot = testState.GetHookRemapSnapshot();
+            const ShortcutDispatchTable& dispatchTable = remapSnapshot->GetConfiguration().GetOSLevelShortcutDispatchTable();
+            size_t invokedRemap = remapSnapshot->GetInvokedRemap(dispatchTable);
+            Assert::IsTrue(invokedRemap != ShortcutDispatchTable::NoRemap);
+            Assert::IsTrue(src == dispatchTable.GetRemap(invokedRemap).first);
+            Assert::AreEqual(true, testState.CheckShortcutRemapInvoked(std::nullopt));
+
+            // Release A then Ctrl
+            SendKeyEvent(0x41, KEYEVENTF_KEYUP);
+            SendKeyEvent(VK_CONTROL, KEYEVENTF_KEYUP);
+
+            Assert::IsTrue(remapSnapshot->GetInvokedRemap(dispatchTable) == ShortcutDispatchTable::NoRemap);
+            Assert::AreEqual(false, testState.CheckShortcutRemapInvoked(std::nullopt));
+        }
+
+        // Micro-benchmark for the shortcut remap hook path with 1000 os level shortcut remaps
+        TEST_METHOD (Benchmark_ShortcutRemapHook_With1000Remaps)
+        {
+            std::vector<std::vector<DWORD>> modifierSets = {
+                { VK_LCONTROL }, { VK_RCONTROL }, { VK_CONTROL }, { VK_LMENU }, { VK_RMENU }, { VK_MENU }, { VK_LSHIFT }, { VK_RSHIFT }, { VK_SHIFT }, { VK_LWIN }, { VK_RWIN }, { CommonSharedConstants::VK_WIN_BOTH }, { VK_CONTROL, VK_SHIFT }, { VK_CONTROL, VK_MENU }, { VK_MENU, VK_SHIFT }, { VK_LWIN, VK_CONTROL }, { VK_LWIN, VK_SHIFT }, { VK_LWIN, VK_MENU }, { VK_LCONTROL, VK_LSHIFT }, { VK_RCONTROL, VK_RSHIFT }
+            };
+            std::vector<DWORD> actionKeys;
+            for (DWORD key = 0x41; key <= 0x5A; key++)
+            {
+                actionKeys.push_back(key);
+            }
+            for (DWORD key = 0x30; key <= 0x39; key++)
+            {
+                actionKeys.push_back(key);
+            }
+            for (DWORD key = VK_F1; key <= VK_F14; key++)
+            {
+                actionKeys.push_back(key);
+            }
+
+            // Remap every shortcut to F24. The remaps are added to a single configuration which is published once
+            RemapConfiguration remapConfiguration;
+            for (const auto& modifierSet : modifierSets)
+            {
+                for (auto actionKey : actionKeys)
+                {
+                    Shortcut src;
+                    for (auto modifier : modifierSet)
+                    {
+                        src.SetKey(modifier);
+                    }
+                    src.SetKey(actionKey);
+                    remapConfiguration.AddOSLevelShortcut(src, (DWORD)VK_F24);
+                }
+            }
+            testState.SetRemapConfiguration(std::move(remapConfiguration));
+            Assert::AreEqual((size_t)1000, testState.GetRemapConfiguration()->osLevelShortcutReMap.size());
+
+            const int iterations = 10000;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                // Alternate between a remapped shortcut and plain typing which does not match any remap
+                WORD actionKey = (WORD)actionKeys[i % actionKeys.size()];
+                if (i % 2 == 0)
+                {
+                    SendKeyEvent(VK_LCONTROL, 0);
+                    SendKeyEvent(actionKey, 0);
+                    SendKeyEvent(actionKey, KEYEVENTF_KEYUP);
+                    SendKeyEvent(VK_LCONTROL, KEYEVENTF_KEYUP);
+                }
+                else
+                {
+                    SendKeyEvent(actionKey, 0);
+                    SendKeyEvent(actionKey, KEYEVENTF_KEYUP);
+                }
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            // All the keys should be released at the end of the run
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_F24));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_LCONTROL));
+            Assert::AreEqual(false, testState.CheckShortcutRemapInvoked(std::nullopt));
+
+            std::wstring message = L"Shortcut remap hook with 1000 remaps: " + std::to_wstring(elapsed / (iterations * 3)) + L" ns per physical key event\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
@@ -3,7 +3,10 @@
 #include <keyboardmanager/common/Shortcut.h>
 #include <keyboardmanager/common/Helpers.h>
 #include "TestHelpers.h"
+#include <keyboardmanager/common/KeyboardStateReader.h>
+#include "MockedInput.h"
 #include "../common/keyboard_layout.h"
+#include "../common/shared_constants.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -172,5 +175,128 @@ namespace KeyboardManagerCommonTests
             // Assert
             Assert::IsTrue(result == KeyboardManagerHelper::ErrorType::NoError);
         }
+
+        // Test if the CheckModifiersKeyboardState method returns true for a shortcut with both win keys when either of the win keys is pressed
+        TEST_METHOD (CheckModifiersKeyboardState_ShouldReturnTrue_OnPassingKeyboardStateWithEitherWinKeyForWinKeyBoth)
+        {
+            // Arrange
+            Shortcut s(std::vector<int32_t>{ (int32_t)CommonSharedConstants::VK_WIN_BOTH, VK_LCONTROL, 0x41 });
+            KeyboardStateSnapshot leftWinState;
+            leftWinState.set(VK_LWIN);
+            leftWinState.set(VK_LCONTROL);
+            KeyboardStateSnapshot rightWinState;
+            rightWinState.set(VK_RWIN);
+            rightWinState.set(VK_LCONTROL);
+            KeyboardStateSnapshot noWinState;
+            noWinState.set(VK_LCONTROL);
+
+            // Act and Assert
+            Assert::IsTrue(s.CheckModifiersKeyboardState(leftWinState));
+            Assert::IsTrue(s.CheckModifiersKeyboardState(rightWinState));
+            Assert::IsFalse(s.CheckModifiersKeyboardState(noWinState));
+        }
+
+        // Test if the CheckModifiersKeyboardState method returns false when the pressed modifier is on the other side of the shortcut modifier
+        TEST_METHOD (CheckModifiersKeyboardState_ShouldReturnFalse_OnPassingKeyboardStateWithModifierOnOtherSide)
+        {
+            // Arrange
+            Shortcut s(std::vector<int32_t>{ VK_LSHIFT, 0x41 });
+            KeyboardStateSnapshot keyboardState;
+            keyboardState.set(VK_RSHIFT);
+            keyboardState.set(VK_SHIFT);
+
+            // Act
+            bool result = s.CheckModifiersKeyboardState(keyboardState);
+
+            // Assert
+            Assert::IsFalse(result);
+        }
+
+        // Test if the IsKeyboardStateClearExceptShortcut method returns true when only the shortcut keys and ignored keys are pressed
+        TEST_METHOD (IsKeyboardStateClearExceptShortcut_ShouldReturnTrue_OnPassingKeyboardStateWithOnlyShortcutAndIgnoredKeys)
+        {
+            // Arrange
+            Shortcut s(std::vector<int32_t>{ VK_LCONTROL, VK_SHIFT, 0x41 });
+            KeyboardStateSnapshot keyboardState;
+            keyboardState.set(VK_LCONTROL);
+            keyboardState.set(VK_CONTROL);
+            keyboardState.set(VK_RSHIFT);
+            keyboardState.set(VK_SHIFT);
+            keyboardState.set(0x41);
+
+            // Mouse buttons and 0xFF (set because of the Num Lock) are ignored
+            keyboardState.set(VK_LBUTTON);
+            keyboardState.set(0xFF);
+
+            // Act
+            bool result = s.IsKeyboardStateClearExceptShortcut(keyboardState);
+
+            // Assert
+            Assert::IsTrue(result);
+        }
+
+        // Test if the IsKeyboardStateClearExceptShortcut method returns false when a key which is not in the shortcut is pressed
+        TEST_METHOD (IsKeyboardStateClearExceptShortcut_ShouldReturnFalse_OnPassingKeyboardStateWithOtherKeys)
+        {
+            // Arrange
+            Shortcut s(std::vector<int32_t>{ VK_LCONTROL, 0x41 });
+            KeyboardStateSnapshot otherKeyState;
+            otherKeyState.set(VK_LCONTROL);
+            otherKeyState.set(0x41);
+            otherKeyState.set(0x42);
+            KeyboardStateSnapshot otherSideState;
+            otherSideState.set(VK_RCONTROL);
+            otherSideState.set(0x41);
+
+            // Act and Assert
+            Assert::IsFalse(s.IsKeyboardStateClearExceptShortcut(otherKeyState));
+            Assert::IsFalse(s.IsKeyboardStateClearExceptShortcut(otherSideState));
+        }
+
+        // Test if the keyboard state reader only reads the modifier keys of the shortcut for the modifier check, and reads the state of all the keys once for the keyboard state check
+        TEST_METHOD (KeyboardStateReader_ShouldReadAllKeysOnlyOnce_WhenKeyboardStateIsCheckedForShortcut)
+        {
+            // Mocked input which counts the key state queries
+            class CountingInput : public MockedInput
+            {
+            public:
+                int keyStateCount = 0;
+                int snapshotCount = 0;
+
+                bool GetVirtualKeyState(int key) override
+                {
+                    keyStateCount++;
+                    return MockedInput::GetVirtualKeyState(key);
+                }
+
+                KeyboardStateSnapshot GetKeyboardStateSnapshot() override
+                {
+                    snapshotCount++;
+                    return MockedInput::GetKeyboardStateSnapshot();
+                }
+            };
+
+            CountingInput countingInput;
+            INPUT input[2] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = VK_LCONTROL;
+            input[1].type = INPUT_KEYBOARD;
+            input[1].ki.wVk = 0x41;
+            countingInput.SendVirtualInput(2, input, sizeof(INPUT));
+            Shortcut s(std::vector<int32_t>{ VK_LCONTROL, 0x41 });
+            KeyboardStateReader keyboardState(countingInput);
+
+            // Act and Assert
+            Assert::IsTrue(s.CheckModifiersKeyboardState(keyboardState));
+            Assert::IsTrue(s.CheckModifiersKeyboardState(keyboardState));
+            Assert::AreEqual(1, countingInput.keyStateCount);
+            Assert::AreEqual(0, countingInput.snapshotCount);
+
+            Assert::IsTrue(s.IsKeyboardStateClearExceptShortcut(keyboardState));
+            Assert::IsTrue(s.IsKeyboardStateClearExceptShortcut(keyboardState));
+            Assert::IsTrue(keyboardState.IsKeyPressed(0x41));
+            Assert::AreEqual(1, countingInput.keyStateCount);
+            Assert::AreEqual(1, countingInput.snapshotCount);
+        }
     };
 }
@@ -12,9 +12,11 @@ namespace TestHelpers
         input.SetHookProc(nullptr);
         input.SetSendVirtualInputTestHandler(nullptr);
         input.SetForegroundProcess(L"");
+        state.BeginRemapConfigurationBatch();
         state.ClearSingleKeyRemaps();
         state.ClearOSLevelShortcuts();
         state.ClearAppSpecificShortcuts();
+        state.EndRemapConfigurationBatch();
 
         // Allocate memory for the keyboardManagerState activatedApp member to avoid CRT assert errors
         std::wstring maxLengthString;
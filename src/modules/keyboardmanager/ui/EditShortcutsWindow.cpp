@@ -227,8 +227,9 @@ void createEditShortcutsWindow(HINSTANCE hInst, KeyboardManagerState& keyboardMa
     keyboardManagerState.SetUIState(KeyboardManagerUIState::EditShortcutsWindowActivated, _hWndEditShortcutsWindow);
 
     // Load existing os level shortcuts into UI
-    // Create copy of the remaps to avoid concurrent access
-    ShortcutRemapTable osLevelShortcutReMapCopy = keyboardManagerState.osLevelShortcutReMap;
+    // The published remap configuration is immutable, so it can be read while the hook is running
+    std::shared_ptr<const RemapConfiguration> remapConfiguration = keyboardManagerState.GetRemapConfiguration();
+    const ShortcutRemapTable& osLevelShortcutReMapCopy = remapConfiguration->osLevelShortcutReMap;
 
     for (const auto& it : osLevelShortcutReMapCopy)
     {
@@ -236,8 +237,7 @@ void createEditShortcutsWindow(HINSTANCE hInst, KeyboardManagerState& keyboardMa
     }
 
     // Load existing app-specific shortcuts into UI
-    // Create copy of the remaps to avoid concurrent access
-    AppSpecificShortcutRemapTable appSpecificShortcutReMapCopy = keyboardManagerState.appSpecificShortcutReMap;
+    const AppSpecificShortcutRemapTable& appSpecificShortcutReMapCopy = remapConfiguration->appSpecificShortcutReMap;
 
     // Iterate through all the apps
     for (const auto& itApp : appSpecificShortcutReMapCopy)
@@ -259,13 +259,10 @@ void createEditShortcutsWindow(HINSTANCE hInst, KeyboardManagerState& keyboardMa
     header.SetLeftOf(applyButton, cancelButton);
 
     auto ApplyRemappings = [&keyboardManagerState, _hWndEditShortcutsWindow]() {
-        // Disable the remappings while the remapping table is updated
-        keyboardManagerState.RemappingsDisabledWrapper(
-            [&keyboardManagerState]() {
-                LoadingAndSavingRemappingHelper::ApplyShortcutRemappings(keyboardManagerState, ShortcutControl::shortcutRemapBuffer, true);
-                // Save the updated key remaps to file.
-                bool saveResult = keyboardManagerState.SaveConfigToFile();
-            });
+        // The new remap tables are swapped in atomically, so the existing remaps stay active while they are built
+        LoadingAndSavingRemappingHelper::ApplyShortcutRemappings(keyboardManagerState, ShortcutControl::shortcutRemapBuffer, true);
+        // Save the updated key remaps to file.
+        bool saveResult = keyboardManagerState.SaveConfigToFile();
         PostMessage(_hWndEditShortcutsWindow, WM_CLOSE, 0, 0);
     };
 
@@ -102,59 +102,63 @@ namespace LoadingAndSavingRemappingHelper
     // Function to apply the single key remappings from the buffer to the KeyboardManagerState variable
     void ApplySingleKeyRemappings(KeyboardManagerState& keyboardManagerState, const RemapBuffer& remappings, bool isTelemetryRequired)
     {
-        // Clear existing Key Remaps
-        keyboardManagerState.ClearSingleKeyRemaps();
         DWORD successfulKeyToKeyRemapCount = 0;
         DWORD successfulKeyToShortcutRemapCount = 0;
-        for (int i = 0; i < remappings.size(); i++)
-        {
-            DWORD originalKey = std::get<DWORD>(remappings[i].first[0]);
-            KeyShortcutUnion newKey = remappings[i].first[1];
 
-            if (originalKey != NULL && !(newKey.index() == 0 && std::get<DWORD>(newKey) == NULL) && !(newKey.index() == 1 && !std::get<Shortcut>(newKey).IsValidShortcut()))
+        // Build the new remap table on a copy of the configuration, which is swapped in atomically once it is complete
+        keyboardManagerState.UpdateRemapConfiguration([&](RemapConfiguration& remapConfiguration) {
+            // Clear existing Key Remaps
+            remapConfiguration.ClearSingleKeyRemaps();
+            for (int i = 0; i < remappings.size(); i++)
             {
-                // If Ctrl/Alt/Shift are added, add their L and R versions instead to the same key
-                bool result = false;
-                bool res1, res2;
-                switch (originalKey)
-                {
-                case VK_CONTROL:
-                    res1 = keyboardManagerState.AddSingleKeyRemap(VK_LCONTROL, newKey);
-                    res2 = keyboardManagerState.AddSingleKeyRemap(VK_RCONTROL, newKey);
-                    result = res1 && res2;
-                    break;
-                case VK_MENU:
-                    res1 = keyboardManagerState.AddSingleKeyRemap(VK_LMENU, newKey);
-                    res2 = keyboardManagerState.AddSingleKeyRemap(VK_RMENU, newKey);
-                    result = res1 && res2;
-                    break;
-                case VK_SHIFT:
-                    res1 = keyboardManagerState.AddSingleKeyRemap(VK_LSHIFT, newKey);
-                    res2 = keyboardManagerState.AddSingleKeyRemap(VK_RSHIFT, newKey);
-                    result = res1 && res2;
-                    break;
-                case CommonSharedConstants::VK_WIN_BOTH:
-                    res1 = keyboardManagerState.AddSingleKeyRemap(VK_LWIN, newKey);
-                    res2 = keyboardManagerState.AddSingleKeyRemap(VK_RWIN, newKey);
-                    result = res1 && res2;
-                    break;
-                default:
-                    result = keyboardManagerState.AddSingleKeyRemap(originalKey, newKey);
-                }
+                DWORD originalKey = std::get<DWORD>(remappings[i].first[0]);
+                KeyShortcutUnion newKey = remappings[i].first[1];
 
-                if (result)
+                if (originalKey != NULL && !(newKey.index() == 0 && std::get<DWORD>(newKey) == NULL) && !(newKey.index() == 1 && !std::get<Shortcut>(newKey).IsValidShortcut()))
                 {
-                    if (newKey.index() == 0)
+                    // If Ctrl/Alt/Shift are added, add their L and R versions instead to the same key
+                    bool result = false;
+                    bool res1, res2;
+                    switch (originalKey)
                     {
-                        successfulKeyToKeyRemapCount += 1;
+                    case VK_CONTROL:
+                        res1 = remapConfiguration.AddSingleKeyRemap(VK_LCONTROL, newKey);
+                        res2 = remapConfiguration.AddSingleKeyRemap(VK_RCONTROL, newKey);
+                        result = res1 && res2;
+                        break;
+                    case VK_MENU:
+                        res1 = remapConfiguration.AddSingleKeyRemap(VK_LMENU, newKey);
+                        res2 = remapConfiguration.AddSingleKeyRemap(VK_RMENU, newKey);
+                        result = res1 && res2;
+                        break;
+                    case VK_SHIFT:
+                        res1 = remapConfiguration.AddSingleKeyRemap(VK_LSHIFT, newKey);
+                        res2 = remapConfiguration.AddSingleKeyRemap(VK_RSHIFT, newKey);
+                        result = res1 && res2;
+                        break;
+                    case CommonSharedConstants::VK_WIN_BOTH:
+                        res1 = remapConfiguration.AddSingleKeyRemap(VK_LWIN, newKey);
+                        res2 = remapConfiguration.AddSingleKeyRemap(VK_RWIN, newKey);
+                        result = res1 && res2;
+                        break;
+                    default:
+                        result = remapConfiguration.AddSingleKeyRemap(originalKey, newKey);
                     }
-                    else
+
+                    if (result)
                     {
-                        successfulKeyToShortcutRemapCount += 1;
+                        if (newKey.index() == 0)
+                        {
+                            successfulKeyToKeyRemapCount += 1;
+                        }
+                        else
+                        {
+                            successfulKeyToShortcutRemapCount += 1;
+                        }
                     }
                 }
             }
-        }
+        });
 
         // If telemetry is to be logged, log the key remap counts
         if (isTelemetryRequired)
@@ -166,53 +170,57 @@ namespace LoadingAndSavingRemappingHelper
     // Function to apply the shortcut remappings from the buffer to the KeyboardManagerState variable
     void ApplyShortcutRemappings(KeyboardManagerState& keyboardManagerState, const RemapBuffer& remappings, bool isTelemetryRequired)
     {
-        // Clear existing shortcuts
-        keyboardManagerState.ClearOSLevelShortcuts();
-        keyboardManagerState.ClearAppSpecificShortcuts();
         DWORD successfulOSLevelShortcutToShortcutRemapCount = 0;
         DWORD successfulOSLevelShortcutToKeyRemapCount = 0;
         DWORD successfulAppSpecificShortcutToShortcutRemapCount = 0;
         DWORD successfulAppSpecificShortcutToKeyRemapCount = 0;
-        // Save the shortcuts that are valid and report if any of them were invalid
-        for (int i = 0; i < remappings.size(); i++)
-        {
-            Shortcut originalShortcut = std::get<Shortcut>(remappings[i].first[0]);
-            KeyShortcutUnion newShortcut = remappings[i].first[1];
 
-            if (originalShortcut.IsValidShortcut() && ((newShortcut.index() == 0 && std::get<DWORD>(newShortcut) != NULL) || (newShortcut.index() == 1 && std::get<Shortcut>(newShortcut).IsValidShortcut())))
+        // Build the new remap table on a copy of the configuration, which is swapped in atomically once it is complete
+        keyboardManagerState.UpdateRemapConfiguration([&](RemapConfiguration& remapConfiguration) {
+            // Clear existing shortcuts
+            remapConfiguration.ClearOSLevelShortcuts();
+            remapConfiguration.ClearAppSpecificShortcuts();
+            // Save the shortcuts that are valid and report if any of them were invalid
+            for (int i = 0; i < remappings.size(); i++)
             {
-                if (remappings[i].second == L"")
+                Shortcut originalShortcut = std::get<Shortcut>(remappings[i].first[0]);
+                KeyShortcutUnion newShortcut = remappings[i].first[1];
+
+                if (originalShortcut.IsValidShortcut() && ((newShortcut.index() == 0 && std::get<DWORD>(newShortcut) != NULL) || (newShortcut.index() == 1 && std::get<Shortcut>(newShortcut).IsValidShortcut())))
                 {
-                    bool result = keyboardManagerState.AddOSLevelShortcut(originalShortcut, newShortcut);
-                    if (result)
+                    if (remappings[i].second == L"")
                     {
-                        if (newShortcut.index() == 0)
+                        bool result = remapConfiguration.AddOSLevelShortcut(originalShortcut, newShortcut);
+                        if (result)
                         {
-                            successfulOSLevelShortcutToKeyRemapCount += 1;
-                        }
-                        else
-                        {
-                            successfulOSLevelShortcutToShortcutRemapCount += 1;
+                            if (newShortcut.index() == 0)
+                            {
+                                successfulOSLevelShortcutToKeyRemapCount += 1;
+                            }
+                            else
+                            {
+                                successfulOSLevelShortcutToShortcutRemapCount += 1;
+                            }
                         }
                     }
-                }
-                else
-                {
-                    bool result = keyboardManagerState.AddAppSpecificShortcut(remappings[i].second, originalShortcut, newShortcut);
-                    if (result)
+                    else
                     {
-                        if (newShortcut.index() == 0)
+                        bool result = remapConfiguration.AddAppSpecificShortcut(remappings[i].second, originalShortcut, newShortcut);
+                        if (result)
                         {
-                            successfulAppSpecificShortcutToKeyRemapCount += 1;
-                        }
-                        else
-                        {
-                            successfulAppSpecificShortcutToShortcutRemapCount += 1;
+                            if (newShortcut.index() == 0)
+                            {
+                                successfulAppSpecificShortcutToKeyRemapCount += 1;
+                            }
+                            else
+                            {
+                                successfulAppSpecificShortcutToShortcutRemapCount += 1;
+                            }
                         }
                     }
                 }
             }
-        }
+        });
 
         // If telemetry is to be logged, log the shortcut remap counts
         if (isTelemetryRequired)
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Names as they are found in photo, document and music folders, shared by the benchmarks so that they all measure
+// the same selection of files
+inline std::vector<std::wstring> MakeBenchmarkNames(int count)
+{
+    std::vector<std::wstring> names;
+    names.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        switch (i % 4)
+        {
+        case 0:
+            names.push_back(L"IMG_2020" + std::to_wstring(1 + i % 12 + 100).substr(1) + std::to_wstring(1 + i % 28 + 100).substr(1) + L"_" + std::to_wstring(i) + L".jpg");
+            break;
+        case 1:
+            names.push_back(L"Quarterly report (" + std::to_wstring(i) + L") - Copy.docx");
+            break;
+        case 2:
+            names.push_back(L"Track " + std::to_wstring(i % 20) + L" - the_artist_name - album_title_" + std::to_wstring(i) + L".mp3");
+            break;
+        default:
+            names.push_back(L"notes_" + std::to_wstring(i) + L" copy of copy.txt");
+            break;
+        }
+    }
+    return names;
+}
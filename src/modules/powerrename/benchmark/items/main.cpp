@@ -0,0 +1,143 @@
+// Measures how long PowerRenameManager takes to add and look up the items of a large selection of files, the way
+// the workers and the list view do it: every item by index, every item by id, and every visible item by index with
+// a filter, asking for the visible item count each time like the list view does for each row it draws.
+//
+// Usage: PowerRenameItemsBenchmark [items...]
+// Prints one CSV line per measurement, with the time of a pass over all the items in milliseconds and the average
+// time per item in nanoseconds, which stays flat as the number of items grows when lookups are O(1).
+
+#include <PowerRenameManager.h>
+#include <PowerRenameItem.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+HINSTANCE g_hInst = GetModuleHandle(nullptr);
+
+namespace
+{
+    const int DefaultItemCounts[] = { 1000, 10000, 100000 };
+
+    // Keeps the compiler from optimizing away the lookups
+    volatile size_t g_sink = 0;
+
+    template<typename Run>
+    double Measure(Run&& run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void Print(const char* operation, int itemCount, double milliseconds)
+    {
+        printf("%s,%d,%.2f,%.1f\n", operation, itemCount, milliseconds, milliseconds * 1000000 / itemCount);
+    }
+
+    bool RunBenchmark(int itemCount)
+    {
+        CComPtr<IPowerRenameManager> manager;
+        if (FAILED(CPowerRenameManager::s_CreateInstance(&manager)))
+        {
+            return false;
+        }
+
+        std::vector<CComPtr<IPowerRenameItem>> items(itemCount);
+        std::vector<int> ids(itemCount);
+        for (int i = 0; i < itemCount; i++)
+        {
+            if (FAILED(CPowerRenameItem::s_CreateInstance(nullptr, IID_PPV_ARGS(&items[i]))))
+            {
+                return false;
+            }
+            items[i]->GetId(&ids[i]);
+        }
+
+        Print("add", itemCount, Measure([&] {
+                  for (const auto& item : items)
+                  {
+                      manager->AddItem(item);
+                  }
+              }));
+
+        Print("by-index", itemCount, Measure([&] {
+                  for (UINT i = 0; i < static_cast<UINT>(itemCount); i++)
+                  {
+                      CComPtr<IPowerRenameItem> item;
+                      manager->GetItemByIndex(i, &item);
+                      g_sink = g_sink + (item != nullptr);
+                  }
+              }));
+
+        Print("by-id", itemCount, Measure([&] {
+                  for (int id : ids)
+                  {
+                      CComPtr<IPowerRenameItem> item;
+                      manager->GetItemById(id, &item);
+                      g_sink = g_sink + (item != nullptr);
+                  }
+              }));
+
+        // Show the selected items, every other item is selected
+        for (int i = 0; i < itemCount; i += 2)
+        {
+            items[i]->PutSelected(false);
+        }
+        manager->SwitchFilter(0);
+
+        Print("set-visible", itemCount, Measure([&] {
+                  manager->SetVisible();
+              }));
+
+        Print("visible-by-index", itemCount, Measure([&] {
+                  UINT visibleItemCount = 0;
+                  manager->GetVisibleItemCount(&visibleItemCount);
+                  for (UINT i = 0; i < visibleItemCount; i++)
+                  {
+                      UINT count = 0;
+                      manager->GetVisibleItemCount(&count);
+
+                      CComPtr<IPowerRenameItem> item;
+                      manager->GetVisibleItemByIndex(i, &item);
+                      g_sink = g_sink + (item != nullptr) + count;
+                  }
+              }));
+
+        manager->Shutdown();
+        return true;
+    }
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+    std::vector<int> itemCounts(std::begin(DefaultItemCounts), std::end(DefaultItemCounts));
+    if (argc > 1)
+    {
+        itemCounts.clear();
+        for (int i = 1; i < argc; i++)
+        {
+            itemCounts.push_back(_wtoi(argv[i]));
+            if (itemCounts.back() <= 0)
+            {
+                fwprintf(stderr, L"Usage: PowerRenameItemsBenchmark [items...]\n");
+                return 1;
+            }
+        }
+    }
+
+    printf("operation,items,milliseconds,nanoseconds-per-item\n");
+    for (int itemCount : itemCounts)
+    {
+        if (!RunBenchmark(itemCount))
+        {
+            fwprintf(stderr, L"Failed to set up the rename manager\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
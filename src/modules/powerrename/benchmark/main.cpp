@@ -0,0 +1,155 @@
+// Measures how long PowerRename takes to compute the new names of a large selection of files, for a few typical
+// search and replace terms. The terms are applied once through CPowerRenameRegEx, which compiles them when they
+// change, and once the way Replace used to do it, compiling the regular expressions again for every name.
+//
+// Usage: PowerRenameRegExBenchmark [names] [iterations]
+// Prints one CSV line per measurement, with the average time of a pass over all the names in milliseconds.
+
+#include <PowerRenameRegEx.h>
+
+#include "BenchmarkNames.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int DefaultNames = 50000;
+    constexpr int DefaultIterations = 3;
+
+    struct Scenario
+    {
+        const char* name;
+        PCWSTR searchTerm;
+        PCWSTR replaceTerm;
+        DWORD flags;
+    };
+
+    const Scenario Scenarios[] = {
+        { "literal", L"copy", L"backup", MatchAllOccurences },
+        { "regex-groups", L"IMG_(\\d{4})(\\d{2})(\\d{2})", L"$1-$2-$3", MatchAllOccurences | UseRegularExpressions | CaseSensitive },
+        { "regex-first-only", L"\\s+", L"_", UseRegularExpressions },
+        { "regex-whole-name", L"^(.*)\\.(\\w+)$", L"$2 - $1", MatchAllOccurences | UseRegularExpressions },
+    };
+
+    // Keeps the compiler from optimizing away the replacements
+    volatile size_t g_sink = 0;
+
+    size_t Find(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos)
+    {
+        if (caseInsensitive)
+        {
+            std::transform(data.begin(), data.end(), data.begin(), ::towlower);
+            std::transform(toSearch.begin(), toSearch.end(), toSearch.begin(), ::towlower);
+        }
+        return data.find(toSearch, pos);
+    }
+
+    // CPowerRenameRegEx::Replace before the terms were compiled once per change
+    std::wstring ReplaceUncached(const std::wstring& source, const Scenario& scenario)
+    {
+        std::wstring replaceTerm = regex_replace(std::wstring(scenario.replaceTerm), std::wregex(L"(([^\\$]|^)(\\$\\$)*)\\$[0]"), L"$1$$$0");
+        replaceTerm = regex_replace(replaceTerm, std::wregex(L"(([^\\$]|^)(\\$\\$)*)\\$([1-9])"), L"$1$0$4");
+
+        if (scenario.flags & UseRegularExpressions)
+        {
+            std::wregex pattern(scenario.searchTerm, (!(scenario.flags & CaseSensitive)) ? std::regex_constants::icase | std::regex_constants::ECMAScript : std::regex_constants::ECMAScript);
+            return regex_replace(source, pattern, replaceTerm, (scenario.flags & MatchAllOccurences) ? std::regex_constants::format_default : std::regex_constants::format_first_only);
+        }
+
+        // Simple search and replace
+        std::wstring sourceToUse = source;
+        std::wstring result = source;
+        const std::wstring searchTerm = scenario.searchTerm;
+        size_t pos = 0;
+        do
+        {
+            pos = Find(sourceToUse, searchTerm, (!(scenario.flags & CaseSensitive)), pos);
+            if (pos != std::wstring::npos)
+            {
+                result = sourceToUse.replace(pos, searchTerm.length(), replaceTerm);
+                pos += replaceTerm.length();
+            }
+
+            if (!(scenario.flags & MatchAllOccurences))
+            {
+                break;
+            }
+        } while (pos != std::wstring::npos);
+        return result;
+    }
+
+    template<typename Run>
+    double Measure(int iterations, Run&& run)
+    {
+        size_t length = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            length += run();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        g_sink = g_sink + length;
+
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    }
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+    const int nameCount = argc > 1 ? _wtoi(argv[1]) : DefaultNames;
+    const int iterations = argc > 2 ? _wtoi(argv[2]) : DefaultIterations;
+    if (nameCount <= 0 || iterations <= 0)
+    {
+        fwprintf(stderr, L"Usage: PowerRenameRegExBenchmark [names] [iterations]\n");
+        return 1;
+    }
+
+    const auto names = MakeBenchmarkNames(nameCount);
+
+    printf("scenario,implementation,names,milliseconds\n");
+    for (const auto& scenario : Scenarios)
+    {
+        const double uncached = Measure(iterations, [&] {
+            size_t length = 0;
+            for (const auto& name : names)
+            {
+                length += ReplaceUncached(name, scenario).size();
+            }
+            return length;
+        });
+        printf("%s,uncached,%d,%.2f\n", scenario.name, nameCount, uncached);
+
+        CComPtr<IPowerRenameRegEx> renameRegEx;
+        if (FAILED(CPowerRenameRegEx::s_CreateInstance(&renameRegEx)) ||
+            FAILED(renameRegEx->PutFlags(scenario.flags)) ||
+            FAILED(renameRegEx->PutSearchTerm(scenario.searchTerm)) ||
+            FAILED(renameRegEx->PutReplaceTerm(scenario.replaceTerm)))
+        {
+            fwprintf(stderr, L"Failed to set up the rename regex\n");
+            return 1;
+        }
+
+        const double cached = Measure(iterations, [&] {
+            size_t length = 0;
+            for (const auto& name : names)
+            {
+                PWSTR result = nullptr;
+                if (SUCCEEDED(renameRegEx->Replace(name.c_str(), &result)))
+                {
+                    length += wcslen(result);
+                    CoTaskMemFree(result);
+                }
+            }
+            return length;
+        });
+        printf("%s,cached,%d,%.2f\n", scenario.name, nameCount, cached);
+    }
+
+    return 0;
+}
@@ -0,0 +1,217 @@
+// Measures how the time PowerRename takes to compute the new names of a large selection of files changes with the
+// number of threads they are computed on. The items are renamed the way the regex rename worker does it, in batches
+// which are read from the manager, computed with ComputeRenamePreview, then published to the items, for a few typical
+// search and replace terms.
+//
+// Usage: PowerRenamePreviewBenchmark [items] [iterations]
+// Prints one CSV line per measurement, with the average time of a pass over all the items in milliseconds for each
+// stage and in total, and the speedup of the total over a single thread.
+
+#include <PowerRenameManager.h>
+#include <PowerRenameItem.h>
+#include <PowerRenameRegEx.h>
+#include <RenamePreview.h>
+
+#include "../BenchmarkNames.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+HINSTANCE g_hInst = GetModuleHandle(nullptr);
+
+namespace
+{
+    constexpr int DefaultItems = 100000;
+    constexpr int DefaultIterations = 3;
+
+    struct Scenario
+    {
+        const char* name;
+        PCWSTR searchTerm;
+        PCWSTR replaceTerm;
+        DWORD flags;
+    };
+
+    const Scenario Scenarios[] = {
+        { "literal", L"copy", L"backup", MatchAllOccurences },
+        { "regex-groups", L"IMG_(\\d{4})(\\d{2})(\\d{2})", L"$1-$2-$3", MatchAllOccurences | UseRegularExpressions | CaseSensitive },
+        { "regex-titlecase", L"[_-]+", L" ", MatchAllOccurences | UseRegularExpressions | Titlecase | NameOnly },
+        { "regex-enumerate", L"^(.*)\\.(\\w+)$", L"$2 - $1", MatchAllOccurences | UseRegularExpressions | EnumerateItems },
+    };
+
+    // Keeps the compiler from optimizing away the published ids
+    volatile size_t g_sink = 0;
+
+    // Item with a name and no shell item, so that the benchmark doesn't touch the file system
+    class CBenchmarkItem :
+        public CPowerRenameItem
+    {
+    public:
+        static HRESULT CreateInstance(_In_ PCWSTR originalName, _Outptr_ IPowerRenameItem** ppItem)
+        {
+            *ppItem = nullptr;
+            CBenchmarkItem* newItem = new CBenchmarkItem();
+            HRESULT hr = SHStrDup(originalName, &newItem->m_originalName);
+            if (SUCCEEDED(hr))
+            {
+                hr = newItem->QueryInterface(IID_PPV_ARGS(ppItem));
+            }
+            newItem->Release();
+            return hr;
+        }
+    };
+
+    // Average time of each stage of a pass over all the items, in milliseconds
+    struct StageTimes
+    {
+        double read = 0;
+        double compute = 0;
+        double publish = 0;
+
+        double Total() const
+        {
+            return read + compute + publish;
+        }
+    };
+
+    // Renames all the items in batches of the size used by the regex rename worker, starting from items without a new name
+    StageTimes Measure(IPowerRenameManager* manager, std::vector<CComPtr<IPowerRenameItem>>& items, IPowerRenameRegEx* renameRegEx, UINT threadCount, int iterations)
+    {
+        using Clock = std::chrono::steady_clock;
+        constexpr UINT BatchSize = 2048;
+        const UINT itemCount = static_cast<UINT>(items.size());
+
+        Clock::duration read{};
+        Clock::duration compute{};
+        Clock::duration publish{};
+        for (int i = 0; i < iterations; i++)
+        {
+            for (auto& item : items)
+            {
+                item->Reset();
+            }
+
+            unsigned long enumIndex = 1;
+            for (UINT batchStart = 0; batchStart < itemCount; batchStart += BatchSize)
+            {
+                const UINT batchEnd = min(batchStart + BatchSize, itemCount);
+
+                const auto readStart = Clock::now();
+                std::vector<RenamePreviewItem> previewItems;
+                previewItems.reserve(batchEnd - batchStart);
+                for (UINT u = batchStart; u < batchEnd; u++)
+                {
+                    CComPtr<IPowerRenameItem> spItem;
+                    if (SUCCEEDED(manager->GetItemByIndex(u, &spItem)))
+                    {
+                        RenamePreviewItem previewItem;
+                        if (SUCCEEDED(GetRenamePreviewItem(spItem, &previewItem)))
+                        {
+                            previewItems.push_back(std::move(previewItem));
+                        }
+                    }
+                }
+
+                const auto computeStart = Clock::now();
+                ComputeRenamePreview(previewItems.data(), previewItems.size(), renameRegEx, threadCount, nullptr, &enumIndex);
+
+                // The worker then hands the ids to the manager, which appends them to the queue of item updates
+                const auto publishStart = Clock::now();
+                std::vector<int> updatedItemIds;
+                for (const RenamePreviewItem& previewItem : previewItems)
+                {
+                    PCWSTR newNameToUse = previewItem.hasNewName ? previewItem.newName.c_str() : nullptr;
+                    PCWSTR currentNewName = previewItem.hasCurrentNewName ? previewItem.currentNewName.c_str() : nullptr;
+                    previewItem.item->PutNewName(newNameToUse);
+                    if (previewItem.excluded || lstrcmp(currentNewName, newNameToUse) != 0)
+                    {
+                        updatedItemIds.push_back(previewItem.id);
+                    }
+                }
+                g_sink = g_sink + updatedItemIds.size();
+                const auto publishEnd = Clock::now();
+
+                read += computeStart - readStart;
+                compute += publishStart - computeStart;
+                publish += publishEnd - publishStart;
+            }
+        }
+
+        StageTimes times;
+        times.read = std::chrono::duration<double, std::milli>(read).count() / iterations;
+        times.compute = std::chrono::duration<double, std::milli>(compute).count() / iterations;
+        times.publish = std::chrono::duration<double, std::milli>(publish).count() / iterations;
+        return times;
+    }
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+    const int itemCount = argc > 1 ? _wtoi(argv[1]) : DefaultItems;
+    const int iterations = argc > 2 ? _wtoi(argv[2]) : DefaultIterations;
+    if (itemCount <= 0 || iterations <= 0)
+    {
+        fwprintf(stderr, L"Usage: PowerRenamePreviewBenchmark [items] [iterations]\n");
+        return 1;
+    }
+
+    CComPtr<IPowerRenameManager> manager;
+    if (FAILED(CPowerRenameManager::s_CreateInstance(&manager)))
+    {
+        fwprintf(stderr, L"Failed to set up the rename manager\n");
+        return 1;
+    }
+
+    const auto names = MakeBenchmarkNames(itemCount);
+    std::vector<CComPtr<IPowerRenameItem>> items(itemCount);
+    for (int i = 0; i < itemCount; i++)
+    {
+        if (FAILED(CBenchmarkItem::CreateInstance(names[i].c_str(), &items[i])) || FAILED(manager->AddItem(items[i])))
+        {
+            fwprintf(stderr, L"Failed to set up the rename manager\n");
+            return 1;
+        }
+    }
+
+    // 1, 2, 4... threads up to the number of processors, which is measured too when it isn't a power of two
+    std::vector<UINT> threadCounts;
+    const UINT processorCount = max(1u, std::thread::hardware_concurrency());
+    for (UINT threadCount = 1; threadCount < processorCount; threadCount *= 2)
+    {
+        threadCounts.push_back(threadCount);
+    }
+    threadCounts.push_back(processorCount);
+
+    printf("scenario,threads,items,read-milliseconds,compute-milliseconds,publish-milliseconds,milliseconds,speedup\n");
+    for (const auto& scenario : Scenarios)
+    {
+        CComPtr<IPowerRenameRegEx> renameRegEx;
+        if (FAILED(CPowerRenameRegEx::s_CreateInstance(&renameRegEx)) ||
+            FAILED(renameRegEx->PutFlags(scenario.flags)) ||
+            FAILED(renameRegEx->PutSearchTerm(scenario.searchTerm)) ||
+            FAILED(renameRegEx->PutReplaceTerm(scenario.replaceTerm)))
+        {
+            fwprintf(stderr, L"Failed to set up the rename regex\n");
+            return 1;
+        }
+
+        double singleThread = 0;
+        for (UINT threadCount : threadCounts)
+        {
+            const StageTimes times = Measure(manager, items, renameRegEx, threadCount, iterations);
+            const double milliseconds = times.Total();
+            if (threadCount == 1)
+            {
+                singleThread = milliseconds;
+            }
+            printf("%s,%u,%d,%.2f,%.2f,%.2f,%.2f,%.2f\n", scenario.name, threadCount, itemCount, times.read, times.compute, times.publish, milliseconds, singleThread / milliseconds);
+        }
+    }
+
+    manager->Shutdown();
+    return 0;
+}
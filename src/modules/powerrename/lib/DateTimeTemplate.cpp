@@ -0,0 +1,311 @@
+#include "pch.h"
+#include "DateTimeTemplate.h"
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Localized names of the months and days, capitalized
+struct DateTimeNames
+{
+    std::wstring months[12];
+    std::wstring monthAbbreviations[12];
+    // Indexed by day of the week, Sunday first as in SYSTEMTIME
+    std::wstring days[7];
+    std::wstring dayAbbreviations[7];
+};
+
+namespace
+{
+    struct TokenName
+    {
+        PCWSTR name;
+        size_t length;
+    };
+
+    // Longer tokens come first, a token is matched with the first name that is a prefix of the text after the $.
+    // The fields are listed in the same order as the token names.
+    const TokenName tokenNames[] = {
+        { L"YYYY", 4 }, { L"YY", 2 }, { L"Y", 1 },
+        { L"MMMM", 4 }, { L"MMM", 3 }, { L"MM", 2 }, { L"M", 1 },
+        { L"DDDD", 4 }, { L"DDD", 3 }, { L"DD", 2 }, { L"D", 1 },
+        { L"hh", 2 }, { L"h", 1 },
+        { L"mm", 2 }, { L"m", 1 },
+        { L"ss", 2 }, { L"s", 1 },
+        { L"fff", 3 }, { L"ff", 2 }, { L"f", 1 },
+    };
+
+    std::wstring FormatDateName(_In_ PCWSTR localeName, const SYSTEMTIME& date, _In_ PCWSTR format)
+    {
+        wchar_t formattedDate[MAX_PATH] = { 0 };
+        GetDateFormatEx(localeName, NULL, &date, format, formattedDate, MAX_PATH, NULL);
+
+        wchar_t firstLetter = formattedDate[0];
+        if (LCMapStringEx(localeName, LCMAP_UPPERCASE, &formattedDate[0], 1, &firstLetter, 1, nullptr, nullptr, 0) == 1)
+        {
+            formattedDate[0] = firstLetter;
+        }
+        return formattedDate;
+    }
+
+    std::unique_ptr<const DateTimeNames> CreateDateTimeNames(_In_ PCWSTR localeName)
+    {
+        auto names = std::make_unique<DateTimeNames>();
+        for (WORD month = 1; month <= 12; month++)
+        {
+            const SYSTEMTIME date = { 2000, month, 0, 1 };
+            names->months[month - 1] = FormatDateName(localeName, date, L"MMMM");
+            names->monthAbbreviations[month - 1] = FormatDateName(localeName, date, L"MMM");
+        }
+
+        // January 2nd, 2000 was a Sunday
+        for (WORD day = 0; day < 7; day++)
+        {
+            const SYSTEMTIME date = { 2000, 1, day, static_cast<WORD>(2 + day) };
+            names->days[day] = FormatDateName(localeName, date, L"dddd");
+            names->dayAbbreviations[day] = FormatDateName(localeName, date, L"ddd");
+        }
+        return names;
+    }
+
+    // The names are built once per locale and kept until the process exits
+    const DateTimeNames& GetDateTimeNames(_In_ PCWSTR localeName)
+    {
+        static std::mutex namesLock;
+        static std::map<std::wstring, std::unique_ptr<const DateTimeNames>> namesByLocale;
+
+        std::scoped_lock lock(namesLock);
+        auto& names = namesByLocale[localeName];
+        if (!names)
+        {
+            names = CreateDateTimeNames(localeName);
+        }
+        return *names;
+    }
+
+    // Day of the week of a date of the Gregorian calendar, from 0 for Sunday to 6
+    int GetDayOfWeek(int year, int month, int day)
+    {
+        static const int monthOffsets[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+        if (month < 3)
+        {
+            year--;
+        }
+        return (year + year / 4 - year / 100 + year / 400 + monthOffsets[month - 1] + day) % 7;
+    }
+
+    // Writes to a buffer of a fixed size, truncating what doesn't fit
+    class TruncatingWriter
+    {
+    public:
+        TruncatingWriter(_Out_writes_(cchMax) PWSTR buffer, UINT cchMax) :
+            m_position(buffer), m_end(buffer + cchMax - 1)
+        {
+        }
+
+        void Append(_In_reads_(length) PCWSTR text, size_t length)
+        {
+            const size_t available = m_end - m_position;
+            if (length > available)
+            {
+                length = available;
+                m_truncated = true;
+            }
+            wmemcpy(m_position, text, length);
+            m_position += length;
+        }
+
+        void Append(const std::wstring& text)
+        {
+            Append(text.c_str(), text.length());
+        }
+
+        void AppendNumber(unsigned int value, int minDigits)
+        {
+            wchar_t digits[16];
+            int count = 0;
+            do
+            {
+                digits[count++] = static_cast<wchar_t>(L'0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+
+            while (count < minDigits)
+            {
+                digits[count++] = L'0';
+            }
+
+            wchar_t text[16];
+            for (int i = 0; i < count; i++)
+            {
+                text[i] = digits[count - 1 - i];
+            }
+            Append(text, count);
+        }
+
+        HRESULT Finish()
+        {
+            *m_position = L'\0';
+            return m_truncated ? STRSAFE_E_INSUFFICIENT_BUFFER : S_OK;
+        }
+
+    private:
+        PWSTR m_position;
+        PWSTR m_end;
+        bool m_truncated = false;
+    };
+}
+
+CDateTimeTemplate::CDateTimeTemplate(_In_ PCWSTR replaceTerm) :
+    m_replaceTerm(replaceTerm)
+{
+    wchar_t localeName[LOCALE_NAME_MAX_LENGTH];
+    if (GetUserDefaultLocaleName(localeName, LOCALE_NAME_MAX_LENGTH) == 0)
+    {
+        StringCchCopy(localeName, LOCALE_NAME_MAX_LENGTH, L"en_US");
+    }
+    m_names = &GetDateTimeNames(localeName);
+
+    const size_t length = m_replaceTerm.length();
+    size_t literalStart = 0;
+    size_t i = 0;
+    while (i < length)
+    {
+        if (m_replaceTerm[i] != L'$')
+        {
+            i++;
+            continue;
+        }
+
+        size_t dollarCount = 0;
+        while (i + dollarCount < length && m_replaceTerm[i + dollarCount] == L'$')
+        {
+            dollarCount++;
+        }
+        i += dollarCount;
+
+        // Doubled $ are escaped, a token follows an odd number of them
+        if (dollarCount % 2 == 0)
+        {
+            continue;
+        }
+
+        for (size_t tokenIndex = 0; tokenIndex < ARRAYSIZE(tokenNames); tokenIndex++)
+        {
+            const TokenName& tokenName = tokenNames[tokenIndex];
+            if (m_replaceTerm.compare(i, tokenName.length, tokenName.name) == 0)
+            {
+                // The literal ends before the $ of the token
+                if (i - 1 > literalStart)
+                {
+                    m_tokens.push_back({ Field::Literal, literalStart, i - 1 - literalStart });
+                }
+                m_tokens.push_back({ static_cast<Field>(static_cast<int>(Field::Year4) + tokenIndex), 0, 0 });
+                m_usesDateTime = true;
+
+                i += tokenName.length;
+                literalStart = i;
+                break;
+            }
+        }
+    }
+
+    if (length > literalStart)
+    {
+        m_tokens.push_back({ Field::Literal, literalStart, length - literalStart });
+    }
+}
+
+HRESULT CDateTimeTemplate::Expand(_Out_writes_(cchMax) PWSTR result, UINT cchMax, const SYSTEMTIME& time) const
+{
+    if (result == nullptr || cchMax == 0 || cchMax > STRSAFE_MAX_CCH)
+    {
+        return STRSAFE_E_INVALID_PARAMETER;
+    }
+
+    const bool isValidMonth = time.wMonth >= 1 && time.wMonth <= 12;
+
+    TruncatingWriter writer(result, cchMax);
+    for (const Token& token : m_tokens)
+    {
+        switch (token.field)
+        {
+        case Field::Literal:
+            writer.Append(m_replaceTerm.c_str() + token.offset, token.length);
+            break;
+        case Field::Year4:
+            writer.AppendNumber(time.wYear, 4);
+            break;
+        case Field::Year2:
+            writer.AppendNumber(time.wYear % 100, 2);
+            break;
+        case Field::Year1:
+            writer.AppendNumber(time.wYear % 10, 1);
+            break;
+        case Field::MonthName:
+            if (isValidMonth)
+            {
+                writer.Append(m_names->months[time.wMonth - 1]);
+            }
+            break;
+        case Field::MonthAbbreviation:
+            if (isValidMonth)
+            {
+                writer.Append(m_names->monthAbbreviations[time.wMonth - 1]);
+            }
+            break;
+        case Field::Month2:
+            writer.AppendNumber(time.wMonth, 2);
+            break;
+        case Field::Month1:
+            writer.AppendNumber(time.wMonth, 1);
+            break;
+        case Field::DayName:
+            if (isValidMonth)
+            {
+                writer.Append(m_names->days[GetDayOfWeek(time.wYear, time.wMonth, time.wDay)]);
+            }
+            break;
+        case Field::DayAbbreviation:
+            if (isValidMonth)
+            {
+                writer.Append(m_names->dayAbbreviations[GetDayOfWeek(time.wYear, time.wMonth, time.wDay)]);
+            }
+            break;
+        case Field::Day2:
+            writer.AppendNumber(time.wDay, 2);
+            break;
+        case Field::Day1:
+            writer.AppendNumber(time.wDay, 1);
+            break;
+        case Field::Hour2:
+            writer.AppendNumber(time.wHour, 2);
+            break;
+        case Field::Hour1:
+            writer.AppendNumber(time.wHour, 1);
+            break;
+        case Field::Minute2:
+            writer.AppendNumber(time.wMinute, 2);
+            break;
+        case Field::Minute1:
+            writer.AppendNumber(time.wMinute, 1);
+            break;
+        case Field::Second2:
+            writer.AppendNumber(time.wSecond, 2);
+            break;
+        case Field::Second1:
+            writer.AppendNumber(time.wSecond, 1);
+            break;
+        case Field::Millisecond3:
+            writer.AppendNumber(time.wMilliseconds, 3);
+            break;
+        case Field::Millisecond2:
+            writer.AppendNumber(time.wMilliseconds / 10, 2);
+            break;
+        case Field::Millisecond1:
+            writer.AppendNumber(time.wMilliseconds / 100, 1);
+            break;
+        }
+    }
+
+    return writer.Finish();
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "pch.h"
+#include <string>
+#include <vector>
+
+struct DateTimeNames;
+
+// Replace term with its date and time tokens ($YYYY, $MMMM, $DD, $hh, $fff...) parsed once, so that they can be
+// expanded with the date of every item in a single pass. A token is escaped with an even number of $ before it,
+// the $ are kept in the expanded term for the regular expression replace.
+class CDateTimeTemplate
+{
+public:
+    // Month and day names are taken from the user default locale
+    explicit CDateTimeTemplate(_In_ PCWSTR replaceTerm);
+
+    // True when the replace term contains at least one date or time token
+    bool UsesDateTime() const
+    {
+        return m_usesDateTime;
+    }
+
+    // Writes the replace term with its tokens replaced by the fields of the given time, without allocating.
+    // Like StringCchCopy, the result is truncated when it doesn't fit and STRSAFE_E_INSUFFICIENT_BUFFER is returned
+    HRESULT Expand(_Out_writes_(cchMax) PWSTR result, UINT cchMax, const SYSTEMTIME& time) const;
+
+private:
+    enum class Field : unsigned char
+    {
+        Literal,
+        Year4,
+        Year2,
+        Year1,
+        MonthName,
+        MonthAbbreviation,
+        Month2,
+        Month1,
+        DayName,
+        DayAbbreviation,
+        Day2,
+        Day1,
+        Hour2,
+        Hour1,
+        Minute2,
+        Minute1,
+        Second2,
+        Second1,
+        Millisecond3,
+        Millisecond2,
+        Millisecond1
+    };
+
+    struct Token
+    {
+        Field field;
+        // Range of the replace term written by a literal token
+        size_t offset;
+        size_t length;
+    };
+
+    std::wstring m_replaceTerm;
+    std::vector<Token> m_tokens;
+    const DateTimeNames* m_names = nullptr;
+    bool m_usesDateTime = false;
+};
@@ -105,6 +105,7 @@ public:
     IFACEMETHOD(GetItemById)(_In_ int id, _COM_Outptr_ IPowerRenameItem** ppItem) = 0;
     IFACEMETHOD(GetItemCount)(_Out_ UINT* count) = 0;
     IFACEMETHOD(GetVisibleItemCount)(_Out_ UINT* count) = 0;
+    IFACEMETHOD(GetVisibleItemsVersion)(_Out_ UINT* version) = 0;
     IFACEMETHOD(GetSelectedItemCount)(_Out_ UINT* count) = 0;
     IFACEMETHOD(GetRenameItemCount)(_Out_ UINT* count) = 0;
     IFACEMETHOD(GetFlags)(_Out_ DWORD* flags) = 0;
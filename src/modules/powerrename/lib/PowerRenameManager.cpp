@@ -2,9 +2,11 @@
 #include "PowerRenameManager.h"
 #include "PowerRenameRegEx.h" // Default RegEx handler
 #include <algorithm>
+#include <functional>
 #include <shlobj.h>
 #include <cstring>
 #include "helpers.h"
+#include "RenamePreview.h"
 #include "window_helpers.h"
 #include <filesystem>
 #include "trace.h"
@@ -119,10 +121,24 @@ IFACEMETHODIMP CPowerRenameManager::AddItem(_In_ IPowerRenameItem* pItem)
         int id = 0;
         pItem->GetId(&id);
         // Verify the item isn't already added
-        if (m_renameItems.find(id) == m_renameItems.end())
+        if (m_renameItemIndexes.find(id) == m_renameItemIndexes.end())
         {
-            m_renameItems[id] = pItem;
-            m_isVisible.push_back(true);
+            // Items are almost always added in the order they were created in, and appended
+            auto it = m_renameItems.end();
+            if (!m_renameItems.empty() && m_renameItems.back().id > id)
+            {
+                it = std::lower_bound(m_renameItems.begin(), m_renameItems.end(), id, [](const RENAME_ITEM& renameItem, int itemId) {
+                    return renameItem.id < itemId;
+                });
+            }
+
+            it = m_renameItems.insert(it, { id, pItem });
+            for (size_t i = it - m_renameItems.begin(); i < m_renameItems.size(); i++)
+            {
+                m_renameItemIndexes[m_renameItems[i].id] = static_cast<UINT>(i);
+            }
+
+            m_isVisibilityValid = false;
             pItem->AddRef();
             hr = S_OK;
         }
@@ -143,9 +159,7 @@ IFACEMETHODIMP CPowerRenameManager::GetItemByIndex(_In_ UINT index, _COM_Outptr_
     HRESULT hr = E_FAIL;
     if (index < m_renameItems.size())
     {
-        std::map<int, IPowerRenameItem*>::iterator it = m_renameItems.begin();
-        std::advance(it, index);
-        *ppItem = it->second;
+        *ppItem = m_renameItems[index].pItem;
         (*ppItem)->AddRef();
         hr = S_OK;
     }
@@ -156,31 +170,23 @@ IFACEMETHODIMP CPowerRenameManager::GetItemByIndex(_In_ UINT index, _COM_Outptr_
 IFACEMETHODIMP CPowerRenameManager::GetVisibleItemByIndex(_In_ UINT index, _COM_Outptr_ IPowerRenameItem** ppItem)
 {
     *ppItem = nullptr;
-    CSRWSharedAutoLock lock(&m_lockItems);
-    UINT count = 0;
     HRESULT hr = E_FAIL;
 
     if (m_filter == PowerRenameFilters::None)
     {
         hr = GetItemByIndex(index, ppItem);
     }
-    else if (SUCCEEDED(GetVisibleItemCount(&count)) && index < count)
+    else
     {
-        UINT realIndex = 0;
-        int visibleIndex = -1;
-        for (size_t i = 0; i < m_isVisible.size(); i++)
+        _EnsureVisibility();
+
+        CSRWSharedAutoLock lock(&m_lockItems);
+        if (index < m_visibleItemIndexes.size())
         {
-            if (m_isVisible[i])
-            {
-                visibleIndex++;
-            }
-            if (visibleIndex == index)
-            {
-                realIndex = static_cast<UINT>(i);
-                break;
-            }
+            *ppItem = m_renameItems[m_visibleItemIndexes[index]].pItem;
+            (*ppItem)->AddRef();
+            hr = S_OK;
         }
-        hr = GetItemByIndex(realIndex, ppItem);
     }
 
     return hr;
@@ -192,11 +198,10 @@ IFACEMETHODIMP CPowerRenameManager::GetItemById(_In_ int id, _COM_Outptr_ IPower
 
     CSRWSharedAutoLock lock(&m_lockItems);
     HRESULT hr = E_FAIL;
-    std::map<int, IPowerRenameItem*>::iterator it;
-    it = m_renameItems.find(id);
-    if (it !=  m_renameItems.end())
+    auto it = m_renameItemIndexes.find(id);
+    if (it != m_renameItemIndexes.end())
     {
-        *ppItem = m_renameItems[id];
+        *ppItem = m_renameItems[it->second].pItem;
         (*ppItem)->AddRef();
         hr = S_OK;
     }
@@ -213,26 +218,23 @@ IFACEMETHODIMP CPowerRenameManager::GetItemCount(_Out_ UINT* count)
 
 IFACEMETHODIMP CPowerRenameManager::SetVisible()
 {
-    CSRWSharedAutoLock lock(&m_lockItems);
+    bool showAll = _IsShowingAllItems();
+
+    CSRWExclusiveAutoLock lock(&m_lockItems);
     HRESULT hr = E_FAIL;
     UINT lastVisibleDepth = 0;
-    size_t i = m_isVisible.size() - 1;
-    PWSTR searchTerm = nullptr;
-    for (auto rit = m_renameItems.rbegin(); rit != m_renameItems.rend(); ++rit, --i)
+    m_visibleItemIndexes.clear();
+    for (size_t i = m_renameItems.size(); i-- > 0;)
     {
-        bool isVisible = false;
-        if (m_filter == PowerRenameFilters::ShouldRename && 
-            (FAILED(m_spRegEx->GetSearchTerm(&searchTerm)) || searchTerm && wcslen(searchTerm) == 0))
+        IPowerRenameItem* pItem = m_renameItems[i].pItem;
+        bool isVisible = showAll;
+        if (!showAll)
         {
-            isVisible = true;
-        }
-        else
-        {
-            rit->second->IsItemVisible(m_filter, m_flags, &isVisible);
+            pItem->IsItemVisible(m_filter, m_flags, &isVisible);
         }
 
         UINT itemDepth = 0;
-        rit->second->GetDepth(&itemDepth);
+        pItem->GetDepth(&itemDepth);
 
         //Make an item visible if it has a least one visible subitem
         if (isVisible)
@@ -244,30 +246,32 @@ IFACEMETHODIMP CPowerRenameManager::SetVisible()
             isVisible = true;
             lastVisibleDepth = itemDepth;
         }
-        
-        m_isVisible[i] = isVisible;
+
+        if (isVisible)
+        {
+            m_visibleItemIndexes.push_back(static_cast<UINT>(i));
+        }
         hr = S_OK;
     }
 
+    // The items were visited from the last one
+    std::reverse(m_visibleItemIndexes.begin(), m_visibleItemIndexes.end());
+    m_isVisibilityValid = true;
+    m_visibleItemsVersion++;
+
     return hr; 
 }
 
 IFACEMETHODIMP CPowerRenameManager::GetVisibleItemCount(_Out_ UINT* count)
 {
     *count = 0;
-    CSRWSharedAutoLock lock(&m_lockItems);
 
     if (m_filter != PowerRenameFilters::None)
     {
-        SetVisible();
+        _EnsureVisibility();
 
-        for (size_t i = 0; i < m_isVisible.size(); i++)
-        {
-            if (m_isVisible[i])
-            {
-                (*count)++;
-            }
-        }
+        CSRWSharedAutoLock lock(&m_lockItems);
+        *count = static_cast<UINT>(m_visibleItemIndexes.size());
     }
     else
     {
@@ -277,14 +281,21 @@ IFACEMETHODIMP CPowerRenameManager::GetVisibleItemCount(_Out_ UINT* count)
     return S_OK;
 }
 
+IFACEMETHODIMP CPowerRenameManager::GetVisibleItemsVersion(_Out_ UINT* version)
+{
+    CSRWSharedAutoLock lock(&m_lockItems);
+    *version = m_visibleItemsVersion;
+    return S_OK;
+}
+
 IFACEMETHODIMP CPowerRenameManager::GetSelectedItemCount(_Out_ UINT* count)
 {
     *count = 0;
     CSRWSharedAutoLock lock(&m_lockItems);
 
-    for (auto it : m_renameItems)
+    for (const auto& renameItem : m_renameItems)
     {
-        IPowerRenameItem* pItem = it.second;
+        IPowerRenameItem* pItem = renameItem.pItem;
         bool selected = false;
         if (SUCCEEDED(pItem->GetSelected(&selected)) && selected)
         {
@@ -300,9 +311,9 @@ IFACEMETHODIMP CPowerRenameManager::GetRenameItemCount(_Out_ UINT* count)
     *count = 0;
     CSRWSharedAutoLock lock(&m_lockItems);
 
-    for (auto it : m_renameItems)
+    for (const auto& renameItem : m_renameItems)
     {
-        IPowerRenameItem* pItem = it.second;
+        IPowerRenameItem* pItem = renameItem.pItem;
         bool shouldRename = false;
         if (SUCCEEDED(pItem->ShouldRenameItem(m_flags, &shouldRename)) && shouldRename)
         {
@@ -325,6 +336,7 @@ IFACEMETHODIMP CPowerRenameManager::PutFlags(_In_ DWORD flags)
     if (flags != m_flags)
     {
         m_flags = flags;
+        _InvalidateVisibility();
         _EnsureRegEx();
         m_spRegEx->PutFlags(flags);
     }
@@ -355,6 +367,7 @@ IFACEMETHODIMP CPowerRenameManager::SwitchFilter(_In_ int columnNumber)
         break;
     }
 
+    _InvalidateVisibility();
     return S_OK;
 }
 
@@ -398,6 +411,7 @@ IFACEMETHODIMP CPowerRenameManager::PutRenameItemFactory(_In_ IPowerRenameItemFa
 
 IFACEMETHODIMP CPowerRenameManager::OnSearchTermChanged(_In_ PCWSTR /*searchTerm*/)
 {
+    _InvalidateVisibility();
     _PerformRegExRename();
     return S_OK;
 }
@@ -412,6 +426,7 @@ IFACEMETHODIMP CPowerRenameManager::OnFlagsChanged(_In_ DWORD flags)
 {
     // Flags were updated in the rename regex.  Update our preview.
     m_flags = flags;
+    _InvalidateVisibility();
     _PerformRegExRename();
     return S_OK;
 }
@@ -459,8 +474,7 @@ HRESULT CPowerRenameManager::_Init()
 // Custom messages for worker threads
 enum
 {
-    SRM_REGEX_ITEM_UPDATED = (WM_APP + 1),  // Single rename item processed by regex worker thread
-    SRM_REGEX_STARTED,                      // RegEx operation was started
+    SRM_REGEX_STARTED = (WM_APP + 1),       // RegEx operation was started
     SRM_REGEX_CANCELED,                     // Regex operation was canceled
     SRM_REGEX_COMPLETE,                     // Regex worker thread completed
     SRM_FILEOP_COMPLETE                     // File Operation worker thread completed
@@ -473,6 +487,8 @@ struct WorkerThreadData
     HANDLE cancelEvent = nullptr;
     HWND hwndParent = nullptr;
     CComPtr<IPowerRenameManager> spsrm;
+    // Set for the regex worker thread, which queues the item updates in the manager
+    CPowerRenameManager* renameManager = nullptr;
 };
 
 // Msg-only worker window proc for communication from our worker threads
@@ -506,25 +522,33 @@ LRESULT CPowerRenameManager::_WndProc(_In_ HWND hwnd, _In_ UINT msg, _In_ WPARAM
 
     switch (msg)
     {
-    case SRM_REGEX_ITEM_UPDATED:
-    {
-        int id = static_cast<int>(lParam);
-        CComPtr<IPowerRenameItem> spItem;
-        if (SUCCEEDED(GetItemById(id, &spItem)))
+    case WM_TIMER:
+        if (wParam == s_itemUpdatesTimerId)
         {
-            _OnUpdate(spItem);
+            _FlushItemUpdates();
         }
         break;
-    }
+
     case SRM_REGEX_STARTED:
+        if (m_regExWorkerCount++ == 0)
+        {
+            SetTimer(hwnd, s_itemUpdatesTimerId, s_itemUpdatesInterval, nullptr);
+        }
         _OnRegExStarted(static_cast<DWORD>(wParam));
         break;
 
     case SRM_REGEX_CANCELED:
+        _FlushItemUpdates();
         _OnRegExCanceled(static_cast<DWORD>(wParam));
         break;
 
     case SRM_REGEX_COMPLETE:
+        // All the item updates are notified before the completion
+        _FlushItemUpdates();
+        if (m_regExWorkerCount > 0 && --m_regExWorkerCount == 0)
+        {
+            KillTimer(hwnd, s_itemUpdatesTimerId);
+        }
         _OnRegExCompleted(static_cast<DWORD>(wParam));
         break;
 
@@ -800,6 +824,7 @@ HRESULT CPowerRenameManager::_CreateRegExWorkerThread()
         pwtd->cancelEvent = m_cancelRegExWorkerEvent;
         pwtd->hwndParent = m_hwndParent;
         pwtd->spsrm = this;
+        pwtd->renameManager = this;
         m_regExWorkerThreadHandle = CreateThread(nullptr, 0, s_regexWorkerThread, pwtd, 0, nullptr);
         hr = (m_regExWorkerThreadHandle) ? S_OK : E_FAIL;
         if (FAILED(hr))
@@ -826,16 +851,33 @@ DWORD WINAPI CPowerRenameManager::s_regexWorkerThread(_In_ void* pv)
                 CComPtr<IPowerRenameRegEx> spRenameRegEx;
                 if (SUCCEEDED(pwtd->spsrm->GetRenameRegEx(&spRenameRegEx)))
                 {
-                    DWORD flags = 0;
-                    spRenameRegEx->GetFlags(&flags);
-
                     UINT itemCount = 0;
                     unsigned long itemEnumIndex = 1;
                     pwtd->spsrm->GetItemCount(&itemCount);
-                    for (UINT u = 0; u <= itemCount; u++)
+
+                    // The items are read and their new names computed on several threads one batch at a time,
+                    // then the items of the batch are updated in order so that the UI shows the progress
+                    std::vector<RenamePreviewItem> previewItems;
+                    std::vector<int> updatedItemIds;
+                    for (UINT batchStart = 0; batchStart < itemCount; batchStart += s_previewBatchSize)
                     {
-                        // Check if cancel event is signaled
-                        if (WaitForSingleObject(pwtd->cancelEvent, 0) == WAIT_OBJECT_0)
+                        const UINT batchEnd = min(itemCount, batchStart + s_previewBatchSize);
+                        previewItems.clear();
+                        previewItems.reserve(batchEnd - batchStart);
+                        for (UINT u = batchStart; u < batchEnd; u++)
+                        {
+                            CComPtr<IPowerRenameItem> spItem;
+                            if (SUCCEEDED(pwtd->spsrm->GetItemByIndex(u, &spItem)))
+                            {
+                                RenamePreviewItem previewItem;
+                                if (SUCCEEDED(GetRenamePreviewItem(spItem, &previewItem)))
+                                {
+                                    previewItems.push_back(std::move(previewItem));
+                                }
+                            }
+                        }
+
+                        if (ComputeRenamePreview(previewItems.data(), previewItems.size(), spRenameRegEx, 0, pwtd->cancelEvent, &itemEnumIndex) == E_ABORT)
                         {
                             // Canceled from manager
                             // Send the manager thread the canceled message
@@ -843,162 +885,24 @@ DWORD WINAPI CPowerRenameManager::s_regexWorkerThread(_In_ void* pv)
                             break;
                         }
 
-                        CComPtr<IPowerRenameItem> spItem;
-                        if (SUCCEEDED(pwtd->spsrm->GetItemByIndex(u, &spItem)))
+                        updatedItemIds.clear();
+                        for (const RenamePreviewItem& previewItem : previewItems)
                         {
-                            int id = -1;
-                            spItem->GetId(&id);
-
-                            bool isFolder = false;
-                            bool isSubFolderContent = false;
-                            spItem->GetIsFolder(&isFolder);
-                            spItem->GetIsSubFolderContent(&isSubFolderContent);
-                            if ((isFolder && (flags & PowerRenameFlags::ExcludeFolders)) ||
-                                (!isFolder && (flags & PowerRenameFlags::ExcludeFiles)) ||
-                                (isSubFolderContent && (flags & PowerRenameFlags::ExcludeSubfolders)))
-                            {
-                                // Exclude this item from renaming.  Ensure new name is cleared.
-                                spItem->PutNewName(nullptr);
+                            PCWSTR newNameToUse = previewItem.hasNewName ? previewItem.newName.c_str() : nullptr;
+                            PCWSTR currentNewName = previewItem.hasCurrentNewName ? previewItem.currentNewName.c_str() : nullptr;
 
-                                // Send the manager thread the item processed message
-                                PostMessage(pwtd->hwndManager, SRM_REGEX_ITEM_UPDATED, GetCurrentThreadId(), id);
+                            // Excluded items get their new name cleared
+                            previewItem.item->PutNewName(newNameToUse);
 
-                                continue;
-                            }
-
-                            PWSTR originalName = nullptr;
-                            if (SUCCEEDED(spItem->GetOriginalName(&originalName)))
+                            // Was there a change?
+                            if (previewItem.excluded || lstrcmp(currentNewName, newNameToUse) != 0)
                             {
-                                PWSTR currentNewName = nullptr;
-                                spItem->GetNewName(&currentNewName);
-
-                                wchar_t sourceName[MAX_PATH] = { 0 };
-                                if (flags & NameOnly)
-                                {
-                                    StringCchCopy(sourceName, ARRAYSIZE(sourceName), fs::path(originalName).stem().c_str());
-                                }
-                                else if (flags & ExtensionOnly)
-                                {
-                                    std::wstring extension = fs::path(originalName).extension().wstring();
-                                    if (!extension.empty() && extension.front() == '.')
-                                    {
-                                        extension = extension.erase(0, 1);
-                                    }
-                                    StringCchCopy(sourceName, ARRAYSIZE(sourceName), extension.c_str());
-                                }
-                                else
-                                {
-                                    StringCchCopy(sourceName, ARRAYSIZE(sourceName), originalName);
-                                }
-
-                                wchar_t newReplaceTerm[MAX_PATH] = { 0 };
-                                PWSTR replaceTerm = nullptr;
-                                SYSTEMTIME LocalTime;
-
-                                if (SUCCEEDED(spRenameRegEx->GetReplaceTerm(&replaceTerm)) && isFileAttributesUsed(replaceTerm))
-                                {
-                                    if (SUCCEEDED(spItem->GetDate(&LocalTime)))
-                                    {
-                                        if (SUCCEEDED(GetDatedFileName(newReplaceTerm, ARRAYSIZE(newReplaceTerm), replaceTerm, LocalTime)))
-                                        {
-                                            spRenameRegEx->PutReplaceTerm(newReplaceTerm);
-                                        }
-                                    }
-                                }
-
-                                PWSTR newName = nullptr;
-                                // Failure here means we didn't match anything or had nothing to match
-                                // Call put_newName with null in that case to reset it
-                                spRenameRegEx->Replace(sourceName, &newName);
-
-                                spRenameRegEx->PutReplaceTerm(replaceTerm);
-
-                                wchar_t resultName[MAX_PATH] = { 0 };
-
-                                PWSTR newNameToUse = nullptr;
-
-                                // newName == nullptr likely means we have an empty search string.  We should leave newNameToUse
-                                // as nullptr so we clear the renamed column
-                                // Except string transformation is selected.
-                                
-                                if (newName == nullptr && (flags & Uppercase || flags & Lowercase || flags & Titlecase))
-                                {
-                                    SHStrDup(sourceName, &newName);
-                                }
-
-                                if (newName != nullptr)
-                                {
-                                    newNameToUse = resultName;
-                                    if (flags & NameOnly)
-                                    {
-                                        StringCchPrintf(resultName, ARRAYSIZE(resultName), L"%s%s", newName, fs::path(originalName).extension().c_str());
-                                    }
-                                    else if (flags & ExtensionOnly)
-                                    {
-                                        std::wstring extension = fs::path(originalName).extension().wstring();
-                                        if (!extension.empty())
-                                        {
-                                            StringCchPrintf(resultName, ARRAYSIZE(resultName), L"%s.%s", fs::path(originalName).stem().c_str(), newName);
-                                        }
-                                        else
-                                        {
-                                            StringCchCopy(resultName, ARRAYSIZE(resultName), originalName);
-                                        }
-                                    }
-                                    else
-                                    {
-                                        StringCchCopy(resultName, ARRAYSIZE(resultName), newName);
-                                    }
-                                }
-                                
-                                wchar_t trimmedName[MAX_PATH] = { 0 };
-                                if (newNameToUse != nullptr && SUCCEEDED(GetTrimmedFileName(trimmedName, ARRAYSIZE(trimmedName), newNameToUse)))
-                                {
-                                    newNameToUse = trimmedName;
-                                }
-                                                                
-                                wchar_t transformedName[MAX_PATH] = { 0 };
-                                if (newNameToUse != nullptr && (flags & Uppercase || flags & Lowercase || flags & Titlecase))
-                                {
-                                    if (SUCCEEDED(GetTransformedFileName(transformedName, ARRAYSIZE(transformedName), newNameToUse, flags)))
-                                    {
-                                        newNameToUse = transformedName;
-                                    }
-                                }
-
-                                // No change from originalName so set newName to
-                                // null so we clear it from our UI as well.
-                                if (lstrcmp(originalName, newNameToUse) == 0)
-                                {
-                                    newNameToUse = nullptr;
-                                }
-
-                                wchar_t uniqueName[MAX_PATH] = { 0 };
-                                if (newNameToUse != nullptr && (flags & EnumerateItems))
-                                {
-                                    unsigned long countUsed = 0;
-                                    if (GetEnumeratedFileName(uniqueName, ARRAYSIZE(uniqueName), newNameToUse, nullptr, itemEnumIndex, &countUsed))
-                                    {
-                                        newNameToUse = uniqueName;
-                                    }
-                                    itemEnumIndex++;
-                                }
-
-                                spItem->PutNewName(newNameToUse);
-
-                                // Was there a change?
-                                if (lstrcmp(currentNewName, newNameToUse) != 0)
-                                {
-                                    // Send the manager thread the item processed message
-                                    PostMessage(pwtd->hwndManager, SRM_REGEX_ITEM_UPDATED, GetCurrentThreadId(), id);
-                                }
-
-                                CoTaskMemFree(newName);
-                                CoTaskMemFree(replaceTerm);
-                                CoTaskMemFree(currentNewName);
-                                CoTaskMemFree(originalName);
+                                updatedItemIds.push_back(previewItem.id);
                             }
                         }
+
+                        // The manager thread notifies the updated items on a timer rather than one message per item
+                        pwtd->renameManager->_QueueItemUpdates(updatedItemIds);
                     }
                 }
             }
@@ -1178,6 +1082,8 @@ void CPowerRenameManager::_OnRenameStarted()
 
 void CPowerRenameManager::_OnRenameCompleted()
 {
+    _InvalidateVisibility();
+
     CSRWSharedAutoLock lock(&m_lockEvents);
 
     for (auto it : m_powerRenameManagerEvents)
@@ -1212,17 +1118,177 @@ void CPowerRenameManager::_ClearPowerRenameItems()
     CSRWExclusiveAutoLock lock(&m_lockItems);
 
     // Cleanup rename items
-    for (std::map<int, IPowerRenameItem*>::iterator it = m_renameItems.begin(); it != m_renameItems.end(); ++it)
+    for (auto& renameItem : m_renameItems)
     {
-        IPowerRenameItem* pItem = it->second;
-        if (pItem)
+        if (renameItem.pItem)
         {
-            pItem->Release();
-            it->second = nullptr;
+            renameItem.pItem->Release();
+            renameItem.pItem = nullptr;
         }
     }
 
     m_renameItems.clear();
+    m_renameItemIndexes.clear();
+    m_visibleItemIndexes.clear();
+    m_isVisibilityValid = false;
+}
+
+void CPowerRenameManager::_QueueItemUpdates(_In_ const std::vector<int>& ids)
+{
+    CSRWExclusiveAutoLock lock(&m_lockItemUpdates);
+    m_updatedItemIds.insert(m_updatedItemIds.end(), ids.begin(), ids.end());
+}
+
+void CPowerRenameManager::_FlushItemUpdates()
+{
+    std::vector<int> updatedItemIds;
+    // Scope lock
+    {
+        CSRWExclusiveAutoLock lock(&m_lockItemUpdates);
+        updatedItemIds.swap(m_updatedItemIds);
+    }
+
+    if (updatedItemIds.empty())
+    {
+        return;
+    }
+
+    // The new names of the items changed, which changes whether they should be renamed
+    _UpdateVisibility(updatedItemIds);
+
+    for (int id : updatedItemIds)
+    {
+        CComPtr<IPowerRenameItem> spItem;
+        if (SUCCEEDED(GetItemById(id, &spItem)))
+        {
+            _OnUpdate(spItem);
+        }
+    }
+}
+
+void CPowerRenameManager::_InvalidateVisibility()
+{
+    CSRWExclusiveAutoLock lock(&m_lockItems);
+    m_isVisibilityValid = false;
+}
+
+bool CPowerRenameManager::_IsShowingAllItems()
+{
+    bool showAll = false;
+    if (m_filter == PowerRenameFilters::ShouldRename)
+    {
+        PWSTR searchTerm = nullptr;
+        showAll = FAILED(m_spRegEx->GetSearchTerm(&searchTerm)) || (searchTerm && wcslen(searchTerm) == 0);
+        CoTaskMemFree(searchTerm);
+    }
+
+    return showAll;
+}
+
+void CPowerRenameManager::_UpdateVisibility(_In_ const std::vector<int>& ids)
+{
+    if (m_filter == PowerRenameFilters::None)
+    {
+        _InvalidateVisibility();
+        return;
+    }
+
+    bool showAll = _IsShowingAllItems();
+
+    CSRWExclusiveAutoLock lock(&m_lockItems);
+    // Otherwise all the items are computed the next time they are needed
+    if (!m_isVisibilityValid)
+    {
+        return;
+    }
+
+    // The items are updated from the last one, so that the subitems of a folder are up to date when the folder is updated
+    std::vector<UINT> indexes;
+    indexes.reserve(ids.size());
+    for (int id : ids)
+    {
+        auto it = m_renameItemIndexes.find(id);
+        if (it != m_renameItemIndexes.end())
+        {
+            indexes.push_back(it->second);
+        }
+    }
+    std::sort(indexes.begin(), indexes.end(), std::greater<UINT>());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+
+    for (UINT index : indexes)
+    {
+        // Same rules as SetVisible: an item is visible if it is visible itself or if the next visible item is one of its subitems
+        for (;;)
+        {
+            IPowerRenameItem* pItem = m_renameItems[index].pItem;
+            bool isVisible = showAll;
+            if (!showAll)
+            {
+                pItem->IsItemVisible(m_filter, m_flags, &isVisible);
+            }
+
+            UINT itemDepth = 0;
+            pItem->GetDepth(&itemDepth);
+
+            auto next = std::upper_bound(m_visibleItemIndexes.begin(), m_visibleItemIndexes.end(), index);
+            if (!isVisible && next != m_visibleItemIndexes.end())
+            {
+                UINT nextDepth = 0;
+                m_renameItems[*next].pItem->GetDepth(&nextDepth);
+                isVisible = nextDepth == itemDepth + 1;
+            }
+
+            auto it = std::lower_bound(m_visibleItemIndexes.begin(), next, index);
+            bool wasVisible = it != next;
+            if (isVisible == wasVisible)
+            {
+                break;
+            }
+
+            if (isVisible)
+            {
+                m_visibleItemIndexes.insert(it, index);
+            }
+            else
+            {
+                m_visibleItemIndexes.erase(it);
+            }
+            m_visibleItemsVersion++;
+
+            // The visibility of the parent folder depends on the visibility of the item
+            if (itemDepth == 0)
+            {
+                break;
+            }
+
+            UINT parentDepth = itemDepth;
+            while (index > 0 && parentDepth >= itemDepth)
+            {
+                m_renameItems[--index].pItem->GetDepth(&parentDepth);
+            }
+
+            if (parentDepth >= itemDepth)
+            {
+                break;
+            }
+        }
+    }
+}
+
+void CPowerRenameManager::_EnsureVisibility()
+{
+    bool isVisibilityValid = false;
+    // Scope lock
+    {
+        CSRWSharedAutoLock lock(&m_lockItems);
+        isVisibilityValid = m_isVisibilityValid;
+    }
+
+    if (!isVisibilityValid)
+    {
+        SetVisible();
+    }
 }
 
 void CPowerRenameManager::_Cleanup()
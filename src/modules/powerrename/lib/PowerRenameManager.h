@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include "srwlock.h"
 
 #include <lib/PowerRenameManager.h>
@@ -31,6 +32,7 @@ public:
     IFACEMETHODIMP GetItemCount(_Out_ UINT* count);
     IFACEMETHODIMP SetVisible();
     IFACEMETHODIMP GetVisibleItemCount(_Out_ UINT* count);
+    IFACEMETHODIMP GetVisibleItemsVersion(_Out_ UINT* version);
     IFACEMETHODIMP GetSelectedItemCount(_Out_ UINT* count);
     IFACEMETHODIMP GetRenameItemCount(_Out_ UINT* count);
     IFACEMETHODIMP GetFlags(_Out_ DWORD* flags);
@@ -82,8 +84,28 @@ protected:
     HRESULT _InitRegEx();
     void _ClearRegEx();
 
+    // Marks the visible items to be computed again the next time they are needed
+    void _InvalidateVisibility();
+    // Computes the visible items if they were invalidated
+    void _EnsureVisibility();
+    // Updates the visibility of the given items and of their parent folders, if the visible items are up to date
+    void _UpdateVisibility(_In_ const std::vector<int>& ids);
+    // Whether all the items are visible regardless of their state, which is the case with the ShouldRename filter until there is a search term
+    bool _IsShowingAllItems();
+
     // Thread proc for performing the regex rename of each item
     static DWORD WINAPI s_regexWorkerThread(_In_ void* pv);
+    // Number of items whose new names are computed together by the regex rename worker before they are updated
+    static constexpr UINT s_previewBatchSize = 2048;
+    // The items updated by the regex rename worker are notified on a timer, about once per frame
+    static constexpr UINT_PTR s_itemUpdatesTimerId = 1;
+    static constexpr UINT s_itemUpdatesInterval = 16;
+
+    // Queues the ids of items updated by the regex rename worker
+    void _QueueItemUpdates(_In_ const std::vector<int>& ids);
+    // Notifies the updates of the queued items
+    void _FlushItemUpdates();
+
     // Thread proc for performing the actual file operation that does the file rename
     static DWORD WINAPI s_fileOpWorkerThread(_In_ void* pv);
 
@@ -101,6 +123,7 @@ protected:
 
     CSRWLock m_lockEvents;
     CSRWLock m_lockItems;
+    CSRWLock m_lockItemUpdates;
 
     DWORD m_flags = 0;
 
@@ -115,12 +138,30 @@ protected:
         DWORD cookie;
     };
 
+    struct RENAME_ITEM
+    {
+        int id;
+        IPowerRenameItem* pItem;
+    };
+
     CComPtr<IPowerRenameItemFactory> m_spItemFactory;
     CComPtr<IPowerRenameRegEx> m_spRegEx;
 
     _Guarded_by_(m_lockEvents) std::vector<RENAME_MGR_EVENT> m_powerRenameManagerEvents;
-    _Guarded_by_(m_lockItems) std::map<int, IPowerRenameItem*> m_renameItems;
-    _Guarded_by_(m_lockItems) std::vector<bool> m_isVisible;
+    // Items in id order, which is the order they were created in
+    _Guarded_by_(m_lockItems) std::vector<RENAME_ITEM> m_renameItems;
+    // Index of each item in m_renameItems by id
+    _Guarded_by_(m_lockItems) std::unordered_map<int, UINT> m_renameItemIndexes;
+    // Indexes in m_renameItems of the items visible with the current filter, up to date when m_isVisibilityValid
+    _Guarded_by_(m_lockItems) std::vector<UINT> m_visibleItemIndexes;
+    _Guarded_by_(m_lockItems) bool m_isVisibilityValid = false;
+    // Incremented whenever items are added to or removed from m_visibleItemIndexes, which moves the visible items after them
+    _Guarded_by_(m_lockItems) UINT m_visibleItemsVersion = 0;
+
+    // Ids of the items updated by the regex rename worker and not notified yet
+    _Guarded_by_(m_lockItemUpdates) std::vector<int> m_updatedItemIds;
+    // Regex rename workers started and not completed, the item updates timer runs while there is one
+    UINT m_regExWorkerCount = 0;
 
     // Parent HWND used by IFileOperation
     HWND m_hwndParent = nullptr;
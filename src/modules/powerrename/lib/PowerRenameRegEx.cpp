@@ -95,6 +95,10 @@ IFACEMETHODIMP CPowerRenameRegEx::PutSearchTerm(_In_ PCWSTR searchTerm)
             changed = true;
             CoTaskMemFree(m_searchTerm);
             hr = SHStrDup(searchTerm, &m_searchTerm);
+            if (SUCCEEDED(hr))
+            {
+                _Compile();
+            }
         }
     }
 
@@ -130,6 +134,10 @@ IFACEMETHODIMP CPowerRenameRegEx::PutReplaceTerm(_In_ PCWSTR replaceTerm)
             changed = true;
             CoTaskMemFree(m_replaceTerm);
             hr = SHStrDup(replaceTerm, &m_replaceTerm);
+            if (SUCCEEDED(hr))
+            {
+                _Compile();
+            }
         }
     }
 
@@ -149,9 +157,19 @@ IFACEMETHODIMP CPowerRenameRegEx::GetFlags(_Out_ DWORD* flags)
 
 IFACEMETHODIMP CPowerRenameRegEx::PutFlags(_In_ DWORD flags)
 {
-    if (m_flags != flags)
+    bool changed = false;
+    {
+        CSRWExclusiveAutoLock lock(&m_lock);
+        if (m_flags != flags)
+        {
+            changed = true;
+            m_flags = flags;
+            _Compile();
+        }
+    }
+
+    if (changed)
     {
-        m_flags = flags;
         _OnFlagsChanged();
     }
     return S_OK;
@@ -177,6 +195,7 @@ CPowerRenameRegEx::CPowerRenameRegEx() :
     // Init to empty strings
     SHStrDup(L"", &m_searchTerm);
     SHStrDup(L"", &m_replaceTerm);
+    _Compile();
 }
 
 CPowerRenameRegEx::~CPowerRenameRegEx()
@@ -189,54 +208,63 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result)
 {
     *result = nullptr;
 
-    CSRWSharedAutoLock lock(&m_lock);
-    HRESULT hr = (source && wcslen(source) > 0 && m_searchTerm && wcslen(m_searchTerm) > 0) ? S_OK : E_INVALIDARG;
+    // The compiled terms aren't modified, the lock is only needed to take a reference to them
+    std::shared_ptr<const CompiledTerms> compiled;
+    {
+        CSRWSharedAutoLock lock(&m_lock);
+        compiled = m_compiled;
+    }
+
+    HRESULT hr = (source && wcslen(source) > 0 && compiled && !compiled->searchTerm.empty()) ? S_OK : E_INVALIDARG;
     if (SUCCEEDED(hr))
     {
         wstring res = source;
         try
         {
-            // TODO: creating the regex could be costly.  May want to cache this.
-            std::wstring sourceToUse(source);
-            std::wstring searchTerm(m_searchTerm);
-            std::wstring replaceTerm(m_replaceTerm ? wstring(m_replaceTerm) : wstring(L""));
-
-            replaceTerm = regex_replace(replaceTerm, std::wregex(L"(([^\\$]|^)(\\$\\$)*)\\$[0]"), L"$1$$$0");
-            replaceTerm = regex_replace(replaceTerm, std::wregex(L"(([^\\$]|^)(\\$\\$)*)\\$([1-9])"), L"$1$0$4");
+            const std::wstring& searchTerm = compiled->searchTerm;
+            const std::wstring& replaceTerm = compiled->replaceTerm;
 
-            if (m_flags & UseRegularExpressions)
+            if (compiled->flags & UseRegularExpressions)
             {
-                std::wregex pattern(m_searchTerm, (!(m_flags & CaseSensitive)) ? regex_constants::icase | regex_constants::ECMAScript : regex_constants::ECMAScript);
-                if (m_flags & MatchAllOccurences)
+                // There is no pattern when the search term isn't a valid regular expression
+                hr = compiled->pattern ? S_OK : E_FAIL;
+                if (SUCCEEDED(hr))
                 {
-                    res = regex_replace(wstring(source), pattern, replaceTerm);
-                }
-                else
-                {
-                    res = regex_replace(wstring(source), pattern, replaceTerm, regex_constants::format_first_only);
+                    if (compiled->flags & MatchAllOccurences)
+                    {
+                        res = regex_replace(res, *compiled->pattern, replaceTerm);
+                    }
+                    else
+                    {
+                        res = regex_replace(res, *compiled->pattern, replaceTerm, regex_constants::format_first_only);
+                    }
                 }
             }
             else
             {
                 // Simple search and replace
+                std::wstring sourceToUse(source);
                 size_t pos = 0;
                 do
                 {
-                    pos = _Find(sourceToUse, searchTerm, (!(m_flags & CaseSensitive)), pos);
+                    pos = _Find(sourceToUse, searchTerm, (!(compiled->flags & CaseSensitive)), pos);
                     if (pos != std::string::npos)
                     {
                         res = sourceToUse.replace(pos, searchTerm.length(), replaceTerm);
                         pos += replaceTerm.length();
                     }
 
-                    if (!(m_flags & MatchAllOccurences))
+                    if (!(compiled->flags & MatchAllOccurences))
                     {
                         break;
                     }
                 } while (pos != std::string::npos);
             }
 
-            hr = SHStrDup(res.c_str(), result);
+            if (SUCCEEDED(hr))
+            {
+                hr = SHStrDup(res.c_str(), result);
+            }
         }
         catch (regex_error e)
         {
@@ -246,6 +274,38 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result)
     return hr;
 }
 
+void CPowerRenameRegEx::_Compile()
+{
+    auto compiled = std::make_shared<CompiledTerms>();
+    compiled->flags = m_flags;
+    compiled->searchTerm = m_searchTerm ? m_searchTerm : L"";
+    compiled->replaceTerm = m_replaceTerm ? m_replaceTerm : L"";
+
+    try
+    {
+        static const std::wregex zeroReference(L"(([^\\$]|^)(\\$\\$)*)\\$[0]");
+        static const std::wregex groupReference(L"(([^\\$]|^)(\\$\\$)*)\\$([1-9])");
+        compiled->replaceTerm = regex_replace(compiled->replaceTerm, zeroReference, L"$1$$$0");
+        compiled->replaceTerm = regex_replace(compiled->replaceTerm, groupReference, L"$1$0$4");
+
+        if (m_compiled && m_compiled->flags == m_flags && m_compiled->searchTerm == compiled->searchTerm)
+        {
+            // Only the replace term changed, as for each item when it contains date and time tokens
+            compiled->pattern = m_compiled->pattern;
+        }
+        else if ((m_flags & UseRegularExpressions) && !compiled->searchTerm.empty())
+        {
+            compiled->pattern = std::make_shared<const std::wregex>(compiled->searchTerm, (!(m_flags & CaseSensitive)) ? regex_constants::icase | regex_constants::ECMAScript : regex_constants::ECMAScript);
+        }
+    }
+    catch (regex_error e)
+    {
+        // Replace fails until the search term is changed to a valid regular expression
+    }
+
+    m_compiled = std::move(compiled);
+}
+
 size_t CPowerRenameRegEx::_Find(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos)
 {
     if (caseInsensitive)
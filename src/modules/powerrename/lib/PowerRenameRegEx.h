@@ -1,5 +1,7 @@
 #pragma once
 #include "pch.h"
+#include <memory>
+#include <regex>
 #include <vector>
 #include <string>
 #include "srwlock.h"
@@ -37,11 +39,28 @@ protected:
     void _OnReplaceTermChanged();
     void _OnFlagsChanged();
 
+    // Search and replace terms prepared for the flags they are used with. A new instance is built whenever the
+    // terms or the flags change, it is never modified afterwards and is shared read-only by the threads calling Replace.
+    struct CompiledTerms
+    {
+        DWORD flags;
+        std::wstring searchTerm;
+        // Replace term with the $0 and $N references rewritten to the std::regex_replace format
+        std::wstring replaceTerm;
+        // Null when the regular expressions are not used or the search term isn't a valid one. Shared with the
+        // next compiled terms when only the replace term changes
+        std::shared_ptr<const std::wregex> pattern;
+    };
+
+    // Builds the compiled terms from the current ones, must be called with m_lock held exclusively
+    void _Compile();
+
     size_t _Find(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos);
 
     DWORD m_flags = DEFAULT_FLAGS;
     PWSTR m_searchTerm = nullptr;
     PWSTR m_replaceTerm = nullptr;
+    _Guarded_by_(m_lock) std::shared_ptr<const CompiledTerms> m_compiled;
 
     CSRWLock m_lock;
     CSRWLock m_lockEvents;
@@ -0,0 +1,363 @@
+#include "pch.h"
+#include "RenamePreview.h"
+#include "PowerRenameRegEx.h"
+#include "DateTimeTemplate.h"
+#include "Helpers.h"
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Items are taken by the threads in chunks, the cancel event is checked before each chunk
+    constexpr size_t ChunkSize = 64;
+
+    // Search term, replace term and flags read once from the rename regex, shared by the threads
+    struct PreviewTerms
+    {
+        IPowerRenameRegEx* renameRegEx = nullptr;
+        DWORD flags = 0;
+        std::wstring searchTerm;
+        std::wstring replaceTerm;
+        std::optional<CDateTimeTemplate> dateTimeTemplate;
+    };
+
+    // Computes the new names of items on one thread. The rename regex is shared by the threads unless the replace
+    // term has date and time tokens: the replace term changes with every item then, so each thread has its own.
+    class PreviewWorker
+    {
+    public:
+        explicit PreviewWorker(const PreviewTerms& terms) :
+            m_terms(terms), m_renameRegEx(terms.renameRegEx)
+        {
+            if (m_terms.dateTimeTemplate)
+            {
+                CComPtr<IPowerRenameRegEx> renameRegEx;
+                if (SUCCEEDED(CPowerRenameRegEx::s_CreateInstance(&renameRegEx)) &&
+                    SUCCEEDED(renameRegEx->PutFlags(m_terms.flags)) &&
+                    SUCCEEDED(renameRegEx->PutSearchTerm(m_terms.searchTerm.c_str())))
+                {
+                    m_datedRenameRegEx = renameRegEx;
+                    m_renameRegEx = m_datedRenameRegEx;
+                }
+            }
+        }
+
+        void Compute(RenamePreviewItem& previewItem);
+
+    private:
+        PWSTR Replace(RenamePreviewItem& previewItem, _In_ PCWSTR sourceName);
+
+        const PreviewTerms& m_terms;
+        IPowerRenameRegEx* m_renameRegEx;
+        CComPtr<IPowerRenameRegEx> m_datedRenameRegEx;
+    };
+
+    PWSTR PreviewWorker::Replace(RenamePreviewItem& previewItem, _In_ PCWSTR sourceName)
+    {
+        if (m_datedRenameRegEx)
+        {
+            wchar_t newReplaceTerm[MAX_PATH] = { 0 };
+            SYSTEMTIME LocalTime;
+            if (previewItem.item && SUCCEEDED(previewItem.item->GetDate(&LocalTime)) &&
+                SUCCEEDED(m_terms.dateTimeTemplate->Expand(newReplaceTerm, ARRAYSIZE(newReplaceTerm), LocalTime)))
+            {
+                m_datedRenameRegEx->PutReplaceTerm(newReplaceTerm);
+            }
+            else
+            {
+                m_datedRenameRegEx->PutReplaceTerm(m_terms.replaceTerm.c_str());
+            }
+        }
+
+        PWSTR newName = nullptr;
+        // Failure here means we didn't match anything or had nothing to match
+        // Leave the new name null in that case to reset it
+        m_renameRegEx->Replace(sourceName, &newName);
+        return newName;
+    }
+
+    void PreviewWorker::Compute(RenamePreviewItem& previewItem)
+    {
+        const DWORD flags = m_terms.flags;
+        previewItem.hasNewName = false;
+        previewItem.newName.clear();
+
+        previewItem.excluded = (previewItem.isFolder && (flags & PowerRenameFlags::ExcludeFolders)) ||
+                               (!previewItem.isFolder && (flags & PowerRenameFlags::ExcludeFiles)) ||
+                               (previewItem.isSubFolderContent && (flags & PowerRenameFlags::ExcludeSubfolders));
+        if (previewItem.excluded)
+        {
+            return;
+        }
+
+        PCWSTR originalName = previewItem.originalName.c_str();
+
+        wchar_t sourceName[MAX_PATH] = { 0 };
+        if (flags & NameOnly)
+        {
+            StringCchCopy(sourceName, ARRAYSIZE(sourceName), fs::path(originalName).stem().c_str());
+        }
+        else if (flags & ExtensionOnly)
+        {
+            std::wstring extension = fs::path(originalName).extension().wstring();
+            if (!extension.empty() && extension.front() == '.')
+            {
+                extension = extension.erase(0, 1);
+            }
+            StringCchCopy(sourceName, ARRAYSIZE(sourceName), extension.c_str());
+        }
+        else
+        {
+            StringCchCopy(sourceName, ARRAYSIZE(sourceName), originalName);
+        }
+
+        PWSTR newName = Replace(previewItem, sourceName);
+
+        wchar_t resultName[MAX_PATH] = { 0 };
+
+        PWSTR newNameToUse = nullptr;
+
+        // newName == nullptr likely means we have an empty search string.  We should leave newNameToUse
+        // as nullptr so we clear the renamed column
+        // Except string transformation is selected.
+        if (newName == nullptr && (flags & Uppercase || flags & Lowercase || flags & Titlecase))
+        {
+            SHStrDup(sourceName, &newName);
+        }
+
+        if (newName != nullptr)
+        {
+            newNameToUse = resultName;
+            if (flags & NameOnly)
+            {
+                StringCchPrintf(resultName, ARRAYSIZE(resultName), L"%s%s", newName, fs::path(originalName).extension().c_str());
+            }
+            else if (flags & ExtensionOnly)
+            {
+                std::wstring extension = fs::path(originalName).extension().wstring();
+                if (!extension.empty())
+                {
+                    StringCchPrintf(resultName, ARRAYSIZE(resultName), L"%s.%s", fs::path(originalName).stem().c_str(), newName);
+                }
+                else
+                {
+                    StringCchCopy(resultName, ARRAYSIZE(resultName), originalName);
+                }
+            }
+            else
+            {
+                StringCchCopy(resultName, ARRAYSIZE(resultName), newName);
+            }
+        }
+
+        wchar_t trimmedName[MAX_PATH] = { 0 };
+        if (newNameToUse != nullptr && SUCCEEDED(GetTrimmedFileName(trimmedName, ARRAYSIZE(trimmedName), newNameToUse)))
+        {
+            newNameToUse = trimmedName;
+        }
+
+        wchar_t transformedName[MAX_PATH] = { 0 };
+        if (newNameToUse != nullptr && (flags & Uppercase || flags & Lowercase || flags & Titlecase))
+        {
+            if (SUCCEEDED(GetTransformedFileName(transformedName, ARRAYSIZE(transformedName), newNameToUse, flags)))
+            {
+                newNameToUse = transformedName;
+            }
+        }
+
+        // No change from originalName so leave the new name
+        // null so we clear it from our UI as well.
+        if (newNameToUse != nullptr && lstrcmp(originalName, newNameToUse) != 0)
+        {
+            previewItem.hasNewName = true;
+            previewItem.newName = newNameToUse;
+        }
+
+        CoTaskMemFree(newName);
+    }
+
+    // Runs a worker created by createWorker on the calling thread and on up to threadCount - 1 threads of the process
+    // thread pool. The workers take chunks of [0, count) until all the chunks are taken or the cancel event is signaled.
+    template<typename CreateWorker>
+    HRESULT RunInChunks(size_t count, UINT threadCount, _In_opt_ HANDLE cancelEvent, CreateWorker& createWorker)
+    {
+        struct ChunkedLoop
+        {
+            size_t count;
+            HANDLE cancelEvent;
+            CreateWorker& createWorker;
+            std::atomic<size_t> nextChunk = 0;
+            std::atomic<bool> canceled = false;
+
+            static VOID CALLBACK s_Run(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK)
+            {
+                static_cast<ChunkedLoop*>(context)->Run();
+            }
+
+            void Run()
+            {
+                auto worker = createWorker();
+                for (;;)
+                {
+                    const size_t begin = nextChunk.fetch_add(ChunkSize);
+                    if (begin >= count || canceled)
+                    {
+                        break;
+                    }
+
+                    if (cancelEvent && WaitForSingleObject(cancelEvent, 0) == WAIT_OBJECT_0)
+                    {
+                        canceled = true;
+                        break;
+                    }
+
+                    worker(begin, min(count, begin + ChunkSize));
+                }
+            }
+        };
+
+        ChunkedLoop loop{ count, cancelEvent, createWorker };
+
+        // The calling thread takes chunks too, no more threads are needed than there are chunks
+        const size_t chunkCount = (count + ChunkSize - 1) / ChunkSize;
+        const UINT helperCount = static_cast<UINT>(min(static_cast<size_t>(threadCount - 1), chunkCount > 0 ? chunkCount - 1 : 0));
+
+        PTP_WORK work = nullptr;
+        if (helperCount > 0)
+        {
+            work = CreateThreadpoolWork(ChunkedLoop::s_Run, &loop, nullptr);
+        }
+
+        if (work)
+        {
+            for (UINT i = 0; i < helperCount; i++)
+            {
+                SubmitThreadpoolWork(work);
+            }
+        }
+
+        loop.Run();
+
+        if (work)
+        {
+            WaitForThreadpoolWorkCallbacks(work, FALSE);
+            CloseThreadpoolWork(work);
+        }
+
+        return loop.canceled ? E_ABORT : S_OK;
+    }
+}
+
+HRESULT GetRenamePreviewItem(_In_ IPowerRenameItem* renameItem, _Out_ RenamePreviewItem* previewItem)
+{
+    *previewItem = RenamePreviewItem();
+    previewItem->item = renameItem;
+    renameItem->GetId(&previewItem->id);
+    renameItem->GetIsFolder(&previewItem->isFolder);
+    renameItem->GetIsSubFolderContent(&previewItem->isSubFolderContent);
+
+    PWSTR originalName = nullptr;
+    HRESULT hr = renameItem->GetOriginalName(&originalName);
+    if (SUCCEEDED(hr))
+    {
+        previewItem->originalName = originalName;
+        CoTaskMemFree(originalName);
+
+        PWSTR currentNewName = nullptr;
+        if (SUCCEEDED(renameItem->GetNewName(&currentNewName)))
+        {
+            previewItem->hasCurrentNewName = true;
+            previewItem->currentNewName = currentNewName;
+            CoTaskMemFree(currentNewName);
+        }
+    }
+
+    return hr;
+}
+
+HRESULT ComputeRenamePreview(
+    _Inout_updates_(count) RenamePreviewItem* items,
+    size_t count,
+    _In_ IPowerRenameRegEx* renameRegEx,
+    UINT threadCount,
+    _In_opt_ HANDLE cancelEvent,
+    _Inout_ unsigned long* enumIndex)
+{
+    if (threadCount == 0)
+    {
+        threadCount = max(1u, std::thread::hardware_concurrency());
+    }
+
+    PreviewTerms terms;
+    terms.renameRegEx = renameRegEx;
+    renameRegEx->GetFlags(&terms.flags);
+
+    PWSTR searchTerm = nullptr;
+    if (SUCCEEDED(renameRegEx->GetSearchTerm(&searchTerm)))
+    {
+        terms.searchTerm = searchTerm;
+        CoTaskMemFree(searchTerm);
+    }
+
+    // The date and time tokens of the replace term are parsed once and expanded with the date of each item
+    PWSTR replaceTerm = nullptr;
+    if (SUCCEEDED(renameRegEx->GetReplaceTerm(&replaceTerm)))
+    {
+        terms.replaceTerm = replaceTerm;
+        CoTaskMemFree(replaceTerm);
+
+        terms.dateTimeTemplate.emplace(terms.replaceTerm.c_str());
+        if (!terms.dateTimeTemplate->UsesDateTime())
+        {
+            terms.dateTimeTemplate.reset();
+        }
+    }
+
+    auto createNameWorker = [&] {
+        return [&, worker = PreviewWorker(terms)](size_t begin, size_t end) mutable {
+            for (size_t i = begin; i < end; i++)
+            {
+                worker.Compute(items[i]);
+            }
+        };
+    };
+    HRESULT hr = RunInChunks(count, threadCount, cancelEvent, createNameWorker);
+
+    if (SUCCEEDED(hr) && (terms.flags & EnumerateItems))
+    {
+        // The renamed items are numbered in order, each one gets the number of renamed items before it
+        std::vector<unsigned long> itemEnumIndexes(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            itemEnumIndexes[i] = *enumIndex;
+            if (items[i].hasNewName)
+            {
+                (*enumIndex)++;
+            }
+        }
+
+        auto createEnumWorker = [&] {
+            return [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    RenamePreviewItem& previewItem = items[i];
+                    wchar_t uniqueName[MAX_PATH] = { 0 };
+                    unsigned long countUsed = 0;
+                    if (previewItem.hasNewName &&
+                        GetEnumeratedFileName(uniqueName, ARRAYSIZE(uniqueName), previewItem.newName.c_str(), nullptr, itemEnumIndexes[i], &countUsed))
+                    {
+                        previewItem.newName = uniqueName;
+                    }
+                }
+            };
+        };
+        hr = RunInChunks(count, threadCount, cancelEvent, createEnumWorker);
+    }
+
+    return hr;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "pch.h"
+#include <string>
+
+#include "PowerRenameInterfaces.h"
+
+// Item of the rename preview. The item is read once, then its new name is computed from the copy without calling
+// the item, so that the new names of many items can be computed on several threads.
+struct RenamePreviewItem
+{
+    // Read from the item before the new names are computed. The item is only called for its date, when the
+    // replace term has date and time tokens.
+    CComPtr<IPowerRenameItem> item;
+    int id = -1;
+    std::wstring originalName;
+    bool isFolder = false;
+    bool isSubFolderContent = false;
+    bool hasCurrentNewName = false;
+    std::wstring currentNewName;
+
+    // Set when the new names are computed. Excluded items and items which keep their name have no new name
+    bool excluded = false;
+    bool hasNewName = false;
+    std::wstring newName;
+};
+
+// Copies the item data used to compute its new name
+HRESULT GetRenamePreviewItem(_In_ IPowerRenameItem* renameItem, _Out_ RenamePreviewItem* previewItem);
+
+// Computes the new names of the items with the search term, replace term and flags of the regex, on the calling
+// thread and up to threadCount - 1 threads of the process thread pool, or one thread per processor when threadCount is 0.
+// When items are enumerated, their numbers are assigned in order starting from *enumIndex, which is then advanced
+// past the numbers used. Returns E_ABORT when the cancel event is signaled before all the names are computed.
+HRESULT ComputeRenamePreview(
+    _Inout_updates_(count) RenamePreviewItem* items,
+    size_t count,
+    _In_ IPowerRenameRegEx* renameRegEx,
+    UINT threadCount,
+    _In_opt_ HANDLE cancelEvent,
+    _Inout_ unsigned long* enumIndex);
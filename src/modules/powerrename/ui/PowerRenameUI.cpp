@@ -13,6 +13,12 @@ extern "C" IMAGE_DOS_HEADER __ImageBase;
 
 extern HINSTANCE g_hInst;
 
+// Custom messages for the dialog
+enum
+{
+    SRUI_REFRESH_ITEMS = (WM_APP + 1) // Updated items are refreshed in the list view
+};
+
 enum
 {
     MATCHMODE_FULLNAME = 0,
@@ -169,16 +175,17 @@ IFACEMETHODIMP CPowerRenameUI::OnItemAdded(_In_ IPowerRenameItem*)
     return S_OK;
 }
 
-IFACEMETHODIMP CPowerRenameUI::OnUpdate(_In_ IPowerRenameItem*)
+IFACEMETHODIMP CPowerRenameUI::OnUpdate(_In_ IPowerRenameItem* renameItem)
 {
-    UINT visibleItemCount = 0;
-    if (m_spsrm)
+    // The items updated together are refreshed once, after the manager is done notifying them
+    int id = 0;
+    renameItem->GetId(&id);
+    m_updatedItemIds.insert(id);
+    if (!m_refreshPending)
     {
-        m_spsrm->GetVisibleItemCount(&visibleItemCount);
+        m_refreshPending = true;
+        PostMessage(m_hwnd, SRUI_REFRESH_ITEMS, 0, 0);
     }
-    m_listview.SetItemCount(visibleItemCount);
-    m_listview.RedrawItems(0, visibleItemCount);
-    _UpdateCounts();
     return S_OK;
 }
 
@@ -588,6 +595,10 @@ INT_PTR CPowerRenameUI::_DlgProc(UINT uMsg, WPARAM wParam, LPARAM lParam)
         _OnDestroyDlg();
         break;
 
+    case SRUI_REFRESH_ITEMS:
+        _RefreshUpdatedItems();
+        break;
+
     default:
         bRet = FALSE;
     }
@@ -1012,6 +1023,27 @@ void CPowerRenameUI::_UpdateCounts()
     }
 }
 
+void CPowerRenameUI::_RefreshUpdatedItems()
+{
+    m_refreshPending = false;
+
+    UINT visibleItemCount = 0;
+    UINT visibleItemsVersion = 0;
+    if (m_spsrm)
+    {
+        m_spsrm->GetVisibleItemCount(&visibleItemCount);
+        m_spsrm->GetVisibleItemsVersion(&visibleItemsVersion);
+
+        m_listview.SetItemCount(visibleItemCount);
+        // When items were shown or hidden the rows after them moved, so all the rows in view are redrawn
+        m_listview.RedrawUpdatedItems(m_spsrm, visibleItemsVersion == m_visibleItemsVersion ? &m_updatedItemIds : nullptr);
+        m_visibleItemsVersion = visibleItemsVersion;
+    }
+
+    m_updatedItemIds.clear();
+    _UpdateCounts();
+}
+
 void CPowerRenameUI::_CollectItemPosition(_In_ DWORD id)
 {
     HWND hwnd = GetDlgItem(m_hwnd, id);
@@ -1102,6 +1134,8 @@ void CPowerRenameListView::ToggleAll(_In_ IPowerRenameManager* psrm, _In_ bool s
             }
         }
 
+        // The selection was changed on the items, the manager computes which ones are visible again
+        psrm->SetVisible();
         psrm->GetVisibleItemCount(&visibleItemCount);
         SetItemCount(visibleItemCount);
         RedrawItems(0, visibleItemCount);
@@ -1117,8 +1151,8 @@ void CPowerRenameListView::ToggleItem(_In_ IPowerRenameManager* psrm, _In_ int i
         spItem->GetSelected(&selected);
         spItem->PutSelected(!selected);
 
-        
         UINT visibleItemCount = 0;
+        psrm->SetVisible();
         psrm->GetVisibleItemCount(&visibleItemCount);
         SetItemCount(visibleItemCount);
         RedrawItems(0, visibleItemCount);
@@ -1169,6 +1203,7 @@ void CPowerRenameListView::UpdateItemCheckState(_In_ IPowerRenameManager* psrm,
 
             // Update the rename column if necessary
             UINT visibleItemCount = 0;
+            psrm->SetVisible();
             psrm->GetVisibleItemCount(&visibleItemCount);
             SetItemCount(visibleItemCount);
             RedrawItems(0, visibleItemCount);
@@ -1273,6 +1308,37 @@ void CPowerRenameListView::RedrawItems(_In_ int first, _In_ int last)
     ListView_RedrawItems(m_hwndLV, first, last);
 }
 
+void CPowerRenameListView::RedrawUpdatedItems(_In_ IPowerRenameManager* psrm, _In_opt_ const std::unordered_set<int>* updatedItemIds)
+{
+    if (m_itemCount == 0)
+    {
+        return;
+    }
+
+    // Only the rows in view are drawn, the others are drawn when they are scrolled into view
+    int first = ListView_GetTopIndex(m_hwndLV);
+    int last = min(static_cast<int>(m_itemCount) - 1, first + ListView_GetCountPerPage(m_hwndLV));
+    if (!updatedItemIds)
+    {
+        RedrawItems(first, last);
+        return;
+    }
+
+    for (int i = first; i <= last; i++)
+    {
+        CComPtr<IPowerRenameItem> spItem;
+        if (SUCCEEDED(psrm->GetVisibleItemByIndex(i, &spItem)))
+        {
+            int id = 0;
+            spItem->GetId(&id);
+            if (updatedItemIds->find(id) != updatedItemIds->end())
+            {
+                RedrawItems(i, i);
+            }
+        }
+    }
+}
+
 void CPowerRenameListView::SetItemCount(_In_ UINT itemCount)
 {
     if (m_itemCount != itemCount)
@@ -2,6 +2,7 @@
 #include <PowerRenameInterfaces.h>
 #include <settings.h>
 #include <shldisp.h>
+#include <unordered_set>
 
 void ModuleAddRef();
 void ModuleRelease();
@@ -17,6 +18,7 @@ public:
     void ToggleItem(_In_ IPowerRenameManager* psrm, _In_ int item);
     void UpdateItemCheckState(_In_ IPowerRenameManager* psrm, _In_ int iItem);
     void RedrawItems(_In_ int first, _In_ int last);
+    void RedrawUpdatedItems(_In_ IPowerRenameManager* psrm, _In_opt_ const std::unordered_set<int>* updatedItemIds);
     void SetItemCount(_In_ UINT itemCount);
     void OnKeyDown(_In_ IPowerRenameManager* psrm, _In_ LV_KEYDOWN* lvKeyDown);
     void OnClickList(_In_ IPowerRenameManager* psrm, NM_LISTVIEW* pnmListView);
@@ -142,6 +144,7 @@ private:
 
     void _EnumerateItems(_In_ IUnknown* pdtobj);
     void _UpdateCounts();
+    void _RefreshUpdatedItems();
 
     void _CollectItemPosition(_In_ DWORD id);
 
@@ -150,6 +153,7 @@ private:
     bool m_enableDragDrop = false;
     bool m_disableCountUpdate = false;
     bool m_modeless = true;
+    bool m_refreshPending = false;
     HWND m_hwnd = nullptr;
     HWND m_hwndLV = nullptr;
     HICON m_iconMain = nullptr;
@@ -171,4 +175,8 @@ private:
     CComPtr<IAutoComplete2> m_spReplaceAC;
     CComPtr<IUnknown> m_spReplaceACL;
     CPowerRenameListView m_listview;
+    // Ids of the items updated since the list view was last refreshed
+    std::unordered_set<int> m_updatedItemIds;
+    // Version of the visible items when the list view was last refreshed
+    UINT m_visibleItemsVersion = 0;
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <DateTimeTemplate.h>
+
+#include <locale>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace DateTimeTemplateTests
+{
+    const SYSTEMTIME testTime = { 2020, 7, 3, 22, 15, 6, 42, 453 };
+
+    std::wstring Expand(PCWSTR replaceTerm, const SYSTEMTIME& time = testTime)
+    {
+        wchar_t result[MAX_PATH] = { 0 };
+        Assert::IsTrue(CDateTimeTemplate(replaceTerm).Expand(result, ARRAYSIZE(result), time) == S_OK);
+        return result;
+    }
+
+    std::wstring FormatName(const SYSTEMTIME& time, PCWSTR format)
+    {
+        wchar_t localeName[LOCALE_NAME_MAX_LENGTH];
+        if (GetUserDefaultLocaleName(localeName, LOCALE_NAME_MAX_LENGTH) == 0)
+        {
+            StringCchCopy(localeName, LOCALE_NAME_MAX_LENGTH, L"en_US");
+        }
+
+        wchar_t formattedDate[MAX_PATH] = { 0 };
+        GetDateFormatEx(localeName, NULL, &time, format, formattedDate, MAX_PATH, NULL);
+        formattedDate[0] = towupper(formattedDate[0]);
+        return formattedDate;
+    }
+
+    TEST_CLASS (ExpandTests)
+    {
+    public:
+        TEST_METHOD (NoPadding)
+        {
+            Assert::AreEqual(std::wstring(L"bar20-7-22-15-6-42-4"), Expand(L"bar$YY-$M-$D-$h-$m-$s-$f"));
+        }
+
+        TEST_METHOD (Padding)
+        {
+            Assert::AreEqual(std::wstring(L"bar2020-07-22-15-06-42-453"), Expand(L"bar$YYYY-$MM-$DD-$hh-$mm-$ss-$fff"));
+            Assert::AreEqual(std::wstring(L"0-45"), Expand(L"$Y-$ff"));
+
+            const SYSTEMTIME early = { 2001, 2, 5, 9, 3, 4, 5, 7 };
+            Assert::AreEqual(std::wstring(L"2001-01-1-02-09-03-04-05-007-00-0"), Expand(L"$YYYY-$YY-$Y-$MM-$DD-$hh-$mm-$ss-$fff-$ff-$f", early));
+        }
+
+        TEST_METHOD (LongestTokenFirst)
+        {
+            Assert::AreEqual(std::wstring(L"20Y"), Expand(L"$YYY"));
+            Assert::AreEqual(std::wstring(L"15h"), Expand(L"$hhh"));
+            Assert::AreEqual(std::wstring(L"453f"), Expand(L"$ffff"));
+        }
+
+        TEST_METHOD (AdjacentTokens)
+        {
+            Assert::AreEqual(std::wstring(L"20200722"), Expand(L"$YYYY$MM$DD"));
+            Assert::AreEqual(std::wstring(L"2222"), Expand(L"$DD$DD"));
+        }
+
+        TEST_METHOD (EscapedTokensAreKept)
+        {
+            Assert::AreEqual(std::wstring(L"$$YYYY"), Expand(L"$$YYYY"));
+            Assert::AreEqual(std::wstring(L"$$2020"), Expand(L"$$$YYYY"));
+            Assert::AreEqual(std::wstring(L"$$$$Y"), Expand(L"$$$$Y"));
+            Assert::AreEqual(std::wstring(L"a$x$1$"), Expand(L"a$x$1$"));
+        }
+
+        TEST_METHOD (MonthAndDayNames)
+        {
+            const SYSTEMTIME time = { 2020, 1, 3, 1, 15, 6, 42, 453 };
+            std::locale::global(std::locale(""));
+
+            Assert::AreEqual(FormatName(time, L"MMM") + L"-" + FormatName(time, L"MMMM"), Expand(L"$MMM-$MMMM", time));
+            Assert::AreEqual(FormatName(time, L"ddd") + L"-" + FormatName(time, L"dddd"), Expand(L"$DDD-$DDDD", time));
+        }
+
+        TEST_METHOD (TruncatedResult)
+        {
+            wchar_t result[6] = { 0 };
+            Assert::IsTrue(CDateTimeTemplate(L"abc$YYYYdef").Expand(result, ARRAYSIZE(result), testTime) == STRSAFE_E_INSUFFICIENT_BUFFER);
+            Assert::AreEqual(L"abc20", result);
+        }
+    };
+
+    TEST_CLASS (UsesDateTimeTests)
+    {
+    public:
+        TEST_METHOD (DateTimeTokens)
+        {
+            PCWSTR replaceTerms[] = { L"$Y", L"a$MMMM", L"$DDD b", L"$$$h", L"$m$", L"x$s", L"$fff" };
+            for (PCWSTR replaceTerm : replaceTerms)
+            {
+                Assert::IsTrue(CDateTimeTemplate(replaceTerm).UsesDateTime());
+            }
+        }
+
+        TEST_METHOD (NoDateTimeTokens)
+        {
+            PCWSTR replaceTerms[] = { L"", L"bar", L"$$Y", L"$1", L"$0", L"Y$", L"$x", L"$$$$MM" };
+            for (PCWSTR replaceTerm : replaceTerms)
+            {
+                Assert::IsFalse(CDateTimeTemplate(replaceTerm).UsesDateTime());
+            }
+        }
+    };
+}
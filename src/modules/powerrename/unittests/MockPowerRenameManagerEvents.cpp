@@ -38,6 +38,7 @@ IFACEMETHODIMP CMockPowerRenameManagerEvents::OnItemAdded(_In_ IPowerRenameItem*
 IFACEMETHODIMP CMockPowerRenameManagerEvents::OnUpdate(_In_ IPowerRenameItem* pItem)
 {
     m_itemUpdated = pItem;
+    m_itemUpdatedCount++;
     return S_OK;
 }
 
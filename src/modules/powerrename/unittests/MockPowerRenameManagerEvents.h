@@ -35,6 +35,7 @@ public:
 
     CComPtr<IPowerRenameItem> m_itemAdded;
     CComPtr<IPowerRenameItem> m_itemUpdated;
+    UINT m_itemUpdatedCount = 0;
     CComPtr<IPowerRenameItem> m_itemError;
     bool m_regExStarted = false;
     bool m_regExCanceled = false;
@@ -158,6 +158,203 @@ namespace PowerRenameManagerTests
             mockMgrEvents->Release();
         }
 
+        TEST_METHOD(VerifyItemLookup)
+        {
+            CComPtr<IPowerRenameManager> mgr;
+            Assert::IsTrue(CPowerRenameManager::s_CreateInstance(&mgr) == S_OK);
+
+            CComPtr<IPowerRenameItem> items[3];
+            CMockPowerRenameItem::CreateInstance(L"foo", L"foo", 0, false, &items[0]);
+            CMockPowerRenameItem::CreateInstance(L"bar", L"bar", 0, false, &items[1]);
+            CMockPowerRenameItem::CreateInstance(L"baz", L"baz", 0, false, &items[2]);
+
+            // Items are kept in the order they were created in, whatever the order they are added in
+            Assert::IsTrue(mgr->AddItem(items[2]) == S_OK);
+            Assert::IsTrue(mgr->AddItem(items[0]) == S_OK);
+            Assert::IsTrue(mgr->AddItem(items[1]) == S_OK);
+            Assert::IsTrue(mgr->AddItem(items[1]) == E_FAIL);
+
+            UINT itemCount = 0;
+            Assert::IsTrue(mgr->GetItemCount(&itemCount) == S_OK);
+            Assert::AreEqual(3u, itemCount);
+
+            for (UINT i = 0; i < ARRAYSIZE(items); i++)
+            {
+                CComPtr<IPowerRenameItem> itemByIndex;
+                Assert::IsTrue(mgr->GetItemByIndex(i, &itemByIndex) == S_OK);
+                Assert::IsTrue(itemByIndex == items[i]);
+
+                int id = 0;
+                items[i]->GetId(&id);
+                CComPtr<IPowerRenameItem> itemById;
+                Assert::IsTrue(mgr->GetItemById(id, &itemById) == S_OK);
+                Assert::IsTrue(itemById == items[i]);
+            }
+
+            CComPtr<IPowerRenameItem> missingItem;
+            Assert::IsTrue(mgr->GetItemByIndex(3, &missingItem) == E_FAIL);
+            Assert::IsTrue(missingItem == nullptr);
+
+            Assert::IsTrue(mgr->Shutdown() == S_OK);
+        }
+
+        TEST_METHOD(VerifyVisibleItems)
+        {
+            CComPtr<IPowerRenameManager> mgr;
+            Assert::IsTrue(CPowerRenameManager::s_CreateInstance(&mgr) == S_OK);
+
+            CComPtr<IPowerRenameItem> items[4];
+            CMockPowerRenameItem::CreateInstance(L"folder", L"folder", 0, true, &items[0]);
+            CMockPowerRenameItem::CreateInstance(L"folder\\foo", L"foo", 1, false, &items[1]);
+            CMockPowerRenameItem::CreateInstance(L"bar", L"bar", 0, false, &items[2]);
+            CMockPowerRenameItem::CreateInstance(L"baz", L"baz", 0, false, &items[3]);
+            for (auto& item : items)
+            {
+                Assert::IsTrue(mgr->AddItem(item) == S_OK);
+            }
+
+            // Switch to the selected items filter, the parent folder of a selected item is visible too
+            Assert::IsTrue(mgr->SwitchFilter(0) == S_OK);
+            items[0]->PutSelected(false);
+            items[2]->PutSelected(false);
+            Assert::IsTrue(mgr->SetVisible() == S_OK);
+
+            UINT visibleItemCount = 0;
+            Assert::IsTrue(mgr->GetVisibleItemCount(&visibleItemCount) == S_OK);
+            Assert::AreEqual(3u, visibleItemCount);
+
+            IPowerRenameItem* expectedItems[] = { items[0], items[1], items[3] };
+            for (UINT i = 0; i < ARRAYSIZE(expectedItems); i++)
+            {
+                CComPtr<IPowerRenameItem> visibleItem;
+                Assert::IsTrue(mgr->GetVisibleItemByIndex(i, &visibleItem) == S_OK);
+                Assert::IsTrue(visibleItem == expectedItems[i]);
+            }
+
+            CComPtr<IPowerRenameItem> missingItem;
+            Assert::IsTrue(mgr->GetVisibleItemByIndex(3, &missingItem) == E_FAIL);
+
+            // An item added later is visible as soon as it is looked up
+            CComPtr<IPowerRenameItem> addedItem;
+            CMockPowerRenameItem::CreateInstance(L"qux", L"qux", 0, false, &addedItem);
+            Assert::IsTrue(mgr->AddItem(addedItem) == S_OK);
+            Assert::IsTrue(mgr->GetVisibleItemCount(&visibleItemCount) == S_OK);
+            Assert::AreEqual(4u, visibleItemCount);
+
+            Assert::IsTrue(mgr->Shutdown() == S_OK);
+        }
+
+        // Dispatches the manager messages until the regex worker is completed
+        bool WaitForRegExCompleted(_In_ CMockPowerRenameManagerEvents* mockMgrEvents)
+        {
+            ULONGLONG timeout = GetTickCount64() + 5000;
+            while (!mockMgrEvents->m_regExCompleted && GetTickCount64() < timeout)
+            {
+                MSG msg;
+                while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+                {
+                    TranslateMessage(&msg);
+                    DispatchMessage(&msg);
+                }
+                Sleep(10);
+            }
+            return mockMgrEvents->m_regExCompleted;
+        }
+
+        TEST_METHOD(VerifyItemUpdatesBeforeRegExCompleted)
+        {
+            CComPtr<IPowerRenameManager> mgr;
+            Assert::IsTrue(CPowerRenameManager::s_CreateInstance(&mgr) == S_OK);
+            CMockPowerRenameManagerEvents* mockMgrEvents = new CMockPowerRenameManagerEvents();
+            CComPtr<IPowerRenameManagerEvents> mgrEvents;
+            Assert::IsTrue(mockMgrEvents->QueryInterface(IID_PPV_ARGS(&mgrEvents)) == S_OK);
+            DWORD cookie = 0;
+            Assert::IsTrue(mgr->Advise(mgrEvents, &cookie) == S_OK);
+
+            CComPtr<IPowerRenameItem> items[2];
+            CMockPowerRenameItem::CreateInstance(L"foo", L"foo", 0, false, &items[0]);
+            CMockPowerRenameItem::CreateInstance(L"bar", L"bar", 0, false, &items[1]);
+            for (auto& item : items)
+            {
+                Assert::IsTrue(mgr->AddItem(item) == S_OK);
+            }
+
+            CComPtr<IPowerRenameRegEx> renRegEx;
+            Assert::IsTrue(mgr->GetRenameRegEx(&renRegEx) == S_OK);
+            renRegEx->PutReplaceTerm(L"baz");
+            Assert::IsTrue(WaitForRegExCompleted(mockMgrEvents));
+            mockMgrEvents->m_regExCompleted = false;
+            mockMgrEvents->m_itemUpdated = nullptr;
+            mockMgrEvents->m_itemUpdatedCount = 0;
+
+            // Only the renamed item is updated, and it is notified before the regex worker is completed
+            renRegEx->PutSearchTerm(L"foo");
+            Assert::IsTrue(WaitForRegExCompleted(mockMgrEvents));
+            Assert::IsTrue(mockMgrEvents->m_itemUpdated == items[0]);
+            Assert::AreEqual(1u, mockMgrEvents->m_itemUpdatedCount);
+
+            PWSTR newName = nullptr;
+            Assert::IsTrue(items[0]->GetNewName(&newName) == S_OK);
+            Assert::AreEqual(std::wstring(L"baz"), std::wstring(newName));
+            CoTaskMemFree(newName);
+
+            Assert::IsTrue(mgr->Shutdown() == S_OK);
+
+            mockMgrEvents->Release();
+        }
+
+        TEST_METHOD(VerifyVisibleItemsAfterItemUpdates)
+        {
+            CComPtr<IPowerRenameManager> mgr;
+            Assert::IsTrue(CPowerRenameManager::s_CreateInstance(&mgr) == S_OK);
+            CMockPowerRenameManagerEvents* mockMgrEvents = new CMockPowerRenameManagerEvents();
+            CComPtr<IPowerRenameManagerEvents> mgrEvents;
+            Assert::IsTrue(mockMgrEvents->QueryInterface(IID_PPV_ARGS(&mgrEvents)) == S_OK);
+            DWORD cookie = 0;
+            Assert::IsTrue(mgr->Advise(mgrEvents, &cookie) == S_OK);
+
+            CComPtr<IPowerRenameItem> items[3];
+            CMockPowerRenameItem::CreateInstance(L"folder", L"folder", 0, true, &items[0]);
+            CMockPowerRenameItem::CreateInstance(L"folder\\foo", L"foo", 1, false, &items[1]);
+            CMockPowerRenameItem::CreateInstance(L"bar", L"bar", 0, false, &items[2]);
+            for (auto& item : items)
+            {
+                Assert::IsTrue(mgr->AddItem(item) == S_OK);
+            }
+
+            // Switch to the should rename filter, the parent folder of a renamed item is visible too
+            Assert::IsTrue(mgr->SwitchFilter(1) == S_OK);
+            CComPtr<IPowerRenameRegEx> renRegEx;
+            Assert::IsTrue(mgr->GetRenameRegEx(&renRegEx) == S_OK);
+            renRegEx->PutReplaceTerm(L"baz");
+            Assert::IsTrue(WaitForRegExCompleted(mockMgrEvents));
+            mockMgrEvents->m_regExCompleted = false;
+            renRegEx->PutSearchTerm(L"foo");
+            Assert::IsTrue(WaitForRegExCompleted(mockMgrEvents));
+            mockMgrEvents->m_regExCompleted = false;
+
+            UINT visibleItemCount = 0;
+            Assert::IsTrue(mgr->GetVisibleItemCount(&visibleItemCount) == S_OK);
+            Assert::AreEqual(2u, visibleItemCount);
+            UINT visibleItemsVersion = 0;
+            Assert::IsTrue(mgr->GetVisibleItemsVersion(&visibleItemsVersion) == S_OK);
+
+            // The replace term doesn't invalidate the visible items, they are updated with the items whose new name changed
+            renRegEx->PutReplaceTerm(L"foo");
+            Assert::IsTrue(WaitForRegExCompleted(mockMgrEvents));
+            Assert::IsTrue(mockMgrEvents->m_itemUpdated == items[1]);
+
+            UINT updatedVisibleItemsVersion = 0;
+            Assert::IsTrue(mgr->GetVisibleItemsVersion(&updatedVisibleItemsVersion) == S_OK);
+            Assert::AreNotEqual(visibleItemsVersion, updatedVisibleItemsVersion);
+            Assert::IsTrue(mgr->GetVisibleItemCount(&visibleItemCount) == S_OK);
+            Assert::AreEqual(0u, visibleItemCount);
+
+            Assert::IsTrue(mgr->Shutdown() == S_OK);
+
+            mockMgrEvents->Release();
+        }
+
         TEST_METHOD(VerifySingleRename)
         {
             // Create a single item and verify rename works as expected
@@ -4,6 +4,11 @@
 #include <PowerRenameRegEx.h>
 #include "MockPowerRenameRegExEvents.h"
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace PowerRenameRegExTests
@@ -381,6 +386,89 @@ TEST_METHOD(VerifyEventsFire)
     Assert::IsTrue(renameRegEx->UnAdvise(cookie) == S_OK);
     mockEvents->Release();
 }
+
+TEST_METHOD(VerifyFlagsChangeAfterTerms)
+{
+    CComPtr<IPowerRenameRegEx> renameRegEx;
+    Assert::IsTrue(CPowerRenameRegEx::s_CreateInstance(&renameRegEx) == S_OK);
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"F.o") == S_OK);
+    Assert::IsTrue(renameRegEx->PutReplaceTerm(L"bar") == S_OK);
+
+    PWSTR result = nullptr;
+    Assert::IsTrue(renameRegEx->Replace(L"fooF.o", &result) == S_OK);
+    Assert::IsTrue(wcscmp(result, L"foobar") == 0);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences | UseRegularExpressions) == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"fooF.o", &result) == S_OK);
+    Assert::IsTrue(wcscmp(result, L"barbar") == 0);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences | UseRegularExpressions | CaseSensitive) == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"fooF.o", &result) == S_OK);
+    Assert::IsTrue(wcscmp(result, L"foobar") == 0);
+    CoTaskMemFree(result);
+}
+
+TEST_METHOD(VerifyInvalidRegExFailsUntilChanged)
+{
+    CComPtr<IPowerRenameRegEx> renameRegEx;
+    Assert::IsTrue(CPowerRenameRegEx::s_CreateInstance(&renameRegEx) == S_OK);
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences | UseRegularExpressions) == S_OK);
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"(foo") == S_OK);
+    Assert::IsTrue(renameRegEx->PutReplaceTerm(L"bar") == S_OK);
+
+    PWSTR result = nullptr;
+    Assert::IsTrue(renameRegEx->Replace(L"(foo", &result) == E_FAIL);
+    Assert::IsTrue(result == nullptr);
+
+    // Without regular expressions the search term is matched literally
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences) == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"(foo", &result) == S_OK);
+    Assert::IsTrue(wcscmp(result, L"bar") == 0);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences | UseRegularExpressions) == S_OK);
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"(foo)") == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"(foo", &result) == S_OK);
+    Assert::IsTrue(wcscmp(result, L"(bar") == 0);
+    CoTaskMemFree(result);
+}
+
+TEST_METHOD(VerifyConcurrentReplace)
+{
+    CComPtr<IPowerRenameRegEx> renameRegEx;
+    Assert::IsTrue(CPowerRenameRegEx::s_CreateInstance(&renameRegEx) == S_OK);
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences | UseRegularExpressions) == S_OK);
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"(\\d+)") == S_OK);
+    Assert::IsTrue(renameRegEx->PutReplaceTerm(L"<$1>") == S_OK);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> failures = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&renameRegEx, &failures, i] {
+            for (int j = 0; j < 500; j++)
+            {
+                const std::wstring source = L"file" + std::to_wstring(i) + L"_" + std::to_wstring(j);
+                const std::wstring expected = L"file<" + std::to_wstring(i) + L">_<" + std::to_wstring(j) + L">";
+                PWSTR result = nullptr;
+                if (renameRegEx->Replace(source.c_str(), &result) != S_OK || expected != result)
+                {
+                    failures++;
+                }
+                CoTaskMemFree(result);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    Assert::AreEqual(0, failures.load());
+}
 }
 ;
 }
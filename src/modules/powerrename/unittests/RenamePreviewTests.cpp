@@ -0,0 +1,119 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <PowerRenameInterfaces.h>
+#include <PowerRenameRegEx.h>
+#include <RenamePreview.h>
+
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RenamePreviewTests
+{
+    CComPtr<IPowerRenameRegEx> CreateRenameRegEx(PCWSTR searchTerm, PCWSTR replaceTerm, DWORD flags)
+    {
+        CComPtr<IPowerRenameRegEx> renameRegEx;
+        Assert::IsTrue(CPowerRenameRegEx::s_CreateInstance(&renameRegEx) == S_OK);
+        Assert::IsTrue(renameRegEx->PutFlags(flags) == S_OK);
+        Assert::IsTrue(renameRegEx->PutSearchTerm(searchTerm) == S_OK);
+        Assert::IsTrue(renameRegEx->PutReplaceTerm(replaceTerm) == S_OK);
+        return renameRegEx;
+    }
+
+    // Files and folders without an item, every third item of the list is a folder
+    std::vector<RenamePreviewItem> CreateItems(size_t count)
+    {
+        std::vector<RenamePreviewItem> items(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            items[i].id = static_cast<int>(i);
+            items[i].isFolder = i % 3 == 0;
+            items[i].originalName = (i % 2 == 0 ? L"report_" : L"photo_") + std::to_wstring(i) + (items[i].isFolder ? L"" : L".txt");
+        }
+        return items;
+    }
+
+    void VerifySameNames(const std::vector<RenamePreviewItem>& expected, const std::vector<RenamePreviewItem>& actual)
+    {
+        Assert::AreEqual(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            Assert::AreEqual(expected[i].excluded, actual[i].excluded);
+            Assert::AreEqual(expected[i].hasNewName, actual[i].hasNewName);
+            Assert::AreEqual(expected[i].newName, actual[i].newName);
+        }
+    }
+
+    TEST_CLASS (ComputeRenamePreviewTests)
+    {
+    public:
+        TEST_METHOD (NewNames)
+        {
+            auto renameRegEx = CreateRenameRegEx(L"report_(\\d+)", L"$1_report", MatchAllOccurences | UseRegularExpressions | ExcludeFolders);
+            auto items = CreateItems(4);
+            unsigned long enumIndex = 1;
+            Assert::IsTrue(ComputeRenamePreview(items.data(), items.size(), renameRegEx, 1, nullptr, &enumIndex) == S_OK);
+
+            Assert::IsTrue(items[0].excluded);
+            Assert::IsFalse(items[0].hasNewName);
+            Assert::IsFalse(items[1].excluded);
+            Assert::IsFalse(items[1].hasNewName);
+            Assert::IsTrue(items[2].hasNewName);
+            Assert::AreEqual(std::wstring(L"2_report.txt"), items[2].newName);
+            Assert::IsTrue(items[3].excluded);
+            Assert::AreEqual(1ul, enumIndex);
+        }
+
+        TEST_METHOD (SameNamesOnSeveralThreads)
+        {
+            auto renameRegEx = CreateRenameRegEx(L"_(\\d)", L"-$1", MatchAllOccurences | UseRegularExpressions | Uppercase | NameOnly);
+            auto expected = CreateItems(5000);
+            auto actual = expected;
+
+            unsigned long expectedEnumIndex = 1;
+            Assert::IsTrue(ComputeRenamePreview(expected.data(), expected.size(), renameRegEx, 1, nullptr, &expectedEnumIndex) == S_OK);
+            unsigned long actualEnumIndex = 1;
+            Assert::IsTrue(ComputeRenamePreview(actual.data(), actual.size(), renameRegEx, 8, nullptr, &actualEnumIndex) == S_OK);
+
+            VerifySameNames(expected, actual);
+            Assert::AreEqual(std::wstring(L"PHOTO-1.txt"), actual[1].newName);
+        }
+
+        TEST_METHOD (EnumeratedInOrderAcrossBatches)
+        {
+            auto renameRegEx = CreateRenameRegEx(L"photo", L"image", MatchAllOccurences | EnumerateItems | ExcludeFolders);
+            auto expected = CreateItems(3000);
+            unsigned long expectedEnumIndex = 1;
+            Assert::IsTrue(ComputeRenamePreview(expected.data(), expected.size(), renameRegEx, 1, nullptr, &expectedEnumIndex) == S_OK);
+
+            // The same items in two batches computed on several threads get the same numbers
+            auto actual = CreateItems(3000);
+            unsigned long actualEnumIndex = 1;
+            Assert::IsTrue(ComputeRenamePreview(actual.data(), 1000, renameRegEx, 4, nullptr, &actualEnumIndex) == S_OK);
+            Assert::IsTrue(ComputeRenamePreview(actual.data() + 1000, 2000, renameRegEx, 4, nullptr, &actualEnumIndex) == S_OK);
+
+            VerifySameNames(expected, actual);
+            Assert::AreEqual(expectedEnumIndex, actualEnumIndex);
+
+            // photo_1.txt and photo_5.txt are the first renamed items, photo_3 is a folder
+            Assert::AreEqual(std::wstring(L"image_1 (1).txt"), actual[1].newName);
+            Assert::IsTrue(actual[3].excluded);
+            Assert::AreEqual(std::wstring(L"image_5 (2).txt"), actual[5].newName);
+            Assert::AreEqual(1001ul, actualEnumIndex);
+        }
+
+        TEST_METHOD (Canceled)
+        {
+            HANDLE cancelEvent = CreateEvent(nullptr, TRUE, TRUE, nullptr);
+            Assert::IsNotNull(cancelEvent);
+
+            auto renameRegEx = CreateRenameRegEx(L"photo", L"image", MatchAllOccurences);
+            auto items = CreateItems(1000);
+            unsigned long enumIndex = 1;
+            Assert::IsTrue(ComputeRenamePreview(items.data(), items.size(), renameRegEx, 4, cancelEvent, &enumIndex) == E_ABORT);
+
+            CloseHandle(cancelEvent);
+        }
+    };
+}